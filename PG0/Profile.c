@@ -52,26 +52,26 @@ static int key_find(const SECTION_INFO *si, const TCHAR *key_name);
 static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCHAR *str, const TCHAR *file_path);
 
 /*
- * trim - ̑Ő, Tab
+ * trim - 文字列の前後の空白, Tabを除去する
  */
 static BOOL trim(TCHAR *buf)
 {
 	TCHAR *p, *r;
 
-	// Ő󔒂|C^擾
+	// 前後の空白を除いたポインタを取得
 	for (p = buf; (*p == TEXT(' ') || *p == TEXT('\t')) && *p != TEXT('\0'); p++)
 		;
 	for (r = buf + lstrlen(buf) - 1; r > p && (*r == TEXT(' ') || *r == TEXT('\t')); r--)
 		;
 	*(r + 1) = TEXT('\0');
 
-	// ̕ɃRs[
+	// 元の文字列にコピー
 	lstrcpy(buf, p);
 	return TRUE;
 }
 
 /*
- * str2hash - ̃nbVl擾
+ * str2hash - 文字列のハッシュ値を取得
  */
 static int str2hash(const TCHAR *str)
 {
@@ -87,7 +87,7 @@ static int str2hash(const TCHAR *str)
 }
 
 /*
- * section_add - ZNV̒ǉ
+ * section_add - セクションの追加
  */
 static BOOL section_add(const TCHAR *section_name)
 {
@@ -98,7 +98,7 @@ static BOOL section_add(const TCHAR *section_name)
 	}
 
 	if (section_size < section_count + 1) {
-		// Ċm
+		// 再確保
 		section_size += ALLOC_SIZE;
 		if ((tmp_section = (SECTION_INFO *)mem_calloc(sizeof(SECTION_INFO) * section_size)) == NULL) {
 			return FALSE;
@@ -109,7 +109,7 @@ static BOOL section_add(const TCHAR *section_name)
 		}
 		section_info = tmp_section;
 	}
-	// ZNVǉ
+	// セクション追加
 	lstrcpyn((section_info + section_count)->section_name, section_name, BUF_SIZE);
 	trim((section_info + section_count)->section_name);
 	(section_info + section_count)->hash = str2hash((section_info + section_count)->section_name);
@@ -119,7 +119,7 @@ static BOOL section_add(const TCHAR *section_name)
 }
 
 /*
- * section_find - ZNV̌
+ * section_find - セクションの検索
  */
 static int section_find(const TCHAR *section_name)
 {
@@ -143,7 +143,7 @@ static int section_find(const TCHAR *section_name)
 }
 
 /*
- * key_add - L[̒ǉ
+ * key_add - キーの追加
  */
 static BOOL key_add(SECTION_INFO *si, const TCHAR *key_name, const TCHAR *str, const BOOL comment_flag)
 {
@@ -155,7 +155,7 @@ static BOOL key_add(SECTION_INFO *si, const TCHAR *key_name, const TCHAR *str, c
 	}
 
 	if (si->key_size < si->key_count + 1) {
-		// Ċm
+		// 再確保
 		si->key_size += ALLOC_SIZE;
 		if ((tmp_key = (KEY_INFO *)mem_calloc(sizeof(KEY_INFO) * si->key_size)) == NULL) {
 			return FALSE;
@@ -166,7 +166,7 @@ static BOOL key_add(SECTION_INFO *si, const TCHAR *key_name, const TCHAR *str, c
 		}
 		si->key_info = tmp_key;
 	}
-	// L[ǉ
+	// キー追加
 	(si->key_info + si->key_count)->string = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(str) + 1));
 	if ((si->key_info + si->key_count)->string == NULL) {
 		return FALSE;
@@ -184,7 +184,7 @@ static BOOL key_add(SECTION_INFO *si, const TCHAR *key_name, const TCHAR *str, c
 }
 
 /*
- * key_find - L[̌
+ * key_find - キーの検索
  */
 static int key_find(const SECTION_INFO *si, const TCHAR *key_name)
 {
@@ -209,7 +209,7 @@ static int key_find(const SECTION_INFO *si, const TCHAR *key_name)
 }
 
 /*
- * profile_initialize - 
+ * profile_initialize - 初期化
  */
 BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 {
@@ -226,23 +226,23 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 		return TRUE;
 	}
 
-	// t@CJ
+	// ファイルを開く
 	hFile = CreateFile(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
 	if (hFile == NULL || hFile == (HANDLE)-1) {
 		return FALSE;
 	}
-	// mۂTCY̎擾
+	// 確保するサイズの取得
 	if ((size_low = GetFileSize(hFile, &size_high)) == 0xFFFFFFFF) {
 		CloseHandle(hFile);
 		return FALSE;
 	}
 
-	// ǂݎ̈̊m
+	// 読み取る領域の確保
 	if ((cbuf = (BYTE *)mem_alloc(size_low + sizeof(WCHAR))) == NULL) {
 		CloseHandle(hFile);
 		return FALSE;
 	}
-	// t@Cǂݍ
+	// ファイルを読み込む
 	if (ReadFile(hFile, cbuf, size_low, &ret, NULL) == FALSE) {
 		mem_free(&cbuf);
 		CloseHandle(hFile);
@@ -252,12 +252,12 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 
 #ifdef UNICODE
 	if(size_low > 2 && *cbuf == 0xFF && *(cbuf + 1) == 0xFE) {
-		// BOMXLbv
+		// BOMをスキップ
 		len = (size_low - 2) / sizeof(TCHAR);
 		buf = (TCHAR *)(cbuf + 2);
 		*(buf + len) = TEXT('\0');
 	} else {
-		// Unicodeɕϊ
+		// Unicodeに変換
 		*(cbuf + size_low) = '\0';
 		len = MultiByteToWideChar(CP_ACP, 0, cbuf, -1, NULL, 0);
 		if ((buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * len)) == NULL) {
@@ -273,9 +273,9 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 	if(size_low > 2 && *cbuf == 0xFF && *(cbuf + 1) == 0xFE) {
 		WCHAR *wbuf = (WCHAR *)cbuf;
 		*(wbuf + (size_low / sizeof(WCHAR))) = L'\0';
-		// BOMXLbv
+		// BOMをスキップ
 		wbuf++;
-		// }`oCgɕϊ
+		// マルチバイトに変換
 		len = WideCharToMultiByte(CP_ACP, 0, wbuf, -1, NULL, 0, NULL, NULL);
 		if ((buf = (char *)mem_alloc(sizeof(char) * len)) == NULL) {
 			mem_free(&cbuf);
@@ -291,7 +291,7 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 	}
 #endif
 
-	// ZNV̊m
+	// セクションの確保
 	if ((section_info = (SECTION_INFO *)mem_calloc(sizeof(SECTION_INFO) * ALLOC_SIZE)) == NULL) {
 		mem_free(&cbuf);
 		return FALSE;
@@ -306,7 +306,7 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 
 		switch (*p) {
 		case TEXT('['):
-			// ZNV̒ǉ
+			// セクションの追加
 			if (p == r || *(r - 1) != TEXT(']')) {
 				break;
 			}
@@ -323,14 +323,14 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 				break;
 			}
 			if (*p == TEXT('#')) {
-				// Rg
+				// コメント
 				for (s = tmp; p < r; p++, s++) {
 					*s = *p;
 				}
 				*s = TEXT('\0');
 				key_add((section_info + section_count - 1), tmp, TEXT(""), TRUE);
 			} else {
-				// L[̒ǉ
+				// キーの追加
 				for (s = tmp; p < r; p++, s++) {
 					if (*p == TEXT('=')) {
 						break;
@@ -357,7 +357,7 @@ BOOL profile_initialize(const TCHAR *path, const BOOL ReadFlag)
 }
 
 /*
- * profile_flush - obt@t@Cɏ
+ * profile_flush - バッファをファイルに書き込む
  */
 BOOL profile_flush(const TCHAR *path)
 {
@@ -371,13 +371,13 @@ BOOL profile_flush(const TCHAR *path)
 		return FALSE;
 	}
 
-	// ۑTCY̌vZ
+	// 保存サイズの計算
 	len = 0;
 	for (i = 0; i < section_count; i++) {
 		if ((section_info + i)->key_info == NULL) {
 			continue;
 		}
-		// ZNV
+		// セクション名
 		if (i != 0) {
 			len += lstrlen((section_info + i)->section_name) + 4;
 		}
@@ -385,12 +385,12 @@ BOOL profile_flush(const TCHAR *path)
 			if (*((section_info + i)->key_info + j)->key_name == TEXT('\0')) {
 				continue;
 			}
-			// L[
+			// キー名
 			len += lstrlen(((section_info + i)->key_info + j)->key_name);
 			if (((section_info + i)->key_info + j)->comment_flag == FALSE) {
 				len++;
 				if (((section_info + i)->key_info + j)->string != NULL) {
-					// 
+					// 文字列
 					len += lstrlen(((section_info + i)->key_info + j)->string);
 				}
 			}
@@ -399,7 +399,7 @@ BOOL profile_flush(const TCHAR *path)
 		len += 2;
 	}
 
-	// ۑ邽߂̗̈̊m
+	// 保存するための領域の確保
 #ifdef UNICODE
 	if ((buf = (TCHAR *)mem_alloc(2 + sizeof(TCHAR) * (len + 1))) == NULL) {
 		return FALSE;
@@ -413,12 +413,12 @@ BOOL profile_flush(const TCHAR *path)
 		return FALSE;
 	}
 #endif
-	// ۑ̍쐬
+	// 保存文字列の作成
 	for (i = 0; i < section_count; i++) {
 		if ((section_info + i)->key_info == NULL) {
 			continue;
 		}
-		// ZNV
+		// セクション名
 		if (i != 0) {
 			*(p++) = TEXT('[');
 			lstrcpy(p, (section_info + i)->section_name);
@@ -431,13 +431,13 @@ BOOL profile_flush(const TCHAR *path)
 			if (*((section_info + i)->key_info + j)->key_name == TEXT('\0')) {
 				continue;
 			}
-			// L[
+			// キー名
 			lstrcpy(p, ((section_info + i)->key_info + j)->key_name);
 			p += lstrlen(p);
 			if (((section_info + i)->key_info + j)->comment_flag == FALSE) {
 				*(p++) = TEXT('=');
 				if (((section_info + i)->key_info + j)->string != NULL) {
-					// 
+					// 文字列
 					lstrcpy(p, ((section_info + i)->key_info + j)->string);
 					p += lstrlen(p);
 				}
@@ -450,13 +450,13 @@ BOOL profile_flush(const TCHAR *path)
 	}
 	*p = TEXT('\0');
 
-	// t@CJ
+	// ファイルを開く
 	hFile = CreateFile(path, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
 	if (hFile == NULL || hFile == (HANDLE)-1) {
 		mem_free(&buf);
 		return FALSE;
 	}
-	// t@Cɏ
+	// ファイルに書き込む
 #ifdef UNICODE
 	if (WriteFile(hFile, buf, 2 + sizeof(TCHAR) * len, &ret, NULL) == FALSE) {
 #else
@@ -466,16 +466,16 @@ BOOL profile_flush(const TCHAR *path)
 		CloseHandle(hFile);
 		return FALSE;
 	}
-	// ̉
+	// メモリの解放
 	mem_free(&buf);
-	// t@C
+	// ファイルを閉じる
 	FlushFileBuffers(hFile);
 	CloseHandle(hFile);
 	return TRUE;
 }
 
 /*
- * profile_free - ݒ̉
+ * profile_free - 設定情報の解放
  */
 void profile_free(void)
 {
@@ -488,7 +488,7 @@ void profile_free(void)
 		if ((section_info + i)->key_info == NULL) {
 			continue;
 		}
-		// L[̉
+		// キーの解放
 		for (j = 0; j < (section_info + i)->key_count; j++) {
 			if (((section_info + i)->key_info + j)->string != NULL) {
 				mem_free(&((section_info + i)->key_info + j)->string);
@@ -503,7 +503,7 @@ void profile_free(void)
 }
 
 /*
- * profile_get_string - ̎擾
+ * profile_get_string - 文字列の取得
  */
 long profile_get_string(const TCHAR *section, const TCHAR *key, const TCHAR *default_str, TCHAR *ret, const long size, const TCHAR *file_path)
 {
@@ -512,20 +512,20 @@ long profile_get_string(const TCHAR *section, const TCHAR *key, const TCHAR *def
 	int key_index;
 	int len;
 
-	// ZNV̌
+	// セクションの検索
 	if ((section_index = section_find(section)) == -1) {
 		lstrcpyn(ret, default_str, size);
 		return lstrlen(ret);
 	}
 
-	// L[̌
+	// キーの検索
 	key_index = key_find((section_info + section_index), key);
 	if (key_index == -1 || ((section_info + section_index)->key_info + key_index)->string == NULL) {
 		lstrcpyn(ret, default_str, size);
 		return lstrlen(ret);
 	}
 
-	// e̎擾
+	// 内容の取得
 	buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(((section_info + section_index)->key_info + key_index)->string) + 1));
 	if (buf != NULL) {
 		lstrcpy(buf, ((section_info + section_index)->key_info + key_index)->string);
@@ -543,7 +543,7 @@ long profile_get_string(const TCHAR *section, const TCHAR *key, const TCHAR *def
 }
 
 /*
- * profile_alloc_string - obt@mۂĕ̎擾
+ * profile_alloc_string - バッファを確保して文字列の取得
  */
 TCHAR *profile_alloc_string(const TCHAR *section, const TCHAR *key, const TCHAR *default_str, const TCHAR *file_path)
 {
@@ -552,7 +552,7 @@ TCHAR *profile_alloc_string(const TCHAR *section, const TCHAR *key, const TCHAR
 	int key_index;
 	int len;
 
-	// ZNV̌
+	// セクションの検索
 	if ((section_index = section_find(section)) == -1) {
 		if ((buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(default_str) + 1))) != NULL) {
 			lstrcpy(buf, default_str);
@@ -561,7 +561,7 @@ TCHAR *profile_alloc_string(const TCHAR *section, const TCHAR *key, const TCHAR
 		return NULL;
 	}
 
-	// L[̌
+	// キーの検索
 	key_index = key_find((section_info + section_index), key);
 	if (key_index == -1 || ((section_info + section_index)->key_info + key_index)->string == NULL) {
 		if ((buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(default_str) + 1))) != NULL) {
@@ -571,7 +571,7 @@ TCHAR *profile_alloc_string(const TCHAR *section, const TCHAR *key, const TCHAR
 		return NULL;
 	}
 
-	// e̎擾
+	// 内容の取得
 	buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(((section_info + section_index)->key_info + key_index)->string) + 1));
 	if (buf != NULL) {
 		lstrcpy(buf, ((section_info + section_index)->key_info + key_index)->string);
@@ -588,7 +588,7 @@ TCHAR *profile_alloc_string(const TCHAR *section, const TCHAR *key, const TCHAR
 }
 
 /*
- * profile_free_string - obt@̉
+ * profile_free_string - バッファの解放
  */
 void profile_free_string(TCHAR *buf)
 {
@@ -596,7 +596,7 @@ void profile_free_string(TCHAR *buf)
 }
 
 /*
- * profile_get_int - l̎擾
+ * profile_get_int - 数値の取得
  */
 int profile_get_int(const TCHAR *section, const TCHAR *key, const int default_str, const TCHAR *file_path)
 {
@@ -606,18 +606,18 @@ int profile_get_int(const TCHAR *section, const TCHAR *key, const int default_st
 	int ret;
 	int len;
 
-	// ZNV̌
+	// セクションの検索
 	if ((section_index = section_find(section)) == -1) {
 		return default_str;
 	}
 
-	// L[̌
+	// キーの検索
 	key_index = key_find((section_info + section_index), key);
 	if (key_index == -1 || ((section_info + section_index)->key_info + key_index)->string == NULL) {
 		return default_str;
 	}
 
-	// e̎擾
+	// 内容の取得
 	buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(((section_info + section_index)->key_info + key_index)->string) + 1));
 	if (buf != NULL) {
 		lstrcpy(buf, ((section_info + section_index)->key_info + key_index)->string);
@@ -635,7 +635,7 @@ int profile_get_int(const TCHAR *section, const TCHAR *key, const int default_st
 }
 
 /*
- * profile_write_data - f[^̏
+ * profile_write_data - データの書き込み
  */
 static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCHAR *str, const TCHAR *file_path)
 {
@@ -648,7 +648,7 @@ static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCH
 	}
 
 	if (section_info == NULL) {
-		// ZNV̊m
+		// セクションの確保
 		if ((section_info = (SECTION_INFO *)mem_calloc(sizeof(SECTION_INFO) * ALLOC_SIZE)) == NULL) {
 			return FALSE;
 		}
@@ -656,9 +656,9 @@ static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCH
 		section_size = ALLOC_SIZE;
 	}
 
-	// ZNV̌
+	// セクションの検索
 	if ((section_index = section_find(section)) == -1) {
-		// ZNV̒ǉ
+		// セクションの追加
 		if (section_add(section) == FALSE) {
 			return FALSE;
 		}
@@ -667,7 +667,7 @@ static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCH
 
 	if (key == NULL) {
 		if ((section_info + section_index)->key_info != NULL) {
-			// L[̍폜
+			// キーの削除
 			for (j = 0; j < (section_info + section_index)->key_count; j++) {
 				if (((section_info + section_index)->key_info + j)->string != NULL) {
 					mem_free(&((section_info + section_index)->key_info + j)->string);
@@ -681,12 +681,12 @@ static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCH
 		return TRUE;
 	}
 
-	// L[̌
+	// キーの検索
 	if ((key_index = key_find((section_info + section_index), key)) == -1) {
-		// L[̒ǉ
+		// キーの追加
 		return key_add((section_info + section_index), key, str, FALSE);
 	} else {
-		// e̕ύX
+		// 内容の変更
 		if (((section_info + section_index)->key_info + key_index)->string != NULL) {
 			mem_free(&((section_info + section_index)->key_info + key_index)->string);
 		}
@@ -705,7 +705,7 @@ static BOOL profile_write_data(const TCHAR *section, const TCHAR *key, const TCH
 }
 
 /*
- * profile_write_string - ̏
+ * profile_write_string - 文字列の書き込み
  */
 BOOL profile_write_string(const TCHAR *section, const TCHAR *key, const TCHAR *str, const TCHAR *file_path)
 {
@@ -731,7 +731,7 @@ BOOL profile_write_string(const TCHAR *section, const TCHAR *key, const TCHAR *s
 }
 
 /*
- * profile_write_int - l̏
+ * profile_write_int - 数値の書き込み
  */
 BOOL profile_write_int(const TCHAR *section, const TCHAR *key, const int num, const TCHAR *file_path)
 {
@@ -10,6 +10,7 @@
 
 /* Include Files */
 #include <windows.h>
+#include <limits.h>
 #ifdef OP_XP_STYLE
 #include <uxtheme.h>
 #include <vssym32.h>
@@ -29,11 +30,18 @@
 #endif
 #define LOCOLOR(c)				(c & 0xF)
 
-/* zC[bZ[W */
+//文字幅のキャッシュの数
+#define CHAR_WIDTH_SIZE			0x10000
+
+//表示行の先頭位置
+#define LINE_PTR(bf, i)			((bf)->buf - (bf)->top + *((bf)->line + (i)))
+#define LINE_OFFSET(bf, p)		((int)((p) - (bf)->buf) + (bf)->top)
+
+/* ホイールメッセージ */
 #ifndef WM_MOUSEWHEEL
 #define WM_MOUSEWHEEL			0x020A
 #endif
-// XPe[}ύXʒm
+// XPテーマ変更通知
 #ifndef WM_THEMECHANGED
 #define WM_THEMECHANGED			0x031A
 #endif
@@ -50,7 +58,28 @@
 #define IS_LEAD_TBYTE(tb)				IsDBCSLeadByte(tb)
 #endif
 
+//出力キュー
+#define ID_QUEUE_TIMER					1
+//チャンクの文字数
+#define QUEUE_CHUNK_SIZE				8192
+//キューの上限 (超えた場合は追加側で取り出しを待つ)
+#define QUEUE_LIMIT						(1024 * 1024)
+//追加の間隔 (ミリ秒)
+#define QUEUE_INTERVAL					16
+
 /* Global Variables */
+//出力キューのチャンク
+typedef struct _VIEW_CHUNK {
+	struct _VIEW_CHUNK *next;
+	//追加済みの文字数 (追加側のみ更新)
+	volatile LONG len;
+	//取り出した位置 (取り出し側のみ更新)
+	LONG read;
+	LONG end;
+	LONG size;
+	TCHAR buf[1];
+} VIEW_CHUNK;
+
 typedef struct _PUTINFO {
 	BOOL sel;
 	BOOL bold;
@@ -63,38 +92,60 @@ typedef struct _PUTINFO {
 	COLORREF rbackColor;
 } PUTINFO;
 
+//描画用のキャッシュ
+typedef struct _VIEW_CACHE {
+	//文字幅 (通常と太字、値は幅 + 1 で 0 は未取得)
+	short width[2][CHAR_WIDTH_SIZE];
+
+	//レイアウトを保持している表示行の先頭と長さ
+	TCHAR *layout_line;
+	int layout_len;
+	//文字の区切り位置と X 座標
+	int *layout_pos;
+	int *layout_x;
+	int layout_cnt;
+	int layout_size;
+
+	//行頭の装飾状態を保持している位置
+	TCHAR *style_line;
+	PUTINFO style_pi;
+} VIEW_CACHE;
+
 /* Local Function Prototypes */
-static TCHAR *TStrCpy(TCHAR *ret, const TCHAR *buf);
 static HFONT CreateViewFont(const HDC hdc, const VIEW_BUFFER *bf,
 							const BOOL bold, const BOOL underline, const BOOL italic);
 static BOOL Text2Clipboard(const HWND hWnd, const TCHAR *st, const TCHAR *en);
 static void SetScrollBar(HWND hWnd, VIEW_BUFFER *bf, int bottom);
+static BOOL AllocBuffer(VIEW_BUFFER *bf, const int size);
+static void FreeBuffer(VIEW_BUFFER *bf);
+static void ClearBuffer(VIEW_BUFFER *bf);
+static BOOL ReserveBuffer(VIEW_BUFFER *bf, const int len);
+static void DeleteText(VIEW_BUFFER *bf, TCHAR *r);
+static BOOL InitLine(VIEW_BUFFER *bf);
+static void FreeLine(VIEW_BUFFER *bf);
 static BOOL AllocLine(VIEW_BUFFER *bf);
+static void ClearCache(VIEW_BUFFER *bf, const BOOL font);
+static int GetCharExtent(VIEW_BUFFER *bf, const TCHAR *p, const int clen, const BOOL bold);
+static int GetTextWidth(VIEW_BUFFER *bf, const TCHAR *s, const int len, const BOOL bold);
+static int GetLineIndex(VIEW_BUFFER *bf, const TCHAR *p);
+static int GetLogicalLine(VIEW_BUFFER *bf, int i);
+static void GetLineStyle(VIEW_BUFFER *bf, int i, PUTINFO *pi);
+static BOOL GetLineLayout(VIEW_BUFFER *bf, int i);
 static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st);
 static void ReCountLine(VIEW_BUFFER *bf, int ln);
 static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str);
+static VIEW_CHUNK *AllocChunk(const int size);
+static BOOL InitQueue(VIEW_BUFFER *bf);
+static void FreeQueue(VIEW_BUFFER *bf);
+static BOOL FlushQueue(HWND hWnd, VIEW_BUFFER *bf);
 static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi);
-static int Char2Caret(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi, TCHAR *cp);
+static int Char2Caret(VIEW_BUFFER *bf, int i, TCHAR *cp);
 static TCHAR *Point2Caret(HWND hWnd, VIEW_BUFFER *bf, int x, int y);
 static void GetCaretToken(VIEW_BUFFER *bf, TCHAR **st, TCHAR **en);
 static void RefreshLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *p, TCHAR *r);
 
 /*
- * TStrCpy - Rs[čŌ̃̕AhXԂ
- */
-static TCHAR *TStrCpy(TCHAR *ret, const TCHAR *buf)
-{
-	if(buf == NULL){
-		*ret = TEXT('\0');
-		return ret;
-	}
-	while(*(ret++) = *(buf++));
-	ret--;
-	return ret;
-}
-
-/*
- * CreateViewFont - tHg쐬
+ * CreateViewFont - フォントを作成する
  */
 static HFONT CreateViewFont(const HDC hdc, const VIEW_BUFFER *bf,
 							const BOOL bold, const BOOL underline, const BOOL italic)
@@ -109,14 +160,14 @@ static HFONT CreateViewFont(const HDC hdc, const VIEW_BUFFER *bf,
 }
 
 /*
- * Text2Clipboard - Nbv{[hɐݒ
+ * Text2Clipboard - 文字列をクリップボードに設定
  */
 static BOOL Text2Clipboard(const HWND hWnd, const TCHAR *st, const TCHAR *en)
 {
 	HANDLE hMem;
 	TCHAR *buf;
 
-	//Nbv{[hJ
+	//クリップボードを開く
 	if(OpenClipboard(hWnd) == FALSE){
 		return FALSE;
 	}
@@ -148,7 +199,7 @@ static BOOL Text2Clipboard(const HWND hWnd, const TCHAR *st, const TCHAR *en)
 }
 
 /*
- * SetScrollBar - XN[o[̐ݒ
+ * SetScrollBar - スクロールバーの設定
  */
 static void SetScrollBar(HWND hWnd, VIEW_BUFFER *bf, int bottom)
 {
@@ -173,7 +224,7 @@ static void SetScrollBar(HWND hWnd, VIEW_BUFFER *bf, int bottom)
 }
 
 /*
- * GetColor - F̎擾
+ * GetColor - 色の取得
  */
 static COLORREF GetColor(char c, COLORREF def)
 {
@@ -200,7 +251,7 @@ static COLORREF GetColor(char c, COLORREF def)
 }
 
 /*
- * SetColor - F̐ݒ
+ * SetColor - 色の設定
  */
 static TCHAR *SetColor(TCHAR *p, char *ret, char *style)
 {
@@ -242,37 +293,479 @@ static TCHAR *SetColor(TCHAR *p, char *ret, char *style)
 }
 
 /*
- * AllocLine - s̊m
+ * AllocBuffer - バッファの確保
+ */
+static BOOL AllocBuffer(VIEW_BUFFER *bf, const int size)
+{
+	FreeBuffer(bf);
+	bf->size = size;
+	bf->buf = mem_alloc(sizeof(TCHAR) * bf->size);
+	if(bf->buf == NULL) return FALSE;
+	bf->color = mem_calloc(sizeof(char) * bf->size);
+	if(bf->color == NULL) return FALSE;
+	bf->style = mem_calloc(sizeof(char) * bf->size);
+	if(bf->style == NULL) return FALSE;
+	*bf->buf = TEXT('\0');
+	bf->len = 0;
+	bf->sp = bf->cp = bf->buf;
+	return TRUE;
+}
+
+/*
+ * FreeBuffer - バッファの解放
+ */
+static void FreeBuffer(VIEW_BUFFER *bf)
+{
+	TCHAR *p;
+	char *cp;
+
+	if(bf->buf != NULL){
+		p = bf->buf - bf->top;
+		mem_free(&p);
+	}
+	if(bf->style != NULL){
+		cp = bf->style - bf->top;
+		mem_free(&cp);
+	}
+	if(bf->color != NULL){
+		cp = bf->color - bf->top;
+		mem_free(&cp);
+	}
+	bf->buf = NULL;
+	bf->style = NULL;
+	bf->color = NULL;
+	bf->top = 0;
+	ClearCache(bf, FALSE);
+}
+
+/*
+ * ClearBuffer - バッファの内容を消去 (確保したバッファは再利用)
+ */
+static void ClearBuffer(VIEW_BUFFER *bf)
+{
+	bf->buf -= bf->top;
+	bf->style -= bf->top;
+	bf->color -= bf->top;
+	ZeroMemory(bf->color, sizeof(char) * (bf->top + bf->len + 1));
+	ZeroMemory(bf->style, sizeof(char) * (bf->top + bf->len + 1));
+	bf->top = 0;
+	*bf->buf = TEXT('\0');
+	bf->len = 0;
+	bf->sp = bf->cp = bf->buf;
+
+	bf->line -= bf->line_top;
+	bf->linelen -= bf->line_top;
+	bf->line_top = 0;
+	*bf->line = 0;
+	bf->view_line = 1;
+	ClearCache(bf, FALSE);
+}
+
+/*
+ * ReserveBuffer - 末尾に追加するサイズを確保
+ *
+ *	削除済みの領域が残りの文字数以上の場合は先頭に詰める
+ *	(詰める量は削除した文字数以下のため、追加文字数に対して償却 O(1))
+ */
+static BOOL ReserveBuffer(VIEW_BUFFER *bf, const int len)
+{
+	TCHAR *p;
+	char *cp;
+	int size;
+	int i;
+
+	if(bf->top + bf->len + len + 1 <= bf->size){
+		return TRUE;
+	}
+	if(bf->top > 0 && bf->top >= bf->len && bf->len + len + 1 <= bf->size){
+		//先頭に詰める
+		MoveMemory(bf->buf - bf->top, bf->buf, sizeof(TCHAR) * (bf->len + 1));
+		MoveMemory(bf->style - bf->top, bf->style, sizeof(char) * (bf->len + 1));
+		MoveMemory(bf->color - bf->top, bf->color, sizeof(char) * (bf->len + 1));
+		bf->buf -= bf->top;
+		bf->style -= bf->top;
+		bf->color -= bf->top;
+		ZeroMemory(bf->style + bf->len + 1, sizeof(char) * bf->top);
+		ZeroMemory(bf->color + bf->len + 1, sizeof(char) * bf->top);
+		for(i = 0; i < bf->view_line; i++){
+			*(bf->line + i) -= bf->top;
+		}
+		bf->cp -= bf->top;
+		bf->sp -= bf->top;
+		bf->top = 0;
+		ClearCache(bf, FALSE);
+		return TRUE;
+	}
+
+	//倍に拡張
+	size = bf->top + bf->len + len + 1;
+	size += (bf->size > RESERVE_SZIE) ? bf->size : RESERVE_SZIE;
+
+	cp = mem_realloc(bf->color - bf->top, size);
+	if(cp == NULL) return FALSE;
+	ZeroMemory(cp + bf->size, sizeof(char) * (size - bf->size));
+	bf->color = cp + bf->top;
+
+	cp = mem_realloc(bf->style - bf->top, size);
+	if(cp == NULL) return FALSE;
+	ZeroMemory(cp + bf->size, sizeof(char) * (size - bf->size));
+	bf->style = cp + bf->top;
+
+	p = mem_realloc(bf->buf - bf->top, sizeof(TCHAR) * size);
+	if(p == NULL) return FALSE;
+	bf->cp = p + bf->top + (bf->cp - bf->buf);
+	bf->sp = p + bf->top + (bf->sp - bf->buf);
+	bf->buf = p + bf->top;
+	bf->size = size;
+	ClearCache(bf, FALSE);
+	return TRUE;
+}
+
+/*
+ * DeleteText - 先頭から r の前までの文字列を削除
+ *
+ *	buf の位置を進めるのみで移動はしない
+ */
+static void DeleteText(VIEW_BUFFER *bf, TCHAR *r)
+{
+	int i = (int)(r - bf->buf);
+
+	bf->buf += i;
+	bf->style += i;
+	bf->color += i;
+	bf->top += i;
+	bf->len -= i;
+	if(bf->cp < bf->buf) bf->cp = bf->buf;
+	if(bf->sp < bf->buf) bf->sp = bf->buf;
+	ClearCache(bf, FALSE);
+}
+
+/*
+ * InitLine - 行情報の初期化
+ */
+static BOOL InitLine(VIEW_BUFFER *bf)
+{
+	FreeLine(bf);
+	bf->linesize = RESERVE_LINE;
+	bf->line = mem_calloc(sizeof(int) * bf->linesize);
+	if(bf->line == NULL) return FALSE;
+	bf->linelen = mem_calloc(sizeof(int) * bf->linesize);
+	if(bf->linelen == NULL) return FALSE;
+	*bf->line = bf->top;
+	bf->view_line = 1;
+	ClearCache(bf, FALSE);
+	return TRUE;
+}
+
+/*
+ * FreeLine - 行情報の解放
+ */
+static void FreeLine(VIEW_BUFFER *bf)
+{
+	int *mi;
+
+	if(bf->line != NULL){
+		mi = bf->line - bf->line_top;
+		mem_free(&mi);
+	}
+	if(bf->linelen != NULL){
+		mi = bf->linelen - bf->line_top;
+		mem_free(&mi);
+	}
+	bf->line = NULL;
+	bf->linelen = NULL;
+	bf->line_top = 0;
+}
+
+/*
+ * AllocLine - 行情報の確保
+ *
+ *	削除済みの行が残りの行数以上の場合は先頭に詰める
  */
 static BOOL AllocLine(VIEW_BUFFER *bf)
 {
 	int *mi;
+	int size;
+
+	if(bf->line_top > 0 && bf->line_top >= bf->view_line){
+		MoveMemory(bf->line - bf->line_top, bf->line, sizeof(int) * bf->view_line);
+		MoveMemory(bf->linelen - bf->line_top, bf->linelen, sizeof(int) * bf->view_line);
+		bf->line -= bf->line_top;
+		bf->linelen -= bf->line_top;
+		bf->line_top = 0;
+		return TRUE;
+	}
 
-	bf->linesize += RESERVE_LINE;
-	mi = mem_realloc(bf->line, sizeof(int) * bf->linesize);
+	size = bf->linesize + ((bf->linesize > RESERVE_LINE) ? bf->linesize : RESERVE_LINE);
+	mi = mem_realloc(bf->line - bf->line_top, sizeof(int) * size);
 	if(mi == NULL){
 		return FALSE;
 	}
-	bf->line = mi;
+	bf->line = mi + bf->line_top;
 	
-	mi = mem_realloc(bf->linelen, sizeof(int) * bf->linesize);
+	mi = mem_realloc(bf->linelen - bf->line_top, sizeof(int) * size);
 	if(mi == NULL){
 		return FALSE;
 	}
-	bf->linelen = mi;
+	bf->linelen = mi + bf->line_top;
+	bf->linesize = size;
 	return TRUE;
 }
 
 /*
- * CountLine - s̐ݒ
+ * ClearCache - キャッシュの破棄
+ *
+ *	テキストの位置や折り返しが変わった場合はレイアウトと装飾状態、
+ *	フォントが変わった場合は文字幅も破棄する
  */
-static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
+static void ClearCache(VIEW_BUFFER *bf, const BOOL font)
+{
+	if(bf->cache == NULL){
+		return;
+	}
+	bf->cache->layout_line = NULL;
+	bf->cache->style_line = NULL;
+	if(font == TRUE){
+		ZeroMemory(bf->cache->width, sizeof(bf->cache->width));
+	}
+}
+
+/*
+ * GetCharExtent - 1文字の幅を取得
+ *
+ *	幅はフォントごとにキャッシュし、未取得の場合のみ GDI で計測する
+ */
+static int GetCharExtent(VIEW_BUFFER *bf, const TCHAR *p, const int clen, const BOOL bold)
 {
 	HFONT hFont;
 	HFONT hRetFont;
-	HFONT hTmpFont;
-	RECT rect;
 	SIZE sz;
+	int key = -1;
+
+#ifdef UNICODE
+	if(clen == 0){
+		key = (TBYTE)*p;
+	}
+#else
+	key = (clen == 0) ? (BYTE)*p : (((BYTE)*p << 8) | (BYTE)*(p + 1));
+#endif
+	if(key >= 0 && bf->cache != NULL && bf->cache->width[(bold == TRUE) ? 1 : 0][key] != 0){
+		return bf->cache->width[(bold == TRUE) ? 1 : 0][key] - 1;
+	}
+
+	hFont = CreateViewFont(bf->mdc, bf, bold, FALSE, FALSE);
+	hRetFont = SelectObject(bf->mdc, hFont);
+	GetTextExtentPoint32(bf->mdc, p, clen + 1, &sz);
+	SelectObject(bf->mdc, hRetFont);
+	DeleteObject(hFont);
+
+	if(key >= 0 && bf->cache != NULL && sz.cx >= 0 && sz.cx < SHRT_MAX){
+		bf->cache->width[(bold == TRUE) ? 1 : 0][key] = (short)(sz.cx + 1);
+	}
+	return sz.cx;
+}
+
+/*
+ * GetTextWidth - 文字列の幅を取得
+ */
+static int GetTextWidth(VIEW_BUFFER *bf, const TCHAR *s, const int len, const BOOL bold)
+{
+	const TCHAR *p;
+	int clen;
+	int width = 0;
+
+	for(p = s; p < s + len; p++){
+		clen = (IS_LEAD_TBYTE((TBYTE)*p) == TRUE && p + 1 < s + len) ? 1 : 0;
+		width += GetCharExtent(bf, p, clen, bold);
+		p += clen;
+	}
+	return width;
+}
+
+/*
+ * GetLineIndex - 位置を含む表示行を取得
+ *
+ *	行頭の位置は昇順のため二分探索する
+ */
+static int GetLineIndex(VIEW_BUFFER *bf, const TCHAR *p)
+{
+	int low = 0, high = bf->view_line - 1, mid;
+
+	while(low < high){
+		mid = (low + high + 1) / 2;
+		if(LINE_PTR(bf, mid) <= p){
+			low = mid;
+		}else{
+			high = mid - 1;
+		}
+	}
+	return low;
+}
+
+/*
+ * GetLogicalLine - 表示行を含む論理行の先頭の表示行を取得
+ */
+static int GetLogicalLine(VIEW_BUFFER *bf, int i)
+{
+	TCHAR *p;
+
+	for(; i > 0; i--){
+		p = LINE_PTR(bf, i) - 1;
+		if(*p == TEXT('\r') || *p == TEXT('\n')){
+			break;
+		}
+	}
+	return i;
+}
+
+/*
+ * GetLineStyle - 表示行の先頭の装飾状態を取得
+ *
+ *	論理行の先頭 (またはキャッシュした位置) から装飾情報のみを走査する
+ */
+static void GetLineStyle(VIEW_BUFFER *bf, int i, PUTINFO *pi)
+{
+	TCHAR *p, *st, *en;
+	char style;
+
+	pi->txtColor = bf->TextColor;
+	pi->backColor = bf->BackClolor;
+	pi->rtxtColor = bf->TextColor;
+	pi->rbackColor = bf->BackClolor;
+	pi->sel = FALSE;
+	pi->bold = FALSE;
+	pi->underline = FALSE;
+	pi->reverse = FALSE;
+	pi->italic = FALSE;
+
+	en = LINE_PTR(bf, i);
+	st = LINE_PTR(bf, GetLogicalLine(bf, i));
+	if(bf->cache != NULL && bf->cache->style_line != NULL &&
+		bf->cache->style_line >= st && bf->cache->style_line <= en){
+		*pi = bf->cache->style_pi;
+		st = bf->cache->style_line;
+	}
+	for(p = st; p < en; p++){
+		style = *(bf->style + (p - bf->buf));
+		if(style == 0){
+			continue;
+		}
+		if(style & STYLE_BOLD){
+			pi->bold = (pi->bold == TRUE) ? FALSE : TRUE;
+		}
+		if(style & STYLE_UNDERLINE){
+			pi->underline = (pi->underline == TRUE) ? FALSE : TRUE;
+		}
+		if(style & STYLE_RETURNCOLOR){
+			pi->txtColor = bf->TextColor;
+			pi->backColor = bf->BackClolor;
+		}
+		if(style & STYLE_ITALIC){
+			pi->italic = (pi->italic == TRUE) ? FALSE : TRUE;
+		}
+		if(style & STYLE_REVERSE){
+			if(pi->reverse == TRUE){
+				pi->reverse = FALSE;
+				pi->txtColor = pi->rtxtColor;
+				pi->backColor = pi->rbackColor;
+			}else{
+				pi->reverse = TRUE;
+				pi->rtxtColor = pi->txtColor;
+				pi->rbackColor = pi->backColor;
+				pi->txtColor = bf->BackClolor;
+				pi->backColor = bf->TextColor;
+			}
+		}
+		if(style & STYLE_TEXTCOLOR){
+			pi->txtColor = GetColor((char)LOCOLOR(*(bf->color + (p - bf->buf))), bf->TextColor);
+		}
+		if(style & STYLE_BACKCOLOR){
+			pi->backColor = GetColor((char)HICOLOR(*(bf->color + (p - bf->buf))), bf->BackClolor);
+		}
+	}
+	if(bf->cache != NULL){
+		bf->cache->style_line = en;
+		bf->cache->style_pi = *pi;
+	}
+}
+
+/*
+ * GetLineLayout - 表示行の文字の区切り位置と X 座標を取得
+ *
+ *	行の内容が変わるまではキャッシュを使用する
+ */
+static BOOL GetLineLayout(VIEW_BUFFER *bf, int i)
+{
+	VIEW_CACHE *vc = bf->cache;
+	PUTINFO pi;
+	TCHAR *p, *st;
+	int *mi;
+	int size;
+	int len;
+	int offset;
+	int cnt = 0;
+	int clen;
+	int j;
+	BOOL bold;
+
+	if(vc == NULL){
+		return FALSE;
+	}
+	st = LINE_PTR(bf, i);
+	len = *(bf->linelen + i);
+	if(vc->layout_line == st && vc->layout_len == len){
+		return TRUE;
+	}
+	vc->layout_line = NULL;
+	if(vc->layout_size < len + 1){
+		size = len + 1 + RESERVE_LINE;
+		mi = mem_alloc(sizeof(int) * size);
+		if(mi == NULL) return FALSE;
+		mem_free(&vc->layout_pos);
+		vc->layout_pos = mi;
+		mi = mem_alloc(sizeof(int) * size);
+		if(mi == NULL) return FALSE;
+		mem_free(&vc->layout_x);
+		vc->layout_x = mi;
+		vc->layout_size = size;
+	}
+
+	GetLineStyle(bf, i, &pi);
+	bold = pi.bold;
+	offset = bf->LeftMargin;
+	vc->layout_cnt = 0;
+	for(j = 0, p = st; j <= len; p++, j++){
+		if(*(bf->style + (p - bf->buf)) & STYLE_BOLD){
+			bold = (bold == TRUE) ? FALSE : TRUE;
+		}
+		*(vc->layout_pos + vc->layout_cnt) = j;
+		*(vc->layout_x + vc->layout_cnt) = offset;
+		vc->layout_cnt++;
+		if(j == len){
+			break;
+		}
+		if(*p == TEXT('\t')){
+			offset += (bf->TabStop - (cnt % bf->TabStop)) * bf->CharWidth;
+			cnt += bf->TabStop - (cnt % bf->TabStop);
+			continue;
+		}
+		clen = (IS_LEAD_TBYTE((TBYTE)*p) == TRUE && *(p + 1) != TEXT('\0')) ? 1 : 0;
+		offset += GetCharExtent(bf, p, clen, bold);
+		p += clen;
+		j += clen;
+		cnt += clen + 1;
+	}
+	vc->layout_line = st;
+	vc->layout_len = len;
+	return TRUE;
+}
+
+/*
+ * CountLine - 行情報の設定
+ */
+static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
+{
+	RECT rect;
 	TCHAR *p;
 	int line_size;
 	int len = 0;
@@ -282,9 +775,7 @@ static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
 	int clen;
 	BOOL bold = FALSE;
 
-	hFont = CreateViewFont(bf->mdc, bf, FALSE, FALSE, FALSE);
-	hRetFont = SelectObject(bf->mdc, hFont);
-
+	ClearCache(bf, FALSE);
 	GetClientRect(hWnd, &rect);
 	line_size = rect.right - bf->RightMargin;
 
@@ -292,27 +783,18 @@ static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
 		if(*(bf->style + (p - bf->buf)) & STYLE_BOLD){
 			//bold
 			bold = (bold == TRUE) ? FALSE : TRUE;
-
-			hFont = CreateViewFont(bf->mdc, bf, bold, FALSE, FALSE);
-			hTmpFont = SelectObject(bf->mdc, hFont);
-			DeleteObject(hTmpFont);
 		}
 		if(*p == TEXT('\r')){
 		}else if(*p == TEXT('\n')){
 			//new line
-			*(bf->line + bf->view_line) = p + 1 - bf->buf;
+			*(bf->line + bf->view_line) = LINE_OFFSET(bf, p + 1);
 			*(bf->linelen + bf->view_line - 1) = len;
 			bf->view_line++;
-			if(bf->view_line >= bf->linesize){
+			if(bf->line_top + bf->view_line >= bf->linesize){
 				if(AllocLine(bf) == FALSE){
 					return FALSE;
 				}
 			}
-			if(bold == TRUE){
-				hFont = CreateViewFont(bf->mdc, bf, FALSE, FALSE, FALSE);
-				hTmpFont = SelectObject(bf->mdc, hFont);
-				DeleteObject(hTmpFont);
-			}
 			cnt = len = 0;
 			offset = bf->LeftMargin;
 			bold = FALSE;
@@ -322,10 +804,10 @@ static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
 			cnt += bf->TabStop - (cnt % bf->TabStop);
 			len++;
 			if(offset > line_size){
-				*(bf->line + bf->view_line) = p + 1 - bf->buf;
+				*(bf->line + bf->view_line) = LINE_OFFSET(bf, p + 1);
 				*(bf->linelen + bf->view_line - 1) = len;
 				bf->view_line++;
-				if(bf->view_line >= bf->linesize){
+				if(bf->line_top + bf->view_line >= bf->linesize){
 					if(AllocLine(bf) == FALSE){
 						return FALSE;
 					}
@@ -336,14 +818,13 @@ static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
 		}else{
 			//char
 			clen = (IS_LEAD_TBYTE((TBYTE)*p) == TRUE && *(p + 1) != TEXT('\0')) ? 1 : 0;
-			GetTextExtentPoint32(bf->mdc, p, clen + 1, &sz);
-			width = sz.cx;
+			width = GetCharExtent(bf, p, clen, bold);
 			if(offset + width >= line_size){
 				//new line
-				*(bf->line + bf->view_line) = p - bf->buf;
+				*(bf->line + bf->view_line) = LINE_OFFSET(bf, p);
 				*(bf->linelen + bf->view_line - 1) = len;
 				bf->view_line++;
-				if(bf->view_line >= bf->linesize){
+				if(bf->line_top + bf->view_line >= bf->linesize){
 					if(AllocLine(bf) == FALSE){
 						return FALSE;
 					}
@@ -360,39 +841,31 @@ static BOOL CountLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *st)
 	}
 	*(bf->linelen + bf->view_line - 1) = len;
 
-	hFont = SelectObject(bf->mdc, hRetFont);
-	DeleteObject(hFont);
-
 	SetScrollBar(hWnd, bf, rect.bottom);
 	return TRUE;
 }
 
 /*
- * ReCountLine - s̍Đݒ
+ * ReCountLine - 行情報の再設定
+ *
+ *	先頭の ln 行を削除する (line の位置を進めるのみ)
  */
 static void ReCountLine(VIEW_BUFFER *bf, int ln)
 {
-	int i, j;
-
-	i = *(bf->line + ln);
-
-	for(j = ln; j < bf->view_line; j++){
-		*(bf->line + j) -= i;
-	}
-	CopyMemory(bf->line, bf->line + ln, sizeof(int) * (bf->view_line - ln));
-	CopyMemory(bf->linelen, bf->linelen + ln, sizeof(int) * (bf->view_line - ln));
+	bf->line += ln;
+	bf->linelen += ln;
+	bf->line_top += ln;
 	bf->view_line -= ln;
 	bf->max -= ln;
 }
 
 /*
- * AddString - ̒ǉ
+ * AddString - 文字列の追加
  */
 static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 {
 	RECT rect;
 	TCHAR *p, *r, *s;
-	char *cp;
 	int len, len2;
 	int ln;
 	int last_color;
@@ -409,7 +882,7 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 	p = str;
 
 	if(bf->LineLimit > 0){
-		//s̃`FbN
+		//行数制限のチェック
 		for(ln = 0, r = str; *r != TEXT('\0'); r++){
 			if(*r == TEXT('\n')){
 				ln++;
@@ -430,25 +903,10 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 			str = p;
 			len2 = lstrlen(str);
 
-			bf->size = len2 + RESERVE_SZIE;
-
 			//buf init
-			mem_free(&bf->buf);
-			mem_free(&bf->style);
-			mem_free(&bf->color);
-			bf->buf = mem_alloc(sizeof(TCHAR) * bf->size);
-			if(bf->buf == NULL) return FALSE;
-			bf->color = mem_alloc(sizeof(char) * bf->size);
-			if(bf->color == NULL) return FALSE;
-			bf->style = mem_alloc(sizeof(char) * bf->size);
-			if(bf->style == NULL) return FALSE;
-
-			ZeroMemory(bf->color, sizeof(char) * bf->size);
-			ZeroMemory(bf->style, sizeof(char) * bf->size);
-			*bf->buf = TEXT('\0');
-			bf->len = 0;
-			bf->view_line = 1;
-			*bf->line = 0;
+			if(AllocBuffer(bf, len2 + RESERVE_SZIE) == FALSE) return FALSE;
+			ClearBuffer(bf);
+			len = 0;
 
 			bf->logic_line = bf->LineLimit;
 
@@ -464,28 +922,17 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 			}
 			for(; *r == TEXT('\r') || *r == TEXT('\n'); r++);
 
-			for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= r; i++);
+			i = GetLineIndex(bf, r);
 			j = bf->view_line;
 			ReCountLine(bf, i);
 			j -= bf->view_line;
 
-			bf->cp = bf->cp - (r - bf->buf);
-			bf->sp = bf->sp - (r - bf->buf);
-			if(bf->cp < bf->buf) bf->cp = bf->buf;
-			if(bf->sp < bf->buf) bf->sp = bf->buf;
-
-			CopyMemory(bf->style, bf->style + (r - bf->buf), sizeof(char) * (bf->size - (r - bf->buf)));
-			ZeroMemory(bf->style + (bf->size - (r - bf->buf)), sizeof(char) * (r - bf->buf));
-			CopyMemory(bf->color, bf->color + (r - bf->buf), sizeof(char) * (bf->size - (r - bf->buf)));
-			ZeroMemory(bf->color + (bf->size - (r - bf->buf)), sizeof(char) * (r - bf->buf));
-
-			bf->len -= (r - bf->buf);
-			r = TStrCpy(bf->buf, r);
-			len = r - bf->buf;
+			DeleteText(bf, r);
+			len = bf->len;
 
 			bf->logic_line = bf->LineLimit;
 			
-			//XN[ݒ
+			//スクロール設定
 			if(bf->sc_lock != 0){
 				bf->pos -= j;
 				if(bf->pos < 0) bf->pos = 0;
@@ -496,77 +943,39 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 	}
 
 
-	if(bf->Limit <= 0){
-		// no limit
-		if(len + len2 + 1 > bf->size){
-			bf->size = len + len2 + RESERVE_SZIE;
-
-			cp = mem_realloc(bf->color, bf->size);
-			if(cp == NULL) return FALSE;
-			ZeroMemory(cp + len + 1, sizeof(char) * (len2 + RESERVE_SZIE - 1));
-			bf->color = (char *)cp;
-			
-			cp = mem_realloc(bf->style, bf->size);
-			if(cp == NULL) return FALSE;
-			ZeroMemory(cp + len + 1, sizeof(char) * (len2 + RESERVE_SZIE - 1));
-			bf->style = (char *)cp;
-
-			s = mem_realloc(bf->buf, sizeof(TCHAR) * bf->size);
-			if(s == NULL) return FALSE;
-			bf->cp = s + (bf->cp - bf->buf);
-			bf->sp = s + (bf->sp - bf->buf);
-			bf->buf = s;
-			r = bf->buf + len;
-		}else{
-			r = bf->buf + len;
-		}
-
-	}else if(bf->Limit > 0 && len + len2 >= bf->Limit){
-		//
+	if(bf->Limit > 0 && len + len2 >= bf->Limit){
+		//文字数制限
 		redraw = TRUE;
 		if(len2 >= bf->Limit){
 			scroll = TRUE;
 			p = str + len2 - bf->Limit + 1;
 			for(; *p != TEXT('\0') && *p != TEXT('\n'); p++);
 			for(; *p == TEXT('\r') || *p == TEXT('\n'); p++);
-			r = bf->buf;
-			bf->len = 0;
-			ZeroMemory(bf->style, sizeof(char) * (bf->Limit));
-			ZeroMemory(bf->color, sizeof(char) * (bf->Limit));
-			bf->view_line = 1;
-			*bf->line = 0;
+			len2 = lstrlen(p);
+			ClearBuffer(bf);
 		}else{
 			r = bf->buf + len - bf->Limit + len2 + 1;
 			for(; *r != TEXT('\0') && *r != TEXT('\n'); r++);
 			for(; *r == TEXT('\r') || *r == TEXT('\n'); r++);
-			for(ln = 0; ln < bf->view_line - 1 && *(bf->line + ln + 1) + bf->buf <= r; ln++);
+			ln = GetLineIndex(bf, r);
 
 			j = bf->view_line;
 			ReCountLine(bf, ln);
 			j -= bf->view_line;
 
-			bf->cp = bf->cp - (r - bf->buf);
-			bf->sp = bf->sp - (r - bf->buf);
-			if(bf->cp < bf->buf) bf->cp = bf->buf;
-			if(bf->sp < bf->buf) bf->sp = bf->buf;
-
-			CopyMemory(bf->style, bf->style + (r - bf->buf), sizeof(char) * (bf->Limit - (r - bf->buf)));
-			ZeroMemory(bf->style + (bf->Limit - (r - bf->buf)), sizeof(char) * (r - bf->buf));
-			CopyMemory(bf->color, bf->color + (r - bf->buf), sizeof(char) * (bf->Limit - (r - bf->buf)));
-			ZeroMemory(bf->color + (bf->Limit - (r - bf->buf)), sizeof(char) * (r - bf->buf));
-
-			bf->len -= (r - bf->buf);
-			r = TStrCpy(bf->buf, r);
+			DeleteText(bf, r);
 
-			//XN[ݒ
+			//スクロール設定
 			if(bf->sc_lock != 0){
 				bf->pos -= j;
 				if(bf->pos < 0) bf->pos = 0;
 			}
 		}
-	}else{
-		r = bf->buf + len;
 	}
+	if(ReserveBuffer(bf, len2) == FALSE){
+		return FALSE;
+	}
+	r = bf->buf + bf->len;
 
 	//copy
 	last_color = -1;
@@ -627,8 +1036,8 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 
 	scroll_line = bf->max;
 	draw_line = bf->view_line;
-	//s̐ݒ
-	if(CountLine(hWnd, bf, bf->buf + *(bf->line + bf->view_line - 1)) == FALSE){
+	//行情報の設定
+	if(CountLine(hWnd, bf, LINE_PTR(bf, bf->view_line - 1)) == FALSE){
 		return FALSE;
 	}
 	scroll_line -= bf->max;
@@ -642,7 +1051,7 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 		if(bf->sc_lock == 0){
 			GetClientRect(hWnd, &rect);
 			if(bf->max > 0){
-				//ǉXN[
+				//追加分をスクロール
 				ScrollWindow(hWnd, 0, scroll_line * bf->FontHeight, NULL, &rect);
 				rect.top = ((rect.bottom / bf->FontHeight) + draw_line) * bf->FontHeight - bf->FontHeight;
 				InvalidateRect(hWnd, &rect, FALSE);
@@ -664,14 +1073,183 @@ static BOOL AddString(HWND hWnd, VIEW_BUFFER *bf, TCHAR *str)
 }
 
 /*
- * DrawLine - 1s`
+ * AllocChunk - 出力キューのチャンクの確保
+ *
+ *	スレッド間で受け渡すためプロセスのヒープから確保する
+ */
+static VIEW_CHUNK *AllocChunk(const int size)
+{
+	MEMHEAP *mh;
+	VIEW_CHUNK *c;
+
+	mh = mem_heap_select(NULL);
+	c = mem_alloc(sizeof(VIEW_CHUNK) + sizeof(TCHAR) * size);
+	mem_heap_select(mh);
+	if(c == NULL){
+		return NULL;
+	}
+	c->next = NULL;
+	c->len = 0;
+	c->read = 0;
+	c->end = 0;
+	c->size = size;
+	return c;
+}
+
+/*
+ * InitQueue - 出力キューの初期化
+ */
+static BOOL InitQueue(VIEW_BUFFER *bf)
+{
+	bf->q_head = bf->q_tail = AllocChunk(QUEUE_CHUNK_SIZE);
+	if(bf->q_head == NULL){
+		return FALSE;
+	}
+	bf->q_size = 0;
+	bf->q_notify = 0;
+	bf->q_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if(bf->q_event == NULL){
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * FreeQueue - 出力キューの解放
+ */
+static void FreeQueue(VIEW_BUFFER *bf)
+{
+	VIEW_CHUNK *c;
+
+	while(bf->q_head != NULL){
+		c = bf->q_head->next;
+		mem_free(&bf->q_head);
+		bf->q_head = c;
+	}
+	bf->q_tail = NULL;
+	if(bf->q_event != NULL){
+		SetEvent(bf->q_event);
+		CloseHandle(bf->q_event);
+		bf->q_event = NULL;
+	}
+}
+
+/*
+ * FlushQueue - 出力キューの文字列をまとめて追加
+ *
+ *	ウィンドウのスレッドから呼び出す
+ */
+static BOOL FlushQueue(HWND hWnd, VIEW_BUFFER *bf)
+{
+	VIEW_CHUNK *c, *next, *last;
+	TCHAR *buf, *p;
+	LONG total = 0;
+	BOOL ret;
+
+	InterlockedExchange(&bf->q_notify, 0);
+	bf->q_time = GetTickCount();
+	if(bf->q_head == NULL){
+		return TRUE;
+	}
+
+	//取り出す範囲の確定 (next を確認してから len を読む)
+	for(c = bf->q_head; ; c = next){
+		next = c->next;
+		MemoryBarrier();
+		c->end = c->len;
+		total += c->end - c->read;
+		if(next == NULL){
+			break;
+		}
+	}
+	last = c;
+	if(total == 0){
+		return TRUE;
+	}
+
+	buf = mem_alloc(sizeof(TCHAR) * (total + 1));
+	if(buf == NULL){
+		return FALSE;
+	}
+	p = buf;
+	for(c = bf->q_head; ; c = next){
+		CopyMemory(p, c->buf + c->read, sizeof(TCHAR) * (c->end - c->read));
+		p += c->end - c->read;
+		c->read = c->end;
+		if(c == last){
+			break;
+		}
+		next = c->next;
+		mem_free(&c);
+	}
+	*p = TEXT('\0');
+	bf->q_head = last;
+
+	InterlockedExchangeAdd(&bf->q_size, -total);
+	SetEvent(bf->q_event);
+
+	ret = AddString(hWnd, bf, buf);
+	mem_free(&buf);
+	return ret;
+}
+
+/*
+ * ConsoleQueueText - 出力キューに文字列を追加
+ *
+ *	別スレッドから呼び出す (追加するスレッドは1つのみ)
+ *	キューが上限を超えている場合は取り出されるまで待つ
+ */
+BOOL ConsoleQueueText(const HWND hWnd, const TCHAR *str)
+{
+	VIEW_BUFFER *bf;
+	VIEW_CHUNK *c, *n;
+	int len;
+
+	bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+	if(bf == NULL || bf->q_tail == NULL || str == NULL){
+		return FALSE;
+	}
+	len = lstrlen(str);
+	if(len == 0){
+		return TRUE;
+	}
+	while(bf->q_size > QUEUE_LIMIT && IsWindow(hWnd) == TRUE){
+		WaitForSingleObject(bf->q_event, 100);
+	}
+
+	c = bf->q_tail;
+	if(c->size - c->len < len){
+		//新しいチャンクに追加してから連結
+		n = AllocChunk((len > QUEUE_CHUNK_SIZE) ? len : QUEUE_CHUNK_SIZE);
+		if(n == NULL){
+			return FALSE;
+		}
+		CopyMemory(n->buf, str, sizeof(TCHAR) * len);
+		n->len = len;
+		MemoryBarrier();
+		c->next = n;
+		bf->q_tail = n;
+	}else{
+		CopyMemory(c->buf + c->len, str, sizeof(TCHAR) * len);
+		MemoryBarrier();
+		c->len += len;
+	}
+	InterlockedExchangeAdd(&bf->q_size, len);
+
+	if(InterlockedExchange(&bf->q_notify, 1) == 0){
+		PostMessage(hWnd, WM_VIEW_FLUSHTEXT, 0, 0);
+	}
+	return TRUE;
+}
+
+/*
+ * DrawLine - 1行描画
  */
 static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 {
 	HFONT hFont;
 	HFONT hTmpFont;
 	RECT drect;
-	SIZE sz;
 	TCHAR *p, *s;
 	int offset;
 	int height;
@@ -679,7 +1257,7 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 	int cnt = 0;
 	int j, tab;
 
-	s = p = *(bf->line + i) + bf->buf;
+	s = p = LINE_PTR(bf, i);
 	offset = bf->LeftMargin;
 	height = (i - bf->pos) * bf->FontHeight + (bf->Spacing / 2);
 	drect.top = (i - bf->pos) * bf->FontHeight;
@@ -701,17 +1279,7 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 	for(j = 0; j < *(bf->linelen + i); j++, p++){
 		if(*(bf->style + (p - bf->buf)) != 0){
 			//change style
-#ifdef UNICODE
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			csize = sz.cx;
-#else
-			if(bf->Fixed == FALSE || pi->bold == TRUE){
-				GetTextExtentPoint32(mdc, s, p - s, &sz);
-				csize = sz.cx;
-			}else{
-				csize = (p - s) * bf->CharWidth;
-			}
-#endif
+			csize = GetTextWidth(bf, s, p - s, pi->bold);
 			drect.left = offset;
 			drect.right = offset + csize;
 			ExtTextOut(mdc, offset, height, ETO_OPAQUE, &drect, s, p - s, NULL);
@@ -774,17 +1342,7 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 		if((p >= bf->sp && p < bf->cp) || (p >= bf->cp && p < bf->sp)){
 			if(pi->sel == FALSE){
 				//select
-#ifdef UNICODE
-				GetTextExtentPoint32(mdc, s, p - s, &sz);
-				csize = sz.cx;
-#else
-				if(bf->Fixed == FALSE || pi->bold == TRUE){
-					GetTextExtentPoint32(mdc, s, p - s, &sz);
-					csize = sz.cx;
-				}else{
-					csize = (p - s) * bf->CharWidth;
-				}
-#endif
+				csize = GetTextWidth(bf, s, p - s, pi->bold);
 				drect.left = offset;
 				drect.right = offset + csize;
 				ExtTextOut(mdc, offset, height, ETO_OPAQUE, &drect, s, p - s, NULL);
@@ -797,18 +1355,7 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 			}
 		}else if(pi->sel == TRUE){
 			//unselect
-#ifdef UNICODE
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			csize = sz.cx;
-#else
-			if (bf->Fixed == FALSE || pi->bold == TRUE) {
-				GetTextExtentPoint32(mdc, s, p - s, &sz);
-				csize = sz.cx;
-			}
-			else {
-				csize = (p - s) * bf->CharWidth;
-			}
-#endif
+			csize = GetTextWidth(bf, s, p - s, pi->bold);
 			drect.left = offset;
 			drect.right = offset + csize;
 			ExtTextOut(mdc, offset, height, ETO_OPAQUE, &drect, s, p - s, NULL);
@@ -823,17 +1370,7 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 			RECT trect;
 			HBRUSH hBrush;
 
-#ifdef UNICODE
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			csize = sz.cx;
-#else
-			if(bf->Fixed == FALSE || pi->bold == TRUE){
-				GetTextExtentPoint32(mdc, s, p - s, &sz);
-				csize = sz.cx;
-			}else{
-				csize = (p - s) * bf->CharWidth;
-			}
-#endif
+			csize = GetTextWidth(bf, s, p - s, pi->bold);
 			drect.left = offset;
 			drect.right = offset + csize;
 			ExtTextOut(mdc, offset, height, ETO_OPAQUE, &drect, s, p - s, NULL);
@@ -857,8 +1394,7 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 			continue;
 		}
 		if(pi->bold == TRUE){
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			csize = sz.cx;
+			csize = GetTextWidth(bf, s, p - s, pi->bold);
 			drect.left = offset;
 			drect.right = offset + csize;
 			ExtTextOut(mdc, offset, height, ETO_OPAQUE, &drect, s, p - s, NULL);
@@ -873,21 +1409,11 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 		cnt++;
 	}
 	drect.left = offset;
-#ifdef UNICODE
-	GetTextExtentPoint32(mdc, s, p - s, &sz);
-	drect.right = offset + sz.cx;
-#else
-	if(bf->Fixed == FALSE || pi->bold == TRUE){
-		GetTextExtentPoint32(mdc, s, p - s, &sz);
-		drect.right = offset + sz.cx;
-	}else{
-		drect.right = offset + (p - s) * bf->CharWidth;
-	}
-#endif
+	drect.right = offset + GetTextWidth(bf, s, p - s, pi->bold);
 	ExtTextOut(mdc, offset, height, ETO_OPAQUE, &drect, s, p - s, NULL);
 
 	if(*p == TEXT('\r') || *p == TEXT('\n')){
-		//
+		//初期化
 		pi->txtColor = bf->TextColor;
 		pi->backColor = bf->BackClolor;
 		SetTextColor(mdc, pi->txtColor);
@@ -905,182 +1431,76 @@ static void DrawLine(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi)
 }
 
 /*
- * Char2Caret - ʒuLbg̈ʒu擾
+ * Char2Caret - 文字位置からキャレットの位置取得
  */
-static int Char2Caret(HWND hWnd, HDC mdc, VIEW_BUFFER *bf, int i, PUTINFO *pi, TCHAR *cp)
+static int Char2Caret(VIEW_BUFFER *bf, int i, TCHAR *cp)
 {
-	HFONT hFont;
-	HFONT hTmpFont;
-	SIZE sz;
-	TCHAR *p, *s;
-	int len;
-	int offset;
-	int cnt = 0;
-	int j;
-	BOOL bold = pi->bold;
-
-	s = p = *(bf->line + i) + bf->buf;
-	len = *(bf->linelen + i);
-	offset = bf->LeftMargin;
-	for(j = 0; j < len; j++, p++){
-		if(*(bf->style + (p - bf->buf)) & STYLE_BOLD){
-			//bold
-#ifdef UNICODE
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			offset += sz.cx;
-#else
-			if(bf->Fixed == FALSE || bold == TRUE){
-				GetTextExtentPoint32(mdc, s, p - s, &sz);
-				offset += sz.cx;
-			}else{
-				offset += (p - s) * bf->CharWidth;
-			}
-#endif
-			s = p;
-
-			bold = (bold == TRUE) ? FALSE : TRUE;
-			hFont = CreateViewFont(mdc, bf, bold, FALSE, FALSE);
-			hTmpFont = SelectObject(mdc, hFont);
-			DeleteObject(hTmpFont);
-		}
-		if(cp != NULL && p >= cp){
-			break;
-		}
-		if(*p == TEXT('\t')){
-			//tab
-#ifdef UNICODE
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			offset += sz.cx;
-#else
-			if(bf->Fixed == FALSE || bold == TRUE){
-				GetTextExtentPoint32(mdc, s, p - s, &sz);
-				offset += sz.cx;
-			}else{
-				offset += (p - s) * bf->CharWidth;
-			}
-#endif
+	VIEW_CACHE *vc = bf->cache;
+	int k;
+	int low, high, mid;
 
-			offset += (bf->TabStop - (cnt % bf->TabStop)) * bf->CharWidth;
-			cnt += bf->TabStop - (cnt % bf->TabStop);
-			s = p + 1;
-			continue;
-		}
-		if(bold == TRUE){
-			GetTextExtentPoint32(mdc, s, p - s, &sz);
-			offset += sz.cx;
-			s = p;
-		}
-		if(IS_LEAD_TBYTE((TBYTE)*p) == TRUE && *(p + 1) != TEXT('\0')){
-			p++;
-			j++;
-			cnt++;
-		}
-		cnt++;
+	if(GetLineLayout(bf, i) == FALSE){
+		return bf->LeftMargin;
 	}
-#ifdef UNICODE
-	GetTextExtentPoint32(mdc, s, p - s, &sz);
-	offset += sz.cx;
-#else
-	if(bf->Fixed == FALSE || bold == TRUE){
-		GetTextExtentPoint32(mdc, s, p - s, &sz);
-		offset += sz.cx;
-	}else{
-		offset += (p - s) * bf->CharWidth;
+	k = (int)(cp - LINE_PTR(bf, i));
+	//k 以上の最初の区切り位置
+	low = 0;
+	high = vc->layout_cnt - 1;
+	while(low < high){
+		mid = (low + high) / 2;
+		if(*(vc->layout_pos + mid) < k){
+			low = mid + 1;
+		}else{
+			high = mid;
+		}
 	}
-#endif
-	hFont = CreateViewFont(mdc, bf, pi->bold, pi->underline, pi->italic);
-	hTmpFont = SelectObject(mdc, hFont);
-	DeleteObject(hTmpFont);
-	return offset;
+	return *(vc->layout_x + low);
 }
 
 /*
- * Point2Caret - WLbg̈ʒu擾
+ * Point2Caret - 座標からキャレットの位置取得
  */
 static TCHAR *Point2Caret(HWND hWnd, VIEW_BUFFER *bf, int x, int y)
 {
-	HFONT hFont;
-	HFONT hRetFont;
-	HFONT hTmpFont;
-	RECT rect;
-	SIZE sz;
-	TCHAR *p, *r = bf->buf;
-	int cnt;
-	int offset;
-	int clen;
-	int ci;
-	int i, j;
-	BOOL bold = FALSE;
-
-	hFont = CreateViewFont(bf->mdc, bf, FALSE, FALSE, FALSE);
-	hRetFont = SelectObject(bf->mdc, hFont);
+	VIEW_CACHE *vc = bf->cache;
+	int i;
+	int low, high, mid;
 
-	GetClientRect(hWnd, &rect);
-	ci = i = bf->pos + (y / bf->FontHeight);
+	i = bf->pos + (y / bf->FontHeight);
 	if(i < 0){
 		return bf->buf;
 	}else if(i >= bf->view_line){
 		return bf->buf + bf->len;
 	}
-	for(; i > 0; i--){
-		//_s̐擪Ɉړ
-		p = *(bf->line + i) + bf->buf - 1;
-		if(*p == '\r' || *p == '\n'){
-			break;
-		}
+	if(GetLineLayout(bf, i) == FALSE){
+		return LINE_PTR(bf, i);
 	}
-
-	for(; i <= ci; i++){
-		cnt = j = 0;
-		offset = bf->LeftMargin - (bf->CharWidth / 2);
-		for(r = p = *(bf->line + i) + bf->buf; j <= *(bf->linelen + i); p++, j++){
-			if(*(bf->style + (p - bf->buf)) & STYLE_BOLD){
-				//bold
-				bold = (bold == TRUE) ? FALSE : TRUE;
-				hFont = CreateViewFont(bf->mdc, bf, bold, FALSE, FALSE);
-				hTmpFont = SelectObject(bf->mdc, hFont);
-				DeleteObject(hTmpFont);
-			}
-			if(i == ci && offset > x){
-				break;
-			}
-			r = p;
-			if(*p == TEXT('\t')){
-				offset += (bf->TabStop - (cnt % bf->TabStop)) * bf->CharWidth;
-				cnt += bf->TabStop - (cnt % bf->TabStop);
-				continue;
-			}
-			clen = (IS_LEAD_TBYTE((TBYTE)*p) == TRUE && *(p + 1) != TEXT('\0')) ? 1 : 0;
-			GetTextExtentPoint32(bf->mdc, p, clen + 1, &sz);
-			offset += sz.cx;
-			p += clen;
-			j += clen;
-			cnt += clen + 1;
+	//文字の中央より左にある最後の区切り位置
+	x += bf->CharWidth / 2;
+	low = 0;
+	high = vc->layout_cnt - 1;
+	while(low < high){
+		mid = (low + high + 1) / 2;
+		if(*(vc->layout_x + mid) <= x){
+			low = mid;
+		}else{
+			high = mid - 1;
 		}
 	}
-	hFont = SelectObject(bf->mdc, hRetFont);
-	DeleteObject(hFont);
-	return r;
+	return LINE_PTR(bf, i) + *(vc->layout_pos + low);
 }
 
 /*
- * GetCaretToken - Lbgʒũg[N擾
+ * GetCaretToken - キャレット位置のトークンを取得
  */
 static void GetCaretToken(VIEW_BUFFER *bf, TCHAR **st, TCHAR **en)
 {
 	TCHAR *p, *r;
 	int i;
 
-	for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= bf->cp; i++);
-	for(; i > 0; i--){
-		//_s̐擪Ɉړ
-		p = *(bf->line + i) + bf->buf - 1;
-		if(*p == '\r' || *p == '\n'){
-			break;
-		}
-	}
+	i = GetLogicalLine(bf, GetLineIndex(bf, bf->cp));
 
-	p = *(bf->line + i) + bf->buf;
+	p = LINE_PTR(bf, i);
 	while(*p != TEXT('\0') && *p != TEXT('\r') && *p != TEXT('\n')){
 #ifdef UNICODE
 		if(IS_LEAD_TBYTE((TBYTE)*p) == TRUE || WideCharToMultiByte(CP_ACP, 0, p, 1, NULL, 0, NULL, NULL) != 1){
@@ -1122,18 +1542,18 @@ static void GetCaretToken(VIEW_BUFFER *bf, TCHAR **st, TCHAR **en)
 }
 
 /*
- * RefreshLine - ŵ͈͕sĕ`Ώۂɂ
+ * RefreshLine - 指定範囲文字列のある行を再描画対象にする
  */
 static void RefreshLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *p, TCHAR *r)
 {
 	RECT rect;
 	int i, j, k;
 
-	for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= p; i++);
+	i = GetLineIndex(bf, p);
 	if(p == r){
 		j = i;
 	}else{
-		for(j = 0; j < bf->view_line - 1 && *(bf->line + j + 1) + bf->buf <= r; j++);
+		j = GetLineIndex(bf, r);
 	}
 	if(i > j){
 		k = i; i = j; j = k;
@@ -1148,7 +1568,7 @@ static void RefreshLine(HWND hWnd, VIEW_BUFFER *bf, TCHAR *p, TCHAR *r)
 }
 
 /*
- * SetInputBuf - ̓obt@̐ݒ
+ * SetInputBuf - 入力バッファの設定
  */
 static void SetInputBuf(HWND hWnd, VIEW_BUFFER *bf, TCHAR *input_str)
 {
@@ -1175,7 +1595,7 @@ static void SetInputBuf(HWND hWnd, VIEW_BUFFER *bf, TCHAR *input_str)
 }
 
 /*
- * ConsoleProc - EBhEvV[W
+ * ConsoleProc - ウィンドウプロシージャ
  */
 static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -1188,7 +1608,6 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 	TCHAR *p, *r;
 	TCHAR *oldcp, *oldsp;
 	TCHAR in[3];
-	char *cp;
 	int len;
 	int i, j;
 #ifdef OP_XP_STYLE
@@ -1204,6 +1623,8 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 	case WM_CREATE:
 		bf = mem_calloc(sizeof(VIEW_BUFFER));
 		if(bf == NULL) return -1;
+		bf->cache = mem_calloc(sizeof(VIEW_CACHE));
+		if(bf->cache == NULL) return -1;
 
 #ifdef OP_XP_STYLE
 		// XP
@@ -1224,32 +1645,16 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		bf->RightMargin = 1;
 		bf->Spacing = 2;
 
-		bf->size = (bf->Limit <= 0) ? RESERVE_SZIE : bf->Limit;
-		bf->linesize = RESERVE_LINE;
-		bf->view_line = 1;
 		bf->logic_line = 1;
 
 		//buf init
-		bf->buf = mem_alloc(sizeof(TCHAR) * bf->size);
-		if(bf->buf == NULL) return -1;
-		*bf->buf = TEXT('\0');
-		bf->len = 0;
-		bf->color = mem_alloc(sizeof(char) * bf->size);
-		if(bf->color == NULL) return -1;
-		ZeroMemory(bf->color, sizeof(char) * bf->size);
-		bf->style = mem_alloc(sizeof(char) * bf->size);
-		if(bf->style == NULL) return -1;
-		ZeroMemory(bf->style, sizeof(char) * bf->size);
+		if(AllocBuffer(bf, (bf->Limit <= 0) ? RESERVE_SZIE : bf->Limit) == FALSE) return -1;
 
 		//line init
-		bf->line = mem_alloc(sizeof(int) * bf->linesize);
-		if(bf->line == NULL) return -1;
-		ZeroMemory(bf->line, sizeof(int) * bf->linesize);
-		bf->linelen = mem_alloc(sizeof(int) * bf->linesize);
-		if(bf->linelen == NULL) return -1;
-		ZeroMemory(bf->linelen, sizeof(int) * bf->linesize);
+		if(InitLine(bf) == FALSE) return -1;
 
-		bf->sp = bf->cp = bf->buf;
+		//queue init
+		if(InitQueue(bf) == FALSE) return -1;
 
 		hDC = GetDC(hWnd);
 		GetClientRect(hWnd, &rect);
@@ -1278,6 +1683,8 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf != NULL){
 			SetWindowLongPtr(hWnd, GWLP_USERDATA, (LONG_PTR)0);
+			KillTimer(hWnd, ID_QUEUE_TIMER);
+			FreeQueue(bf);
 #ifdef OP_XP_STYLE
 			// XP
 			if (bf->hTheme != NULL) {
@@ -1298,11 +1705,11 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			DeleteDC(bf->mdc);
 			DeleteObject(bf->hBkBrush);
 
-			mem_free(&bf->buf);
-			mem_free(&bf->style);
-			mem_free(&bf->color);
-			mem_free(&bf->line);
-			mem_free(&bf->linelen);
+			FreeBuffer(bf);
+			FreeLine(bf);
+			mem_free(&bf->cache->layout_pos);
+			mem_free(&bf->cache->layout_x);
+			mem_free(&bf->cache);
 			mem_free(&bf);
 		}
 		if(GetFocus() == hWnd){
@@ -1412,12 +1819,12 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		GetClientRect(hWnd, &rect);
 		oldcp = bf->cp;
 		oldsp = bf->sp;
-		for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= bf->cp; i++);
+		i = GetLineIndex(bf, bf->cp);
 		switch(wParam)
 		{
 		case TEXT('A'):
 			if(GetKeyState(VK_CONTROL) < 0){
-				//SđI
+				//全て選択
 				bf->sp = bf->buf;
 				bf->cp = bf->buf + bf->len;
 				bf->pos = bf->max;
@@ -1429,7 +1836,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 
 		case TEXT('C'):
 			if(GetKeyState(VK_CONTROL) < 0){
-				//Rs[
+				//コピー
 				SendMessage(hWnd, WM_COPY, 0, 0);
 			}
 			break;
@@ -1440,14 +1847,14 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 
 		case VK_HOME:
 			if(GetKeyState(VK_CONTROL) < 0){
-				//Ŝ̐擪
+				//全体の先頭
 				bf->cp = bf->buf;
 				if(GetKeyState(VK_SHIFT) >= 0) bf->sp = bf->cp;
 				bf->pos = 0;
 				SetScrollPos(hWnd, SB_VERT, bf->pos, TRUE);
 				InvalidateRect(hWnd, NULL, FALSE);
 			}else{
-				//_s
+				//論理行頭
 				for(; *bf->cp == TEXT('\r') || *bf->cp == TEXT('\n'); bf->cp--);
 				for(; bf->cp > bf->buf && *bf->cp != TEXT('\r') && *bf->cp != TEXT('\n'); bf->cp--);
 				if(bf->cp > bf->buf) bf->cp++;
@@ -1459,14 +1866,14 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 
 		case VK_END:
 			if(GetKeyState(VK_CONTROL) < 0){
-				//Ŝ̖
+				//全体の末尾
 				bf->cp = (bf->buf + bf->len);
 				if(GetKeyState(VK_SHIFT) >= 0) bf->sp = bf->cp;
 				bf->pos = bf->max;
 				SetScrollPos(hWnd, SB_VERT, bf->pos, TRUE);
 				InvalidateRect(hWnd, NULL, FALSE);
 			}else{
-				//_s
+				//論理行末
 				for(; *bf->cp != TEXT('\0') && *bf->cp != TEXT('\r') && *bf->cp != TEXT('\n'); bf->cp++);
 				if(GetKeyState(VK_SHIFT) >= 0) bf->sp = bf->cp;
 				InvalidateRect(hWnd, NULL, FALSE);
@@ -1502,7 +1909,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			}
 			if(GetCaretPos(&pt) == FALSE) break;
 			if(bf->cpx == 0){
-				//Lbgʒȗޔ
+				//キャレット位置の退避
 				bf->cpx = pt.x;
 			}
 			bf->cp = Point2Caret(hWnd, bf, bf->cpx, pt.y - bf->FontHeight);
@@ -1517,7 +1924,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			}
 			if(GetCaretPos(&pt) == FALSE) break;
 			if(bf->cpx == 0){
-				//Lbgʒȗޔ
+				//キャレット位置の退避
 				bf->cpx = pt.x;
 			}
 			bf->cp = Point2Caret(hWnd, bf, bf->cpx, pt.y + bf->FontHeight);
@@ -1527,13 +1934,13 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		case VK_LEFT:
 			bf->cpx = 0;
 			if(bf->cp != bf->sp && GetKeyState(VK_SHIFT) >= 0){
-				//I
+				//選択解除
 				p = (bf->cp > bf->sp) ? bf->sp : bf->cp;
 				bf->cp = bf->sp = p;
-				for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= bf->cp; i++);
+				i = GetLineIndex(bf, bf->cp);
 				break;
 			}
-			p = *(bf->line + i) + bf->buf;
+			p = LINE_PTR(bf, i);
 			if(bf->cp == p){
 				i--;
 				if(i < 0){
@@ -1541,7 +1948,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 					break;
 				}
 			}
-			for(j = 0, r = p = *(bf->line + i) + bf->buf; j <= *(bf->linelen + i); p++, j++){
+			for(j = 0, r = p = LINE_PTR(bf, i); j <= *(bf->linelen + i); p++, j++){
 				if(p >= bf->cp) break;
 				r = p;
 				if(IS_LEAD_TBYTE((TBYTE)*p) == TRUE && *(p + 1) != TEXT('\0')){
@@ -1556,10 +1963,10 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		case VK_RIGHT:
 			bf->cpx = 0;
 			if(bf->cp != bf->sp && GetKeyState(VK_SHIFT) >= 0){
-				//I
+				//選択解除
 				p = (bf->cp < bf->sp) ? bf->sp : bf->cp;
 				bf->cp = bf->sp = p;
-				for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= bf->cp; i++);
+				i = GetLineIndex(bf, bf->cp);
 				break;
 			}
 			if(*bf->cp == TEXT('\0')){
@@ -1571,14 +1978,14 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			}else{
 				bf->cp++;
 			}
-			if(bf->cp - (*(bf->line + i) + bf->buf) >= *(bf->linelen + i) &&
+			if(bf->cp - (LINE_PTR(bf, i)) >= *(bf->linelen + i) &&
 				*bf->cp != TEXT('\0') && *bf->cp != TEXT('\r')){
 				i++;
 				if(i >= bf->view_line){
 					bf->cp = bf->buf + bf->len;
 					break;
 				}
-				bf->cp = *(bf->line + i) + bf->buf;
+				bf->cp = LINE_PTR(bf, i);
 			}
 			if(GetKeyState(VK_SHIFT) >= 0) bf->sp = bf->cp;
 			break;
@@ -1627,7 +2034,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		}
 		switch (wParam) {
 		case VK_RETURN:
-			// s
+			// 改行
 			AddString(hWnd, bf, TEXT("\r\n"));
 			bf->input_mode = FALSE;
 			break;
@@ -1690,7 +2097,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 
 			hIMC = ImmGetContext(hWnd);
 			ImmSetCompositionFont(hIMC, &bf->lf);
-			// ʒu̐ݒ
+			// 位置の設定
 			GetCaretPos(&pt);
 			cf.dwStyle = CFS_POINT | CFS_RECT;
 			cf.ptCurrentPos.x = pt.x;
@@ -1708,7 +2115,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			bf->input_mode == TRUE && (lParam & GCS_RESULTSTR)) {
 			TCHAR *buf;
 
-			// m蕶obt@ɒǉ
+			// 確定文字列をバッファに追加
 			hIMC = ImmGetContext(hWnd);
 			len = ImmGetCompositionString(hIMC, GCS_RESULTSTR, NULL, 0);
 			buf = mem_calloc(len + sizeof(TCHAR));
@@ -1721,7 +2128,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 				UpdateWindow(hWnd);
 				mem_free(&buf);
 			}
-			// ʒu̐ݒ
+			// 位置の設定
 			GetCaretPos(&pt);
 			cf.dwStyle = CFS_POINT | CFS_RECT;
 			cf.ptCurrentPos.x = pt.x;
@@ -1823,41 +2230,29 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			hDC = BeginPaint(hWnd, &ps);
 			GetClientRect(hWnd, &rect);
 
-			hFont = CreateViewFont(bf->mdc, bf, FALSE, FALSE, FALSE);
-			hRetFont = SelectObject(bf->mdc, hFont);
-
 			FillRect(bf->mdc, &rect, bf->hBkBrush);
 
 			//caret pos
 			j = -1;
 			if(GetFocus() == hWnd){
-				for(j = 0; j < bf->view_line - 1 && *(bf->line + j + 1) + bf->buf <= bf->cp; j++);
+				j = GetLineIndex(bf, bf->cp);
 			}
 
-			pi.txtColor = bf->TextColor;
-			pi.backColor = bf->BackClolor;
-			pi.sel = FALSE;
-			pi.bold = FALSE;
-			pi.underline = FALSE;
-			pi.reverse = FALSE;
-			pi.italic = FALSE;
+			//描画範囲の先頭行から描画
+			i = bf->pos + (ps.rcPaint.top / bf->FontHeight);
+			if(i >= bf->view_line) i = bf->view_line - 1;
+			if(i < 0) i = 0;
+			GetLineStyle(bf, i, &pi);
 
+			hFont = CreateViewFont(bf->mdc, bf, pi.bold, pi.underline, pi.italic);
+			hRetFont = SelectObject(bf->mdc, hFont);
 			SetTextColor(bf->mdc, pi.txtColor);
 			SetBkColor(bf->mdc, pi.backColor);
 
-			i = bf->pos + (ps.rcPaint.top / bf->FontHeight);
-			if(i >= bf->view_line) i = bf->view_line - 1;
-			for(; i > 0; i--){
-				//_s̐擪Ɉړ
-				p = *(bf->line + i) + bf->buf - 1;
-				if(*p == '\r' || *p == '\n'){
-					break;
-				}
-			}
 			for(; i < bf->view_line && i < bf->pos + (ps.rcPaint.bottom / bf->FontHeight) + 1; i++){
 				if(i == j){
 					//set caret
-					len = Char2Caret(hWnd, bf->mdc, bf, j, &pi, bf->cp);
+					len = Char2Caret(bf, j, bf->cp);
 					SetCaretPos(len, (j - bf->pos) * bf->FontHeight);
 					j = -1;
 				}
@@ -1865,7 +2260,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 				DrawLine(hWnd, bf->mdc, bf, i, &pi);
 			}
 			if(j != -1 && GetFocus() == hWnd){
-				len = Char2Caret(hWnd, bf->mdc, bf, j, &pi, bf->cp);
+				len = Char2Caret(bf, j, bf->cp);
 				SetCaretPos(len, (j - bf->pos) * bf->FontHeight);
 			}
 
@@ -1889,14 +2284,14 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			if ((bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->hTheme == NULL) {
 				return DefWindowProc(hWnd, message, wParam, lParam);
 			}
-			// XPp̔wi`
+			// XP用の背景描画
 			if (_DrawThemeBackground == NULL) {
 				_DrawThemeBackground = GetProcAddress(bf->hModThemes, "DrawThemeBackground");
 			}
 			if (_DrawThemeBackground == NULL) {
 				return DefWindowProc(hWnd, message, wParam, lParam);
 			}
-			// Ԃ̐ݒ
+			// 状態の設定
 			if (IsWindowEnabled(hWnd) == 0) {
 				stats = ETS_DISABLED;
 			} else if (GetFocus() == hWnd) {
@@ -1904,7 +2299,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			} else {
 				stats = ETS_NORMAL;
 			}
-			// EBhEg̕`
+			// ウィンドウ枠の描画
 			hDC = GetDCEx(hWnd, (HRGN)wParam, DCX_WINDOW | DCX_INTERSECTRGN);
 			if (hDC == NULL) {
 				hDC = GetWindowDC(hWnd);
@@ -1917,7 +2312,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			_DrawThemeBackground(bf->hTheme, hDC, EP_EDITTEXT, stats, &rect, &clip_rect);
 			ReleaseDC(hWnd, hDC);
 
-			// XN[o[̕`
+			// スクロールバーの描画
 			GetWindowRect(hWnd, (LPRECT)&rect);
 			hrgn = CreateRectRgn(rect.left + GetSystemMetrics(SM_CXEDGE), rect.top + GetSystemMetrics(SM_CYEDGE),
 				rect.right - GetSystemMetrics(SM_CXEDGE), rect.bottom - GetSystemMetrics(SM_CYEDGE));
@@ -1931,7 +2326,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		if ((bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->hModThemes == NULL) {
 			break;
 		}
-		// XPe[}̕ύX
+		// XPテーマの変更
 		if (bf->hTheme != NULL) {
 			if (_CloseThemeData == NULL) {
 				_CloseThemeData = GetProcAddress(bf->hModThemes, "CloseThemeData");
@@ -1964,19 +2359,9 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			bf->width = rect.right;
 
 			//clear line info
-			mem_free(&bf->line);
-			mem_free(&bf->linelen);
-
-			bf->linesize = RESERVE_LINE;
-			bf->line = mem_alloc(sizeof(int) * bf->linesize);
-			if(bf->line == NULL) break;
-			ZeroMemory(bf->line, sizeof(int) * bf->linesize);
-			bf->linelen = mem_alloc(sizeof(int) * bf->linesize);
-			if(bf->linelen == NULL) break;
-			ZeroMemory(bf->linelen, sizeof(int) * bf->linesize);
+			if(InitLine(bf) == FALSE) break;
 
 			//set line info
-			bf->view_line = 1;
 			CountLine(hWnd, bf, bf->buf);
 		}else{
 			SetScrollBar(hWnd, bf, rect.bottom);
@@ -1996,7 +2381,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 
 		InvalidateRect(hWnd, NULL, FALSE);
 
-		// IME̐ݒ
+		// IMEの設定
 		hIMC = ImmGetContext(hWnd);
 		GetCaretPos(&pt);
 		cf.dwStyle = CFS_POINT | CFS_RECT;
@@ -2011,35 +2396,13 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
 		if(bf->Limit <= 0){
-			mem_free(&bf->buf);
-			mem_free(&bf->style);
-			mem_free(&bf->color);
-			mem_free(&bf->line);
-			mem_free(&bf->linelen);
-
-			bf->size = RESERVE_SZIE;
-			bf->linesize = RESERVE_LINE;
-
 			//buf init
-			bf->buf = mem_alloc(sizeof(TCHAR) * bf->size);
-			if(bf->buf == NULL) break;
-			bf->color = mem_alloc(sizeof(char) * bf->size);
-			if(bf->color == NULL) break;
-			bf->style = mem_alloc(sizeof(char) * bf->size);
-			if(bf->style == NULL) break;
-
+			if(AllocBuffer(bf, RESERVE_SZIE) == FALSE) break;
 			//line init
-			bf->line = mem_alloc(sizeof(int) * bf->linesize);
-			if(bf->line == NULL) break;
-			bf->linelen = mem_alloc(sizeof(int) * bf->linesize);
-			if(bf->linelen == NULL) break;
-		}
-		ZeroMemory(bf->color, sizeof(char) * bf->size);
-		ZeroMemory(bf->style, sizeof(char) * bf->size);
-		*bf->buf = TEXT('\0');
-		bf->len = 0;
-		*bf->line = 0;
-		bf->view_line = 1;
+			if(InitLine(bf) == FALSE) break;
+		}else{
+			ClearBuffer(bf);
+		}
 		bf->logic_line = 1;
 		bf->pos = bf->max = 0;
 		bf->sp = bf->cp = bf->buf;
@@ -2052,6 +2415,25 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		if(bf == NULL) break;
 		return AddString(hWnd, bf, (TCHAR *)lParam);
 
+	case WM_VIEW_FLUSHTEXT:
+		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+		if(bf == NULL) break;
+		if((BOOL)wParam == FALSE && GetTickCount() - bf->q_time < QUEUE_INTERVAL){
+			//前回の追加から間もない場合はタイマーでまとめて追加
+			SetTimer(hWnd, ID_QUEUE_TIMER, QUEUE_INTERVAL, NULL);
+			break;
+		}
+		KillTimer(hWnd, ID_QUEUE_TIMER);
+		return FlushQueue(hWnd, bf);
+
+	case WM_TIMER:
+		if(wParam != ID_QUEUE_TIMER) break;
+		KillTimer(hWnd, ID_QUEUE_TIMER);
+		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+		if(bf == NULL) break;
+		FlushQueue(hWnd, bf);
+		break;
+
 	case WM_GETTEXT:
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
@@ -2091,6 +2473,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			hRetFont = SelectObject(bf->mdc, hFont);
 			//Metrics
 			GetTextMetrics(bf->mdc, &tm);
+			ClearCache(bf, TRUE);
 			bf->FontHeight = tm.tmHeight + bf->Spacing;
 			bf->CharWidth = tm.tmAveCharWidth;
 			bf->Fixed = (tm.tmPitchAndFamily & TMPF_FIXED_PITCH) ? FALSE : TRUE;
@@ -2137,7 +2520,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		break;
 
 	case WM_PASTE:
-		// \t
+		// 貼り付け
 		if ((bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->input_mode == FALSE) {
 			break;
 		}
@@ -2191,21 +2574,9 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 					}
 				}
 				for(; *p == TEXT('\r') || *p == TEXT('\n'); p++);
-				for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= p; i++);
+				i = GetLineIndex(bf, p);
 				ReCountLine(bf, i);
-
-				bf->cp = bf->cp - (p - bf->buf);
-				bf->sp = bf->sp - (p - bf->buf);
-				if(bf->cp < bf->buf) bf->cp = bf->buf;
-				if(bf->sp < bf->buf) bf->sp = bf->buf;
-
-				CopyMemory(bf->style, bf->style + (p - bf->buf), sizeof(char) * (bf->len - (p - bf->buf)));
-				ZeroMemory(bf->style + (bf->len - (p - bf->buf)), sizeof(char) * (p - bf->buf));
-				CopyMemory(bf->color, bf->color + (p - bf->buf), sizeof(char) * (bf->len - (p - bf->buf)));
-				ZeroMemory(bf->color + (bf->len - (p - bf->buf)), sizeof(char) * (p - bf->buf));
-
-				bf->len -= (p - bf->buf);
-				lstrcpy(bf->buf, p);
+				DeleteText(bf, p);
 
 				bf->logic_line = bf->LineLimit;
 			}else{
@@ -2264,7 +2635,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
 		if((int)wParam >= bf->view_line) return 0;
-		lstrcpyn((TCHAR *)lParam, bf->buf + *(bf->line + wParam), *(bf->linelen + wParam));
+		lstrcpyn((TCHAR *)lParam, LINE_PTR(bf, wParam), *(bf->linelen + wParam));
 		return *(bf->linelen + wParam);
 
 	case EM_GETLINECOUNT:
@@ -2287,50 +2658,16 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			break;
 		}
 
-		bf->size = bf->Limit = (int)wParam;
+		bf->Limit = (int)wParam;
 		if(bf->len > bf->Limit){
 			r = bf->buf + bf->len - bf->Limit + 1;
 			for(; *r != TEXT('\0') && *r != TEXT('\n'); r++);
 			for(; *r == TEXT('\r') || *r == TEXT('\n'); r++);
-		}else{
-			r = bf->buf;
-		}
-
-		cp = mem_alloc(sizeof(char) * bf->size);
-		if(cp != NULL){
-			ZeroMemory(cp, sizeof(char) * bf->size);
-			CopyMemory(cp, bf->style + (r - bf->buf), sizeof(char) * (lstrlen(r)));
-			mem_free(&bf->style);
-			bf->style = (char *)cp;
+			DeleteText(bf, r);
 		}
 
-		cp = mem_alloc(sizeof(char) * bf->size);
-		if(cp != NULL){
-			ZeroMemory(cp, sizeof(char) * bf->size);
-			CopyMemory(cp, bf->color + (r - bf->buf), sizeof(char) * (lstrlen(r)));
-			mem_free(&bf->color);
-			bf->color = (char *)cp;
-		}
-
-		p = mem_alloc(sizeof(TCHAR) * bf->size);
-		if(p != NULL){
-			lstrcpy(p, r);
-			mem_free(&bf->buf);
-			bf->buf = p;
-			bf->len = lstrlen(p);
-		}
-
-		mem_free(&bf->line);
-		mem_free(&bf->linelen);
-
 		//line init
-		bf->linesize = RESERVE_LINE;
-		bf->line = mem_alloc(sizeof(int) * bf->linesize);
-		if(bf->line == NULL) break;
-		*bf->line = 0;
-		bf->linelen = mem_alloc(sizeof(int) * bf->linesize);
-		if(bf->linelen == NULL) break;
-		bf->view_line = 1;
+		if(InitLine(bf) == FALSE) break;
 		bf->max = 0;
 
 		//set line
@@ -2349,25 +2686,25 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
 		p = ((int)wParam == -1) ? bf->cp : bf->buf + wParam;
-		for(j = 0; j < bf->view_line - 1 && *(bf->line + j + 1) + bf->buf <= p; j++);
+		j = GetLineIndex(bf, p);
 		return j;
 
 	case EM_LINEINDEX:
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
 		if((int)wParam == -1){
-			for(j = 0; j < bf->view_line - 1 && *(bf->line + j + 1) + bf->buf <= bf->cp; j++);
+			j = GetLineIndex(bf, bf->cp);
 		}else{
 			if((int)wParam >= bf->view_line) return -1;
 			j = (int)wParam;
 		}
-		return *(bf->line + j);
+		return (int)(LINE_PTR(bf, j) - bf->buf);
 
 	case EM_LINELENGTH:
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
 		p = ((int)wParam == -1) ? bf->cp : bf->buf + wParam;
-		for(j = 0; j < bf->view_line - 1 && *(bf->line + j + 1) + bf->buf <= p; j++);
+		j = GetLineIndex(bf, p);
 		return *(bf->linelen + j);
 
 	case EM_SETTABSTOPS:
@@ -2410,7 +2747,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 		bf = (VIEW_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
 		GetClientRect(hWnd, &rect);
-		for(i = 0; i < bf->view_line - 1 && *(bf->line + i + 1) + bf->buf <= bf->cp; i++);
+		i = GetLineIndex(bf, bf->cp);
 		if(i < bf->pos){
 			bf->pos = i;
 			if(bf->pos < 0) bf->pos = 0;
@@ -2435,21 +2772,21 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 			SendMessage(hWnd, EM_GETSEL, (WPARAM)&st, (LPARAM)&en);
 			lang = PRIMARYLANGID(LANGIDFROMLCID(GetThreadLocale()));
 
-			// j[̍쐬
+			// メニューの作成
 			hMenu = CreatePopupMenu();
 			AppendMenu(hMenu, MF_STRING | ((st != en) ? 0 : MF_GRAYED), WM_COPY,
-				(lang != LANG_JAPANESE) ? TEXT("&Copy") : TEXT("Rs[(&C)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Copy") : TEXT("コピー(&C)"));
 			if (bf->input_mode == TRUE) {
 				AppendMenu(hMenu, MF_STRING, WM_PASTE,
-					(lang != LANG_JAPANESE) ? TEXT("&Paste") : TEXT("\t(&P)"));
+					(lang != LANG_JAPANESE) ? TEXT("&Paste") : TEXT("貼り付け(&P)"));
 			}
 			AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
 			AppendMenu(hMenu, MF_STRING, 1,
-				(lang != LANG_JAPANESE) ? TEXT("Select &All") : TEXT("ׂđI(&A)"));
+				(lang != LANG_JAPANESE) ? TEXT("Select &All") : TEXT("すべて選択(&A)"));
 			AppendMenu(hMenu, MF_STRING, 2,
-				(lang != LANG_JAPANESE) ? TEXT("C&lear console") : TEXT("sʂ̃NA(&L)"));
+				(lang != LANG_JAPANESE) ? TEXT("C&lear console") : TEXT("実行結果のクリア(&L)"));
 
-			// j[̕\
+			// メニューの表示
 			GetCursorPos((LPPOINT)&apos);
 			i = TrackPopupMenu(hMenu, TPM_TOPALIGN | TPM_RETURNCMD, apos.x, apos.y, 0, hWnd, NULL);
 			DestroyMenu(hMenu);
@@ -2476,7 +2813,7 @@ static LRESULT CALLBACK ConsoleProc(HWND hWnd, UINT message, WPARAM wParam, LPAR
 }
 
 /*
- * RegisterConsoleWindow - NX̓o^
+ * RegisterConsoleWindow - クラスの登録
  */
 BOOL RegisterConsoleWindow(HINSTANCE hInstance)
 {
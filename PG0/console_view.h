@@ -28,7 +28,7 @@
 #define CONSOLE_WND_CLASS		TEXT("ConsoleViewClass")
 #endif
 
-//mۂTCY
+//確保するサイズ
 #ifndef DEF_RESERVE
 #define DEF_RESERVE
 #define RESERVE_SZIE			4096
@@ -44,30 +44,32 @@
 #define MSG_NOTIFY_OFFSET		WM_APP + 500
 #endif
 
-//̒ǉ
+//文字列の追加
 #define WM_VIEW_ADDTEXT			(MSG_OFFSET + 0)
-//struct _BUFFER ̎擾
+//struct _BUFFER の取得
 #define WM_VIEW_GETBUFFERINFO	(MSG_OFFSET + 1)
-//eLXgFƔwiF̐ݒ (wParam - TextColor, lParam - BackColor)
+//テキスト色と背景色の設定 (wParam - TextColor, lParam - BackColor)
 #define WM_VIEW_SETCOLOR		(MSG_OFFSET + 2)
-//sԂ̐ݒ (wParam - sԂ̃hbg)
+//行間の設定 (wParam - 行間のドット数)
 #define WM_VIEW_SETSPACING		(MSG_OFFSET + 4)
-//_s̐ݒ
+//論理行数制限の設定
 #define WM_VIEW_SETLINELIMIT	(MSG_OFFSET + 5)
-//tHgsԕύX̔f
+//フォントや行間変更の反映
 #define WM_VIEW_REFLECT			(MSG_OFFSET + 6)
-//XN[̃bN (wPrama - 0ŃXN[ʒuŒA1ŕ\ʒuŒ)
+//スクロールのロック (wPrama - 0でスクロール位置固定、1で表示位置固定)
 #define WM_VIEW_SETSCROLLLOCK	(MSG_OFFSET + 8)
-//̓[h
+//入力モード初期化
 #define WM_VIEW_INITINPUTMODE	(MSG_OFFSET + 9)
-//̓[hݒ
+//入力モード設定
 #define WM_VIEW_SETINPUTMODE	(MSG_OFFSET + 10)
-//̓[h擾
+//入力モード取得
 #define WM_VIEW_GETINPUTMODE	(MSG_OFFSET + 11)
-//͕擾
+//入力文字列取得
 #define WM_VIEW_GETINPUTSTRING	(MSG_OFFSET + 12)
+//キューの文字列を追加 (wParam - TRUEで即時に追加)
+#define WM_VIEW_FLUSHTEXT		(MSG_OFFSET + 13)
 
-//R[h
+//文字装飾コード
 #ifndef DEF_ORN
 #define DEF_ORN
 #define ORN_COLOR				0x03
@@ -77,7 +79,7 @@
 #define ORN_ITALIC				0x14
 #endif
 
-//X^C}XN
+//スタイルマスク
 #ifndef DEF_STYLE
 #define DEF_STYLE
 #define STYLE_TEXTCOLOR			1
@@ -93,99 +95,118 @@
 #ifndef DECL_CONSOLE_BUFFER
 #define DECL_CONSOLE_BUFFER
 typedef struct _VIEW_BUFFER {
-	//ێĂe
+	//保持している内容
 	TCHAR *buf;
-	//X^C (buf ̕ʒuƑΉ)
+	//スタイル情報 (buf の文字位置と対応)
 	char *style;
-	//F (buf ̕ʒuƑΉ)
+	//色情報 (buf の文字位置と対応)
 	char *color;
-	//buf ̊mۂĂTCY
+	//buf の確保しているサイズ
 	int size;
-	//buf '\0'܂ł̒
+	//buf の'\0'までの長さ
 	int len;
+	//確保したバッファの先頭から buf までのオフセット (古い行の削除で進む)
+	int top;
 
-	//Lbg̈ʒu (buf)
+	//キャレットの位置 (buf)
 	TCHAR *cp;
-	//IJnʒu (buf)
+	//選択開始位置 (buf)
 	TCHAR *sp;
-	//㉺ړ̃LbgXW
+	//上下移動時のキャレットのX座標
 	int cpx;
 
-	//\s̃ItZbg (buf + line[3] 4sڂ̈ʒu)
+	//表示行頭のオフセット (確保したバッファの先頭からの位置)
 	int *line;
-	//\s̒
+	//表示行の長さ
 	int *linelen;
-	//line ̊mۂĂTCY
+	//line の確保しているサイズ
 	int linesize;
-	//s (\s)
+	//確保した行情報の先頭から line までのオフセット
+	int line_top;
+	//行数 (表示行)
 	int view_line;
-	//s (_s)
+	//行数 (論理行)
 	int logic_line;
-	//EBhE̕
+	//ウィンドウの幅
 	int width;
 
-	//XN[ o[̂܂݂݂̌̈ʒu
+	//スクロール バーのつまみの現在の位置
 	int pos;
-	//XN[ o[݂̌̂܂݂̈ʒu̍ől
+	//スクロール バーの現在のつまみの位置の最大値
 	int max;
-	//XN[̃bN (0-XN[o[̈ʒuŌŒA1-\ʒuŌŒ)
+	//スクロールのロック (0-スクロールバーの位置で固定、1-表示位置で固定)
 	int sc_lock;
 
-	//ő啶
+	//最大文字数
 	int Limit;
-	//ős
+	//最大行数
 	int LineLimit;
-	//^uXgbv
+	//タブストップ
 	int TabStop;
-	//}[W
+	//左マージン
 	int LeftMargin;
-	//E}[W
+	//右マージン
 	int RightMargin;
-	//s
+	//行間
 	int Spacing;
 
-	//`p
+	//描画用情報
 	HDC mdc;
 	HBITMAP hBmp;
 	HBITMAP hRetBmp;
+	//文字幅やレイアウトのキャッシュ
+	struct _VIEW_CACHE *cache;
 
-	//tHg
+	//フォント情報
 	LOGFONT lf;
-	//tHg̍
+	//フォントの高さ
 	int FontHeight;
-	//1̃tHg̕
+	//1文字のフォントの幅
 	int CharWidth;
-	//Œsb` - TRUE, σsb` - FALSE
+	//固定ピッチ - TRUE, 可変ピッチ - FALSE
 	BOOL Fixed;
 
-	//eLXg̐F
+	//テキストの色
 	COLORREF TextColor;
-	//wiF
+	//背景色
 	COLORREF BackClolor;
-	//wiF̃uV
+	//背景色のブラシ
 	HBRUSH hBkBrush;
 
-	//}EXtO
+	//マウス情報フラグ
 	BOOL mousedown;
 
-	// ̓[h
+	// 入力モード
 	BOOL input_mode;
 	TCHAR input_string[INPUT_SIZE + 1];
 	TCHAR input_buf[INPUT_SIZE + 1];
 
+	// 出力キュー (別スレッドから追加し、ウィンドウのスレッドで取り出す)
+	struct _VIEW_CHUNK *q_head;
+	struct _VIEW_CHUNK *q_tail;
+	//キューの文字数
+	volatile LONG q_size;
+	//通知済みフラグ
+	volatile LONG q_notify;
+	//取り出し時に通知するイベント
+	HANDLE q_event;
+	//最後に取り出した時間
+	DWORD q_time;
+
 #ifdef OP_XP_STYLE
 	// XP
 	HMODULE hModThemes;
 	HTHEME hTheme;
 #endif	// OP_XP_STYLE
 
-	//[U
+	//ユーザ情報
 	long param1;
 	long param2;
 } VIEW_BUFFER;
 #endif
 
 /* Function Prototypes */
+BOOL ConsoleQueueText(const HWND hWnd, const TCHAR *str);
 BOOL RegisterConsoleWindow(HINSTANCE hInstance);
 
 #endif
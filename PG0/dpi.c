@@ -30,7 +30,7 @@ static FARPROC _GetDpiForMonitor;
 
 
 /*
- * Scale - XP[ϊl̎擾
+ * Scale - スケール変換した値の取得
  */
 int Scale(int x)
 {
@@ -46,7 +46,7 @@ int Scale(int x)
 }
 
 /*
- * UnScale - XP[߂l̎擾
+ * UnScale - スケールを戻した値の取得
  */
 int UnScale(int x)
 {
@@ -62,7 +62,7 @@ int UnScale(int x)
 }
 
 /*
- * GetScale - XP[̎擾
+ * GetScale - スケールの取得
  */
 UINT GetScale()
 {
@@ -78,7 +78,7 @@ UINT GetScale()
 }
 
 /*
- * SetScale - XP[̐ݒ
+ * SetScale - スケールの設定
  */
 void SetScale(UINT iDPI)
 {
@@ -90,7 +90,7 @@ void SetScale(UINT iDPI)
 }
 
 /*
- * GetAwareness - Awareness̎擾
+ * GetAwareness - Awarenessの取得
  */
 PROCESS_DPI_AWARENESS GetAwareness()
 {
@@ -103,7 +103,7 @@ PROCESS_DPI_AWARENESS GetAwareness()
 }
 
 /*
- * SetAwareness - Awareness̐ݒ
+ * SetAwareness - Awarenessの設定
  */
 void SetAwareness(PROCESS_DPI_AWARENESS awareness)
 {
@@ -118,7 +118,7 @@ void SetAwareness(PROCESS_DPI_AWARENESS awareness)
 }
 
 /*
- * ScaleRect - RECT̃XP[ϊ
+ * ScaleRect - RECTのスケール変換
  */
 void ScaleRect(RECT* pRect)
 {
@@ -129,7 +129,7 @@ void ScaleRect(RECT* pRect)
 }
 
 /*
- * UnScaleRect - RECT̃XP[ϊ
+ * UnScaleRect - RECTのスケール変換
  */
 void UnScaleRect(RECT* pRect)
 {
@@ -140,7 +140,7 @@ void UnScaleRect(RECT* pRect)
 }
 
 /*
- * ScalePoint - POINT̃XP[ϊ
+ * ScalePoint - POINTのスケール変換
  */
 void ScalePoint(POINT* pPoint)
 {
@@ -149,7 +149,7 @@ void ScalePoint(POINT* pPoint)
 }
 
 /*
- * UnScalePoint - POINT̃XP[ϊ
+ * UnScalePoint - POINTのスケール変換
  */
 void UnScalePoint(POINT* pPoint)
 {
@@ -158,7 +158,7 @@ void UnScalePoint(POINT* pPoint)
 }
 
 /*
- * InitDpi - DPȈ
+ * InitDpi - DPIの初期化
  */
 void InitDpi()
 {
@@ -175,7 +175,7 @@ void InitDpi()
 		return;
 	}
 
-	// DPȈ
+	// DPIの初期化
 	GetAwareness();
 	UINT dpix = 0, dpiy = 0;
 	POINT pt = { 1, 1 };
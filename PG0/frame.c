@@ -14,15 +14,15 @@
 #undef	_INC_OLE
 
 /* Define */
-#define FRAME_CNT				1		// Et[
-#define NOMOVESIZE				6		// t[̈ړl
+#define FRAME_CNT				1		// 境界フレーム数
+#define NOMOVESIZE				6		// フレームの移動制限値
 
 /* Global Variables */
 
 /* Local Function Prototypes */
 
 /*
- * InitializeFrame - t[̏
+ * InitializeFrame - フレームの初期化
  */
 BOOL InitializeFrame(const HWND hWnd)
 {
@@ -31,7 +31,7 @@ BOOL InitializeFrame(const HWND hWnd)
 }
 
 /*
- * FreeFrame - t[̉
+ * FreeFrame - フレームの解放
  */
 void FreeFrame(void)
 {
@@ -39,7 +39,7 @@ void FreeFrame(void)
 }
 
 /*
- * DrawVerticalFrame - t[̕`
+ * DrawVerticalFrame - フレームの描画
  */
 int DrawVerticalFrame(const HWND hWnd, const HWND hContainer)
 {
@@ -50,7 +50,7 @@ int DrawVerticalFrame(const HWND hWnd, const HWND hContainer)
 	GetWindowRect(hWnd, (LPRECT)&window_rect);
 	GetWindowRect(hContainer, (LPRECT)&container_rect);
 
-	// t[̈ړ
+	// フレームの移動制限
 	if (apos.x <= (window_rect.left + NOMOVESIZE + GetSystemMetrics(SM_CXFRAME))) {
 		apos.x = window_rect.left + NOMOVESIZE + GetSystemMetrics(SM_CXFRAME);
 	} else if (apos.x >= (window_rect.right - (NOMOVESIZE + (FRAME_CNT * 2)) - GetSystemMetrics(SM_CXFRAME))) {
@@ -60,7 +60,7 @@ int DrawVerticalFrame(const HWND hWnd, const HWND hContainer)
 }
 
 /*
- * DrawHorizonFrame - t[̕`
+ * DrawHorizonFrame - フレームの描画
  */
 int DrawHorizonFrame(const HWND hWnd, const HWND hContainer)
 {
@@ -71,7 +71,7 @@ int DrawHorizonFrame(const HWND hWnd, const HWND hContainer)
 	GetWindowRect(hWnd, (LPRECT)&window_rect);
 	GetWindowRect(hContainer, (LPRECT)&container_rect);
 
-	// t[̈ړ
+	// フレームの移動制限
 	if (apos.y <= (window_rect.top + NOMOVESIZE + GetSystemMetrics(SM_CYFRAME))) {
 		apos.y = window_rect.top + NOMOVESIZE + GetSystemMetrics(SM_CYFRAME);
 	} else if (apos.y >= (window_rect.bottom - (NOMOVESIZE + (FRAME_CNT * 2)) - GetSystemMetrics(SM_CYFRAME))) {
@@ -81,7 +81,7 @@ int DrawHorizonFrame(const HWND hWnd, const HWND hContainer)
 }
 
 /*
- * DrawVariableFrame - t[̕`
+ * DrawVariableFrame - フレームの描画
  */
 int DrawVariableFrame(const HWND hWnd)
 {
@@ -24,7 +24,7 @@
 /* Local Function Prototypes */
 
 /*
- * _lib_func_istype - ^̔
+ * _lib_func_istype - 型の判定
  */
 int SFUNC _lib_func_istype(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -37,7 +37,7 @@ int SFUNC _lib_func_istype(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
- * _lib_func_length - 擾
+ * _lib_func_length - 長さを取得
  */
 int SFUNC _lib_func_length(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -69,7 +69,9 @@ int SFUNC _lib_func_length(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
- * StringToValueList - zɕϊ
+ * StringToValueList - 文字列を配列に変換
+ *
+ *	メモリの確保に失敗した場合は RET_ERROR を返す
  */
 static VALUEINFO *StringToValueList(TCHAR *str)
 {
@@ -77,12 +79,20 @@ static VALUEINFO *StringToValueList(TCHAR *str)
 
 	To = &Top;
 	To->next = NULL;
+	if (str == NULL) {
+		return (VALUEINFO *)RET_ERROR;
+	}
 	for (; *str != TEXT('\0'); str++) {
 		To = To->next = AllocValue();
 		if (To == NULL) {
-			return Top.next;
+			FreeValueList(Top.next);
+			return (VALUEINFO *)RET_ERROR;
 		}
 		To->v->u.sValue = mem_alloc(sizeof(TCHAR) * 2);
+		if (To->v->u.sValue == NULL) {
+			FreeValueList(Top.next);
+			return (VALUEINFO *)RET_ERROR;
+		}
 		*(To->v->u.sValue) = *str;
 		*(To->v->u.sValue + 1) = TEXT('\0');
 		To->v->type = TYPE_STRING;
@@ -91,7 +101,7 @@ static VALUEINFO *StringToValueList(TCHAR *str)
 }
 
 /*
- * _lib_func_array - zɕϊ
+ * _lib_func_array - 配列に変換
  */
 int SFUNC _lib_func_array(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -113,12 +123,16 @@ int SFUNC _lib_func_array(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 		mem_free(&str);
 		break;
 	}
+	if (ret->v->u.array == (VALUEINFO *)RET_ERROR) {
+		ret->v->u.array = NULL;
+		return -3;
+	}
 	ret->v->type = TYPE_ARRAY;
 	return 0;
 }
 
 /*
- * ValueListToString - z𕶎ɕϊ
+ * ValueListToString - 配列を文字列に変換
  */
 TCHAR *ValueListToString(VALUEINFO *From)
 {
@@ -157,7 +171,7 @@ TCHAR *ValueListToString(VALUEINFO *From)
 }
 
 /*
- * _lib_func_string - ɕϊ
+ * _lib_func_string - 文字列に変換
  */
 int SFUNC _lib_func_string(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -169,12 +183,15 @@ int SFUNC _lib_func_string(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 	} else {
 		ret->v->u.sValue = VariableToString(param);
 	}
+	if (ret->v->u.sValue == NULL) {
+		return -3;
+	}
 	ret->v->type = TYPE_STRING;
 	return 0;
 }
 
 /*
- * StringToNumber - 𐔒lɕϊ
+ * StringToNumber - 文字列を数値に変換
  */
 void StringToNumber(TCHAR *buf, VALUEINFO *ret)
 {
@@ -191,7 +208,7 @@ void StringToNumber(TCHAR *buf, VALUEINFO *ret)
 }
 
 /*
- * _lib_func_number - lɕϊ
+ * _lib_func_number - 数値に変換
  */
 int SFUNC _lib_func_number(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -222,7 +239,7 @@ int SFUNC _lib_func_number(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
- * _lib_func_int - ɕϊ
+ * _lib_func_int - 整数に変換
  */
 int SFUNC _lib_func_int(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -249,7 +266,7 @@ int SFUNC _lib_func_int(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *E
 }
 
 /*
-* indexToChar - wCfbNX̕擾
+* indexToChar - 指定インデックスの文字を取得
 */
 static TCHAR *indexToChar(TCHAR *p, int index)
 {
@@ -258,7 +275,7 @@ static TCHAR *indexToChar(TCHAR *p, int index)
 }
 
 /*
- * _lib_func_code - 1ڂ̕R[h擾
+ * _lib_func_code - 1文字目の文字コード取得
  */
 int SFUNC _lib_func_code(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -304,7 +321,7 @@ int SFUNC _lib_func_code(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *
 }
 
 /*
- * _lib_func_char - R[h𕶎ɕϊ
+ * _lib_func_char - 文字コードを文字に変換
  */
 int SFUNC _lib_func_char(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -335,8 +352,8 @@ int SFUNC _lib_func_char(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *
 }
 
 /*
- * _lib_func_getkey - z̃L[擾
- * getkey(z, CfbNX)  L[
+ * _lib_func_getkey - 配列のキー名を取得
+ * getkey(配列, インデックス) → キー名
  */
 int SFUNC _lib_func_getkey(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -379,8 +396,8 @@ int SFUNC _lib_func_getkey(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
-* _lib_func_setkey - z̃L[ݒ
-* setkey(z, CfbNX, L[)
+* _lib_func_setkey - 配列のキー名を設定
+* setkey(配列, インデックス, キー名)
 */
 int SFUNC _lib_func_setkey(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
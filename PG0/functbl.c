@@ -57,20 +57,32 @@ FUNCTBL ft[] = {
 	TEXT("_lib_func_setkey"), 0, _lib_func_setkey,
 };
 
+static volatile LONG init_state = 0;
+
 /*
- * InitFuncAddress - ֐e[ȕ
+ * InitFuncAddress - 関数テーブルの初期化
+ *
+ *	複数のスレッドから呼ばれても初期化は1度だけ行う
  */
 void InitFuncAddress()
 {
 	int i;
 
+	if (InterlockedCompareExchange(&init_state, 1, 0) != 0) {
+		// 他のスレッドの初期化完了を待つ
+		while (init_state != 2) {
+			Sleep(0);
+		}
+		return;
+	}
 	for(i = 0; i < sizeof(ft) / sizeof(FUNCTBL); i++){
 		(ft + i)->name_hash = str2hash((ft + i)->name);
 	}
+	InterlockedExchange(&init_state, 2);
 }
 
 /*
- * GetFuncAddress - ֐AhX擾
+ * GetFuncAddress - 関数名からアドレスを取得
  */
 LIBFUNC GetFuncAddress(TCHAR *FuncName)
 {
@@ -52,7 +52,10 @@
 #define EXEC_SPEED_MID					250
 #define EXEC_SPEED_LOW					500
 
-// ^C}[ID
+// 実行中の画面更新の間隔 (ミリ秒)
+#define REFRESH_INTERVAL				16
+
+// タイマーID
 #define TIMER_SEP						1
 #define TIMER_CONFIRM_TUTORIAL			2
 
@@ -87,19 +90,29 @@ static OPTION_DATA op;
 
 static HANDLE hThread;
 static int exec_line = -1;
+static DWORD refresh_time;
+// 実行の制御 (スクリプトスレッドはロックせずに参照する)
 typedef struct _EXEC_DATA {
-	BOOL exec_flag;
-	BOOL step_flag;
-	BOOL step_next_flag;
-	BOOL stop_flag;
-	int exec_speed;
-	int stop_line;
+	volatile LONG exec_flag;
+	volatile LONG step_flag;
+	volatile LONG step_next_flag;
+	volatile LONG stop_flag;
+	volatile LONG refresh_flag;
+	volatile LONG exec_speed;
+	volatile LONG stop_line;
+	// フラグの変更をスクリプトスレッドに通知
+	HANDLE step_event;
 } EXEC_DATA;
 static EXEC_DATA ed;
 static CRITICAL_SECTION cs;
+// 実行中のスクリプト (csで保護)
+static SCRIPTINFO *exec_sci;
 
 /* Local Function Prototypes */
 static int SFUNC Callback(EXECINFO *ei, TOKEN *cu_tk);
+static void SetBreakMode(void);
+static void SetStopLine(const int line);
+static void SetScriptBreakPoint(SCRIPTINFO *sci);
 static TCHAR *GetTimeString(TCHAR *ret);
 static void OutputTime(HWND hWnd);
 static unsigned int CALLBACK StartScript(const HWND hWnd);
@@ -120,7 +133,7 @@ static BOOL InitApplication(HINSTANCE hInstance);
 static HWND InitInstance(HINSTANCE hInstance, int CmdShow);
 
 /*
- * _lib_func_error - G[o
+ * _lib_func_error - エラー出力
  */
 int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -135,6 +148,8 @@ int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 		line = VariableToInt(param);
 	}
 
+	// キューの出力を先に追加
+	SendMessage(hConsoleView, WM_VIEW_FLUSHTEXT, (WPARAM)TRUE, 0);
 	OutputTime(hConsoleView);
 	SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT(" \x03")TEXT("04"));
 	SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)str);
@@ -146,7 +161,7 @@ int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
- * _lib_func_print - Wo
+ * _lib_func_print - 標準出力
  */
 int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -166,19 +181,23 @@ int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 		str = VariableToString(param);
 	}
 	if (first_io == TRUE && SendMessage(hConsoleView, WM_GETTEXTLENGTH, 0, 0) > 0) {
-		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT("\r\n"));
+		ConsoleQueueText(hConsoleView, TEXT("\r\n"));
 		first_io = FALSE;
 	}
-	SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)str);
+	// 出力はキューに追加してコンソールのスレッドでまとめて描画
+	if (str != NULL) {
+		ConsoleQueueText(hConsoleView, str);
+	}
 	mem_free(&str);
 	return 0;
 }
 
 /*
- * _lib_func_input - W
+ * _lib_func_input - 標準入力
  */
 int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
+	SendMessage(hConsoleView, WM_VIEW_FLUSHTEXT, (WPARAM)TRUE, 0);
 	if (first_io == TRUE && SendMessage(hConsoleView, WM_GETTEXTLENGTH, 0, 0) > 0) {
 		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT("\r\n"));
 		first_io = FALSE;
@@ -187,13 +206,11 @@ int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 	hFocusWnd = hConsoleView;
 	SendMessage(GetParent(hConsoleView), WM_SETFOCUS, 0, 0);
 	while (SendMessage(hConsoleView, WM_VIEW_GETINPUTMODE, 0, 0) == TRUE) {
-		EnterCriticalSection(&cs);
 		if (ed.stop_flag == TRUE) {
-			LeaveCriticalSection(&cs);
 			return 0;
 		}
-		LeaveCriticalSection(&cs);
-		Sleep(100);
+		// 入力の完了を確認しながら停止を待つ
+		WaitForSingleObject(ed.step_event, 100);
 	}
 	ret->v->u.sValue = alloc_copy((TCHAR *)SendMessage(hConsoleView, WM_VIEW_GETINPUTSTRING, 0, 0));
 	ret->v->type = TYPE_STRING;
@@ -201,84 +218,144 @@ int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
- * Callback - s̃R[obN
+ * Callback - 実行時のコールバック
  */
 static int SFUNC Callback(EXECINFO *ei, TOKEN *cu_tk)
 {
-	EXEC_DATA _ed;
-	EnterCriticalSection(&cs);
-	_ed = ed;
-	LeaveCriticalSection(&cs);
-	if (_ed.stop_flag == TRUE) {
-		if (_ed.exec_speed <= 0 && _ed.step_flag == FALSE) {
-			// ϐ̂ݍXV
-			SendMessage(hVariableView, WM_VIEW_SETVARIABLE, 0, (LPARAM)ei);
-		}
+	DWORD start, elapsed;
+	BOOL first;
+	BOOL hit = FALSE;
+	BOOL brk;
+	int line;
+
+	if (ed.stop_flag == TRUE) {
+		// 変数のみ更新 (終了後も参照できるようにすべての配列の要素を作成)
+		SendMessage(hVariableView, WM_VIEW_SETVARIABLE, TRUE, (LPARAM)ei);
 		return -1;
 	}
 	if (cu_tk == NULL) {
-		// ϐ̂ݍXV
-		SendMessage(hVariableView, WM_VIEW_SETVARIABLE, 0, (LPARAM)ei);
+		// 変数のみ更新 (終了後も参照できるようにすべての配列の要素を作成)
+		SendMessage(hVariableView, WM_VIEW_SETVARIABLE, TRUE, (LPARAM)ei);
 		return 0;
 	}
 
-	if (_ed.stop_line >= 0) {
-		// J[\s܂Ŏs
-		if (cu_tk->line < 0 || exec_line == cu_tk->line) {
-			return 0;
-		}
-		if (_ed.stop_line != cu_tk->line) {
+	if (ed.step_flag == FALSE && (ed.stop_line >= 0 || ed.exec_speed <= 0)) {
+		// ブレークポイントまで実行 (カーソル行まで実行は一時的なブレークポイント)
+		if (IsBreakPoint(ei->sci, cu_tk) == FALSE) {
 			exec_line = cu_tk->line;
 			return 0;
 		}
+		// ブレークポイントで停止してカーソル行の一時的なブレークポイントを解除
+		line = ed.stop_line;
+		brk = (line >= 0) ? (BOOL)SendMessage(hEdit, WM_GET_BREAK_LINE, (WPARAM)line, 0) : TRUE;
 		EnterCriticalSection(&cs);
-		ed.stop_line = -1;
+		if (line >= 0 && ed.stop_line == line) {
+			if (brk == FALSE) {
+				SetBreakPoint(exec_sci, line, FALSE);
+			}
+			ed.stop_line = -1;
+		}
 		ed.step_flag = TRUE;
 		ed.step_next_flag = FALSE;
-		_ed = ed;
+		SetBreakMode();
 		LeaveCriticalSection(&cs);
+		hit = TRUE;
 	}
-	if (_ed.exec_speed <= 0 && _ed.step_flag == FALSE) {
-		// ŝ
-		exec_line = cu_tk->line;
+	if (hit == FALSE && exec_line != -1 && (cu_tk->line < 0 || exec_line == cu_tk->line)) {
+		// 同一行は更新しない
 		return 0;
 	}
-	if (exec_line != -1) {
-		if (cu_tk->line < 0 || exec_line == cu_tk->line) {
-			// s͍XVȂ
-			return 0;
-		}
-		// ϐ̍XV
-		SendMessage(hVariableView, WM_VIEW_SETVARIABLE, 0, (LPARAM)ei);
-	}
-	// sĂs̍XV
+	// 実行している行の更新
+	first = (exec_line == -1 && hit == FALSE) ? TRUE : FALSE;
 	exec_line = cu_tk->line;
 	if (exec_line == -1) {
 		return 0;
 	}
-	SendMessage(hEdit, WM_SET_HIGHLIGHT_LINE, 0, (LPARAM)exec_line);
-	if (_ed.step_flag == TRUE) {
-		// Xebvs
-		while (1) {
-			EnterCriticalSection(&cs);
-			if (ed.step_next_flag == TRUE) {
-				LeaveCriticalSection(&cs);
-				break;
+	if (ed.step_flag == TRUE || InterlockedExchange(&ed.refresh_flag, FALSE) == TRUE ||
+		GetTickCount() - refresh_time >= REFRESH_INTERVAL) {
+		// 停止する行は必ず更新し、それ以外は一定間隔でまとめて更新
+		if (first == FALSE) {
+			SendMessage(hVariableView, WM_VIEW_SETVARIABLE, 0, (LPARAM)ei);
+		}
+		SendMessage(hEdit, WM_SET_HIGHLIGHT_LINE, 0, (LPARAM)exec_line);
+		refresh_time = GetTickCount();
+	}
+	if (ed.step_flag == TRUE) {
+		// ステップ実行 (次の行、停止、変数の再取得の要求を待つ)
+		while (InterlockedExchange(&ed.step_next_flag, FALSE) == FALSE) {
+			if (InterlockedExchange(&ed.refresh_flag, FALSE) == TRUE) {
+				// 変数ビューからの要求で変数を更新
+				SendMessage(hVariableView, WM_VIEW_SETVARIABLE, 0, (LPARAM)ei);
+				continue;
 			}
-			LeaveCriticalSection(&cs);
-			Sleep(100);
+			WaitForSingleObject(ed.step_event, INFINITE);
 		}
-		EnterCriticalSection(&cs);
-		ed.step_next_flag = FALSE;
-		LeaveCriticalSection(&cs);
 	} else {
-		Sleep(_ed.exec_speed);
+		// 実行速度の待機 (停止やステップ実行への切り替えで中断)
+		start = GetTickCount();
+		elapsed = 0;
+		while (ed.stop_flag == FALSE && ed.step_flag == FALSE && elapsed < (DWORD)ed.exec_speed) {
+			if (WaitForSingleObject(ed.step_event, (DWORD)ed.exec_speed - elapsed) == WAIT_TIMEOUT) {
+				break;
+			}
+			elapsed = GetTickCount() - start;
+		}
 	}
 	return 0;
 }
 
 /*
- * GetDateTimeString - Ԃ̎擾
+ * SetBreakMode - コールバックをブレークポイントのみで呼び出すかを設定 (csの中で呼び出す)
+ *
+ *	待ち無しの実行とカーソル行までの実行はブレークポイント以外で呼び出さない
+ */
+static void SetBreakMode(void)
+{
+	if (exec_sci == NULL) {
+		return;
+	}
+	SetBreakOnly(exec_sci, (ed.stop_flag == FALSE && ed.step_flag == FALSE &&
+		(ed.stop_line >= 0 || ed.exec_speed <= 0)) ? TRUE : FALSE);
+}
+
+/*
+ * SetStopLine - カーソル行まで実行する行の設定 (メインスレッドでcsの中で呼び出す)
+ *
+ *	実行中は前の行の一時的なブレークポイントを解除して指定行に設定する
+ */
+static void SetStopLine(const int line)
+{
+	if (exec_sci != NULL && ed.stop_line >= 0 &&
+		SendMessage(hEdit, WM_GET_BREAK_LINE, (WPARAM)ed.stop_line, 0) == FALSE) {
+		SetBreakPoint(exec_sci, ed.stop_line, FALSE);
+	}
+	ed.stop_line = line;
+	if (exec_sci != NULL && line >= 0) {
+		SetBreakPoint(exec_sci, line, TRUE);
+	}
+}
+
+/*
+ * SetScriptBreakPoint - エディタのブレークポイントを解析木に設定
+ */
+static void SetScriptBreakPoint(SCRIPTINFO *sci)
+{
+	int *lines;
+	int cnt, i;
+
+	cnt = (int)SendMessage(hEdit, WM_GET_BREAK_LINE_LIST, 0, 0);
+	if (cnt <= 0 || (lines = (int *)mem_alloc(sizeof(int) * cnt)) == NULL) {
+		return;
+	}
+	cnt = (int)SendMessage(hEdit, WM_GET_BREAK_LINE_LIST, (WPARAM)cnt, (LPARAM)lines);
+	for (i = 0; i < cnt; i++) {
+		SetBreakPoint(sci, *(lines + i), TRUE);
+	}
+	mem_free(&lines);
+}
+
+/*
+ * GetDateTimeString - 時間を書式化した文字列の取得
  */
 static TCHAR *GetTimeString(TCHAR *ret)
 {
@@ -287,7 +364,7 @@ static TCHAR *GetTimeString(TCHAR *ret)
 }
 
 /*
- * OutputTime - ԏo
+ * OutputTime - 時間出力
  */
 static void OutputTime(HWND hWnd)
 {
@@ -300,7 +377,7 @@ static void OutputTime(HWND hWnd)
 }
 
 /*
- * DebugToken - ͖؂̃fobO\
+ * DebugToken - 解析木のデバッグ表示
  */
 #ifdef _DEBUG_TOKEN
 static void DebugToken(TOKEN *tk, int lv)
@@ -336,7 +413,7 @@ static void DebugToken(TOKEN *tk, int lv)
 #endif
 
 /*
- * StartScript - XNvg̎s
+ * StartScript - スクリプトの実行
  */
 static unsigned int CALLBACK StartScript(const HWND hWnd)
 {
@@ -370,6 +447,7 @@ static unsigned int CALLBACK StartScript(const HWND hWnd)
 	EnterCriticalSection(&cs);
 	ed.exec_flag = TRUE;
 	ed.stop_flag = FALSE;
+	ed.refresh_flag = FALSE;
 	LeaveCriticalSection(&cs);
 
 	sci = mem_alloc(sizeof(SCRIPTINFO));
@@ -399,14 +477,15 @@ static unsigned int CALLBACK StartScript(const HWND hWnd)
 	}
 
 	SetEnableWindow(hWnd);
-	// JnbZ[W
+	// 開始メッセージ
 	OutputTime(hConsoleView);
 	SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT(" \x03")TEXT("12"));
 	SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)GetResMessage(IDS_STRING_CONSOLE_START));
 	first_io = TRUE;
 	exec_line = -1;
+	refresh_time = GetTickCount() - REFRESH_INTERVAL;
 
-	//\
+	//構文解析
 	ZeroMemory(&ei, sizeof(EXECINFO));
 	ei.sci = sci;
 	sci->tk = ParseSentence(&ei, sci->buf, 0);
@@ -417,7 +496,7 @@ static unsigned int CALLBACK StartScript(const HWND hWnd)
 		LeaveCriticalSection(&cs);
 		hThread = NULL;
 
-		// IbZ[W
+		// 終了メッセージ
 		OutputTime(hConsoleView);
 		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT(" \x03")TEXT("12"));
 		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)GetResMessage(IDS_STRING_CONSOLE_END));
@@ -428,25 +507,36 @@ static unsigned int CALLBACK StartScript(const HWND hWnd)
 	DebugToken(sci->tk, 1);
 #endif
 
+	// ブレークポイントの設定 (以降は実行中の変更も反映)
+	EnterCriticalSection(&cs);
+	exec_sci = sci;
+	if (ed.stop_line >= 0) {
+		SetBreakPoint(sci, ed.stop_line, TRUE);
+	}
+	SetBreakMode();
+	LeaveCriticalSection(&cs);
+	SetScriptBreakPoint(sci);
+
 	sci->callback = Callback;
 	rvi = NULL;
 	ret = ExecScript(sci, NULL, &rvi);
+	SendMessage(hConsoleView, WM_VIEW_FLUSHTEXT, (WPARAM)TRUE, 0);
 	OutputTime(hConsoleView);
 	SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT(" \x03")TEXT("12"));
 	EnterCriticalSection(&cs);
 	if (ed.stop_flag == FALSE) {
 		LeaveCriticalSection(&cs);
-		// IbZ[W
+		// 終了メッセージ
 		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)GetResMessage(IDS_STRING_CONSOLE_END));
 	} else {
 		LeaveCriticalSection(&cs);
-		// ~bZ[W
+		// 停止メッセージ
 		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)GetResMessage(IDS_STRING_CONSOLE_STOP));
 	}
 	EnterCriticalSection(&cs);
-	if(ret != -1 && ed.stop_flag == FALSE && rvi != NULL && rvi->v != NULL){
+	if(ret == 0 && ed.stop_flag == FALSE && rvi != NULL && rvi->v != NULL){
 		TCHAR msg[BUF_SIZE];
-		// ߂l̏o
+		// 戻り値の出力
 		LeaveCriticalSection(&cs);
 		OutputTime(hConsoleView);
 		SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT(" \x03")TEXT("12"));
@@ -489,6 +579,9 @@ static unsigned int CALLBACK StartScript(const HWND hWnd)
 		LeaveCriticalSection(&cs);
 	}
 	FreeValueList(rvi);
+	EnterCriticalSection(&cs);
+	exec_sci = NULL;
+	LeaveCriticalSection(&cs);
 	FreeScriptInfo(sci);
 	EndScript();
 	SendMessage(hEdit, WM_SET_HIGHLIGHT_LINE, 0, (LPARAM)-1);
@@ -501,7 +594,7 @@ static unsigned int CALLBACK StartScript(const HWND hWnd)
 }
 
 /*
- * ExecScriptThread - XNvgsXbh
+ * ExecScriptThread - スクリプト実行スレッド
  */
 static void ExecScriptThread(const HWND hWnd)
 {
@@ -513,7 +606,7 @@ static void ExecScriptThread(const HWND hWnd)
 }
 
 /*
- * GetErrorMessage - G[l烁bZ[W擾
+ * GetErrorMessage - エラー値からメッセージを取得
  */
 static BOOL GetErrorMessage(const int err_code, TCHAR *err_str)
 {
@@ -526,7 +619,7 @@ static BOOL GetErrorMessage(const int err_code, TCHAR *err_str)
 }
 
 /*
- * GetResMessage - \[X烁bZ[W擾
+ * GetResMessage - リソースからメッセージを取得
  */
 static TCHAR *GetResMessage(const UINT id)
 {
@@ -538,13 +631,13 @@ static TCHAR *GetResMessage(const UINT id)
 }
 
 /*
- * SelectFont - tHg̑I
+ * SelectFont - フォントの選択
  */
 static HFONT SelectFont(const HWND hWnd)
 {
 	CHOOSEFONT cf;
 
-	// tHgI_CAO\
+	// フォント選択ダイアログを表示
 	ZeroMemory(&cf, sizeof(CHOOSEFONT));
 	cf.lStructSize = sizeof(CHOOSEFONT);
 	cf.hwndOwner = hWnd;
@@ -561,7 +654,7 @@ static HFONT SelectFont(const HWND hWnd)
 }
 
 /*
- * GetIni - ݒǂݍ
+ * GetIni - 設定読み込み
  */
 static void GetIni(const HWND hWnd, const TCHAR *ini_path)
 {
@@ -658,7 +751,7 @@ static void GetIni(const HWND hWnd, const TCHAR *ini_path)
 }
 
 /*
- * PutIni - ݒ菑
+ * PutIni - 設定書き込み
  */
 static void PutIni(const HWND hWnd, const TCHAR *ini_path)
 {
@@ -699,7 +792,7 @@ static void PutIni(const HWND hWnd, const TCHAR *ini_path)
 }
 
 /*
- * ReadScriptfile - t@C̓ǂݍ
+ * ReadScriptfile - ファイルの読み込み
  */
 static BOOL ReadScriptfile(const HWND hWnd, TCHAR *path)
 {
@@ -722,7 +815,7 @@ static BOOL ReadScriptfile(const HWND hWnd, TCHAR *path)
 			return FALSE;
 		}
 	}
-	// t@Cǂݍ
+	// ファイルを読み込む
 	buf = read_file(path);
 	if (buf == NULL) {
 		GetErrorMessage(GetLastError(), err_str);
@@ -731,13 +824,13 @@ static BOOL ReadScriptfile(const HWND hWnd, TCHAR *path)
 	}
 	SendMessage(hEdit, WM_SETMEM, sizeof(TCHAR) * lstrlen(buf), (LPARAM)buf);
 	mem_free(&buf);
-	// EDIT ̕ύXtO
+	// EDIT の変更フラグを除去する
 	SendMessage(hEdit, EM_SETMODIFY, (WPARAM)FALSE, 0);
 	return TRUE;
 }
 
 /*
- * SaveFile - t@C̕ۑ
+ * SaveFile - ファイルの保存
  */
 static BOOL SaveFile(const HWND hWnd, TCHAR *path)
 {
@@ -766,7 +859,7 @@ static BOOL SaveFile(const HWND hWnd, TCHAR *path)
 		}
 	}
 
-	// t@CJ
+	// ファイルを開く
 	hFile = CreateFile(path, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
 	if (hFile == NULL || hFile == (HANDLE)-1) {
 		GetErrorMessage(GetLastError(), err_str);
@@ -783,11 +876,11 @@ static BOOL SaveFile(const HWND hWnd, TCHAR *path)
 	}
 	SendMessage(hEdit, WM_GETTEXT, len + 1, (LPARAM)buf);
 	
-	// t@Cɏ
+	// ファイルに書き込む
 #ifdef UNICODE
 	wbuf = buf;
 #else
-	// ASCIIUTF-16ɕϊ
+	// ASCIIからUTF-16に変換
 	len = MultiByteToWideChar(CP_ACP, 0, buf, -1, NULL, 0);
 	if ((wbuf = (WCHAR *)mem_alloc(sizeof(WCHAR) * len)) == NULL) {
 		GetErrorMessage(GetLastError(), err_str);
@@ -799,7 +892,7 @@ static BOOL SaveFile(const HWND hWnd, TCHAR *path)
 	MultiByteToWideChar(CP_ACP, 0, buf, -1, wbuf, len);
 	mem_free(&buf);
 #endif
-	// UTF-16UTF-8ɕϊ
+	// UTF-16からUTF-8に変換
 	len = WideCharToMultiByte(CP_UTF8, 0, wbuf, -1, NULL, 0, NULL, NULL);
 	if ((cbuf = (BYTE *)mem_alloc(sizeof(BYTE) * len)) == NULL) {
 		GetErrorMessage(GetLastError(), err_str);
@@ -821,13 +914,13 @@ static BOOL SaveFile(const HWND hWnd, TCHAR *path)
 	mem_free(&wbuf);
 	CloseHandle(hFile);
 	
-	// EDIT ̕ύXtO
+	// EDIT の変更フラグを除去する
 	SendMessage(hEdit, EM_SETMODIFY, (WPARAM)FALSE, 0);
 	return TRUE;
 }
 
 /*
- * SaveConfirm - ύX̕ۑmF
+ * SaveConfirm - 変更の保存確認
  */
 static BOOL SaveConfirm(const HWND hWnd)
 {
@@ -851,7 +944,7 @@ static BOOL SaveConfirm(const HWND hWnd)
 }
 
 /*
- * SetEnableWindow - j[ڂ̎gp\ gps\ݒ
+ * SetEnableWindow - メニュー項目の使用可能､ 使用不能を設定
  */
 static void SetEnableWindow(const HWND hWnd)
 {
@@ -869,7 +962,7 @@ static void SetEnableWindow(const HWND hWnd)
 }
 
 /*
- * Resize - TCY
+ * Resize - リサイズ
  */
 static void Resize(const HWND hWnd)
 {
@@ -908,7 +1001,7 @@ static void Resize(const HWND hWnd)
 }
 
 /*
- * MainProc - CEBhEvV[W
+ * MainProc - メインウィンドウプロシージャ
  */
 static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
@@ -924,17 +1017,18 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		lstrcpy(window_title, APP_NAME);
 		ZeroMemory(&ed, sizeof(EXEC_DATA));
 		ed.stop_line = -1;
-		//IuWFNg
+		//同期オブジェクト
 		InitializeCriticalSection(&cs);
+		ed.step_event = CreateEvent(NULL, FALSE, FALSE, NULL);
 
-		// pbZ[W̓o^
+		// 検索用メッセージの登録
 		uFindMsg = RegisterWindowMessage(FINDMSGSTRING);
 		fr.lpstrFindWhat = NULL;
 
-		// c[o[
+		// ツールバー
 		toolbar_create(hInst, hWnd, IDR_TOOLBAR);
 
-		// EDIT쐬
+		// EDIT作成
 		hEdit = CreateWindowEx(WS_EX_CLIENTEDGE, NEDIT_WND_CLASS, TEXT(""),
 			WS_TABSTOP | WS_VISIBLE | WS_CHILD | WS_VSCROLL | WS_HSCROLL | ES_MULTILINE | ES_NOHIDESEL,
 			0, 0, 0, 0,
@@ -957,7 +1051,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		SetEnableWindow(hWnd);
 		hFocusWnd = hEdit;
 
-		// INIt@C
+		// INIファイル
 		if (SUCCEEDED(SHGetFolderPath(NULL, CSIDL_LOCAL_APPDATA | CSIDL_FLAG_CREATE, NULL, 0, ini_path))) {
 			lstrcat(ini_path, TEXT("\\pg0"));
 			CreateDirectory(ini_path, NULL);
@@ -965,7 +1059,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 			GetIni(hWnd, ini_path);
 		}
 
-		// R}hC
+		// コマンドライン
 		if (*cmd_line != TEXT('\0') && ReadScriptfile(hWnd, cmd_line) == TRUE) {
 			lstrcpy(file_path, cmd_line);
 			wsprintf(buf, TEXT("%s - [%s]"), window_title, file_path);
@@ -990,7 +1084,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		break;
 
 	case WM_LBUTTONDOWN:
-		// Ëړ
+		// 境界の移動
 		if (GetForegroundWindow() != hWnd) {
 			break;
 		}
@@ -1037,7 +1131,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 
 	case WM_TIMER:
 		switch (wParam) {
-		// Ëړ
+		// 境界の移動
 		case TIMER_SEP:
 			if (hWnd != GetForegroundWindow() || GetAsyncKeyState(VK_ESCAPE) < 0 || GetAsyncKeyState(VK_RBUTTON) < 0) {
 				SendMessage(hWnd, WM_LBUTTONUP, 0, 0);
@@ -1066,7 +1160,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		break;
 
 	case WM_EXITSIZEMOVE:
-		// TCYύX
+		// サイズ変更完了
 		if (IsWindowVisible(hWnd) != 0 && IsIconic(hWnd) == 0 && IsZoomed(hWnd) == 0) {
 			GetWindowRect(hWnd, (LPRECT)&op.window_rect);
 			op.window_rect.right -= op.window_rect.left;
@@ -1096,6 +1190,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		EnterCriticalSection(&cs);
 		ed.stop_flag = TRUE;
 		LeaveCriticalSection(&cs);
+		SetEvent(ed.step_event);
 
 		DestroyWindow(hEdit);
 		DestroyWindow(hVariableView);
@@ -1110,6 +1205,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		if (hThread != NULL) {
 			TerminateThread(hThread, 0);
 		}
+		CloseHandle(ed.step_event);
 		DeleteCriticalSection(&cs);
 		PostQuitMessage(0);
 		break;
@@ -1134,6 +1230,14 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		DragFinish((HANDLE)wParam);
 		break;
 
+	case WM_VIEW_NOTIFY_REFRESH:
+		// スクリプトスレッドで変数を再取得
+		if (ed.exec_flag == TRUE) {
+			InterlockedExchange(&ed.refresh_flag, TRUE);
+			SetEvent(ed.step_event);
+		}
+		break;
+
 	case WM_INITMENUPOPUP:
 		if (LOWORD(lParam) == 1) {
 			DWORD st = 0, en = 0;
@@ -1168,7 +1272,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 		break;
 
 	case WM_NOTIFY:
-		// c[o[
+		// ツールバー
 		if (((NMHDR *)lParam)->code == TTN_NEEDTEXT) {
 			((TOOLTIPTEXT*)lParam)->hinst = hInst;
 			((TOOLTIPTEXT*)lParam)->lpszText = MAKEINTRESOURCE(((NMHDR *)lParam)->idFrom);
@@ -1330,7 +1434,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 
 		case ID_MENUITEM_EXEC:
 			EnterCriticalSection(&cs);
-			ed.stop_line = -1;
+			SetStopLine(-1);
 			if (ed.exec_flag == TRUE) {
 				if (ed.step_flag == TRUE) {
 					ed.step_flag = FALSE;
@@ -1339,7 +1443,9 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 				if (ed.exec_speed == 0) {
 					SendMessage(hEdit, WM_SET_HIGHLIGHT_LINE, 0, (LPARAM)-1);
 				}
+				SetBreakMode();
 				LeaveCriticalSection(&cs);
+				SetEvent(ed.step_event);
 				break;
 			}
 			ed.step_flag = FALSE;
@@ -1349,7 +1455,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 
 		case ID_MENUITEM_STEP:
 			EnterCriticalSection(&cs);
-			ed.stop_line = -1;
+			SetStopLine(-1);
 			if (ed.exec_flag == TRUE) {
 				if (ed.step_flag == FALSE) {
 					ed.step_flag = TRUE;
@@ -1357,7 +1463,9 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 				} else {
 					ed.step_next_flag = TRUE;
 				}
+				SetBreakMode();
 				LeaveCriticalSection(&cs);
+				SetEvent(ed.step_event);
 				break;
 			}
 			ed.step_flag = TRUE;
@@ -1368,16 +1476,18 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 
 		case ID_MENUITEM_RUN_TO_CURSOR:
 			EnterCriticalSection(&cs);
-			ed.stop_line = (int)SendMessage(hEdit, EM_LINEFROMCHAR, (WPARAM)-1, 0);
+			SetStopLine((int)SendMessage(hEdit, EM_LINEFROMCHAR, (WPARAM)-1, 0));
 			if (ed.exec_flag == TRUE) {
 				if (ed.step_flag == TRUE) {
 					ed.step_flag = FALSE;
 					ed.step_next_flag = TRUE;
 				}
+				SetBreakMode();
 				LeaveCriticalSection(&cs);
+				SetEvent(ed.step_event);
 				break;
 			}
-			ed.step_flag = TRUE;
+			ed.step_flag = FALSE;
 			ed.step_next_flag = FALSE;
 			LeaveCriticalSection(&cs);
 			ExecScriptThread(hWnd);
@@ -1392,8 +1502,10 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 				}
 				SendMessage(hEdit, WM_SET_HIGHLIGHT_LINE, 0, (LPARAM)-1);
 				ed.exec_flag = FALSE;
+				exec_sci = NULL;
 				SetEnableWindow(hWnd);
 				LeaveCriticalSection(&cs);
+				SendMessage(hConsoleView, WM_VIEW_FLUSHTEXT, (WPARAM)TRUE, 0);
 				OutputTime(hConsoleView);
 				SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)TEXT(" \x03")TEXT("12"));
 				SendMessage(hConsoleView, WM_VIEW_ADDTEXT, 0, (LPARAM)GetResMessage(IDS_STRING_CONSOLE_STOP));
@@ -1403,7 +1515,23 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 			if (ed.step_flag == TRUE) {
 				ed.step_next_flag = TRUE;
 			}
+			SetBreakMode();
 			LeaveCriticalSection(&cs);
+			SetEvent(ed.step_event);
+			break;
+
+		case ID_MENUITEM_BREAKPOINT:
+			// ブレークポイントの設定/解除 (実行中は解析木にも反映)
+			{
+				int line = (int)SendMessage(hEdit, EM_LINEFROMCHAR, (WPARAM)-1, 0);
+				BOOL brk = (BOOL)SendMessage(hEdit, WM_TOGGLE_BREAK_LINE, (WPARAM)line, 0);
+
+				EnterCriticalSection(&cs);
+				if (exec_sci != NULL) {
+					SetBreakPoint(exec_sci, line, (brk == TRUE || ed.stop_line == line) ? TRUE : FALSE);
+				}
+				LeaveCriticalSection(&cs);
+			}
 			break;
 
 		case ID_MENUITEM_CLEAR:
@@ -1424,28 +1552,36 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 			if (ed.exec_flag == TRUE) {
 				SendMessage(hEdit, WM_SET_HIGHLIGHT_LINE, 0, (LPARAM)-1);
 			}
+			SetBreakMode();
 			LeaveCriticalSection(&cs);
+			SetEvent(ed.step_event);
 			break;
 
 		case ID_MENUITEM_SPEED_HIGH:
 			EnterCriticalSection(&cs);
 			ed.exec_speed = EXEC_SPEED_HIGH;
 			CheckMenuRadioItem(GetMenu(hWnd), ID_MENUITEM_NO_WAIT, ID_MENUITEM_SPEED_LOW, ID_MENUITEM_SPEED_HIGH, MF_BYCOMMAND);
+			SetBreakMode();
 			LeaveCriticalSection(&cs);
+			SetEvent(ed.step_event);
 			break;
 
 		case ID_MENUITEM_SPEED_MID:
 			EnterCriticalSection(&cs);
 			ed.exec_speed = EXEC_SPEED_MID;
 			CheckMenuRadioItem(GetMenu(hWnd), ID_MENUITEM_NO_WAIT, ID_MENUITEM_SPEED_LOW, ID_MENUITEM_SPEED_MID, MF_BYCOMMAND);
+			SetBreakMode();
 			LeaveCriticalSection(&cs);
+			SetEvent(ed.step_event);
 			break;
 
 		case ID_MENUITEM_SPEED_LOW:
 			EnterCriticalSection(&cs);
 			ed.exec_speed = EXEC_SPEED_LOW;
 			CheckMenuRadioItem(GetMenu(hWnd), ID_MENUITEM_NO_WAIT, ID_MENUITEM_SPEED_LOW, ID_MENUITEM_SPEED_LOW, MF_BYCOMMAND);
+			SetBreakMode();
 			LeaveCriticalSection(&cs);
+			SetEvent(ed.step_event);
 			break;
 
 		case ID_MENUITEM_TUTORIAL:
@@ -1456,7 +1592,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 
 				lang = PRIMARYLANGID(LANGIDFROMLCID(GetThreadLocale()));
 				if (lang == LANG_JAPANESE) {
-					// AvP[ṼpX擾
+					// アプリケーションのパスを取得
 					GetModuleFileName(hInst, app_path, MAX_PATH - 1);
 					for (p = r = app_path; *p != TEXT('\0'); p++) {
 #ifndef UNICODE
@@ -1481,7 +1617,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 			break;
 
 		case ID_MENUITEM_ABOUT:
-			// o[W
+			// バージョン情報
 			{
 				TCHAR var_msg[BUF_SIZE];
 				TCHAR path[MAX_PATH];
@@ -1495,7 +1631,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 					BYTE *buf = mem_alloc(size);
 					if (buf != NULL) {
 						GetFileVersionInfo(path, 0, size, buf);
-						VerQueryValue(buf, TEXT("\\"), &FileInfo, &len);
+						VerQueryValue(buf, TEXT("\\"), (LPVOID *)&FileInfo, &len);
 						wsprintf(var_msg + lstrlen(var_msg), TEXT(" Ver %d.%d.%d"),
 							HIWORD(FileInfo->dwFileVersionMS),
 							LOWORD(FileInfo->dwFileVersionMS),
@@ -1526,7 +1662,7 @@ static LRESULT CALLBACK MainProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPar
 }
 
 /*
- * InitApplication - EBhENX̓o^
+ * InitApplication - ウィンドウクラスの登録
  */
 static BOOL InitApplication(HINSTANCE hInstance)
 {
@@ -1542,18 +1678,18 @@ static BOOL InitApplication(HINSTANCE hInstance)
 	wc.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_ICON_MAIN));
 	wc.hbrBackground = (HBRUSH)COLOR_BTNSHADOW;
 	wc.lpszClassName = MAIN_WND_CLASS;
-	// EBhENX̓o^
+	// ウィンドウクラスの登録
 	return RegisterClass(&wc);
 }
 
 /*
- * InitInstance - EBhE̍쐬
+ * InitInstance - ウィンドウの作成
  */
 static HWND InitInstance(HINSTANCE hInstance, int CmdShow)
 {
 	HWND hWnd =  NULL;
 
-	// EBhE̍쐬
+	// ウィンドウの作成
 	hWnd = CreateWindowEx(WS_EX_ACCEPTFILES,
 		MAIN_WND_CLASS,
 		APP_NAME,
@@ -1567,14 +1703,14 @@ static HWND InitInstance(HINSTANCE hInstance, int CmdShow)
 		return NULL;
 	}
 
-	// EBhE̕\
+	// ウィンドウの表示
 	ShowWindow(hWnd, (op.window_state == SW_MAXIMIZE) ? SW_MAXIMIZE : CmdShow);
 	UpdateWindow(hWnd);
 	return hWnd;
 }
 
 /*
- * _tWinMain - C
+ * _tWinMain - メイン
  */
 int WINAPI _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdLine, int nCmdShow)
 {
@@ -1596,13 +1732,13 @@ int WINAPI _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdL
 		lstrcpy(cmd_line, lpCmdLine);
 	}
 
-	// DPȈ
+	// DPIの初期化
 	InitDpi();
 
-	// XNvg̏
+	// スクリプトの初期化
 	InitializeScript();
 
-	// EBhENX̓o^
+	// ウィンドウクラスの登録
 	if (RegisterNedit(hInstance) == FALSE) {
 		return 0;
 	}
@@ -1615,14 +1751,14 @@ int WINAPI _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdL
 	if (InitApplication(hInstance) == FALSE) {
 		return 0;
 	}
-	// EBhE̍쐬
+	// ウィンドウの作成
 	if ((hWnd = InitInstance(hInstance, nCmdShow)) == NULL) {
 		return 0;
 	}
 
-	// \[XANZ[^[h
+	// リソースからアクセラレータをロード
 	hAccel = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDR_ACCELERATOR));
-	// EBhEbZ[W
+	// ウィンドウメッセージ処理
 	while (GetMessage(&msg, NULL, 0, 0)) {
 		if (hFindWnd != NULL && IsDialogMessage(hFindWnd, &msg)) {
 			continue;
@@ -27,16 +27,17 @@
 #define RESERVE_INPUT					256
 #define RESERVE_LINE					256
 #define RESERVE_UNDO					256
+#define RESERVE_BREAK					16
 
 #define DRAW_LEN						256
 #define LINE_MAX						32768
 #define TAB_STOP						4
 
-// zC[bZ[W
+// ホイールメッセージ
 #ifndef WM_MOUSEWHEEL
 #define WM_MOUSEWHEEL					0x020A
 #endif
-// XPe[}ύXʒm
+// XPテーマ変更通知
 #ifndef WM_THEMECHANGED
 #define WM_THEMECHANGED					0x031A
 #endif
@@ -60,6 +61,7 @@
 #define COLOR_KEYWORD					RGB(0x00, 0x00, 0xff)
 #define COLOR_EXEC						RGB(0x80, 0xff, 0xff)
 #define COLOR_ERROR						RGB(0xff, 0xb6, 0xc1)
+#define COLOR_BREAK						RGB(0xff, 0xe0, 0x90)
 #define COLOR_STRING_D					RGB(0x80, 0x00, 0x00)
 #define COLOR_STRING_S					RGB(0x80, 0x01, 0x01)
 
@@ -102,6 +104,10 @@ static int line_get_count(BUFFER *bf, const int lindex);
 static int line_set_count(BUFFER *bf, const int lindex, const int old_cnt, const int line_cnt);
 static void line_refresh(const HWND hWnd, const BUFFER *bf, const DWORD p, const DWORD r);
 
+static int break_find(const BUFFER *bf, const int line);
+static BOOL break_toggle(BUFFER *bf, const int line);
+static void break_move(BUFFER *bf, const int line, const int cnt);
+
 static BOOL undo_alloc(BUFFER *bf);
 static void undo_free(BUFFER *bf, const int index);
 static BOOL undo_set(BUFFER *bf, const int type, const DWORD st, const DWORD len);
@@ -132,7 +138,7 @@ static void caret_move(const HWND hWnd, BUFFER *bf, const int key);
 static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM wParam, const LPARAM lParam);
 
 /*
- * string_to_clipboard - Nbv{[hɐݒ
+ * string_to_clipboard - 文字列をクリップボードに設定
  */
 static BOOL string_to_clipboard(const HWND hWnd, const TCHAR *st, const TCHAR *en)
 {
@@ -170,7 +176,7 @@ static BOOL string_to_clipboard(const HWND hWnd, const TCHAR *st, const TCHAR *e
 }
 
 /*
- * notify_message - eEBhEɒʒm
+ * notify_message - 親ウィンドウに通知
  */
 static void notify_message(const HWND hWnd, const BUFFER *bf, const int code)
 {
@@ -178,7 +184,7 @@ static void notify_message(const HWND hWnd, const BUFFER *bf, const int code)
 }
 
 /*
- * get_edit_rect - `̈̎擾
+ * get_edit_rect - 描画領域の取得
  */
 static BOOL get_edit_rect(const HWND hWnd, const BUFFER *bf, RECT *rect)
 {
@@ -194,7 +200,7 @@ static BOOL get_edit_rect(const HWND hWnd, const BUFFER *bf, RECT *rect)
 }
 
 /*
- * set_scrollbar - XN[o[̐ݒ
+ * set_scrollbar - スクロールバーの設定
  */
 static void set_scrollbar(const HWND hWnd, BUFFER *bf)
 {
@@ -203,7 +209,7 @@ static void set_scrollbar(const HWND hWnd, BUFFER *bf)
 
 	get_edit_rect(hWnd, bf, &rect);
 
-	// XN[o[
+	// 横スクロールバー
 	if (bf->wordwrap == FALSE && (rect.right - rect.left) < bf->line_width) {
 		int width = bf->line_width / bf->char_width + 1;
 
@@ -231,7 +237,7 @@ static void set_scrollbar(const HWND hWnd, BUFFER *bf)
 		SetScrollInfo(hWnd, SB_HORZ, &si, TRUE);
 	}
 
-	// cXN[o[
+	// 縦スクロールバー
 	if (((rect.bottom - rect.top) / bf->font_height) < bf->line_len) {
 		EnableScrollBar(hWnd, SB_VERT, ESB_ENABLE_BOTH);
 
@@ -259,7 +265,7 @@ static void set_scrollbar(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * show_line - ws\
+ * show_line - 指定行を表示
  */
 static void show_line(const HWND hWnd, BUFFER *bf, int line, BOOL begin_line)
 {
@@ -313,7 +319,7 @@ static void show_line(const HWND hWnd, BUFFER *bf, int line, BOOL begin_line)
 }
 
 /*
- * ensure_visible - Lbgʒu\
+ * ensure_visible - キャレット位置を表示
  */
 static void ensure_visible(const HWND hWnd, BUFFER *bf)
 {
@@ -321,7 +327,7 @@ static void ensure_visible(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * is_lead_byte - }`oCg̐擪oCg`FbN
+ * is_lead_byte - マルチバイトの先頭バイトかチェック
  */
 static BOOL is_lead_byte(const BUFFER *bf, TCHAR *p)
 {
@@ -332,7 +338,7 @@ static BOOL is_lead_byte(const BUFFER *bf, TCHAR *p)
 }
 
 /*
- * get_char_extent - ̕`敝̎擾
+ * get_char_extent - 文字の描画幅の取得
  */
 static int get_char_extent(BUFFER *bf, TCHAR *str, int *ret_len)
 {
@@ -366,7 +372,7 @@ static int get_char_extent(BUFFER *bf, TCHAR *str, int *ret_len)
 }
 
 /*
- * char_next - ̕擾
+ * char_next - 次の文字を取得
  */
 static TCHAR *char_next(const BUFFER *bf, TCHAR *p)
 {
@@ -385,7 +391,7 @@ static TCHAR *char_next(const BUFFER *bf, TCHAR *p)
 }
 
 /*
- * char_prev - O̕擾
+ * char_prev - 前の文字を取得
  */
 static TCHAR *char_prev(const BUFFER *bf, TCHAR *p)
 {
@@ -404,7 +410,7 @@ static TCHAR *char_prev(const BUFFER *bf, TCHAR *p)
 }
 
 /*
- * index_to_char - CfbNX當ʒu擾
+ * index_to_char - 文字インデックスから文字位置を取得
  */
 static TCHAR *index_to_char(const BUFFER *bf, const DWORD index)
 {
@@ -425,7 +431,7 @@ static TCHAR *index_to_char(const BUFFER *bf, const DWORD index)
 }
 
 /*
- * char_to_index - ʒu當CfbNX擾
+ * char_to_index - 文字位置から文字インデックスを取得
  */
 static DWORD char_to_index(const BUFFER *bf, const TCHAR *p)
 {
@@ -446,7 +452,7 @@ static DWORD char_to_index(const BUFFER *bf, const TCHAR *p)
 }
 
 /*
- * index_to_line - CfbNXsʒu擾
+ * index_to_line - 文字インデックスから行位置を取得
  */
 static int index_to_line(const BUFFER *bf, const DWORD index)
 {
@@ -475,7 +481,7 @@ static int index_to_line(const BUFFER *bf, const DWORD index)
 }
 
 /*
- * line_alloc - s̊m
+ * line_alloc - 行情報の確保
  */
 static BOOL line_alloc(BUFFER *bf, const int i, const int size)
 {
@@ -494,14 +500,14 @@ static BOOL line_alloc(BUFFER *bf, const int i, const int size)
 }
 
 /*
- * line_move - s̈ړ
+ * line_move - 行情報の移動
  */
 static BOOL line_move(BUFFER *bf, const int i, const int len)
 {
 	int *ln;
 
 	if (bf->line_len + len + 1 > bf->line_size) {
-		// ǉ
+		// 追加
 		bf->line_size = bf->line_len + len + 1 + RESERVE_LINE;
 		if ((ln = mem_alloc(sizeof(int) * bf->line_size)) == NULL) {
 			return FALSE;
@@ -516,7 +522,7 @@ static BOOL line_move(BUFFER *bf, const int i, const int len)
 	bf->line_len += len;
 
 	if (bf->line_len + 1 < bf->line_size - RESERVE_LINE) {
-		// 
+		// 解放
 		bf->line_size = bf->line_len + 1 + RESERVE_LINE;
 		if ((ln = mem_alloc(sizeof(int) * bf->line_size)) == NULL) {
 			return FALSE;
@@ -529,7 +535,7 @@ static BOOL line_move(BUFFER *bf, const int i, const int len)
 }
 
 /*
- * line_get - sCfbNX̎擾
+ * line_get - 行頭インデックスの取得
  */
 static DWORD line_get(const BUFFER *bf, const int lindex)
 {
@@ -540,7 +546,7 @@ static DWORD line_get(const BUFFER *bf, const int lindex)
 }
 
 /*
- * line_set - sCfbNXݒ
+ * line_set - 行頭インデックスを設定
  */
 static void line_set(BUFFER *bf, const int lindex, const DWORD len)
 {
@@ -552,7 +558,7 @@ static void line_set(BUFFER *bf, const int lindex, const DWORD len)
 }
 
 /*
- * line_flush - s̔f
+ * line_flush - 行情報の反映
  */
 static void line_flush(BUFFER *bf)
 {
@@ -566,7 +572,7 @@ static void line_flush(BUFFER *bf)
 }
 
 /*
- * line_add_length - sɕǉ
+ * line_add_length - 行情報に文字数を追加
  */
 static void line_add_length(BUFFER *bf, const int index, const int len)
 {
@@ -582,7 +588,7 @@ static void line_add_length(BUFFER *bf, const int index, const int len)
 }
 
 /*
- * line_get_length - s̒擾
+ * line_get_length - 行の長さを取得
  */
 static int line_get_length(const BUFFER *bf, const DWORD index)
 {
@@ -596,7 +602,7 @@ static int line_get_length(const BUFFER *bf, const DWORD index)
 }
 
 /*
- * line_get_next_index - ̍s̕CfbNX擾
+ * line_get_next_index - 次の行頭の文字インデックスを取得
  */
 static DWORD line_get_next_index(BUFFER *bf, const DWORD index)
 {
@@ -636,7 +642,7 @@ static DWORD line_get_next_index(BUFFER *bf, const DWORD index)
 			}
 			if ((bf->wordwrap == TRUE && offset + tab > line_size) ||
 				(bf->line_max > 0 && cnt + bf->tab_stop - (cnt % bf->tab_stop) > bf->line_max)) {
-				// ܂Ԃ
+				// 折り返し
 				if (bf->line_width < offset + bf->right_margin) {
 					bf->line_width = offset + bf->right_margin;
 				}
@@ -661,7 +667,7 @@ static DWORD line_get_next_index(BUFFER *bf, const DWORD index)
 			}
 			if ((bf->wordwrap == TRUE && offset + width > line_size) ||
 				(bf->line_max > 0 && cnt + 1 > bf->line_max)) {
-				// ܂Ԃ
+				// 折り返し
 				if (bf->line_width < offset + bf->right_margin) {
 					bf->line_width = offset + bf->right_margin;
 				}
@@ -680,7 +686,7 @@ static DWORD line_get_next_index(BUFFER *bf, const DWORD index)
 			}
 			else if (*p != TEXT(' ')) {
 				if (word == (DWORD)-1) {
-					// P̊Jnʒu
+					// 単語の開始位置
 					word = i;
 				}
 			}
@@ -697,7 +703,7 @@ static DWORD line_get_next_index(BUFFER *bf, const DWORD index)
 }
 
 /*
- * line_set_info - s̐ݒ
+ * line_set_info - 行情報の設定
  */
 static BOOL line_set_info(const HWND hWnd, BUFFER *bf)
 {
@@ -709,7 +715,7 @@ static BOOL line_set_info(const HWND hWnd, BUFFER *bf)
 		switch (*index_to_char(bf, index)) {
 		case TEXT('\r'):
 		case TEXT('\n'):
-			// s̃CfbNXݒ
+			// 行頭のインデックスを設定
 			line_set(bf, i, index + 1);
 			if (++i >= bf->line_size && line_alloc(bf, i, BUF_LEN / 30) == FALSE) {
 				return FALSE;
@@ -718,7 +724,7 @@ static BOOL line_set_info(const HWND hWnd, BUFFER *bf)
 			break;
 
 		default:
-			// s̃CfbNXݒ (܂Ԃ)
+			// 行頭のインデックスを設定 (折り返し)
 			line_set(bf, i, index);
 			if (++i >= bf->line_size && line_alloc(bf, i, BUF_LEN / 30) == FALSE) {
 				return FALSE;
@@ -747,7 +753,7 @@ static BOOL line_set_info(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * line_get_count - _s̎擾
+ * line_get_count - 論理行数の取得
  */
 static int line_get_count(BUFFER *bf, const int lindex)
 {
@@ -757,7 +763,7 @@ static int line_get_count(BUFFER *bf, const int lindex)
 	for (i = lindex + 1; i < bf->line_len; i++) {
 		p = index_to_char(bf, line_get(bf, i) - 1);
 		if (*p == TEXT('\r') || *p == TEXT('\n')) {
-			// _s̏I[
+			// 論理行の終端
 			break;
 		}
 	}
@@ -765,7 +771,7 @@ static int line_get_count(BUFFER *bf, const int lindex)
 }
 
 /*
- * line_set_count - s̐ݒ
+ * line_set_count - 行情報の設定
  */
 static int line_set_count(BUFFER *bf, const int lindex, const int old_cnt, const int line_cnt)
 {
@@ -778,19 +784,19 @@ static int line_set_count(BUFFER *bf, const int lindex, const int old_cnt, const
 	while (1) {
 		index = line_get_next_index(bf, index);
 		if ((i - lindex) >= old_cnt) {
-			// }sړ
+			// 挿入行を移動
 			line_move(bf, i, 1);
 		}
 		p = index_to_char(bf, index);
 		if (*p == TEXT('\r') || *p == TEXT('\n')) {
-			// s̃CfbNXݒ
+			// 行頭のインデックスを設定
 			index++;
 			line_set(bf, i++, index);
 			if (++rcnt >= line_cnt) {
 				break;
 			}
 		} else {
-			// s̃CfbNXݒ (܂Ԃ)
+			// 行頭のインデックスを設定 (折り返し)
 			line_set(bf, i++, index);
 			if (index >= BUF_LEN) {
 				break;
@@ -799,21 +805,21 @@ static int line_set_count(BUFFER *bf, const int lindex, const int old_cnt, const
 	}
 
 	if ((i - lindex) < old_cnt) {
-		// s̍폜
+		// 行情報の削除
 		line_move(bf, i + old_cnt - (i - lindex), -(old_cnt - (i - lindex)));
 	}
 	return (i - lindex);
 }
 
 /*
- * line_refresh - ŵ͈͕sĕ`Ώۂɂ
+ * line_refresh - 指定範囲文字列のある行を再描画対象にする
  */
 static void line_refresh(const HWND hWnd, const BUFFER *bf, const DWORD p, const DWORD r)
 {
 	RECT rect;
 	int i, j;
 
-	// ʒus̃CfbNX擾
+	// 文字位置から行のインデックスを取得
 	i = index_to_line(bf, p);
 	if (p == r) {
 		j = i;
@@ -826,7 +832,7 @@ static void line_refresh(const HWND hWnd, const BUFFER *bf, const DWORD p, const
 	i -= bf->pos_y;
 	j -= bf->pos_y;
 
-	// ĕ`
+	// 再描画
 	get_edit_rect(hWnd, bf, &rect);
 	rect.left -= bf->line_no_width;
 	if (i * bf->font_height > (rect.bottom - rect.top) || j * bf->font_height + bf->font_height < 0) {
@@ -842,7 +848,83 @@ static void line_refresh(const HWND hWnd, const BUFFER *bf, const DWORD p, const
 }
 
 /*
- * undo_alloc - UNDO̊m
+ * break_find - ブレークポイントの行の挿入位置を取得
+ */
+static int break_find(const BUFFER *bf, const int line)
+{
+	int low = 0;
+	int high = bf->break_count;
+	int i;
+
+	while (low < high) {
+		i = (low + high) / 2;
+		if (*(bf->break_line + i) < line) {
+			low = i + 1;
+		} else {
+			high = i;
+		}
+	}
+	return low;
+}
+
+/*
+ * break_toggle - ブレークポイントの設定と解除
+ *
+ *	設定した場合は TRUE、解除した場合は FALSE を返す
+ */
+static BOOL break_toggle(BUFFER *bf, const int line)
+{
+	int *p;
+	int i;
+
+	i = break_find(bf, line);
+	if (i < bf->break_count && *(bf->break_line + i) == line) {
+		// 解除
+		MoveMemory(bf->break_line + i, bf->break_line + i + 1, sizeof(int) * (bf->break_count - i - 1));
+		bf->break_count--;
+		return FALSE;
+	}
+	if (bf->break_count + 1 > bf->break_size) {
+		if ((p = mem_alloc(sizeof(int) * (bf->break_size + RESERVE_BREAK))) == NULL) {
+			return FALSE;
+		}
+		bf->break_size += RESERVE_BREAK;
+		if (bf->break_line != NULL) {
+			CopyMemory(p, bf->break_line, sizeof(int) * bf->break_count);
+			mem_free(&bf->break_line);
+		}
+		bf->break_line = p;
+	}
+	// 設定
+	MoveMemory(bf->break_line + i + 1, bf->break_line + i, sizeof(int) * (bf->break_count - i));
+	*(bf->break_line + i) = line;
+	bf->break_count++;
+	return TRUE;
+}
+
+/*
+ * break_move - 行の追加と削除に合わせてブレークポイントの行を移動
+ *
+ *	cnt が負の場合は line から -cnt 行を削除する
+ */
+static void break_move(BUFFER *bf, const int line, const int cnt)
+{
+	int i, j;
+
+	i = break_find(bf, line);
+	if (cnt < 0) {
+		// 削除した行のブレークポイントを解除
+		j = break_find(bf, line - cnt);
+		MoveMemory(bf->break_line + i, bf->break_line + j, sizeof(int) * (bf->break_count - j));
+		bf->break_count -= j - i;
+	}
+	for (; i < bf->break_count; i++) {
+		*(bf->break_line + i) += cnt;
+	}
+}
+
+/*
+ * undo_alloc - UNDOの確保
  */
 static BOOL undo_alloc(BUFFER *bf)
 {
@@ -861,7 +943,7 @@ static BOOL undo_alloc(BUFFER *bf)
 }
 
 /*
- * undo_free - UNDỎ
+ * undo_free - UNDOの解放
  */
 static void undo_free(BUFFER *bf, const int index)
 {
@@ -874,7 +956,7 @@ static void undo_free(BUFFER *bf, const int index)
 }
 
 /*
- * undo_set - UNDÕZbg
+ * undo_set - UNDOのセット
  */
 static BOOL undo_set(BUFFER *bf, const int type, const DWORD index, const DWORD len)
 {
@@ -887,11 +969,11 @@ static BOOL undo_set(BUFFER *bf, const int type, const DWORD index, const DWORD
 	(bf->undo + bf->undo_len)->len = len;
 	switch (type) {
 	case UNDO_TYPE_INPUT:
-		// 
+		// 入力
 		break;
 
 	case UNDO_TYPE_DELETE:
-		// 폜
+		// 削除
 		if (((bf->undo + bf->undo_len)->buf = mem_alloc(sizeof(TCHAR) * len)) == NULL) {
 			return FALSE;
 		}
@@ -903,7 +985,7 @@ static BOOL undo_set(BUFFER *bf, const int type, const DWORD index, const DWORD
 }
 
 /*
- * undo_exec - UNDO̎s
+ * undo_exec - UNDOの実行
  */
 static BOOL undo_exec(const HWND hWnd, BUFFER *bf)
 {
@@ -945,7 +1027,7 @@ static BOOL undo_exec(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * redo_exec - REDO̎s
+ * redo_exec - REDOの実行
  */
 static BOOL redo_exec(const HWND hWnd, BUFFER *bf)
 {
@@ -981,7 +1063,7 @@ static BOOL redo_exec(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * string_init - 
+ * string_init - 初期化
  */
 static BOOL string_init(BUFFER *bf)
 {
@@ -1027,7 +1109,7 @@ static BOOL string_init(BUFFER *bf)
 }
 
 /*
- * string_set - ̐ݒ
+ * string_set - 文字列の設定
  */
 static BOOL string_set(const HWND hWnd, BUFFER *bf, const TCHAR *str, const DWORD len)
 {
@@ -1040,7 +1122,7 @@ static BOOL string_set(const HWND hWnd, BUFFER *bf, const TCHAR *str, const DWOR
 		return FALSE;
 	}
 
-	// ݒ
+	// 文字列設定
 	mem_free(&bf->buf);
 	bf->buf_len = len;
 	bf->buf_size = bf->buf_len + 1 + RESERVE_BUF;
@@ -1050,17 +1132,18 @@ static BOOL string_set(const HWND hWnd, BUFFER *bf, const TCHAR *str, const DWOR
 	}
 	CopyMemory(bf->buf, str, sizeof(TCHAR) * (bf->buf_len + 1));
 	if (bf->lowercase == TRUE) {
-		// ɕϊ
+		// 小文字に変換
 		CharLowerBuff(bf->buf, bf->buf_len);
 	} else if (bf->uppercase == TRUE) {
-		// 啶ɕϊ
+		// 大文字に変換
 		CharUpperBuff(bf->buf, bf->buf_len);
 	}
 
-	// s̐ݒ
+	// 行情報の設定
 	line_set_info(hWnd, bf);
 	set_scrollbar(hWnd, bf);
 	bf->error_line = -1;
+	bf->break_count = 0;
 	InvalidateRect(hWnd, NULL, FALSE);
 
 	SetCursor(old_cursor);
@@ -1068,7 +1151,7 @@ static BOOL string_set(const HWND hWnd, BUFFER *bf, const TCHAR *str, const DWOR
 }
 
 /*
- * string_insert - ̒ǉ
+ * string_insert - 文字列の追加
  */
 static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len, const BOOL insert_mode)
 {
@@ -1082,7 +1165,7 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 	int old_pos_x;
 	BOOL sel = FALSE;
 
-	// ͐ (}[h)
+	// 入力制限 (挿入モード)
 	if ((insert_mode == TRUE || (bf->cp != bf->sp)) && bf->limit_len != 0 && 
 		(BUF_LEN - ((bf->cp > bf->sp) ? bf->cp - bf->sp : bf->sp - bf->cp)) + ilen > bf->limit_len) {
 		i = bf->limit_len - (BUF_LEN - ((bf->cp > bf->sp) ? bf->cp - bf->sp : bf->sp - bf->cp));
@@ -1095,14 +1178,14 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 				ilen++;
 			}
 		}
-		// eEBhEɒʒm
+		// 親ウィンドウに通知
 		notify_message(hWnd, bf, EN_MAXTEXT);
 		if (ilen <= 0) {
 			return FALSE;
 		}
 	}
 	if (bf->cp != bf->sp) {
-		// I𕶎̍폜
+		// 選択文字の削除
 		string_delete(hWnd, bf, bf->cp, bf->sp);
 		if (bf->cp > bf->sp) {
 			SWAP(bf->cp, bf->sp);
@@ -1113,11 +1196,11 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 	if (bf->dp != NULL) {
 		string_flush(bf, TRUE);
 	}
-	// ͐ (㏑[h)
+	// 入力制限 (上書きモード)
 	if (insert_mode == FALSE && sel == FALSE && bf->limit_len != 0) {
 		for (i = bf->cp, p = str; i - (int)bf->cp < ilen && (p - str) < ilen; i++, p++){
 			if ((DWORD)i >= BUF_LEN || *index_to_char(bf, i) == TEXT('\r') || *index_to_char(bf, i) == TEXT('\n')) {
-				// ƍs̏ꍇ͈ȍ~}[hƓ
+				// 文末と行末の場合は以降を挿入モードと同じ動作
 				if (BUF_LEN + ilen > bf->limit_len) {
 					i = bf->limit_len - BUF_LEN;
 					for (ilen = (p - str); ilen < i; ilen++) {
@@ -1134,10 +1217,10 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 			}
 			if (IS_LEAD_TBYTE((TBYTE)*p) == TRUE && (int)(p - str) < ilen) {
 				if (is_lead_byte(bf, index_to_char(bf, i)) == TRUE) {
-					// 2oCgR[h2oCg̏㏑
+					// 2バイトコードに2バイトの上書き
 					i++;
 				} else if ((BUF_LEN - (i - bf->cp)) + (p - str) + 1 > bf->limit_len) {
-					// 1oCgR[h2oCg㏑Đ𒴂ꍇ͈ȍ~؎̂
+					// 1バイトコードに2バイトを上書きして制限を超える場合は以降を切捨て
 					ilen = p - str;
 					break;
 				}
@@ -1145,7 +1228,7 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 			}
 		}
 		if (ilen != len) {
-			// eEBhEɒʒm
+			// 親ウィンドウに通知
 			notify_message(hWnd, bf, EN_MAXTEXT);
 		}
 		if (ilen <= 0) {
@@ -1153,7 +1236,7 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 		}
 	}
 
-	// s̎擾
+	// 改行数の取得
 	for (p = str; (p - str) < ilen; p++) {
 		if (*p == TEXT('\r') || *p == TEXT('\n')) {
 			if (*p == TEXT('\r') && *(p + 1) == TEXT('\n')) {
@@ -1162,10 +1245,16 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 			ret_cnt++;
 		}
 	}
-	// ǉO̕\s
+	if (ret_cnt > 0 && bf->break_count > 0) {
+		// 行頭への挿入は挿入位置の行から移動
+		st = (bf->ip == NULL) ? bf->cp : ((bf->ip - bf->buf) + bf->input_len);
+		i = index_to_line(bf, st);
+		break_move(bf, (line_get(bf, i) == (DWORD)st) ? i : i + 1, ret_cnt);
+	}
+	// 追加前の表示行数
 	lcnt1 = line_get_count(bf, index_to_line(bf, (bf->ip == NULL) ? bf->cp : ((bf->ip - bf->buf) + bf->input_len)));
 
-	// ̓obt@̐ݒ
+	// 入力バッファの設定
 	if (bf->input_len + ilen + 1 > bf->input_size) {
 		bf->input_size = bf->input_len + ilen + 1 + RESERVE_INPUT;
 		if ((p = mem_alloc(sizeof(TCHAR) * bf->input_size)) == NULL) {
@@ -1177,10 +1266,10 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 	}
 	CopyMemory(bf->input_buf + bf->input_len, str, sizeof(TCHAR) * ilen);
 	if (bf->lowercase == TRUE) {
-		// ɕϊ
+		// 小文字に変換
 		CharLowerBuff(bf->input_buf + bf->input_len, ilen);
 	} else if (bf->uppercase == TRUE) {
-		// 啶ɕϊ
+		// 大文字に変換
 		CharUpperBuff(bf->input_buf + bf->input_len, ilen);
 	}
 	bf->input_len += ilen;
@@ -1190,7 +1279,7 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 	bf->cp += ilen;
 	bf->sp = bf->cp;
 
-	// ㏑[h
+	// 上書きモード
 	for (p = str, ip_len = 0; sel == FALSE && insert_mode == FALSE && (p - str) < ilen; p++, ip_len++) {
 		if (char_to_index(bf, bf->ip + bf->ip_len + ip_len) >= BUF_LEN ||
 			*(bf->ip + bf->ip_len + ip_len) == TEXT('\r') || *(bf->ip + bf->ip_len + ip_len) == TEXT('\n')) {
@@ -1205,27 +1294,27 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 	}
 	bf->ip_len += ip_len;
 
-	// s̐ݒ
+	// 行情報の設定
 	st = (bf->ip - bf->buf) + (bf->input_len - ilen);
 	i = index_to_line(bf, st) + 1;
 	lcnt2 = (ret_cnt > 0) ? line_set_count(bf, i, 0, ret_cnt) : 0;
 	lcnt2 += line_set_count(bf, i + lcnt2, lcnt1, 0);
 	line_add_length(bf, i + lcnt2, ilen - ip_len);
 
-	// eEBhEɒʒm
+	// 親ウィンドウに通知
 	notify_message(hWnd, bf, EN_UPDATE);
 
 	if (lcnt1 > lcnt2) {
-		// s
+		// 行数減少
 		InvalidateRect(hWnd, NULL, FALSE);
 	} else if (ret_cnt > 0 || lcnt1 != lcnt2) {
-		// s
+		// 複数行
 		line_refresh(hWnd, bf, line_get(bf, i - 1), bf->buf_len + bf->input_len);
 	} else if (lcnt2 > 1) {
-		// ܂Ԃ܂߂Ĕf
+		// 折り返しを含めて反映
 		line_refresh(hWnd, bf, line_get(bf, i - 1), line_get(bf, i + lcnt2 - 2));
 	} else {
-		// Ps
+		// 単一行
 		line_refresh(hWnd, bf, st, st);
 	}
 	old_pos_x = bf->pos_x;
@@ -1241,7 +1330,7 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 		bf->undo_pos = bf->undo_len;
 	}
 	bf->modified = TRUE;
-	// eEBhEɒʒm
+	// 親ウィンドウに通知
 	notify_message(hWnd, bf, EN_CHANGE);
 
 	if (bf->error_line != -1) {
@@ -1253,7 +1342,7 @@ static BOOL string_insert(const HWND hWnd, BUFFER *bf, TCHAR *str, const int len
 }
 
 /*
- * string_delete - ̍폜
+ * string_delete - 文字列の削除
  */
 static void string_delete(const HWND hWnd, BUFFER *bf, DWORD st, DWORD en)
 {
@@ -1271,15 +1360,20 @@ static void string_delete(const HWND hWnd, BUFFER *bf, DWORD st, DWORD en)
 		return;
 	}
 
-	// s擾
+	// 行数取得
 	ret_cnt = index_to_line(bf, en) - index_to_line(bf, st);
 	lcnt1 = line_get_count(bf, index_to_line(bf, en));
+	if (ret_cnt > 0 && bf->break_count > 0) {
+		// 行頭からの削除は削除位置の行から移動
+		i = index_to_line(bf, st);
+		break_move(bf, (line_get(bf, i) == st) ? i : i + 1, -ret_cnt);
+	}
 
-	// 폜ʒuݒ
+	// 削除位置設定
 	bf->dp = bf->buf + st;
 	bf->del_len += en - st;
 
-	// s̐ݒ
+	// 行情報の設定
 	i = index_to_line(bf, st) + 1;
 	if (ret_cnt > 0) {
 		line_move(bf, i + ret_cnt, -ret_cnt);
@@ -1287,24 +1381,24 @@ static void string_delete(const HWND hWnd, BUFFER *bf, DWORD st, DWORD en)
 	lcnt2 = line_set_count(bf, i, lcnt1, 0);
 	line_add_length(bf, i + lcnt2, st - en);
 
-	// eEBhEɒʒm
+	// 親ウィンドウに通知
 	notify_message(hWnd, bf, EN_UPDATE);
 
 	if (ret_cnt > 0 || lcnt1 != lcnt2) {
-		// s
+		// 複数行
 		InvalidateRect(hWnd, NULL, FALSE);
 	} else if (lcnt2 > 1) {
-		// ܂Ԃ܂߂Ĕf
+		// 折り返しを含めて反映
 		line_refresh(hWnd, bf, line_get(bf, i - 1), line_get(bf, i + lcnt2 - 2));
 	} else {
-		// Ps
+		// 単一行
 		line_refresh(hWnd, bf, st, en);
 	}
 	if (bf->modified == FALSE) {
 		bf->undo_pos = bf->undo_len;
 	}
 	bf->modified = TRUE;
-	// eEBhEɒʒm
+	// 親ウィンドウに通知
 	notify_message(hWnd, bf, EN_CHANGE);
 
 	if (bf->error_line != -1) {
@@ -1315,7 +1409,7 @@ static void string_delete(const HWND hWnd, BUFFER *bf, DWORD st, DWORD en)
 }
 
 /*
- * string_delete_char - ̍폜
+ * string_delete_char - 文字の削除
  */
 static void string_delete_char(const HWND hWnd, BUFFER *bf, DWORD st)
 {
@@ -1323,14 +1417,14 @@ static void string_delete_char(const HWND hWnd, BUFFER *bf, DWORD st)
 	int i = 1;
 
 	if (bf->cp != bf->sp) {
-		// I𕶎̍폜
+		// 選択文字の削除
 		string_delete(hWnd, bf, bf->cp, bf->sp);
 		if (bf->cp > bf->sp) {
 			SWAP(bf->cp, bf->sp);
 		}
 		bf->sp = bf->cp;
 	} else {
-		// ꕶ폜
+		// 一文字削除
 		if (is_lead_byte(bf, index_to_char(bf, st)) == TRUE) {
 			i++;
 		}
@@ -1350,7 +1444,7 @@ static void string_delete_char(const HWND hWnd, BUFFER *bf, DWORD st)
 }
 
 /*
- * string_flush - 폜Ɠ̓obt@̔f
+ * string_flush - 削除と入力バッファの反映
  */
 static BOOL string_flush(BUFFER *bf, const BOOL undo_flag)
 {
@@ -1358,11 +1452,11 @@ static BOOL string_flush(BUFFER *bf, const BOOL undo_flag)
 
 	if (bf->dp != NULL) {
 		if (undo_flag == TRUE) {
-			// undoɒǉ
+			// undoに追加
 			undo_set(bf, UNDO_TYPE_DELETE, bf->dp - bf->buf, bf->del_len);
 		}
 
-		// 폜̔f
+		// 削除文字列の反映
 		MoveMemory(bf->dp, bf->dp + bf->del_len, sizeof(TCHAR) * (bf->buf_len - (bf->dp - bf->buf + bf->del_len) + 1));
 		bf->buf_len -= bf->del_len;
 		bf->dp = NULL;
@@ -1378,7 +1472,7 @@ static BOOL string_flush(BUFFER *bf, const BOOL undo_flag)
 			mem_free(&bf->buf);
 			bf->buf = p;
 		}
-		// s̔f
+		// 行情報の反映
 		line_flush(bf);
 		return TRUE;
 	}
@@ -1387,14 +1481,14 @@ static BOOL string_flush(BUFFER *bf, const BOOL undo_flag)
 	}
 
 	if (undo_flag == TRUE) {
-		// undoɒǉ
+		// undoに追加
 		if (bf->ip_len > 0) {
 			undo_set(bf, UNDO_TYPE_DELETE, bf->ip - bf->buf, bf->ip_len);
 		}
 		undo_set(bf, UNDO_TYPE_INPUT, bf->ip - bf->buf, bf->input_len);
 	}
 
-	// ̓obt@̔f
+	// 入力バッファの反映
 	if (bf->buf_len + bf->input_len - bf->ip_len + 1 > bf->buf_size) {
 		bf->buf_size = bf->buf_len + bf->input_len - bf->ip_len + 1 + RESERVE_BUF;
 		if ((p = mem_alloc(sizeof(TCHAR) * bf->buf_size)) == NULL) {
@@ -1413,7 +1507,7 @@ static BOOL string_flush(BUFFER *bf, const BOOL undo_flag)
 	}
 	bf->buf_len += bf->input_len - bf->ip_len;
 
-	// ̓obt@̉
+	// 入力バッファの解放
 	if (bf->input_size > RESERVE_INPUT) {
 		mem_free(&bf->input_buf);
 		bf->input_size = RESERVE_INPUT;
@@ -1426,13 +1520,13 @@ static BOOL string_flush(BUFFER *bf, const BOOL undo_flag)
 	bf->ip = NULL;
 	bf->ip_len = 0;
 
-	// s̔f
+	// 行情報の反映
 	line_flush(bf);
 	return TRUE;
 }
 
 /*
- * set_select_indent - Is̃CfgύX
+ * set_select_indent - 選択行のインデントを変更
  */
 static void set_select_indent(const HWND hWnd, BUFFER *bf)
 {
@@ -1445,7 +1539,7 @@ static void set_select_indent(const HWND hWnd, BUFFER *bf)
 
 	string_flush(bf, TRUE);
 
-	// I͈͂̊g
+	// 選択範囲の拡張
 	first = line_get(bf, index_to_line(bf, st));
 	r = index_to_char(bf, en - 1);
 	if (*r != TEXT('\r') && *r != TEXT('\n')) {
@@ -1466,7 +1560,7 @@ static void set_select_indent(const HWND hWnd, BUFFER *bf)
 	enc = index_to_char(bf, en);
 	int ret_cnt = 0;
 	if (GetKeyState(VK_SHIFT) >= 0) {
-		// sJEg
+		// 行数カウント
 		for (p = stc; p < enc; p++) {
 			if (*p == TEXT('\r') || *p == TEXT('\n')) {
 				if (*p == TEXT('\r') && *(p + 1) == TEXT('\n')) {
@@ -1476,7 +1570,7 @@ static void set_select_indent(const HWND hWnd, BUFFER *bf)
 			}
 		}
 	}
-	// Is̃CfgύX
+	// 選択行のインデントを変更
 	buf = mem_alloc(sizeof(TCHAR) * (enc - stc + ret_cnt + 1));
 	if (buf == NULL) {
 		return;
@@ -1521,14 +1615,14 @@ static void set_select_indent(const HWND hWnd, BUFFER *bf)
 	string_insert(hWnd, bf, buf, lstrlen(buf), TRUE);
 	mem_free(&buf);
 
-	// I͈͂̍Đݒ
+	// 選択範囲の再設定
 	bf->sp = first;
 	bf->cp = en;
 	InvalidateRect(hWnd, NULL, FALSE);
 }
 
 /*
- * draw_init - `̏
+ * draw_init - 描画情報の初期化
  */
 static BOOL draw_init(const HWND hWnd, BUFFER *bf)
 {
@@ -1546,14 +1640,14 @@ static BOOL draw_init(const HWND hWnd, BUFFER *bf)
 	bf->ret_bmp = SelectObject(bf->mdc, hBmp);
 	ReleaseDC(hWnd, hdc);
 
-	// [W̍쐬
+	// リージョンの作成
 	hrgn[0] = CreateRectRgnIndirect(&rect);
 	bf->hrgn = CreateRectRgnIndirect(&rect);
-	// 郊[W̍쐬
+	// 除去するリージョンの作成
 	get_edit_rect(hWnd, bf, &rect);
 	rect.left -= bf->line_no_width;
 	hrgn[1] = CreateRectRgnIndirect(&rect);
-	// [W̌
+	// リージョンの結合
 	CombineRgn(bf->hrgn, hrgn[0], hrgn[1], RGN_DIFF);
 	DeleteObject(hrgn[0]);
 	DeleteObject(hrgn[1]);
@@ -1561,7 +1655,7 @@ static BOOL draw_init(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * draw_free - `̉
+ * draw_free - 描画情報の解放
  */
 static void draw_free(BUFFER *bf)
 {
@@ -1574,7 +1668,7 @@ static void draw_free(BUFFER *bf)
 }
 
 /*
- * draw_rect - wi`
+ * draw_rect - 背景描画
  */
 static void draw_rect_color(const HWND hWnd, const HDC mdc, const BUFFER *bf, const int left, const int top, const int right, const int bottom, COLORREF color)
 {
@@ -1592,7 +1686,7 @@ static void draw_rect_color(const HWND hWnd, const HDC mdc, const BUFFER *bf, co
 }
 
 /*
- * draw_rect - ``
+ * draw_rect - 矩形描画
  */
 static void draw_rect(const HWND hWnd, const HDC mdc, const BUFFER *bf, const int left, const int top, const int right, const int bottom)
 {
@@ -1617,7 +1711,7 @@ static void draw_rect(const HWND hWnd, const HDC mdc, const BUFFER *bf, const in
 }
 
 /*
- * draw_string - `
+ * draw_string - 文字列描画
  */
 static int draw_string(const HWND hWnd, const HDC mdc, const BUFFER *bf, const RECT *drect, const int left, const int top, const TCHAR *str, const int len, const BOOL sel)
 {
@@ -1642,7 +1736,7 @@ static int draw_string(const HWND hWnd, const HDC mdc, const BUFFER *bf, const R
 }
 
 /*
- * str_cmp_ni - Q̕啶AʂȂŔrs
+ * str_cmp_ni - ２つの文字列を大文字、小文字を区別しないで比較を行う
  */
 static int str_cmp_ni(const TCHAR *buf1, const TCHAR *buf2, const int len)
 {
@@ -1660,7 +1754,7 @@ static int check_word(const TCHAR *p, const TCHAR *word) {
 }
 
 /*
- * show_line_no - sԍ̕`
+ * show_line_no - 行番号の描画
  */
 static void show_line_no(const HDC mdc, BUFFER* bf, int line, const RECT* drect) {
 	HBRUSH hBrush = CreateSolidBrush(GetSysColor(COLOR_WINDOW));
@@ -1686,7 +1780,7 @@ static void show_line_no(const HDC mdc, BUFFER* bf, int line, const RECT* drect)
 }
 
 /*
- * draw_line - 1s`
+ * draw_line - 1行描画
  */
 static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, const int left, const int right)
 {
@@ -1711,6 +1805,12 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 	cur_color = GetSysColor(COLOR_WINDOWTEXT);
 	SetTextColor(mdc, cur_color);
 
+	if (bf->break_count > 0) {
+		j = break_find(bf, i);
+		if (j < (DWORD)bf->break_count && *(bf->break_line + j) == i) {
+			draw_rect_color(hWnd, mdc, bf, drect.left, drect.top, width, drect.bottom, COLOR_BREAK);
+		}
+	}
 	if (bf->hightlight_line == i) {
 		draw_rect_color(hWnd, mdc, bf, drect.left, drect.top, width, drect.bottom, COLOR_EXEC);
 	}
@@ -1720,7 +1820,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 	for (j = line_get(bf, i), s = p = index_to_char(bf, line_get(bf, i)); j < line_get(bf, i + 1) && offset <= width; j++, p = char_next(bf, p)) {
 		if (s != p) {
 			if (bf->ip != NULL && (p == bf->ip + bf->ip_len || p == bf->input_buf)) {
-				// ̓obt@̏o
+				// 入力バッファの出力
 				r = (p == bf->input_buf) ? bf->ip : (bf->input_buf + bf->input_len);
 				offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, r - s, bf->sel);
 				s = p;
@@ -1729,7 +1829,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 					SetTextColor(mdc, cur_color);
 				}
 			} else if (bf->dp != NULL && p == bf->dp + bf->del_len) {
-				// 폜
+				// 削除文字列
 				offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, bf->dp - s, bf->sel);
 				s = p;
 				if (cur_color != COLOR_COMMENT && cur_color != COLOR_STRING_D && cur_color != COLOR_STRING_S) {
@@ -1743,20 +1843,20 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 		}
 		if ((j >= bf->sp && j < bf->cp) || (j >= bf->cp && j < bf->sp)) {
 			if (bf->sel == FALSE) {
-				// IJn
+				// 選択開始
 				offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, p - s, bf->sel);
 				s = p;
 				bf->sel = TRUE;
 			}
 		} else if (bf->sel == TRUE) {
-			// II
+			// 選択終了
 			offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, p - s, bf->sel);
 			s = p;
 			bf->sel = FALSE;
 			SetTextColor(mdc, cur_color);
 		}
 
-		// \̐FύX
+		// 予約語の色変更
 		if (break_word == TRUE && cur_color != COLOR_COMMENT && cur_color != COLOR_STRING_D && cur_color != COLOR_STRING_S) {
 			int keyword_len = 0;
 			int i;
@@ -1785,7 +1885,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 				}
 			}
 			if (keyword_len > 0) {
-				// \Jn
+				// 予約語開始
 				offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, p - s, bf->sel);
 				s = p;
 				cur_color = COLOR_KEYWORD;
@@ -1795,7 +1895,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 		if (cur_color == COLOR_KEYWORD &&
 			!((*p >= TEXT('a') && *p <= TEXT('z')) || (*p >= TEXT('A') && *p <= TEXT('Z')) ||
 			(*p >= TEXT('0') && *p <= TEXT('9')) || *p == TEXT('_') || *p == TEXT('#'))) {
-			// \ƕϐI
+			// 予約後と変数終了
 			offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, p - s, bf->sel);
 			s = p;
 			cur_color = GetSysColor(COLOR_WINDOWTEXT);
@@ -1807,7 +1907,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 		} else {
 			break_word = FALSE;
 		}
-		// Rg̐FύX
+		// コメントの色変更
 		if (*p == TEXT('/') && *(p + 1) == TEXT('/') && cur_color != COLOR_STRING_D && cur_color != COLOR_STRING_S) {
 			offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, p - s, bf->sel);
 			s = p;
@@ -1815,7 +1915,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 			SetTextColor(mdc, cur_color);
 			string_end = FALSE;
 		}
-		// I
+		// 文字列終了
 		if (string_end == TRUE) {
 			string_end = FALSE;
 			offset += draw_string(hWnd, mdc, bf, &drect, offset, top, s, p - s, bf->sel);
@@ -1823,7 +1923,7 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 			cur_color = GetSysColor(COLOR_WINDOWTEXT);
 			SetTextColor(mdc, cur_color);
 		}
-		// ̐FύX
+		// 文字列の色変更
 		if (bf->extension_mode == TRUE &&
 			*p == TEXT('"') && (prev == NULL || *prev != TEXT('\\')) &&
 			cur_color != COLOR_COMMENT && cur_color != COLOR_STRING_S) {
@@ -1897,13 +1997,13 @@ static void draw_line(const HWND hWnd, const HDC mdc, BUFFER *bf, const int i, c
 	}
 	draw_string(hWnd, mdc, bf, &drect, offset, top, s, r - s, bf->sel);
 	if (bf->show_line_no == TRUE) {
-		// sԍ̕`
+		// 行番号の描画
 		show_line_no(mdc, bf, i, &drect);
 	}
 }
 
 /*
- * caret_set_size - Lbg̃TCYݒ
+ * caret_set_size - キャレットのサイズ設定
  */
 static void caret_set_size(const HWND hWnd, BUFFER *bf)
 {
@@ -1921,7 +2021,7 @@ static void caret_set_size(const HWND hWnd, BUFFER *bf)
 }
 
 /*
- * caret_char_to_caret - ʒuLbg̈ʒu擾
+ * caret_char_to_caret - 文字位置からキャレットの位置取得
  */
 static int caret_char_to_caret(const HDC mdc, BUFFER *bf, const int i, const DWORD cp)
 {
@@ -1935,10 +2035,10 @@ static int caret_char_to_caret(const HDC mdc, BUFFER *bf, const int i, const DWO
 	for (j = line_get(bf, i), s = p = index_to_char(bf, line_get(bf, i)); j < line_get(bf, i + 1); j++, p = char_next(bf, p)) {
 		r = NULL;
 		if (s != p && bf->ip != NULL && (p == bf->ip + bf->ip_len || p == bf->input_buf)) {
-			// ̓obt@
+			// 入力バッファ
 			r = (p == bf->input_buf) ? bf->ip : (bf->input_buf + bf->input_len);
 		} else if (s != p && bf->dp != NULL && p == bf->dp + bf->del_len) {
-			// 폜
+			// 削除文字列
 			r = bf->dp;
 		}
 		if (r != NULL) {
@@ -1981,7 +2081,7 @@ static int caret_char_to_caret(const HDC mdc, BUFFER *bf, const int i, const DWO
 }
 
 /*
- * caret_point_to_caret - WLbg̈ʒu擾
+ * caret_point_to_caret - 座標からキャレットの位置取得
  */
 static DWORD caret_point_to_caret(BUFFER *bf, const int x, const int y)
 {
@@ -2036,7 +2136,7 @@ static DWORD caret_point_to_caret(BUFFER *bf, const int x, const int y)
 }
 
 /*
- * caret_get_token - Lbgʒũg[N擾
+ * caret_get_token - キャレット位置のトークンを取得
  */
 static void caret_get_token(BUFFER *bf)
 {
@@ -2045,7 +2145,7 @@ static void caret_get_token(BUFFER *bf)
 
 	i = index_to_line(bf, bf->cp);
 	for (; i > 0; i--) {
-		// _s̐擪Ɉړ
+		// 論理行の先頭に移動
 		p = index_to_char(bf, line_get(bf, i) - 1);
 		if (*p == TEXT('\r') || *p == TEXT('\n')) {
 			break;
@@ -2091,7 +2191,7 @@ static void caret_get_token(BUFFER *bf)
 }
 
 /*
- * caret_move - Lbg̈ړ
+ * caret_move - キャレットの移動
  */
 static void caret_move(const HWND hWnd, BUFFER *bf, const int key)
 {
@@ -2111,10 +2211,10 @@ static void caret_move(const HWND hWnd, BUFFER *bf, const int key)
 	switch (key) {
 	case VK_HOME:
 		if (GetKeyState(VK_CONTROL) < 0) {
-			// Ŝ̐擪
+			// 全体の先頭
 			bf->cp = 0;
 		} else {
-			// _s
+			// 論理行頭
 			for (; *(index_to_char(bf, bf->cp)) == TEXT('\r') || *(index_to_char(bf, bf->cp)) == TEXT('\n'); bf->cp--)
 				;
 			for (; bf->cp > 0 && *(index_to_char(bf, bf->cp)) != TEXT('\r') && *(index_to_char(bf, bf->cp)) != TEXT('\n'); bf->cp--)
@@ -2128,10 +2228,10 @@ static void caret_move(const HWND hWnd, BUFFER *bf, const int key)
 
 	case VK_END:
 		if (GetKeyState(VK_CONTROL) < 0) {
-			// Ŝ̖
+			// 全体の末尾
 			bf->cp = BUF_LEN;
 		} else {
-			// _s
+			// 論理行末
 			for (; bf->cp < BUF_LEN && *(index_to_char(bf, bf->cp)) != TEXT('\r') && *(index_to_char(bf, bf->cp)) != TEXT('\n'); bf->cp++)
 				;
 		}
@@ -2203,7 +2303,7 @@ static void caret_move(const HWND hWnd, BUFFER *bf, const int key)
 	case VK_LEFT:
 		bf->cpx = 0;
 		if (bf->cp != bf->sp && GetKeyState(VK_SHIFT) >= 0) {
-			// I
+			// 選択解除
 			if (bf->cp > bf->sp) {
 				SWAP(bf->cp, bf->sp);
 			}
@@ -2230,7 +2330,7 @@ static void caret_move(const HWND hWnd, BUFFER *bf, const int key)
 	case VK_RIGHT:
 		bf->cpx = 0;
 		if (bf->cp != bf->sp && GetKeyState(VK_SHIFT) >= 0) {
-			// I
+			// 選択解除
 			if (bf->cp < bf->sp) {
 				SWAP(bf->cp, bf->sp);
 			}
@@ -2265,7 +2365,7 @@ static void caret_move(const HWND hWnd, BUFFER *bf, const int key)
 }
 
 /*
- * nedit_proc - EditEBhEvV[W
+ * nedit_proc - Editウィンドウプロシージャ
  */
 static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM wParam, const LPARAM lParam)
 {
@@ -2324,14 +2424,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		if (string_init(bf) == FALSE) {
 			return -1;
 		}
-		// obt@̏
+		// バッファの初期化
 		bf->buf_size = RESERVE_BUF;
 		if ((bf->buf = mem_alloc(sizeof(TCHAR) * bf->buf_size)) == NULL) {
 			return -1;
 		}
 		*bf->buf = TEXT('\0');
 
-		// `̏
+		// 描画情報の初期化
 		hdc = GetDC(hWnd);
 		bf->mdc = CreateCompatibleDC(hdc);
 		ReleaseDC(hWnd, hdc);
@@ -2347,7 +2447,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		SetWindowLongPtr(hWnd, GWLP_USERDATA, (LONG_PTR)bf);
 		SendMessage(hWnd, WM_REFLECT, 0, 0);
 
-		// ̐ݒ
+		// 初期文字列の設定
 		if (((LPCREATESTRUCT)lParam)->lpszName != NULL) {
 			SendMessage(hWnd, WM_SETTEXT, 0, (LPARAM)((LPCREATESTRUCT)lParam)->lpszName);
 		}
@@ -2380,6 +2480,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			mem_free(&bf->buf);
 			mem_free(&bf->input_buf);
 			mem_free(&bf->line);
+			mem_free(&bf->break_line);
 			undo_free(bf, 0);
 			mem_free(&bf->undo);
 			mem_free(&bf);
@@ -2396,7 +2497,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		CreateCaret(hWnd, NULL, 0, bf->font_height);
 		ShowCaret(hWnd);
 		line_refresh(hWnd, bf, bf->cp, bf->sp);
-		// eEBhEɒʒm
+		// 親ウィンドウに通知
 		notify_message(hWnd, bf, EN_SETFOCUS);
 		break;
 
@@ -2407,7 +2508,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		HideCaret(hWnd);
 		DestroyCaret();
 		line_refresh(hWnd, bf, bf->cp, bf->sp);
-		// eEBhEɒʒm
+		// 親ウィンドウに通知
 		notify_message(hWnd, bf, EN_KILLFOCUS);
 		break;
 
@@ -2420,7 +2521,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		}
 		get_edit_rect(hWnd, bf, &rect);
 		if (bf->wordwrap == TRUE && (rect.right - rect.left) > 0) {
-			// s̍Đݒ
+			// 行情報の再設定
 			bf->width = (rect.right - rect.left);
 			bf->line_len = 0;
 			line_set_info(hWnd, bf);
@@ -2432,7 +2533,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 
 		InvalidateRect(hWnd, NULL, FALSE);
 
-		// IME̐ݒ
+		// IMEの設定
 		hIMC = ImmGetContext(hWnd);
 		GetCaretPos(&pt);
 		cf.dwStyle = CFS_POINT | CFS_RECT;
@@ -2500,7 +2601,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		case SB_PAGELEFT:
 		case SB_PAGERIGHT:
 			if (i - bf->pos_x != 0) {
-				// eEBhEɒʒm
+				// 親ウィンドウに通知
 				notify_message(hWnd, bf, EN_HSCROLL);
 			}
 			break;
@@ -2564,7 +2665,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		case SB_PAGEUP:
 		case SB_PAGEDOWN:
 			if (i - bf->pos_y != 0) {
-				// eEBhEɒʒm
+				// 親ウィンドウに通知
 				notify_message(hWnd, bf, EN_VSCROLL);
 			}
 			break;
@@ -2584,13 +2685,13 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 
 		case VK_INSERT:
 			if (GetKeyState(VK_CONTROL) < 0) {
-				// Rs[
+				// コピー
 				SendMessage(hWnd, WM_COPY, 0, 0);
 			} else if (GetKeyState(VK_SHIFT) < 0) {
-				// \t
+				// 貼り付け
 				SendMessage(hWnd, WM_PASTE, 0, 0);
 			} else {
-				// ̓[hؑ
+				// 入力モード切替
 				bf->insert_mode = !bf->insert_mode;
 
 				DestroyCaret();
@@ -2605,10 +2706,10 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 				break;
 			}
 			if (GetKeyState(VK_SHIFT) < 0) {
-				// ؂
+				// 切り取り
 				SendMessage(hWnd, WM_CUT, 0, 0);
 			} else {
-				// 폜
+				// 削除
 				string_delete_char(hWnd, bf, bf->cp);
 			}
 			break;
@@ -2646,10 +2747,10 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 
 		case 'Z':
 			if (GetKeyState(VK_CONTROL) < 0 && GetKeyState(VK_SHIFT) < 0) {
-				// 蒼
+				// やり直し
 				SendMessage(hWnd, EM_REDO, 0, 0);
 			} else if (GetKeyState(VK_CONTROL) < 0) {
-				// ɖ߂
+				// 元に戻す
 				SendMessage(hWnd, EM_UNDO, 0, 0);
 			}
 			break;
@@ -2698,7 +2799,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 				int i;
 
 				string_flush(bf, TRUE);
-				// caseAdefault̍s`FbN
+				// case、defaultの行かチェック
 				for (s = p; *s != TEXT('\0') && *s != TEXT('\r') && *s != TEXT('\n'); s = char_next(bf, s)) {
 					if (str_cmp_ni(s, TEXT("case"), lstrlen(TEXT("case"))) == 0 || str_cmp_ni(s, TEXT("default"), lstrlen(TEXT("default"))) == 0) {
 						case_flag = TRUE;
@@ -2707,7 +2808,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 				if (case_flag == FALSE) {
 					break;
 				}
-				// switcȟ
+				// switch文の検索
 				i = index_to_line(bf, bf->cp) - 1;
 				while (switch_flag == FALSE && i >= 0) {
 					r = index_to_char(bf, line_get(bf, i));
@@ -2719,14 +2820,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 					i--;
 				}
 				if (switch_flag == TRUE) {
-					// switch̃Cfg擾
+					// switch文のインデントを取得
 					for (; *r == TEXT('\t') || *r == TEXT(' '); r = char_next(bf, r)) {
 						if (*p != TEXT('\t') && *p != TEXT(' ')) {
 							break;
 						}
 						p = char_next(bf, p);
 					}
-					//  caseswitch̃Cfgɍ킹
+					//  caseをswitch文のインデントに合わせる
 					if (*p == TEXT('\t') || *p == TEXT(' ')) {
 						int st = char_to_index(bf, p);
 						int en;
@@ -2740,25 +2841,25 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			string_flush(bf, TRUE);
 			break;
 		case VK_RETURN:
-			// s
+			// 改行
 			{
-				// Cfg
+				// 自動インデント
 				TCHAR *cp = index_to_char(bf, bf->cp - 1);
 				TCHAR *p = index_to_char(bf, line_get(bf, index_to_line(bf, bf->cp)));
 				if (p == index_to_char(bf, bf->cp)) {
-					// s̐擪̏ꍇ͎CfgȂ
+					// 行の先頭の場合は自動インデントしない
 					string_insert(hWnd, bf, TEXT("\r\n"), 2, TRUE);
 					break;
 				}
 				string_insert(hWnd, bf, TEXT("\r\n"), 2, TRUE);
 
 				for (; *p == TEXT('\t') || *p == TEXT(' '); p = char_next(bf, p)) {
-					// OsƓCfgێ
+					// 前行と同じインデントを維持
 					string_insert(hWnd, bf, p, 1, TRUE);
 				}
 				for (; *cp == TEXT('\t') || *cp == TEXT(' '); cp = char_prev(bf, cp));
 				if (*cp == TEXT('{') || *cp == TEXT(':')) {
-					// ubNɓꍇ̓Cfg𑝂₷
+					// ブロックに入った場合はインデントを増やす
 					string_insert(hWnd, bf, TEXT("\t"), 1, TRUE);
 				}
 			}
@@ -2778,7 +2879,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 					DWORD st = (bf->cp > bf->sp) ? bf->sp : bf->cp;
 					DWORD en = (bf->cp > bf->sp) ? bf->cp : bf->sp;
 					DWORD i;
-					// I͈͂ɉs܂܂邩`FbN
+					// 選択範囲に改行が含まれるかチェック
 					for (i = st; i < en; i++) {
 						if (*index_to_char(bf, i) == TEXT('\r') || *index_to_char(bf, i) == TEXT('\n')) {
 							line_select_flag = TRUE;
@@ -2787,21 +2888,21 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 					}
 				}
 				if (line_select_flag == FALSE) {
-					// IȂAIɉs܂܂ĂȂꍇTAB
+					// 選択なしか、選択に改行が含まれていない場合はTABを入力
 					in[0] = (TCHAR)wParam;
 					string_insert(hWnd, bf, in, 1, bf->insert_mode);
 					break;
 				}
-				// Is̃CfgύX
+				// 選択行のインデントを変更
 				set_select_indent(hWnd, bf);
 			}
 			break;
 
 		default:
 			in[0] = (TCHAR)wParam;
-			// Cfg
+			// 自動インデント
 			if (*in == TEXT('}') && *index_to_char(bf, bf->cp - 1) == TEXT('\t')) {
-				// ubN甲ꍇ̓Cfg炷
+				// ブロックから抜ける場合はインデントを減らす
 				caret_move(hWnd, bf, VK_LEFT);
 				string_delete_char(hWnd, bf, bf->cp);
 			}
@@ -2835,11 +2936,11 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 
 			hIMC = ImmGetContext(hWnd);
 			if (bf->hfont != NULL) {
-				// tHg̐ݒ
+				// フォントの設定
 				GetObject(bf->hfont, sizeof(LOGFONT), &lf);
 				ImmSetCompositionFont(hIMC, &lf);
 			}
-			// ʒu̐ݒ
+			// 位置の設定
 			GetCaretPos(&pt);
 			cf.dwStyle = CFS_POINT | CFS_RECT;
 			cf.ptCurrentPos.x = pt.x;
@@ -2857,7 +2958,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			bf->lock == FALSE && (lParam & GCS_RESULTSTR)) {
 			TCHAR *buf;
 
-			// m蕶obt@ɒǉ
+			// 確定文字列をバッファに追加
 			hIMC = ImmGetContext(hWnd);
 			len = ImmGetCompositionString(hIMC, GCS_RESULTSTR, NULL, 0);
 			buf = mem_calloc(len + sizeof(TCHAR));
@@ -2867,7 +2968,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 				UpdateWindow(hWnd);
 				mem_free(&buf);
 			}
-			// ʒu̐ݒ
+			// 位置の設定
 			GetCaretPos(&pt);
 			cf.dwStyle = CFS_POINT | CFS_RECT;
 			cf.ptCurrentPos.x = pt.x;
@@ -2898,14 +2999,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		GetCursorPos(&pt);
 		if (msg == WM_LBUTTONDOWN && (GetTickCount() - DoubleClkTime) <= GetDoubleClickTime() &&
 			abs(ClickPt.x - pt.x) < GetSystemMetrics(SM_CXDOUBLECLK) && abs(ClickPt.y - pt.y) < GetSystemMetrics(SM_CYDOUBLECLK)) {
-			// _uNbN̂ߒPI
+			// ダブルクリックのため単語選択
 			string_flush(bf, TRUE);
 			SetFocus(hWnd);
 			bf->cpx = 0;
 			cp = bf->cp;
 			bf->sp = bf->cp;
 			sp = caret_point_to_caret(bf, (short)LOWORD(lParam), (short)HIWORD(lParam));
-			// PI
+			// 単語選択
 			caret_get_token(bf);
 			ensure_visible(hWnd, bf);
 			line_refresh(hWnd, bf, cp, sp);
@@ -2917,7 +3018,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		}
 		if (msg == WM_LBUTTONDOWN && (GetTickCount() - TripleClkTime) <= GetDoubleClickTime() &&
 			abs(ClickPt.x - pt.x) < GetSystemMetrics(SM_CXDOUBLECLK) && abs(ClickPt.y - pt.y) < GetSystemMetrics(SM_CYDOUBLECLK)) {
-			// gvNbN̂ߍsI
+			// トリプルクリックのため行選択
 			bf->sp = line_get(bf, index_to_line(bf, bf->cp));
 			for (; *index_to_char(bf, bf->cp) != TEXT('\r') && *index_to_char(bf, bf->cp) != TEXT('\n') && bf->cp < BUF_LEN; bf->cp++);
 			if (*index_to_char(bf, bf->cp) == TEXT('\r')) {
@@ -2932,7 +3033,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			break;
 		}
 		if (bf->show_line_no == TRUE && msg == WM_LBUTTONDOWN && LOWORD(lParam) <= bf->line_no_width) {
-			// sԍNbN̂ߍsI
+			// 行番号クリックのため行選択
 			string_flush(bf, TRUE);
 			cp = bf->cp;
 			sp = bf->sp;
@@ -3066,7 +3167,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 					SetCaretPos(len, (j - bf->pos_y)* bf->font_height + bf->top_margin);
 					j = -1;
 				}
-				// 1s`
+				// 1行描画
 				FillRect(bf->mdc, &rect, hBrush);
 				draw_line(hWnd, bf->mdc, bf, i, ps.rcPaint.left, ps.rcPaint.right);
 				BitBlt(hdc,
@@ -3075,13 +3176,13 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 					bf->mdc, ps.rcPaint.left, 0, SRCCOPY);
 			}
 			if ((i - bf->pos_y) * bf->font_height + bf->top_margin < ps.rcPaint.bottom) {
-				// ̗]`
+				// 文末の余白描画
 				SetRect(&rect,
 					ps.rcPaint.left, (i - bf->pos_y) * bf->font_height + bf->top_margin,
 					ps.rcPaint.right, ps.rcPaint.bottom);
 				FillRect(hdc, &rect, hBrush);
 			}
-			// ``
+			// 矩形描画
 			FillRgn(hdc, bf->hrgn, hBrush);
 			DeleteObject(hBrush);
 
@@ -3106,14 +3207,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->hTheme == NULL) {
 				return DefWindowProc(hWnd, msg, wParam, lParam);
 			}
-			// XPp̔wi`
+			// XP用の背景描画
 			if (_DrawThemeBackground == NULL) {
 				_DrawThemeBackground = GetProcAddress(bf->hModThemes, "DrawThemeBackground");
 			}
 			if (_DrawThemeBackground == NULL) {
 				return DefWindowProc(hWnd, msg, wParam, lParam);
 			}
-			// Ԃ̐ݒ
+			// 状態の設定
 			if (IsWindowEnabled(hWnd) == 0) {
 				stats = ETS_DISABLED;
 			} else if (GetFocus() == hWnd) {
@@ -3121,7 +3222,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			} else {
 				stats = ETS_NORMAL;
 			}
-			// EBhEg̕`
+			// ウィンドウ枠の描画
 			hdc = GetDCEx(hWnd, (HRGN)wParam, DCX_WINDOW | DCX_INTERSECTRGN);
 			if (hdc == NULL) {
 				hdc = GetWindowDC(hWnd);
@@ -3134,7 +3235,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			_DrawThemeBackground(bf->hTheme, hdc, EP_EDITTEXT, stats, &rect, &clip_rect);
 			ReleaseDC(hWnd, hdc);
 
-			// XN[o[̕`
+			// スクロールバーの描画
 			GetWindowRect(hWnd, (LPRECT)&rect);
 			hrgn = CreateRectRgn(rect.left + GetSystemMetrics(SM_CXEDGE), rect.top + GetSystemMetrics(SM_CYEDGE),
 				rect.right - GetSystemMetrics(SM_CXEDGE), rect.bottom - GetSystemMetrics(SM_CYEDGE));
@@ -3148,7 +3249,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->hModThemes == NULL) {
 			break;
 		}
-		// XPe[}̕ύX
+		// XPテーマの変更
 		if (bf->hTheme != NULL) {
 			if (_CloseThemeData == NULL) {
 				_CloseThemeData = GetProcAddress(bf->hModThemes, "CloseThemeData");
@@ -3168,14 +3269,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 #endif	// OP_XP_STYLE
 
 	case WM_SETTEXT:
-		// eLXgݒ
+		// テキストを設定
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
 		return string_set(hWnd, bf, (TCHAR *)lParam, lstrlen((TCHAR *)lParam));
 
 	case WM_GETTEXT:
-		// eLXg擾
+		// テキストを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3184,14 +3285,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return lstrlen((TCHAR *)lParam);
 
 	case WM_GETTEXTLENGTH:
-		// eLXg̒擾
+		// テキストの長さを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return BUF_LEN;
 
 	case WM_SETFONT:
-		// tHgݒ
+		// フォントを設定
 		{
 			LOGFONT lf;
 
@@ -3217,14 +3318,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_GETFONT:
-		// tHg擾
+		// フォントを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return (LRESULT)bf->hfont;
 
 	case WM_CLEAR:
-		// 폜
+		// 削除
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->lock == TRUE) {
 			break;
 		}
@@ -3234,7 +3335,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_COPY:
-		// Rs[
+		// コピー
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3249,7 +3350,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_CUT:
-		// ؂
+		// 切り取り
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->lock == TRUE) {
 			break;
 		}
@@ -3258,7 +3359,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_PASTE:
-		// \t
+		// 貼り付け
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->lock == TRUE) {
 			break;
 		}
@@ -3290,21 +3391,21 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_CANUNDO:
-		// UNDO\擾
+		// UNDO可能か取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return ((bf->undo_len > 0 || bf->ip != NULL || bf->dp != NULL) ? TRUE : FALSE);
 
 	case EM_CANREDO:
-		// REDO\擾
+		// REDO可能か取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return (((bf->undo + bf->undo_len)->type != 0) ? TRUE : FALSE);
 
 	case EM_EMPTYUNDOBUFFER:
-		// UNDOobt@NA
+		// UNDOバッファをクリア
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3319,14 +3420,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_GETFIRSTVISIBLELINE:
-		// ԏɕ\Ăsԍ擾
+		// 一番上に表示されている行番号を取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return bf->pos_y;
 
 	case EM_GETLINE:
-		// 1s̕擾
+		// 1行の文字列を取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3339,21 +3440,21 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return line_get_length(bf, line_get(bf, (int)wParam));
 
 	case EM_GETLINECOUNT:
-		// s擾
+		// 行数取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return bf->line_len;
 
 	case EM_GETMODIFY:
-		// ύXtO擾
+		// 変更フラグを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return bf->modified;
 
 	case EM_GETRECT:
-		// `̈̎擾
+		// 描画領域の取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3361,7 +3462,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_GETSEL:
-		// IĂCfbNX擾
+		// 選択されているインデックスを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3376,7 +3477,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return MAKELPARAM(i, j);
 
 	case EM_LIMITTEXT:
-		// ͕
+		// 入力文字数制限
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3387,7 +3488,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_LINEFROMCHAR:
-		// 蕶CfbNX܂܂sԍ擾
+		// 特定文字インデックスが含まれる行番号を取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3401,7 +3502,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return index_to_line(bf, (DWORD)wParam);
 
 	case EM_LINEINDEX:
-		// sԍ̕CfbNX擾
+		// 行番号の文字インデックスを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3414,7 +3515,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return line_get(bf, (int)wParam);
 
 	case EM_LINELENGTH:
-		// s̒擾
+		// 行の長さを取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3431,7 +3532,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return line_get_length(bf, (DWORD)wParam);
 
 	case EM_LINESCROLL:
-		// AɃXN[
+		// 水平、垂直にスクロール
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3464,7 +3565,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_REPLACESEL:
-		// I͈͂̃eLXgu
+		// 選択範囲のテキストを置き換える
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3472,7 +3573,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_SCROLL:
-		// eLXg𐂒ɃXN[
+		// テキストを垂直にスクロール
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3506,7 +3607,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return MAKELRESULT(i, TRUE);
 
 	case EM_SCROLLCARET:
-		// LbgʒuɃXN[
+		// キャレット位置にスクロール
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3515,7 +3616,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return !0;
 
 	case EM_SETMODIFY:
-		// ύXtOZbg
+		// 変更フラグをセット
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3523,14 +3624,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_GETREADONLY:
-		// ǂݎptO̎擾
+		// 読み取り専用フラグの取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return bf->lock;
 
 	case EM_SETREADONLY:
-		// ǂݎp̐ݒ
+		// 読み取り専用の設定
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3550,7 +3651,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return !0;
 
 	case EM_SETRECT:
-		// `̈̐ݒ (ĕ`悠)
+		// 描画領域の設定 (再描画あり)
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3559,7 +3660,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_SETRECTNP:
-		// `̈̐ݒ (ĕ`Ȃ)
+		// 描画領域の設定 (再描画なし)
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3574,7 +3675,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_SETSEL:
-		// ICfbNX̐ݒ
+		// 選択インデックスの設定
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3601,7 +3702,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_SETTABSTOPS:
-		// ^uXgbv̐ݒ
+		// タブストップの設定
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3617,7 +3718,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 
 	case WM_UNDO:
 	case EM_UNDO:
-		// ɖ߂
+		// 元に戻す
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->lock == TRUE) {
 			break;
 		}
@@ -3625,7 +3726,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case EM_REDO:
-		// 蒼
+		// やり直し
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->lock == TRUE) {
 			break;
 		}
@@ -3633,7 +3734,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_GETBUFFERINFO:
-		// obt@̎擾
+		// 内部バッファの取得
 		if (lParam == 0) {
 			break;
 		}
@@ -3641,14 +3742,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_REFLECT:
-		// `̍XV
+		// 描画情報の更新
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) != NULL) {
 			TEXTMETRIC tm;
 			HCURSOR old_cursor;
 
 			old_cursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
 
-			// tHg̎擾
+			// フォント情報の取得
 			GetTextMetrics(bf->mdc, &tm);
 			bf->font_height = tm.tmHeight + bf->spacing;
 			bf->char_width = tm.tmAveCharWidth;
@@ -3671,14 +3772,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_GETWORDWRAP:
-		// ܂ԂtO̎擾
+		// 折り返しフラグの取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return bf->wordwrap;
 
 	case WM_SETWORDWRAP:
-		// ܂Ԃݒ
+		// 折り返し設定
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
@@ -3690,14 +3791,14 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		break;
 
 	case WM_GETMEMSIZE:
-		// ̃TCY擾
+		// 内部メモリのサイズ取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
 			break;
 		}
 		return (BUF_LEN * sizeof(TCHAR));
 
 	case WM_GETMEM:
-		// ̎擾
+		// 内部メモリの取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3706,7 +3807,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		return (BUF_LEN * sizeof(TCHAR));
 
 	case WM_SETMEM:
-		// ɐݒ
+		// メモリを内部メモリに設定
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3759,8 +3860,37 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 		SendMessage(hWnd, WM_SIZE, 0, 0);
 		break;
 
+	case WM_TOGGLE_BREAK_LINE:
+		// wParam - 行、設定した場合は TRUE を返す
+		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL ||
+			(int)wParam < 0 || (int)wParam >= bf->line_len) {
+			return FALSE;
+		}
+		i = break_toggle(bf, (int)wParam);
+		line_refresh(hWnd, bf, line_get(bf, (int)wParam), line_get(bf, (int)wParam));
+		return i;
+
+	case WM_GET_BREAK_LINE:
+		// wParam - 行、ブレークポイントの場合は TRUE を返す
+		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
+			return FALSE;
+		}
+		i = break_find(bf, (int)wParam);
+		return (i < bf->break_count && *(bf->break_line + i) == (int)wParam) ? TRUE : FALSE;
+
+	case WM_GET_BREAK_LINE_LIST:
+		// wParam - 取得する最大数、lParam - 行の配列 (NULL の場合は数のみ)、ブレークポイントの数を返す
+		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL) {
+			return 0;
+		}
+		if (lParam != 0) {
+			i = ((int)wParam < bf->break_count) ? (int)wParam : bf->break_count;
+			CopyMemory((int *)lParam, bf->break_line, sizeof(int) * i);
+		}
+		return bf->break_count;
+
 	case WM_FINDTEXT:
-		// ̎擾
+		// 内部メモリの取得
 		if ((bf = (BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || lParam == 0) {
 			break;
 		}
@@ -3809,26 +3939,26 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 			SendMessage(hWnd, EM_GETSEL, (WPARAM)&st, (LPARAM)&en);
 			lang = PRIMARYLANGID(LANGIDFROMLCID(GetThreadLocale()));
 
-			// j[̍쐬
+			// メニューの作成
 			hMenu = CreatePopupMenu();
 			AppendMenu(hMenu, MF_STRING | ((SendMessage(hWnd, EM_CANUNDO, 0, 0) == TRUE) ? 0 : MF_GRAYED), EM_UNDO,
-				(lang != LANG_JAPANESE) ? TEXT("&Undo") : TEXT("ɖ߂(&U)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Undo") : TEXT("元に戻す(&U)"));
 			AppendMenu(hMenu, MF_STRING | ((SendMessage(hWnd, EM_CANREDO, 0, 0) == TRUE) ? 0 : MF_GRAYED), EM_REDO,
-				(lang != LANG_JAPANESE) ? TEXT("&Redo") : TEXT("蒼(&R)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Redo") : TEXT("やり直し(&R)"));
 			AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
 			AppendMenu(hMenu, MF_STRING | ((st != en) ? 0 : MF_GRAYED), WM_CUT,
-				(lang != LANG_JAPANESE) ? TEXT("Cu&t") : TEXT("؂(&T)"));
+				(lang != LANG_JAPANESE) ? TEXT("Cu&t") : TEXT("切り取り(&T)"));
 			AppendMenu(hMenu, MF_STRING | ((st != en) ? 0 : MF_GRAYED), WM_COPY,
-				(lang != LANG_JAPANESE) ? TEXT("&Copy") : TEXT("Rs[(&C)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Copy") : TEXT("コピー(&C)"));
 			AppendMenu(hMenu, MF_STRING, WM_PASTE,
-				(lang != LANG_JAPANESE) ? TEXT("&Paste") : TEXT("\t(&P)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Paste") : TEXT("貼り付け(&P)"));
 			AppendMenu(hMenu, MF_STRING | ((st != en) ? 0 : MF_GRAYED), WM_CLEAR,
-				(lang != LANG_JAPANESE) ? TEXT("&Delete") : TEXT("폜(&D)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Delete") : TEXT("削除(&D)"));
 			AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
 			AppendMenu(hMenu, MF_STRING, 1,
-				(lang != LANG_JAPANESE) ? TEXT("Select &All") : TEXT("ׂđI(&A)"));
+				(lang != LANG_JAPANESE) ? TEXT("Select &All") : TEXT("すべて選択(&A)"));
 
-			// j[̕\
+			// メニューの表示
 			GetCursorPos((LPPOINT)&apos);
 			i = TrackPopupMenu(hMenu, TPM_TOPALIGN | TPM_RETURNCMD, apos.x, apos.y, 0, hWnd, NULL);
 			DestroyMenu(hMenu);
@@ -3852,7 +3982,7 @@ static LRESULT CALLBACK nedit_proc(const HWND hWnd, const UINT msg, const WPARAM
 }
 
 /*
- * RegisterNedit - NX̓o^
+ * RegisterNedit - クラスの登録
  */
 BOOL RegisterNedit(const HINSTANCE hInstance)
 {
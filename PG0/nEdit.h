@@ -34,6 +34,9 @@
 #define WM_SET_EXTENSION				(WM_APP + 10)
 #define WM_FINDTEXT						(WM_APP + 11)
 #define WM_SHOW_LINE_NO					(WM_APP + 12)
+#define WM_TOGGLE_BREAK_LINE			(WM_APP + 13)
+#define WM_GET_BREAK_LINE				(WM_APP + 14)
+#define WM_GET_BREAK_LINE_LIST			(WM_APP + 15)
 
 #define EM_GETREADONLY					(WM_APP + 100)
 
@@ -57,115 +60,119 @@ typedef struct _UNDO {
 } UNDO;
 
 typedef struct _BUFFER {
-	// ێĂe
+	// 保持している内容
 	TCHAR *buf;
 	DWORD buf_size;
 	DWORD buf_len;
 
-	// ̓obt@
+	// 入力バッファ
 	TCHAR *input_buf;
 	DWORD input_size;
 	DWORD input_len;
 
-	// \s̃ItZbg
+	// 表示行頭のオフセット
 	DWORD *line;
 	int line_size;
 	int line_len;
 	int line_add_index;
 	int line_add_len;
 
-	// UNDOobt@
+	// UNDOバッファ
 	UNDO *undo;
 	int undo_size;
 	int undo_len;
 	int undo_pos;
 
-	// ͊Jnʒu
+	// 入力開始位置
 	TCHAR *ip;
 	DWORD ip_len;
-	// 폜Jnʒu
+	// 削除開始位置
 	TCHAR *dp;
 	DWORD del_len;
 
-	// Lbg̈ʒu
+	// キャレットの位置
 	DWORD cp;
-	// Iʒu
+	// 選択位置
 	DWORD sp;
-	// ㉺ړ̃LbgXW
+	// 上下移動時のキャレットのX座標
 	int cpx;
 
-	// 1s̕
+	// 1行の文字数
 	int line_max;
-	// s̍ő啝
+	// 行の最大幅
 	int line_width;
-	// EBhE̕
+	// ウィンドウの幅
 	int width;
 
-	// XN[ o[
+	// スクロール バー
 	int pos_x;
 	int max_x;
 	int pos_y;
 	int max_y;
 
-	// sԍ
+	// 行番号幅
 	int line_no_width;
 
-	// ^uXgbv
+	// タブストップ
 	int tab_stop;
-	// }[W
+	// 左マージン
 	int left_margin;
-	// }[W
+	// 上マージン
 	int top_margin;
-	// E}[W
+	// 右マージン
 	int right_margin;
-	// }[W
+	// 下マージン
 	int bottom_margin;
-	// s
+	// 行間
 	int spacing;
 
-	// `p
+	// 描画用情報
 	HDC mdc;
 	HBITMAP ret_bmp;
 	HRGN hrgn;
 	HFONT hfont;
 	HFONT ret_font;
 
-	// tHg
+	// フォント
 	int font_height;
 	int char_width;
 
-	// ܂ԂtO
+	// 折り返しフラグ
 	BOOL wordwrap;
-	// tH[JXĂI\
+	// フォーカスが無くても選択表示
 	BOOL no_hide_sel;
-	// ɕϊ
+	// 小文字に変換
 	BOOL lowercase;
-	// 啶ɕϊ
+	// 大文字に変換
 	BOOL uppercase;
-	// bNtO
+	// ロックフラグ
 	BOOL lock;
-	// CtO
+	// 修正フラグ
 	BOOL modified;
-	// ̓[h
+	// 入力モード
 	BOOL insert_mode;
-	// ItO
+	// 選択フラグ
 	BOOL sel;
-	// }EXtO
+	// マウス情報フラグ
 	BOOL mousedown;
-	// ͒
+	// 入力長制限
 	DWORD limit_len;
-	// s
+	// 強調行
 	int hightlight_line;
-	// G[s
+	// エラー行
 	int error_line;
+	// ブレークポイントの行 (昇順)
+	int *break_line;
+	int break_count;
+	int break_size;
 	BOOL extension_mode;
-	// sԍ\tO
+	// 行番号表示フラグ
 	BOOL show_line_no;
 
-	// ̕
+	// 文字の幅
 	BYTE cwidth[256];
 
-	// Rg[ʎq
+	// コントロール識別子
 	int id;
 	// IME
 	HIMC himc;
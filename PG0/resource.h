@@ -1,6 +1,6 @@
 //{{NO_DEPENDENCIES}}
-// Microsoft Visual C++ ŐꂽCN[h t@CB
-// pg0edit.rc Ŏgp
+// Microsoft Visual C++ で生成されたインクルード ファイル。
+// pg0edit.rc で使用
 //
 #define IDS_STRING_OPEN_TITLE           10
 #define IDS_STRING_SAVE_TITLE           11
@@ -50,13 +50,14 @@
 #define ID_MENUITEM_FIND                40041
 #define ID_MENUITEM_FINDNEXT            40045
 #define ID_MENUITEM_LINE_NO             40046
+#define ID_MENUITEM_BREAKPOINT          40053
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        111
-#define _APS_NEXT_COMMAND_VALUE         40053
+#define _APS_NEXT_COMMAND_VALUE         40054
 #define _APS_NEXT_CONTROL_VALUE         1001
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
@@ -16,48 +16,128 @@
 
 /* Define */
 #ifdef _DEBUG_TOKEN
-#define DEBUG_SET				//͖؂ɃfobOp̕ێ
+#define DEBUG_SET				//解析木にデバッグ用の文字列を保持
 #endif
 
 #define BUF_SIZE				256
 
+#define LIB_FUNC_HEAD			TEXT("_lib_func_")
+
+#ifndef THREAD_LOCAL
+#define THREAD_LOCAL			__declspec(thread)
+#endif
+
+//統計の加算 (統計が無効の場合は何もしない)
+#define STAT_ADD(member, n)		((cur_stat != NULL) ? (void)(cur_stat->member += (n)) : (void)0)
+
+//値の更新の記録 (更新カウンタを進めて値と値を含む配列に設定)
+#define VALUE_MODIFIED(v)		do { VALUE *_mv = (v); unsigned int _mc = ++mod_count; \
+									for (; _mv != NULL; _mv = _mv->parent) _mv->mod = _mc; } while (0)
+
+//トレースのイベント (トレースが無効の場合は何もしない)
+#define TRACE_BEGIN(cat, name, arg)	((trace_enable == TRUE) ? TraceEvent('B', cat, name, arg) : (void)0)
+#define TRACE_END(cat, name)		((trace_enable == TRUE) ? TraceEvent('E', cat, name, -1) : (void)0)
+
 /* Struct */
 
+/* Global Variables */
+extern THREAD_LOCAL STATINFO *cur_stat;
+extern THREAD_LOCAL unsigned int mod_count;
+extern volatile BOOL trace_enable;
+
 /* Function Prototypes */
 void InitializeScript();
 void EndScript();
 void Error(EXECINFO *ei, ERROR_CODE err_id, TCHAR *msg, TCHAR *pre_str);
+void FlushError(SCRIPTINFO *sci);
 
-//
+//解放
 void FreeToken(TOKEN *tk);
 void FreeExecInfo(EXECINFO *ei);
 void FreeFuncInfo(FUNCINFO *fi);
 void FreeScriptInfo(SCRIPTINFO *sci);
 
-//XNvg
+//スクリプト情報
 void InitializeScriptInfo(SCRIPTINFO *sci, BOOL op_exp, BOOL op_extension);
 VALUEINFO *GetVariable(EXECINFO *ei, TCHAR *name);
 BOOL SetVariable(EXECINFO *ei, TCHAR *name, VALUE *v);
 
-//s
+//実行
 int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack);
 VALUEINFO *ExecFunction(EXECINFO *ei, TCHAR *name, VALUEINFO *param);
+void SetScriptLimit(SCRIPTINFO *sci, LONGLONG step_limit, DWORD timeout);
+int SetBreakPoint(SCRIPTINFO *sci, const int line, const BOOL set);
+BOOL IsBreakPoint(SCRIPTINFO *sci, TOKEN *tk);
+void ClearBreakPoint(SCRIPTINFO *sci);
+void SetBreakOnly(SCRIPTINFO *sci, const BOOL break_only);
+int ExecTopLevel(EXECINFO *ei, VALUEINFO **ret_vi);
 int ExecScript(SCRIPTINFO *sci, VALUEINFO *arg_vi, VALUEINFO **ret_vi);
 
-//
+//解析
 TOKEN *ParseVariable(EXECINFO *ei, TCHAR *buf);
 TOKEN *ParseSentence(EXECINFO *ei, TCHAR *buf, int level);
 
-//ǂݍ
+//読み込み
 void GetFilePathName(TCHAR *path, TCHAR *dir, TCHAR *name);
 TCHAR *read_file(TCHAR *path);
+void ReleaseScriptSource(SCRIPTINFO *sci);
+void FreeSourceInfo(SOURCEINFO *src);
+BOOL GetSourcePosition(SCRIPTINFO *sci, TCHAR *p, int *line, int *col);
+BOOL IsReleasedSource(SCRIPTINFO *sci, TCHAR *p);
+TCHAR *GetSourceLine(SCRIPTINFO *sci, int line);
+MODULEINFO *GetModuleList(SCRIPTINFO *sci);
+void FreeModuleInfo(SCRIPTINFO *sci);
 SCRIPTINFO *ReadScriptFile(SCRIPTINFO *sci, TCHAR *path, TCHAR *FileName);
 BOOL ReadScriptFiles(SCRIPTINFO *sci, TCHAR *path, TCHAR *FileName);
 TCHAR *Preprocessor(SCRIPTINFO *sci, TCHAR *path, TCHAR *p);
 
-//֐e[u
+//関数テーブル
 void InitFuncAddress();
 LIBFUNC GetFuncAddress(TCHAR *FuncName);
 
+//インスタンス
+INSTANCEINFO *CreateInstance(void);
+void DestroyInstance(INSTANCEINFO *inst);
+INSTANCEINFO *SelectInstance(INSTANCEINFO *inst);
+void SetInstanceMemoryLimit(INSTANCEINFO *inst, SIZE_T limit);
+void GetInstanceMemory(INSTANCEINFO *inst, SIZE_T *size, SIZE_T *peak);
+BOOL SetInstanceStat(INSTANCEINFO *inst, BOOL enable);
+STATINFO *GetInstanceStat(INSTANCEINFO *inst);
+void ResetInstanceStat(INSTANCEINFO *inst);
+SCRIPTINFO *CreateScriptInfo(INSTANCEINFO *inst, BOOL op_exp, BOOL op_extension);
+BOOL RegisterFunction(INSTANCEINFO *inst, TCHAR *name, LIBFUNC func);
+BOOL SetInstanceIO(INSTANCEINFO *inst, LIBFUNC error, LIBFUNC print, LIBFUNC input);
+LIBFUNC GetInstanceFunc(SCRIPTINFO *sci, TCHAR *FuncName);
+
+//コンパイル済みスクリプト
+CODEINFO *CompileScript(INSTANCEINFO *inst, TCHAR *path, TCHAR *name, BOOL op_exp, BOOL op_extension);
+void AddRefCode(CODEINFO *code);
+void ReleaseCode(CODEINFO *code);
+BOOL AddCodeModule(CODEINFO *code, SCRIPTINFO *sci);
+SCRIPTINFO *CreateScriptContext(INSTANCEINFO *inst, CODEINFO *code);
+BOOL ExecCodeModules(SCRIPTINFO *sci);
+PREPAREINFO *PrepareScript(INSTANCEINFO *inst, CODEINFO *code);
+int InvokeScript(PREPAREINFO *pp, TCHAR *name, VALUE *argv, int argc, VALUE **ret);
+void SetPreparedLimit(PREPAREINFO *pp, LONGLONG step_limit, DWORD timeout);
+void ResetPrepared(PREPAREINFO *pp);
+void FreePrepared(PREPAREINFO *pp);
+
+//プロファイル
+PROFILEINFO *CreateProfile(void);
+void FreeProfile(PROFILEINFO *prof);
+void ProfileEnterScript(PROFILEINFO *prof, SCRIPTINFO *sci);
+void ProfileEnterFunction(PROFILEINFO *prof, SCRIPTINFO *sci, FUNCINFO *fi);
+void ProfileLeave(PROFILEINFO *prof);
+void ProfileToken(PROFILEINFO *prof, TOKEN *tk);
+BOOL StartSampling(PROFILEINFO *prof, int rate);
+void StopSampling(PROFILEINFO *prof);
+void DrainSamples(PROFILEINFO *prof);
+BOOL SaveProfile(PROFILEINFO *prof, TCHAR *report_path, TCHAR *stack_path);
+
+//トレース
+void TraceEvent(const char ph, TRACE_CAT cat, const TCHAR *name, LONGLONG arg);
+BOOL StartTrace(TCHAR *path);
+void StopTrace(void);
+
 #endif
 /* End of source */
@@ -0,0 +1,427 @@
+/*
+ * PG0
+ *
+ * script_code.c
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <tchar.h>
+
+#include "script.h"
+#include "script_string.h"
+#include "script_memory.h"
+#include "script_utility.h"
+
+/* Define */
+#define ORDER_ALLOC_CNT			16
+
+/* Global Variables */
+
+/* Local Function Prototypes */
+static SCRIPTINFO *create_context(INSTANCEINFO *inst, CODEINFO *code);
+static VALUEINFO *CreateArgs(VALUEINFO *args, int argc);
+
+/*
+ * CompileScript - スクリプトを解析して共有可能な解析結果を作成
+ *
+ *	インポートしたスクリプトは実行せずに実行順のみ記録する
+ *	解析結果は専用のヒープに確保し、参照が無くなった時点で解放する
+ *	inst はエラー出力にのみ使用する
+ */
+CODEINFO *CompileScript(INSTANCEINFO *inst, TCHAR *path, TCHAR *name, BOOL op_exp, BOOL op_extension)
+{
+	CODEINFO *code;
+	SCRIPTINFO *sci;
+	MEMHEAP *mh, *prev;
+
+	mh = mem_heap_create();
+	if (mh == NULL) {
+		return NULL;
+	}
+	prev = mem_heap_select(mh);
+	code = mem_calloc(sizeof(CODEINFO));
+	sci = mem_alloc(sizeof(SCRIPTINFO));
+	if (code == NULL || sci == NULL) {
+		mem_heap_select(prev);
+		mem_heap_destroy(mh);
+		return NULL;
+	}
+	code->mh = mh;
+	code->ref = 1;
+	InitializeScriptInfo(sci, op_exp, op_extension);
+	sci->inst = inst;
+	sci->compile = code;
+
+	ReadScriptFile(sci, path, name);
+
+	sci->inst = NULL;
+	sci->compile = NULL;
+	mem_heap_select(prev);
+	if (sci->tk == NULL) {
+		FreeScriptInfo(sci);
+		mem_heap_destroy(mh);
+		return NULL;
+	}
+	code->sci = sci;
+	return code;
+}
+
+/*
+ * AddRefCode - 解析結果の参照を追加
+ */
+void AddRefCode(CODEINFO *code)
+{
+	InterlockedIncrement(&code->ref);
+}
+
+/*
+ * ReleaseCode - 解析結果の参照を解放
+ *
+ *	参照が無くなった場合は解析結果を解放する
+ */
+void ReleaseCode(CODEINFO *code)
+{
+	MEMHEAP *mh;
+
+	if (code == NULL || InterlockedDecrement(&code->ref) != 0) {
+		return;
+	}
+	mh = code->mh;
+	FreeScriptInfo(code->sci);
+	mem_heap_destroy(mh);
+}
+
+/*
+ * AddCodeModule - インポートしたスクリプトの実行順を記録
+ */
+BOOL AddCodeModule(CODEINFO *code, SCRIPTINFO *sci)
+{
+	SCRIPTINFO *tsci;
+	int *order;
+	int index;
+	int i;
+
+	for (index = 0, tsci = sci->sci_top; tsci != NULL && tsci != sci; tsci = tsci->next, index++);
+	if (tsci == NULL) {
+		return FALSE;
+	}
+	for (i = 0; i < code->order_cnt; i++) {
+		if (*(code->order + i) == index) {
+			// 記録済み
+			return TRUE;
+		}
+	}
+	if (code->order_cnt % ORDER_ALLOC_CNT == 0) {
+		order = (code->order == NULL) ? mem_alloc(sizeof(int) * ORDER_ALLOC_CNT) :
+			mem_realloc(code->order, sizeof(int) * (code->order_cnt + ORDER_ALLOC_CNT));
+		if (order == NULL) {
+			return FALSE;
+		}
+		code->order = order;
+	}
+	*(code->order + code->order_cnt++) = index;
+	return TRUE;
+}
+
+/*
+ * create_context - 現在のヒープに実行コンテキストを作成
+ */
+static SCRIPTINFO *create_context(INSTANCEINFO *inst, CODEINFO *code)
+{
+	SCRIPTINFO *csci;
+	SCRIPTINFO *top = NULL;
+	SCRIPTINFO *sci, *psci = NULL;
+
+	for (csci = code->sci; csci != NULL; csci = csci->next) {
+		sci = mem_calloc(sizeof(SCRIPTINFO));
+		if (sci == NULL) {
+			FreeScriptInfo(top);
+			return NULL;
+		}
+		sci->name = csci->name;
+		sci->path = csci->path;
+		sci->src = csci->src;
+		sci->strict_val_op = csci->strict_val_op;
+		sci->strict_val = csci->strict_val;
+		sci->extension = csci->extension;
+		sci->tk = csci->tk;
+		sci->fi = csci->fi;
+		sci->lib = csci->lib;
+		sci->code = code;
+		if (top == NULL) {
+			top = sci;
+			AddRefCode(code);
+		} else {
+			psci->next = sci;
+		}
+		sci->sci_top = top;
+		psci = sci;
+	}
+	if (top != NULL) {
+		top->inst = inst;
+	}
+	return top;
+}
+
+/*
+ * CreateScriptContext - 解析結果を共有する実行コンテキストを作成
+ *
+ *	解析木、関数、ライブラリ、ソース情報は参照のみ行い、実行情報のみを持つ
+ *	FreeScriptInfo で解放する
+ */
+SCRIPTINFO *CreateScriptContext(INSTANCEINFO *inst, CODEINFO *code)
+{
+	SCRIPTINFO *sci;
+	INSTANCEINFO *prev;
+
+	prev = SelectInstance(inst);
+	sci = create_context(inst, code);
+	SelectInstance(prev);
+	return sci;
+}
+
+/*
+ * ExecCodeModules - インポートしたスクリプトを記録した順に実行
+ */
+BOOL ExecCodeModules(SCRIPTINFO *sci)
+{
+	CODEINFO *code = sci->code;
+	SCRIPTINFO *msci;
+	VALUEINFO *rvi;
+	int i, j;
+
+	for (i = 0; i < code->order_cnt; i++) {
+		for (msci = sci, j = *(code->order + i); msci != NULL && j > 0; msci = msci->next, j--);
+		if (msci == NULL || msci == sci || msci->ei != NULL) {
+			continue;
+		}
+		rvi = NULL;
+		if (ExecScript(msci, NULL, &rvi) != 0) {
+			FreeValueList(rvi);
+			return FALSE;
+		}
+		FreeValueList(rvi);
+	}
+	return TRUE;
+}
+
+/*
+ * PrepareScript - 解析結果を繰り返し実行するための準備
+ *
+ *	インポートしたスクリプトとトップレベルを引数なしで1回実行し、変数 (グローバル変数) を保持する
+ *	実行ごとの値は巻き戻し用のヒープに確保し、次の実行時にヒープを巻き戻して破棄する
+ *	インスタンスを選択したスレッドから使用する
+ */
+PREPAREINFO *PrepareScript(INSTANCEINFO *inst, CODEINFO *code)
+{
+	PREPAREINFO *pp;
+	MEMHEAP *prev;
+	VALUEINFO *rvi = NULL;
+	int r = -1;
+
+	if (code == NULL) {
+		return NULL;
+	}
+	pp = mem_calloc(sizeof(PREPAREINFO));
+	if (pp == NULL) {
+		return NULL;
+	}
+	AddRefCode(code);
+	pp->code = code;
+	pp->inst = inst;
+	pp->mh = mem_heap_create();
+	pp->run_mh = mem_heap_create_rewind();
+	if (pp->mh == NULL || pp->run_mh == NULL) {
+		FreePrepared(pp);
+		return NULL;
+	}
+	if (inst != NULL) {
+		// 実行用のヒープもインスタンスの上限の対象にする
+		mem_heap_set_parent(pp->mh, inst->mh);
+	}
+	mem_heap_set_parent(pp->run_mh, pp->mh);
+
+	prev = mem_heap_select(pp->mh);
+	pp->sci = create_context(inst, code);
+	if (pp->sci != NULL) {
+		r = ExecScript(pp->sci, NULL, &rvi);
+		FreeValueList(rvi);
+	}
+	mem_heap_select(prev);
+	if (r != 0) {
+		FreePrepared(pp);
+		return NULL;
+	}
+	return pp;
+}
+
+/*
+ * CreateArgs - トップレベルに渡す変数 argv と argc の作成
+ */
+static VALUEINFO *CreateArgs(VALUEINFO *args, int argc)
+{
+	VALUEINFO *vi;
+
+	vi = AllocValue();
+	if (vi == NULL) {
+		return NULL;
+	}
+	vi->next = AllocValue();
+	if (vi->next == NULL) {
+		FreeValue(vi);
+		return NULL;
+	}
+	vi->name = alloc_copy(TEXT("argv"));
+	vi->name_hash = str2hash(TEXT("argv"));
+	vi->v->type = TYPE_ARRAY;
+	vi->next->name = alloc_copy(TEXT("argc"));
+	vi->next->name_hash = str2hash(TEXT("argc"));
+	vi->next->v->type = TYPE_INTEGER;
+	vi->next->v->u.iValue = argc;
+	if (vi->name == NULL || vi->next->name == NULL) {
+		FreeValueList(vi);
+		return NULL;
+	}
+	vi->v->u.array = args;
+	return vi;
+}
+
+/*
+ * InvokeScript - 準備済みスクリプトを実行
+ *
+ *	name を指定した場合は関数を呼び出し、argv を引数として渡す
+ *	関数は準備時の変数を参照し、変数への設定は次の実行以降も保持する
+ *	name が NULL の場合はトップレベルを実行ごとの変数で実行し、argv と argc を変数として渡す (argc が 0 の場合は渡さない)
+ *	argv は実行用のヒープにコピーするため呼び出し側で保持する必要はない
+ *	ret は次の実行か ResetPrepared まで有効
+ *	成功時は 0、エラー時は -1、実行の上限に達した場合は RET_LIMIT を返す
+ */
+int InvokeScript(PREPAREINFO *pp, TCHAR *name, VALUE *argv, int argc, VALUE **ret)
+{
+	MEMHEAP *prev;
+	VALUEINFO *vi, *args = NULL;
+	int r = -1;
+	int i;
+
+	*ret = NULL;
+	ResetPrepared(pp);
+	prev = mem_heap_select(pp->run_mh);
+	SetScriptLimit(pp->sci, pp->step_limit, pp->timeout);
+	if (argc > 0) {
+		// 引数のコピー
+		args = (VALUEINFO *)RET_ERROR;
+		vi = mem_calloc(sizeof(VALUEINFO) * argc);
+		if (vi != NULL) {
+			for (i = 0; i < argc; i++) {
+				(vi + i)->v = argv + i;
+				(vi + i)->next = (i + 1 < argc) ? vi + i + 1 : NULL;
+			}
+			args = CopyValueList(vi);
+			mem_free(&vi);
+		}
+		if (args == (VALUEINFO *)RET_ERROR) {
+			mem_heap_select(prev);
+			return -1;
+		}
+	}
+	if (name == NULL) {
+		pp->ei = mem_calloc(sizeof(EXECINFO));
+		if (pp->ei != NULL) {
+			pp->ei->name = pp->sci->name;
+			pp->ei->sci = pp->sci;
+			if (argc > 0 && (pp->ei->vi = CreateArgs(args, argc)) == NULL) {
+				FreeValueList(args);
+			} else {
+				r = ExecTopLevel(pp->ei, &pp->ret);
+			}
+		}
+	} else {
+		pp->param = args;
+		// エラーはソースの位置ではなく関数名を出力する
+		pp->sci->ei->err = name;
+		vi = ExecFunction(pp->sci->ei, name, args);
+		pp->sci->ei->exit = FALSE;
+		if (vi != (VALUEINFO *)RET_ERROR) {
+			pp->ret = vi;
+			r = 0;
+		} else {
+			r = (pp->sci->limit_over == FALSE) ? -1 : RET_LIMIT;
+		}
+	}
+	mem_heap_select(prev);
+	if (pp->ret != NULL) {
+		*ret = pp->ret->v;
+	}
+	return r;
+}
+
+/*
+ * SetPreparedLimit - 実行ごとの上限を設定
+ */
+void SetPreparedLimit(PREPAREINFO *pp, LONGLONG step_limit, DWORD timeout)
+{
+	pp->step_limit = step_limit;
+	pp->timeout = timeout;
+}
+
+/*
+ * ResetPrepared - 実行ごとの状態を破棄
+ *
+ *	値を個別に解放せずに実行用のヒープを巻き戻す (準備時の変数は残す)
+ *	ライブラリを使用している場合はライブラリが確保した値があるため個別に解放する
+ */
+void ResetPrepared(PREPAREINFO *pp)
+{
+	MEMHEAP *prev;
+
+	if (pp->run_mh == NULL) {
+		return;
+	}
+	if (pp->code->sci->lib != NULL) {
+		prev = mem_heap_select(pp->run_mh);
+		FreeValueList(pp->ret);
+		FreeValueList(pp->param);
+		if (pp->ei != NULL) {
+			FreeExecInfo(pp->ei);
+			mem_free(&pp->ei);
+		}
+		mem_heap_select(prev);
+	}
+	pp->ei = NULL;
+	pp->param = NULL;
+	pp->ret = NULL;
+	mem_heap_rewind(pp->run_mh);
+}
+
+/*
+ * FreePrepared - 実行準備済みスクリプトの解放
+ */
+void FreePrepared(PREPAREINFO *pp)
+{
+	MEMHEAP *prev;
+
+	if (pp == NULL) {
+		return;
+	}
+	ResetPrepared(pp);
+	if (pp->sci != NULL) {
+		if (pp->code->sci->lib != NULL) {
+			prev = mem_heap_select(pp->mh);
+			FreeScriptInfo(pp->sci);
+			mem_heap_select(prev);
+		} else {
+			// コンテキストが持つ参照
+			ReleaseCode(pp->code);
+		}
+	}
+	mem_heap_destroy(pp->run_mh);
+	mem_heap_destroy(pp->mh);
+	ReleaseCode(pp->code);
+	mem_free(&pp);
+}
+/* End of source */
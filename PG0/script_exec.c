@@ -20,28 +20,41 @@
 
 /* Define */
 #define ERR_HEAD				TEXT("Error: ")
-#define LIB_FUNC_HEAD			TEXT("_lib_func_")
 #define ARGUMENT_ADDRESS		TEXT('&')
 #define ARGUMENT_VARIABLE		TEXT("arg")
 
+#define DEADLINE_CHECK_MASK		0xFF
+#define EXEC_SENTENSE(debug, ei, tk, retvi, retstack) \
+	((debug) ? ExecSentenseDebug(ei, tk, retvi, retstack) : ExecSentenseLean(ei, tk, retvi, retstack))
+#define BREAK_BIT_SIZE			(sizeof(LONG) * 8)
+#define IS_BREAK_LINE(bi, line) \
+	((bi) != NULL && (line) >= 0 && (line) < (bi)->line_cnt && \
+	(((DWORD)(bi)->bit[(line) / BREAK_BIT_SIZE] >> ((line) % BREAK_BIT_SIZE)) & 1) != 0)
+#define IS_BREAK_TOKEN(sci, tk)	((tk)->line_head != FALSE && IS_BREAK_LINE((sci)->brk, (tk)->line))
+#define IS_CALLBACK_TOKEN(ei, tk) \
+	((ei)->sci->callback != NULL && ((ei)->sci->break_only == FALSE || IS_BREAK_TOKEN((ei)->sci, tk)))
+#define CHECK_LIMIT(ei)			((ei)->sci->sci_top->limit == FALSE || CheckLimit(ei) != FALSE)
+
 /* Global Variables */
 TCHAR err_jp[][BUF_SIZE] = {
-	TEXT("\G["),
-	TEXT("ZqKvł"),
-	TEXT(" :ϐ`Ă܂"),
-	TEXT(" :ϐ̐錾dĂ܂"),
-	TEXT("z̃CfbNX̒lɂȂĂ܂"),
-	TEXT("Ή銇ʂ܂"),
-	TEXT("ubNu{`}v܂"),
-	TEXT("0 ŏZ܂"),
-	TEXT("sȉZqł"),
-	TEXT("zɎgȂZqł"),
-	TEXT("̊mۂɎs܂"),
-	TEXT("Ȃ܂"),
-	TEXT("t@CI[vɎs܂"),
-	TEXT("XNvg܂̓Cu̓ǂݍ݂Ɏs܂"),
-	TEXT("֐܂"),
-	TEXT("֐sɃG[܂"),
+	TEXT("構文エラー"),
+	TEXT("演算子が必要です"),
+	TEXT(" :変数が定義されていません"),
+	TEXT(" :変数の宣言が重複しています"),
+	TEXT("配列のインデックスが負の値になっています"),
+	TEXT("対応する括弧がありません"),
+	TEXT("ブロック「{～}」がありません"),
+	TEXT("0 で除算をしました"),
+	TEXT("不正な演算子です"),
+	TEXT("配列に使えない演算子です"),
+	TEXT("メモリの確保に失敗しました"),
+	TEXT("引数が少なすぎます"),
+	TEXT("ファイルオープンに失敗しました"),
+	TEXT("スクリプトまたはライブラリの読み込みに失敗しました"),
+	TEXT("関数が見つかりません"),
+	TEXT("関数実行中にエラーが発生しました"),
+	TEXT("実行の上限に達しました"),
+	TEXT("ライブラリのバージョンが異なります"),
 };
 
 TCHAR err_en[][BUF_SIZE] = {
@@ -61,12 +74,19 @@ TCHAR err_en[][BUF_SIZE] = {
 	TEXT("Read error in script or library"),
 	TEXT("Function not Found"),
 	TEXT("Function error"),
+	TEXT("Execution limit exceeded"),
+	TEXT("Library version mismatch"),
 };
 
 /* Local Function Prototypes */
-static void SetValue(VALUE *to_v, VALUE *from_v);
+static void OutputError(EXECINFO *pei, TCHAR *err_str, int line);
+static BOOL CheckLimit(EXECINFO *ei);
+static int ExecSentenseDebug(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack);
+static int ExecSentenseLean(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack);
+static BOOL SetValue(VALUE *to_v, VALUE *from_v);
 static VALUEINFO *IndexToArray(EXECINFO *ei, VALUEINFO *pvi, int index);
 static VALUEINFO *GetArrayValue(EXECINFO *ei, VALUEINFO *pvi, VALUE *keyv);
+static BOOL SetArrayKey(VALUEINFO *vi, TCHAR *lower_key, TCHAR *key, int name_hash);
 static VALUEINFO *DeclVariable(EXECINFO *ei, TCHAR *name, TCHAR *err);
 static VALUEINFO *FindValueInfo(VALUEINFO *vi, TCHAR *name);
 static VALUEINFO *AddValueInfo(VALUEINFO **vi_root, TCHAR *name, VALUE *v);
@@ -80,84 +100,71 @@ static VALUEINFO *ArrayCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int
 static VALUEINFO *CalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int c);
 
 /*
- * InitializeScript - XNvg̏
+ * InitializeScript - スクリプトの初期化
  */
 
 void InitializeScript()
 {
-	//֐e[ȕ
+	//関数テーブルの初期化
 	InitFuncAddress();
 }
 
 /*
- * EndScript - XNvg̏I
+ * EndScript - スクリプトの終了処理
  */
 void EndScript()
 {
 }
 
 /*
- * Error - G[
+ * Error - エラー
  */
 void Error(EXECINFO *ei, ERROR_CODE err_id, TCHAR *msg, TCHAR *pre_str)
 {
 	EXECINFO *pei = ei;
-	VALUEINFO *vi, *pvi;
-	LIBFUNC StdFunc;
+	MEMHEAP *mh;
 	TCHAR buf[BUF_SIZE];
-	TCHAR ErrStr[BUF_SIZE];
+	TCHAR msg_buf[BUF_SIZE];
 	TCHAR *err = TEXT("");
 	TCHAR *description = TEXT("");
 	TCHAR *err_str;
-	TCHAR *p, *r, *s, *t = NULL;
+	TCHAR *p, *t = NULL;
 	int line = 0;
 	int size;
-	int i;
 	WORD lang;
 
 	for (; pei->parent != NULL; pei = pei->parent);
 
-	// G[̎擾
+	// エラーの取得
 	lang = PRIMARYLANGID(LANGIDFROMLCID(GetThreadLocale()));
 	if (lang == LANG_JAPANESE) {
 		err = err_jp[err_id];
 	} else {
 		err = err_en[err_id];
 	}
-	//sԍ̎擾
-	if (pei->sci != NULL && pei->sci->buf != NULL) {
-		p = NULL;
-		if (msg != NULL && msg >= pei->sci->buf && msg <= (pei->sci->buf + lstrlen(pei->sci->buf))) {
-			p = msg;
-		} else if (ei->err != NULL && ei->err >= pei->sci->buf && ei->err <= (pei->sci->buf + lstrlen(pei->sci->buf))) {
-			p = ei->err;
-		}
-		if (p != NULL) {
-			i = 1;
-			for (r = pei->sci->buf; r < p; r++) {
-				if (*r == TEXT('\n')) {
-					i++;
-				}
-			}
-			line = i;
+	// メモリの上限に達している場合も出力できるようにプロセスのヒープを使用する
+	mh = mem_heap_select(NULL);
+	//行番号の取得
+	if (pei->sci != NULL) {
+		if (msg != NULL && GetSourcePosition(pei->sci, msg, &line, NULL) == TRUE) {
+			// エラー説明の取得
+			t = GetSourceLine(pei->sci, line);
+			if (t != NULL) {
+				description = t;
+			}
+		} else if (GetSourcePosition(pei->sci, ei->err, &line, NULL) == FALSE) {
+			line = 0;
 		}
 	}
-	// G[̎擾
-	if (msg != NULL && pei->sci != NULL && pei->sci->buf != NULL && msg >= pei->sci->buf && msg <= (pei->sci->buf + lstrlen(pei->sci->buf))) {
-		for (s = r = pei->sci->buf; r < msg; r++) {
-			if (*r == TEXT('\n')) {
-				s = r;
-			}
-		}
-		for (; *s == TEXT('\r') || *s == TEXT('\n') || *s == TEXT('\t') || *s == TEXT(' '); s++);
-		for (r = s; *r != TEXT('\0') && *r != TEXT('\r') && *r != TEXT('\n'); r++);
-		t = alloc_copy_n(s, (int)(r - s));
-		description = t;
-	} else if (msg != NULL) {
-		description = msg;
+	if (t == NULL && msg != NULL && (pei->sci == NULL || IsReleasedSource(pei->sci, msg) == FALSE)) {
+		// 解放済みのソースは参照せずに行番号のみ出力する
+		lstrcpyn(msg_buf, msg, BUF_SIZE);
+		for (p = msg_buf; *p != TEXT('\0') && *p != TEXT('\r') && *p != TEXT('\n'); p++);
+		*p = TEXT('\0');
+		description = msg_buf;
 	}
 
-	// G[bZ[W̃TCYvZ
+	// エラーメッセージのサイズ計算
 	size = lstrlen(ERR_HEAD);
 	if (pei->sci != NULL && pei->sci->name != NULL) {
 		size += lstrlen(TEXT("["));
@@ -173,9 +180,13 @@ void Error(EXECINFO *ei, ERROR_CODE err_id, TCHAR *msg, TCHAR *pre_str)
 	size += lstrlen(TEXT("): "));
 	size += lstrlen(description);
 
-	// G[bZ[W̍\z
+	// エラーメッセージの構築
 	err_str = mem_alloc(sizeof(TCHAR) * (size + 1));
 	if (err_str == NULL) {
+		if (t != NULL) {
+			mem_free(&t);
+		}
+		mem_heap_select(mh);
 		return;
 	}
 	p = str_cpy(err_str, ERR_HEAD);
@@ -196,8 +207,49 @@ void Error(EXECINFO *ei, ERROR_CODE err_id, TCHAR *msg, TCHAR *pre_str)
 		mem_free(&t);
 	}
 
-	//G[bZ[W̏o
-	StdFunc = GetFuncAddress(LIB_FUNC_HEAD TEXT("error"));
+	if (pei->sci != NULL && pei->sci->hold_error == TRUE) {
+		// 並列解析中は最初のエラーを保留する
+		if (pei->sci->hold_err_str == NULL) {
+			pei->sci->hold_err_str = err_str;
+			pei->sci->hold_err_line = line;
+		} else {
+			mem_free(&err_str);
+		}
+		mem_heap_select(mh);
+		return;
+	}
+	OutputError(pei, err_str, line);
+	mem_heap_select(mh);
+}
+
+/*
+ * FlushError - 保留中のエラーを出力
+ */
+void FlushError(SCRIPTINFO *sci)
+{
+	EXECINFO ei;
+
+	sci->hold_error = FALSE;
+	if (sci->hold_err_str == NULL) {
+		return;
+	}
+	ZeroMemory(&ei, sizeof(EXECINFO));
+	ei.sci = sci;
+	OutputError(&ei, sci->hold_err_str, sci->hold_err_line);
+	sci->hold_err_str = NULL;
+}
+
+/*
+ * OutputError - エラーメッセージの出力
+ */
+static void OutputError(EXECINFO *pei, TCHAR *err_str, int line)
+{
+	VALUEINFO *vi, *pvi;
+	LIBFUNC StdFunc;
+	TCHAR ErrStr[BUF_SIZE];
+
+	//エラーメッセージの出力
+	StdFunc = GetInstanceFunc(pei->sci, LIB_FUNC_HEAD TEXT("error"));
 	if (StdFunc == NULL) {
 		mem_free(&err_str);
 		return;
@@ -215,6 +267,7 @@ void Error(EXECINFO *ei, ERROR_CODE err_id, TCHAR *msg, TCHAR *pre_str)
 	}
 	pvi->v->u.sValue = err_str;
 	pvi->v->type = TYPE_STRING;
+	STAT_ADD(alloc[STAT_OBJ_STRING], 1);
 	if (pei->sci != NULL && pei->sci == pei->sci->sci_top) {
 		pvi->next = AllocValue();
 		if (pvi->next == NULL) {
@@ -233,7 +286,7 @@ void Error(EXECINFO *ei, ERROR_CODE err_id, TCHAR *msg, TCHAR *pre_str)
 }
 
 /*
- * FreeToken - g[N̉
+ * FreeToken - トークンの解放
  */
 void FreeToken(TOKEN *tk)
 {
@@ -247,7 +300,7 @@ void FreeToken(TOKEN *tk)
 }
 
 /*
- * FreeFuncAddrList - ֐AhXXg̉
+ * FreeFuncAddrList - 関数アドレスリストの解放
  */
 void FreeFuncAddrList(FUNCADDRINFO *fa)
 {
@@ -255,12 +308,13 @@ void FreeFuncAddrList(FUNCADDRINFO *fa)
 		FUNCADDRINFO *tmpfa = fa->next;
 		mem_free(&(fa->name));
 		mem_free(&fa);
+		STAT_ADD(free[STAT_OBJ_FUNCADDR], 1);
 		fa = tmpfa;
 	}
 }
 
 /*
- * FreeExecInfo - s̉
+ * FreeExecInfo - 実行情報の解放
  */
 void FreeExecInfo(EXECINFO *ei)
 {
@@ -277,7 +331,7 @@ void FreeExecInfo(EXECINFO *ei)
 }
 
 /*
- * FreeFuncInfo - ֐̉
+ * FreeFuncInfo - 関数情報の解放
  */
 void FreeFuncInfo(FUNCINFO *fi)
 {
@@ -289,7 +343,7 @@ void FreeFuncInfo(FUNCINFO *fi)
 }
 
 /*
- * FreeLibInfo - Củ
+ * FreeLibInfo - ライブラリ情報の解放
  */
 void FreeLibInfo(LIBRARYINFO *lib)
 {
@@ -301,28 +355,41 @@ void FreeLibInfo(LIBRARYINFO *lib)
 }
 
 /*
- * FreeScriptInfo - XNvg̉
+ * FreeScriptInfo - スクリプト情報の解放
  */
 void FreeScriptInfo(SCRIPTINFO *sci)
 {
 	if (sci == NULL) return;
 	FreeScriptInfo(sci->next);
+	FreeModuleInfo(sci);
+
+	mem_free(&sci->hold_err_str);
+	mem_free(&sci->brk);
+	if (sci->code == NULL) {
+		mem_free(&sci->name);
+		mem_free(&sci->path);
+		if (sci->src != NULL) {
+			FreeSourceInfo(sci->src);
+			sci->buf = NULL;
+		}
+		mem_free(&sci->buf);
 
-	mem_free(&sci->name);
-	mem_free(&sci->path);
-	mem_free(&sci->buf);
-
-	FreeToken(sci->tk);
-	FreeFuncInfo(sci->fi);
-	FreeLibInfo(sci->lib);
+		FreeToken(sci->tk);
+		FreeFuncInfo(sci->fi);
+		FreeLibInfo(sci->lib);
+	}
 	FreeExecInfo(sci->ei);
 	mem_free(&sci->ei);
 
+	if (sci->code != NULL && sci->sci_top == sci) {
+		// 共有している解析結果の参照を解放
+		ReleaseCode(sci->code);
+	}
 	mem_free(&sci);
 }
 
 /*
- * InitializeScriptInfo - XNvg̏
+ * InitializeScriptInfo - スクリプト情報の初期化
  */
 void InitializeScriptInfo(SCRIPTINFO *sci, BOOL op_exp, BOOL op_extension)
 {
@@ -334,24 +401,66 @@ void InitializeScriptInfo(SCRIPTINFO *sci, BOOL op_exp, BOOL op_extension)
 }
 
 /*
- * SetValue - l̐ݒ
+ * CheckLimit - 実行の上限のチェック
+ *
+ *	ループの先頭へのジャンプとスクリプト関数の呼び出し時にのみチェックする
+ *	時刻の取得は DEADLINE_CHECK_MASK + 1 回ごとに行う
  */
-static void SetValue(VALUE *to_v, VALUE *from_v)
+static BOOL CheckLimit(EXECINFO *ei)
+{
+	SCRIPTINFO *top = ei->sci->sci_top;
+
+	top->step++;
+	if ((top->step_limit > 0 && top->step > top->step_limit) ||
+		(top->deadline != 0 && (top->step & DEADLINE_CHECK_MASK) == 0 && GetTickCount64() >= top->deadline)) {
+		top->limit_over = TRUE;
+		Error(ei, ERR_LIMIT, ei->err, NULL);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * SetValue - 値の設定
+ *
+ *	メモリの確保に失敗した場合は値を変更せずに FALSE を返す
+ *	配列と文字列は設定先の値と同じヒープに確保する (準備済みスクリプトの変数を実行中に更新する場合)
+ */
+static BOOL SetValue(VALUE *to_v, VALUE *from_v)
 {
 	VALUE tmp_v = *to_v;
 	VALUE_TYPE type = from_v->type;
+	VALUEINFO *array;
+	MEMHEAP *mh;
+	TCHAR *str;
 
 	switch (from_v->type) {
 	case TYPE_ARRAY:
-		// z
-		to_v->u.array = CopyValueList(from_v->u.array);
+		// 配列
+		mh = mem_heap_select(mem_heap_owner(to_v));
+		array = CopyValueList(from_v->u.array);
+		mem_heap_select(mh);
+		if (array == (VALUEINFO *)RET_ERROR) {
+			return FALSE;
+		}
+		to_v->u.array = array;
 		break;
 	case TYPE_STRING:
-		// 
-		to_v->u.sValue = alloc_copy(from_v->u.sValue);
+		// 文字列
+		str = NULL;
+		if (from_v->u.sValue != NULL) {
+			mh = mem_heap_select(mem_heap_owner(to_v));
+			str = alloc_copy(from_v->u.sValue);
+			mem_heap_select(mh);
+			if (str == NULL) {
+				return FALSE;
+			}
+			StatString(from_v->u.sValue);
+		}
+		to_v->u.sValue = str;
 		break;
 	case TYPE_FLOAT:
-		// 
+		// 実数
 		if (from_v->u.fValue == (double)((int)from_v->u.fValue)) {
 			to_v->u.iValue = (int)from_v->u.fValue;
 			type = TYPE_INTEGER;
@@ -360,21 +469,24 @@ static void SetValue(VALUE *to_v, VALUE *from_v)
 		}
 		break;
 	default:
-		// 
+		// 整数
 		to_v->u.iValue = from_v->u.iValue;
 		break;
 	}
 	to_v->type = type;
+	VALUE_MODIFIED(to_v);
 
 	if (tmp_v.type == TYPE_ARRAY) {
 		FreeValueList(tmp_v.u.array);
-	} else if (tmp_v.type == TYPE_STRING) {
+	} else if (tmp_v.type == TYPE_STRING && tmp_v.u.sValue != NULL) {
 		mem_free(&tmp_v.u.sValue);
+		STAT_ADD(free[STAT_OBJ_STRING], 1);
 	}
+	return TRUE;
 }
 
 /*
- * IndexToArray - CfbNXŔzvf擾
+ * IndexToArray - インデックスで配列要素を取得
  */
 static VALUEINFO *IndexToArray(EXECINFO *ei, VALUEINFO *pvi, int index)
 {
@@ -383,17 +495,19 @@ static VALUEINFO *IndexToArray(EXECINFO *ei, VALUEINFO *pvi, int index)
 	int i = 0;
 
 	if (index < 0) {
-		//sȃCfbNX
+		//不正なインデックス
 		Error(ei, ERR_INDEX, ei->err, NULL);
 		return NULL;
 	}
 
 	if (vi->v->type != TYPE_ARRAY) {
-		if (vi->v->type == TYPE_STRING) {
+		if (vi->v->type == TYPE_STRING && vi->v->u.sValue != NULL) {
 			mem_free(&vi->v->u.sValue);
+			STAT_ADD(free[STAT_OBJ_STRING], 1);
 		}
-		// 0 Ԗڂ̒ǉ
+		// 0 番目の追加
 		vi->v->type = TYPE_ARRAY;
+		VALUE_MODIFIED(vi->v);
 		vi = vi->v->u.array = AllocValue();
 		if (vi == NULL) {
 			Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -404,10 +518,14 @@ static VALUEINFO *IndexToArray(EXECINFO *ei, VALUEINFO *pvi, int index)
 	else if (vi->v->u.array == NULL) {
 		vi->v->u.array = AllocValue();
 		vi = vi->v->u.array;
+		if (vi == NULL) {
+			Error(ei, ERR_ALLOC, ei->err, NULL);
+			return NULL;
+		}
 		i++;
 	} else {
 		VALUEINFO *tmpvi = NULL;
-		//ʒu
+		//位置検索
 		for (vi = vi->v->u.array; vi != NULL; vi = vi->next, i++) {
 			if (i == index) {
 				return vi;
@@ -420,7 +538,7 @@ static VALUEINFO *IndexToArray(EXECINFO *ei, VALUEINFO *pvi, int index)
 			return NULL;
 		}
 	}
-	//
+	//延長
 	topvi = vi;
 	for (; i <= index; i++) {
 		vi = vi->next = AllocValue();
@@ -431,11 +549,12 @@ static VALUEINFO *IndexToArray(EXECINFO *ei, VALUEINFO *pvi, int index)
 			return NULL;
 		}
 	}
+	VALUE_MODIFIED(pvi->v);
 	return vi;
 }
 
 /*
- * GetArrayValue - z̎擾
+ * GetArrayValue - 配列の取得
  */
 static VALUEINFO *GetArrayValue(EXECINFO *ei, VALUEINFO *pvi, VALUE *keyv)
 {
@@ -446,11 +565,11 @@ static VALUEINFO *GetArrayValue(EXECINFO *ei, VALUEINFO *pvi, VALUE *keyv)
 	int i = 0;
 
 	if (keyv->type != TYPE_STRING) {
-		//CfbNXŎQ
+		//インデックスで参照
 		return IndexToArray(ei, pvi, GetValueInt(keyv));
 	}
 
-	//L[ŎQ
+	//キーで参照
 	key = keyv->u.sValue;
 	TCHAR* tmp_key = _alloca(sizeof(TCHAR) * (lstrlen(key) + 1));
 	if (tmp_key == NULL) {
@@ -461,25 +580,26 @@ static VALUEINFO *GetArrayValue(EXECINFO *ei, VALUEINFO *pvi, VALUE *keyv)
 	name_hash = str2hash(tmp_key);
 
 	if (vi->v->type != TYPE_ARRAY) {
-		if (vi->v->type == TYPE_STRING) {
+		if (vi->v->type == TYPE_STRING && vi->v->u.sValue != NULL) {
 			mem_free(&vi->v->u.sValue);
+			STAT_ADD(free[STAT_OBJ_STRING], 1);
 		}
-		//VKǉ
+		//新規追加
 		vi->v->type = TYPE_ARRAY;
-		vi = vi->v->u.array = AllocValue();
-		if (vi == NULL) {
+		vi->v->u.array = NULL;
+		vi = AllocValue();
+		if (vi == NULL || SetArrayKey(vi, tmp_key, key, name_hash) == FALSE) {
+			FreeValue(vi);
+			VALUE_MODIFIED(pvi->v);
 			Error(ei, ERR_ALLOC, ei->err, NULL);
 			return NULL;
 		}
-		vi->name = alloc_copy(tmp_key);
-#ifndef PG0_CMD
-		vi->org_name = alloc_copy(key);
-#endif
-		vi->name_hash = name_hash;
+		pvi->v->u.array = vi;
+		VALUE_MODIFIED(pvi->v);
 		return vi;
 	}
 
-	//
+	//検索
 	for (vi = vi->v->u.array; vi != NULL; vi = vi->next) {
 		if (vi->name != NULL &&
 			name_hash == vi->name_hash && lstrcmp(tmp_key, vi->name) == 0) {
@@ -488,59 +608,84 @@ static VALUEINFO *GetArrayValue(EXECINFO *ei, VALUEINFO *pvi, VALUE *keyv)
 		kvi = vi;
 	}
 	if (vi == NULL) {
-		//L[ǉ
-		vi = kvi->next = AllocValue();
-		if (vi == NULL) {
+		//キーを追加
+		vi = AllocValue();
+		if (vi == NULL || SetArrayKey(vi, tmp_key, key, name_hash) == FALSE) {
+			FreeValue(vi);
 			Error(ei, ERR_ALLOC, ei->err, NULL);
 			return NULL;
 		}
-		vi->name = alloc_copy(tmp_key);
-#ifndef PG0_CMD
-		vi->org_name = alloc_copy(key);
-#endif
-		if (vi->name != NULL) {
-			str_lower(vi->name);
+		if (kvi == NULL) {
+			//空の配列
+			pvi->v->u.array = vi;
+		} else {
+			kvi->next = vi;
 		}
-		vi->name_hash = name_hash;
+		VALUE_MODIFIED(pvi->v);
 	}
 	return vi;
 }
 
 /*
- * GetVariable - ϐ擾
+ * SetArrayKey - 配列要素のキーを設定
+ */
+static BOOL SetArrayKey(VALUEINFO *vi, TCHAR *lower_key, TCHAR *key, int name_hash)
+{
+	vi->name = alloc_copy(lower_key);
+	if (vi->name == NULL) {
+		return FALSE;
+	}
+#ifndef PG0_CMD
+	vi->org_name = alloc_copy(key);
+	if (vi->org_name == NULL) {
+		return FALSE;
+	}
+#endif
+	vi->name_hash = name_hash;
+	return TRUE;
+}
+
+/*
+ * GetVariable - 変数を取得
  */
 VALUEINFO *GetVariable(EXECINFO *ei, TCHAR *name)
 {
 	VALUEINFO *vi = NULL;
+	int depth = 0;
 
-	//ϐ̌
+	//変数の検索
 	for (; ei != NULL; ei = ei->parent) {
+		depth++;
 		vi = FindValueInfo(ei->vi, name);
 		if (vi != NULL) {
 			break;
 		}
 	}
+	if (cur_stat != NULL) {
+		cur_stat->var_lookup++;
+		cur_stat->var_depth += depth;
+		cur_stat->var_hist[(vi == NULL) ? 0 : ((depth < STAT_DEPTH_SIZE) ? depth : STAT_DEPTH_SIZE - 1)]++;
+	}
 	return vi;
 }
 
 /*
- * SetVariable - ϐݒ
+ * SetVariable - 変数を設定
  */
 BOOL SetVariable(EXECINFO *ei, TCHAR *name, VALUE *v)
 {
 	VALUEINFO *vi;
 
-	//ϐ̐ݒ
+	//変数の設定
 	vi = GetVariable(ei, name);
 	if (vi != NULL) {
-		SetValue(vi->v, v);
-		return TRUE;
+		return SetValue(vi->v, v);
 	}
 	return ((AddValueInfo(&(ei->vi), name, v) == NULL) ? FALSE : TRUE);
 }
 
 /*
- * DeclVariable - ϐ`
+ * DeclVariable - 変数定義
  */
 static VALUEINFO *DeclVariable(EXECINFO *ei, TCHAR *name, TCHAR *err)
 {
@@ -551,7 +696,7 @@ static VALUEINFO *DeclVariable(EXECINFO *ei, TCHAR *name, TCHAR *err)
 		return NULL;
 	}
 	if (FindValueInfo(ei->vi, name) != NULL) {
-		//ϐ̏d`
+		//変数の重複定義
 		Error(ei, ERR_DECLARE, err, name);
 		return NULL;
 	}
@@ -564,7 +709,7 @@ static VALUEINFO *DeclVariable(EXECINFO *ei, TCHAR *name, TCHAR *err)
 }
 
 /*
- * FindValueInfo - ϐ̌
+ * FindValueInfo - 変数の検索
  */
 static VALUEINFO *FindValueInfo(VALUEINFO *vi, TCHAR *name)
 {
@@ -587,65 +732,77 @@ static VALUEINFO *FindValueInfo(VALUEINFO *vi, TCHAR *name)
 }
 
 /*
- * AddValueInfo - ϐ̒ǉ
+ * AddValueInfo - 変数の追加
  */
 static VALUEINFO *AddValueInfo(VALUEINFO **vi_root, TCHAR *name, VALUE *v)
 {
-	VALUEINFO *vi;
+	VALUEINFO *vi, *pvi;
 
-	if (*vi_root == NULL) {
-		vi = *vi_root = AllocValue();
-	} else {
-		for (vi = *vi_root; vi->next != NULL; vi = vi->next);
-		vi = vi->next = AllocValue();
-	}
+	vi = AllocValue();
 	if (vi == NULL) {
 		return NULL;
 	}
 	vi->name = alloc_copy(name);
-	if (vi->name != NULL) {
-		str_lower(vi->name);
+	if (vi->name == NULL) {
+		FreeValue(vi);
+		return NULL;
 	}
+	str_lower(vi->name);
 	vi->name_hash = str2hash(vi->name);
 #ifndef PG0_CMD
 	vi->org_name = alloc_copy(name);
+	if (vi->org_name == NULL) {
+		FreeValue(vi);
+		return NULL;
+	}
 #endif
 	if (v == NULL) {
 		vi->v->u.iValue = 0;
 		vi->v->type = TYPE_INTEGER;
+	} else if (SetValue(vi->v, v) == FALSE) {
+		FreeValue(vi);
+		return NULL;
+	}
+
+	// リストの末尾に追加
+	if (*vi_root == NULL) {
+		*vi_root = vi;
 	} else {
-		SetValue(vi->v, v);
+		for (pvi = *vi_root; pvi->next != NULL; pvi = pvi->next);
+		pvi->next = vi;
 	}
 	return vi;
 }
 
 /*
- * FindCase - case ڂ̌
+ * FindCase - case 項目の検索
  */
 static TOKEN *FindCase(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO *v1)
 {
 	VALUEINFO *vi, *v2;
 	TOKEN *tmp_tk;
 	BOOL cp;
+	int ret;
 
-	//case ڂ̌
+	//case 項目の検索
 	for (tmp_tk = cu_tk->target; tmp_tk != NULL; tmp_tk = tmp_tk->next) {
 		if (tmp_tk->sym_type != SYM_CASE) {
 			continue;
 		}
 		v2 = NULL;
 		ei->to_tk = SYM_LABELEND;
-		if (ExecSentense(ei, tmp_tk->next, NULL, &v2) == -1) {
+		ret = ExecSentense(ei, tmp_tk->next, NULL, &v2);
+		if (ret == RET_ERROR || ret == RET_LIMIT) {
 			return NULL;
 		}
 		ei->to_tk = 0;
 
-		//X^bN̓eo
+		//スタックの内容を取り出す
 		if (v2 == NULL) {
 			return NULL;
 		}
 
-		//r
+		//比較
 		vi = CalcValue(ei, v2, v1, SYM_EQEQ);
 		FreeValue(v2);
 		if (vi == NULL) {
@@ -654,11 +811,11 @@ static TOKEN *FindCase(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO *v1)
 		cp = GetValueBoolean(vi->v);
 		FreeValue(vi);
 		if (cp != FALSE) {
-			//}b`
+			//マッチ
 			break;
 		}
 	}
-	//default ̌
+	//default の検索
 	if (tmp_tk == NULL) {
 		for (tmp_tk = cu_tk->target; tmp_tk != NULL &&
 			tmp_tk->sym_type != SYM_DEFAULT; tmp_tk = tmp_tk->next);
@@ -667,7 +824,7 @@ static TOKEN *FindCase(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO *v1)
 }
 
 /*
-* UnaryCalcValueFloat - PZq̌vZ(Float)
+* UnaryCalcValueFloat - 単項演算子の計算(Float)
 */
 static VALUEINFO *UnaryCalcValueFloat(EXECINFO *ei, VALUEINFO *vi, int c)
 {
@@ -695,11 +852,13 @@ static VALUEINFO *UnaryCalcValueFloat(EXECINFO *ei, VALUEINFO *vi, int c)
 	case SYM_INC:
 		f++;
 		vi->v->u.fValue = f;
+		VALUE_MODIFIED(vi->v);
 		break;
 
 	case SYM_DEC:
 		f--;
 		vi->v->u.fValue = f;
+		VALUE_MODIFIED(vi->v);
 		break;
 
 	case SYM_BINC:
@@ -743,7 +902,7 @@ static VALUEINFO *UnaryCalcValueFloat(EXECINFO *ei, VALUEINFO *vi, int c)
 }
 
 /*
- * UnaryCalcValue - PZq̌vZ
+ * UnaryCalcValue - 単項演算子の計算
  */
 static VALUEINFO *UnaryCalcValue(EXECINFO *ei, VALUEINFO *vi, int c)
 {
@@ -771,11 +930,13 @@ static VALUEINFO *UnaryCalcValue(EXECINFO *ei, VALUEINFO *vi, int c)
 	case SYM_INC:
 		i++;
 		vi->v->u.iValue = i;
+		VALUE_MODIFIED(vi->v);
 		break;
 
 	case SYM_DEC:
 		i--;
 		vi->v->u.iValue = i;
+		VALUE_MODIFIED(vi->v);
 		break;
 
 	case SYM_BINC:
@@ -814,7 +975,7 @@ static VALUEINFO *UnaryCalcValue(EXECINFO *ei, VALUEINFO *vi, int c)
 }
 
 /*
- * UnaryCalcString - PZq̌vZ(String)
+ * UnaryCalcString - 単項演算子の計算(String)
  */
 static VALUEINFO* UnaryCalcString(EXECINFO* ei, VALUEINFO* vi, int c)
 {
@@ -843,7 +1004,7 @@ static VALUEINFO* UnaryCalcString(EXECINFO* ei, VALUEINFO* vi, int c)
 }
 
 /*
- * IntegerCalcValue - ̌vZ
+ * IntegerCalcValue - 整数の計算
  */
 static VALUEINFO *IntegerCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int c)
 {
@@ -902,7 +1063,7 @@ static VALUEINFO *IntegerCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, i
 }
 
 /*
- * FloatCalcValue - ̌vZ
+ * FloatCalcValue - 実数の計算
  */
 static VALUEINFO *FloatCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int c)
 {
@@ -971,7 +1132,7 @@ static VALUEINFO *FloatCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int
 }
 
 /*
- * StringCalcValue - ^̌vZ
+ * StringCalcValue - 文字列型の計算
  */
 static VALUEINFO *StringCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int c)
 {
@@ -995,10 +1156,17 @@ static VALUEINFO *StringCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, in
 	} else {
 		p2 = v2->v->u.sValue;
 	}
+	if ((v1->v->type != TYPE_STRING && p1 == NULL) || (v2->v->type != TYPE_STRING && p2 == NULL)) {
+		// 数値の文字列変換に失敗
+		Error(ei, ERR_ALLOC, ei->err, NULL);
+		mem_free(&f1);
+		mem_free(&f2);
+		return NULL;
+	}
 
 	switch (c) {
 	case SYM_ADD:
-		//񌋍
+		//文字列結合
 		p = mem_alloc(sizeof(TCHAR) * (lstrlen(p1) + lstrlen(p2) + 1));
 		if (p == NULL) {
 			Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1019,6 +1187,7 @@ static VALUEINFO *StringCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, in
 		}
 		vret->v->u.sValue = p;
 		vret->v->type = TYPE_STRING;
+		STAT_ADD(alloc[STAT_OBJ_STRING], 1);
 		mem_free(&f1);
 		mem_free(&f2);
 		return vret;
@@ -1051,7 +1220,7 @@ static VALUEINFO *StringCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, in
 }
 
 /*
- * ArrayCalcValue - žvZ
+ * ArrayCalcValue - 配列の計算
  */
 static VALUEINFO *ArrayCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int c)
 {
@@ -1061,33 +1230,42 @@ static VALUEINFO *ArrayCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int
 
 	switch (c) {
 	case SYM_ADD:
-		//z̘A
+		//配列の連結
 		vret = AllocValue();
 		if (vret == NULL) {
 			Error(ei, ERR_ALLOC, ei->err, NULL);
 			return NULL;
 		}
+		vret->v->type = TYPE_ARRAY;
+		vi = NULL;
 		if (v1->v->type == TYPE_ARRAY) {
-			vret->v->u.array = CopyValueList(v1->v->u.array);
-			vret->v->type = TYPE_ARRAY;
-			if (v2->v->type == TYPE_ARRAY) {
-				//A
+			vret->v->u.array = vi = CopyValueList(v1->v->u.array);
+		}
+		if (vi != (VALUEINFO *)RET_ERROR && v2->v->type == TYPE_ARRAY) {
+			vi = CopyValueList(v2->v->u.array);
+			if (vi != (VALUEINFO *)RET_ERROR) {
+				//連結
 				if (vret->v->u.array == NULL) {
-					vret->v->u.array = CopyValueList(v2->v->u.array);
+					vret->v->u.array = vi;
 				} else {
-					for (vi = vret->v->u.array; vi->next != NULL; vi = vi->next);
-					vi->next = CopyValueList(v2->v->u.array);
+					for (v1 = vret->v->u.array; v1->next != NULL; v1 = v1->next);
+					v1->next = vi;
 				}
 			}
-		} else {
-			vret->v->u.array = CopyValueList(v2->v->u.array);
-			vret->v->type = TYPE_ARRAY;
+		}
+		if (vi == (VALUEINFO *)RET_ERROR) {
+			if (vret->v->u.array == (VALUEINFO *)RET_ERROR) {
+				vret->v->u.array = NULL;
+			}
+			FreeValue(vret);
+			Error(ei, ERR_ALLOC, ei->err, NULL);
+			return NULL;
 		}
 		return vret;
 
 	case SYM_EQEQ:
 	case SYM_NTEQ:
-		//z̓er
+		//配列の内容比較
 		if (v1->v->type == TYPE_ARRAY && v2->v->type == TYPE_ARRAY) {
 			for (v1 = v1->v->u.array, v2 = v2->v->u.array; v1 != NULL && v2 != NULL; v1 = v1->next, v2 = v2->next) {
 				BOOL cp;
@@ -1124,27 +1302,27 @@ static VALUEINFO *ArrayCalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int
 }
 
 /*
- * CalcValue - 񍀉Zq̌vZ
+ * CalcValue - 二項演算子の計算
  */
 static VALUEINFO *CalcValue(EXECINFO *ei, VALUEINFO *v1, VALUEINFO *v2, int c)
 {
 	if (v1->v->type == TYPE_ARRAY || v2->v->type == TYPE_ARRAY) {
-		// žvZ
+		// 配列の計算
 		return ArrayCalcValue(ei, v1, v2, c);
 	} else if (v1->v->type == TYPE_STRING || v2->v->type == TYPE_STRING) {
-		// ^̌vZ
+		// 文字列型の計算
 		return StringCalcValue(ei, v1, v2, c);
 	} else if (v1->v->type == TYPE_FLOAT || v2->v->type == TYPE_FLOAT) {
-		// ̌vZ
+		// 実数の計算
 		return FloatCalcValue(ei, v1, v2, c);
 	} else {
-		// ̌vZ
+		// 整数の計算
 		return IntegerCalcValue(ei, v1, v2, c);
 	}
 }
 
 /*
- * PostfixValue - ǔvZ
+ * PostfixValue - 後置式の計算
  */
 static BOOL PostfixValue(EXECINFO *ei)
 {
@@ -1162,6 +1340,7 @@ static BOOL PostfixValue(EXECINFO *ei)
 			Error(ei, ERR_OPERATOR, ei->err, NULL);
 			return FALSE;
 		}
+		VALUE_MODIFIED(vi->v);
 		FreeValue(vi);
 	}
 	while (ei->dec_vi != NULL) {
@@ -1176,31 +1355,44 @@ static BOOL PostfixValue(EXECINFO *ei)
 			Error(ei, ERR_OPERATOR, ei->err, NULL);
 			return FALSE;
 		}
+		VALUE_MODIFIED(vi->v);
 		FreeValue(vi);
 	}
 	return TRUE;
 }
 
 /*
- * ExecSentense - ͖؂̎s
+ * ExecSentenseMain - 解析木の実行
+ *
+ *	debug が FALSE の場合はコールバックとプロファイル、統計のチェックを行わない
+ *	定数で展開してデバッグ用と通常用の2つの関数を作成する
  */
-int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack)
+static FORCEINLINE int ExecSentenseMain(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack, const BOOL debug)
 {
 	EXECINFO cei;
 	VALUEINFO *vi, *v1, *v2;
 	VALUEINFO *stack = NULL;
+	PROFILEINFO *prof = (debug != FALSE) ? ei->sci->sci_top->prof : NULL;
+	STATINFO *stat = (debug != FALSE) ? cur_stat : NULL;
+	MEMHEAP *tmp_mh;
 	TOKEN *tmp_tk;
 	int RetSt = RET_SUCCESS;
 	BOOL cp;
 
 	while (cu_tk != NULL && cu_tk->sym_type != ei->to_tk) {
 		ei->err = cu_tk->err;
-		if (ei->sci->callback != NULL) {
+		if (debug != FALSE && IS_CALLBACK_TOKEN(ei, cu_tk)) {
 			if (ei->sci->callback(ei, cu_tk) != 0) {
 				RetSt = RET_EXIT;
 				break;
 			}
 		}
+		if (debug != FALSE && prof != NULL) {
+			ProfileToken(prof, cu_tk);
+		}
+		if (debug != FALSE && stat != NULL) {
+			stat->sym[cu_tk->sym_type]++;
+		}
 
 		switch (cu_tk->sym_type) {
 		case SYM_BOPEN:
@@ -1213,11 +1405,11 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			cei.sci = ei->sci;
 			cei.parent = ei;
 			vi = NULL;
-			RetSt = ExecSentense(&cei, cu_tk->target, retvi, &vi);
+			RetSt = EXEC_SENTENSE(debug, &cei, cu_tk->target, retvi, &vi);
 			if (RetSt == RET_BREAK || RetSt == RET_CONTINUE) {
 				ei->err = cei.err;
 			}
-			//s̃X^bN̓ezɐݒ
+			//実行後のスタックの内容を配列に設定
 			v1 = AllocValue();
 			if (v1 == NULL) {
 				Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1226,10 +1418,19 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				FreeExecInfo(&cei);
 				break;
 			}
+			v1->v->type = TYPE_ARRAY;
 			if (vi != NULL) {
 				v1->v->u.array = CopyValueList(vi);
+				if (v1->v->u.array == (VALUEINFO *)RET_ERROR) {
+					v1->v->u.array = NULL;
+					FreeValue(v1);
+					Error(ei, ERR_ALLOC, ei->err, NULL);
+					RetSt = RET_ERROR;
+					FreeValueList(vi);
+					FreeExecInfo(&cei);
+					break;
+				}
 			}
-			v1->v->type = TYPE_ARRAY;
 			v1->next = stack;
 			stack = v1;
 			FreeValueList(vi);
@@ -1245,7 +1446,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				RetSt = RET_ERROR;
 			}
 			if (ei->line_mode == FALSE) {
-				//X^bN
+				//スタックを解放する
 				FreeValueList(stack);
 				stack = NULL;
 			}
@@ -1255,14 +1456,14 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			if (PostfixValue(ei) == FALSE) {
 				RetSt = RET_ERROR;
 			}
-			//X^bN
+			//スタックを解放する
 			FreeValueList(stack);
 			stack = NULL;
 			break;
 
 		case SYM_WORDEND:
 			if (stack == NULL) {
-				//X^bNɋ̒lǉ
+				//スタックに空の値を追加
 				stack = AllocValue();
 				if (stack == NULL) {
 					Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1271,7 +1472,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				}
 			}
 			if (cu_tk->next != NULL && cu_tk->next->sym_type == SYM_WORDEND) {
-				//X^bNɋ̒lǉ
+				//スタックに空の値を追加
 				vi = AllocValue();
 				if (vi == NULL) {
 					Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1284,9 +1485,13 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_JUMP:
-			//ړ
+			//移動
 			cu_tk = cu_tk->link;
-			if (ei->sci->callback != NULL) {
+			if (cu_tk->sym_type == SYM_LOOPSTART && CHECK_LIMIT(ei) == FALSE) {
+				RetSt = RET_LIMIT;
+				break;
+			}
+			if (debug != FALSE && IS_CALLBACK_TOKEN(ei, cu_tk)) {
 				if (ei->sci->callback(ei, cu_tk) != 0) {
 					RetSt = RET_EXIT;
 					break;
@@ -1304,7 +1509,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			cp = GetValueBoolean(stack->v);
 			if ((cu_tk->sym_type == SYM_JZE && cp == FALSE) ||
 				(cu_tk->sym_type == SYM_JNZ && cp != FALSE)) {
-				// X^bNɌʂς
+				// スタックに結果を積む
 				vi = AllocValue();
 				if (vi == NULL) {
 					Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1314,12 +1519,12 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				vi->v->u.iValue = (cp == FALSE) ? 0 : 1;
 				vi->v->type = TYPE_INTEGER;
 				vi->next = stack->next;
-				// ̒l͉
+				// 元の値は解放
 				FreeValue(stack);
 				stack = vi;
-				// ̃XLbv
+				// 式のスキップ
 				cu_tk = cu_tk->link;
-				if (ei->sci->callback != NULL) {
+				if (debug != FALSE && IS_CALLBACK_TOKEN(ei, cu_tk)) {
 					if (ei->sci->callback(ei, cu_tk) != 0) {
 						RetSt = RET_EXIT;
 						break;
@@ -1341,7 +1546,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			if (stack == NULL) {
 				break;
 			}
-			//߂l
+			//戻り値
 			*retvi = AllocValue();
 			if (*retvi == NULL) {
 				Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1350,17 +1555,20 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			}
 			vi = stack;
 			stack = stack->next;
-			SetValue((*retvi)->v, vi->v);
+			if (SetValue((*retvi)->v, vi->v) == FALSE) {
+				Error(ei, ERR_ALLOC, ei->err, NULL);
+				RetSt = RET_ERROR;
+			}
 			FreeValue(vi);
 			break;
 
 		case SYM_BREAK:
-			//f
+			//中断
 			RetSt = RET_BREAK;
 			break;
 
 		case SYM_CONTINUE:
-			//p
+			//継続
 			RetSt = RET_CONTINUE;
 			break;
 
@@ -1370,19 +1578,19 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_CMP:
-			//r
+			//比較
 			if (stack == NULL) {
 				cu_tk = cu_tk->next;
 				break;
 			}
-			//r
+			//比較結果
 			vi = stack;
 			stack = stack->next;
 			cp = GetValueBoolean(vi->v);
 			FreeValue(vi);
 			if (cp != FALSE) {
-				//^
-				//jump ELSE XLbv
+				//真
+				//jump ELSE をスキップ
 				cu_tk = cu_tk->next;
 			}
 			break;
@@ -1393,7 +1601,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_SWITCH:
-			//򕪊
+			//多岐分岐
 			if (stack == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
@@ -1402,19 +1610,19 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			vi = stack;
 			stack = stack->next;
 
-			//case ڂ̌
+			//case 項目の検索
 			cu_tk = cu_tk->next;
 			tmp_tk = FindCase(ei, cu_tk, vi);
 			FreeValue(vi);
 			if (tmp_tk == NULL) {
-				//}b` case ڂ
+				//マッチする case 項目が無い
 				break;
 			}
-			//̎s
+			//文の実行
 			ZeroMemory(&cei, sizeof(EXECINFO));
 			cei.sci = ei->sci;
 			cei.parent = ei;
-			RetSt = ExecSentense(&cei, tmp_tk, retvi, NULL);
+			RetSt = EXEC_SENTENSE(debug, &cei, tmp_tk, retvi, NULL);
 			FreeExecInfo(&cei);
 			if (RetSt != RET_SUCCESS && RetSt != RET_BREAK) {
 				break;
@@ -1423,9 +1631,9 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_LOOP:
-			//JԂ
+			//繰り返し
 			if (stack != NULL) {
-				//r
+				//比較結果
 				vi = stack;
 				stack = stack->next;
 				cp = GetValueBoolean(vi->v);
@@ -1435,18 +1643,18 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 					break;
 				}
 			}
-			//[vΏۏ
-			RetSt = ExecSentense(ei, cu_tk->target, retvi, NULL);
+			//ループ対象処理
+			RetSt = EXEC_SENTENSE(debug, ei, cu_tk->target, retvi, NULL);
 			if (RetSt != RET_SUCCESS && RetSt != RET_BREAK && RetSt != RET_CONTINUE) {
 				break;
 			}
 			if (RetSt == RET_BREAK) {
-				//[v𒆒f
+				//ループを中断
 				for (; cu_tk->next != NULL && cu_tk->sym_type != SYM_LOOPEND; cu_tk = cu_tk->next);
 				RetSt = RET_SUCCESS;
 				break;
 			}
-			//p
+			//継続
 			cu_tk = cu_tk->next;
 			RetSt = RET_SUCCESS;
 			//jump LOOPSTART
@@ -1457,27 +1665,27 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_ARGSTART:
-			//̊Jnʒu
+			//引数の開始位置
 			vi = AllocValue();
 			if (vi == NULL) {
 				Error(ei, ERR_ALLOC, ei->err, NULL);
 				RetSt = RET_ERROR;
 				break;
 			}
-			// Jnʒu͒lɂĎ
+			// 引数開始位置は値を空にして識別
 			mem_free(&vi->v);
 			vi->next = stack;
 			stack = vi;
 			break;
 
 		case SYM_FUNC:
-			//֐Ăяo
+			//関数呼び出し
 			if (stack == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
 				break;
 			}
-			//̎擾
+			//引数の取得
 			v1 = NULL;
 			while (stack != NULL && stack->v != NULL) {
 				vi = stack;
@@ -1485,7 +1693,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				vi->next = v1;
 				v1 = vi;
 			}
-			//Jnʒủ
+			//引数開始位置の解放
 			vi = stack;
 			stack = stack->next;
 			FreeValue(vi);
@@ -1493,24 +1701,24 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			v2 = ExecFunction(ei, cu_tk->buf, v1);
 			FreeValueList(v1);
 			if (v2 == NULL || v2 == (VALUEINFO *)-1) {
-				RetSt = RET_ERROR;
+				RetSt = (ei->sci->sci_top->limit_over == FALSE) ? RET_ERROR : RET_LIMIT;
 				break;
 			}
 			if (ei->exit == TRUE) {
 				RetSt = RET_EXIT;
 				if (retvi != NULL) {
-					//߂l
+					//戻り値
 					*retvi = v2;
 					break;
 				}
 			}
-			//߂lX^bNɐς
+			//戻り値をスタックに積む
 			v2->next = stack;
 			stack = v2;
 			break;
 
 		case SYM_DECLVARIABLE:
-			//ϐ`
+			//変数定義
 			v1 = DeclVariable(ei, cu_tk->buf, ei->err);
 			if (v1 == NULL) {
 				RetSt = RET_ERROR;
@@ -1530,16 +1738,16 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_VARIABLE:
-			//ϐ擾
+			//変数取得
 			v1 = GetVariable(ei, cu_tk->buf);
 			if (v1 == NULL) {
 				if (ei->sci->strict_val == TRUE) {
-					//ϐ`
+					//変数が未定義
 					Error(ei, ERR_NOTDECLARE, ei->err, cu_tk->buf);
 					RetSt = RET_ERROR;
 					break;
 				}
-				//ϐ`
+				//変数を定義
 				v1 = DeclVariable(ei, cu_tk->buf, ei->err);
 				if (v1 == NULL) {
 					RetSt = RET_ERROR;
@@ -1563,7 +1771,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_ARRAY:
-			//z
+			//配列
 			if (stack == NULL || stack->next == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
@@ -1574,7 +1782,10 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			v2 = stack;
 			stack = stack->next;
 
+			//要素は配列と同じヒープに追加する (準備済みスクリプトの変数を実行中に更新する場合)
+			tmp_mh = mem_heap_select(mem_heap_owner(v2->v));
 			vi = GetArrayValue(ei, v2->v->vi, v1->v);
+			mem_heap_select(tmp_mh);
 			if (vi == NULL) {
 				FreeValue(v1);
 				FreeValue(v2);
@@ -1591,12 +1802,19 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				break;
 			}
 			if (v2->v != NULL && v2->v->vi == v2) {
-				//萔̏ꍇ̓Rs[
-				SetValue(v1->v, vi->v);
+				//定数の場合はコピー
+				if (SetValue(v1->v, vi->v) == FALSE) {
+					FreeValue(v1);
+					FreeValue(v2);
+					Error(ei, ERR_ALLOC, ei->err, NULL);
+					RetSt = RET_ERROR;
+					break;
+				}
 			} else {
-				//ϐ̒l̎Q
+				//変数内の値の参照 (要素の更新を配列の更新カウンタに反映する)
 				mem_free(&v1->v);
 				v1->v = vi->v;
+				v1->v->parent = v2->v;
 			}
 			v1->next = stack;
 			stack = v1;
@@ -1604,7 +1822,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_CONST_INT:
-			// 萔()
+			// 定数(整数)
 			vi = AllocValue();
 			if (vi == NULL) {
 				Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1619,7 +1837,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_CONST_FLOAT:
-			// 萔()
+			// 定数(実数)
 			vi = AllocValue();
 			if (vi == NULL) {
 				Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1634,7 +1852,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_CONST_STRING:
-			//萔
+			//文字列定数
 			vi = AllocValue();
 			if (vi == NULL) {
 				Error(ei, ERR_ALLOC, ei->err, NULL);
@@ -1642,19 +1860,21 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 				break;
 			}
 			vi->v->u.sValue = alloc_copy(cu_tk->buf);
-			conv_ctrl(vi->v->u.sValue);
 			if (vi->v->u.sValue == NULL) {
 				FreeValue(vi);
+				Error(ei, ERR_ALLOC, ei->err, NULL);
 				RetSt = RET_ERROR;
 				break;
 			}
+			StatString(cu_tk->buf);
+			conv_ctrl(vi->v->u.sValue);
 			vi->v->type = TYPE_STRING;
 			vi->next = stack;
 			stack = vi;
 			break;
 
 		case SYM_NOT:
-			//PZq
+			//単項演算子
 			if (stack == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
@@ -1695,7 +1915,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 		case SYM_DEC:
 		case SYM_BINC:
 		case SYM_BDEC:
-			//PZq
+			//単項演算子
 			if (stack == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
@@ -1725,43 +1945,54 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		case SYM_EQ:
-			//Zq
+			//代入演算子
 			if (stack == NULL || stack->next == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
 				break;
 			}
-			//E
+			//右辺
 			v1 = stack;
 			stack = stack->next;
-			//
+			//左辺
 			v2 = stack;
 			stack = stack->next;
 
-			//ϐɒlݒ
-			SetValue(v2->v, v1->v);
+			//変数に値を設定
+			if (SetValue(v2->v, v1->v) == FALSE) {
+				FreeValue(v1);
+				FreeValue(v2);
+				Error(ei, ERR_ALLOC, ei->err, NULL);
+				RetSt = RET_ERROR;
+				break;
+			}
 			if (retstack != NULL) {
 				mem_free(&v1->name);
 				v1->name = alloc_copy(v2->name);
 				v1->name_hash = v2->name_hash;
 			}
-			//lX^bNɐς
+			//代入した値をスタックに積む
 			v1->next = stack;
 			stack = v1;
 			FreeValue(v2);
 			break;
 
 		case SYM_COMP_EQ:
-			// Zq
+			// 複合代入演算子
 			if (stack == NULL || stack->next == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
 				break;
 			}
-			// X^bNɍӂ̃Rs[ǉ
+			// スタックに左辺のコピーを追加
 			v1 = stack->next;
 			vi = AllocValue();
-			SetValue(vi->v, v1->v);
+			if (vi == NULL || SetValue(vi->v, v1->v) == FALSE) {
+				FreeValue(vi);
+				Error(ei, ERR_ALLOC, ei->err, NULL);
+				RetSt = RET_ERROR;
+				break;
+			}
 			if (retstack != NULL) {
 				vi->name = alloc_copy(v1->name);
 				vi->name_hash = v1->name_hash;
@@ -1798,7 +2029,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 
 		case SYM_CPAND:
 		case SYM_CPOR:
-			// _Zq
+			// 論理演算子
 			if (stack == NULL || stack->next == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
@@ -1829,7 +2060,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			break;
 
 		default:
-			//񍀉Zq
+			//二項演算子
 			if (stack == NULL || stack->next == NULL) {
 				Error(ei, ERR_SENTENCE, ei->err, NULL);
 				RetSt = RET_ERROR;
@@ -1850,7 +2081,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			FreeValue(v1);
 			FreeValue(v2);
 
-			//ZʂX^bNɐς
+			//演算結果をスタックに積む
 			vi->next = stack;
 			stack = vi;
 			break;
@@ -1865,7 +2096,7 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 		RetSt = RET_ERROR;
 	}
 	if (retstack != NULL) {
-		//X^bNԂ
+		//スタックを返す
 		*retstack = NULL;
 		while (stack != NULL) {
 			vi = stack;
@@ -1874,26 +2105,56 @@ int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **rets
 			*retstack = vi;
 		}
 	} else {
-		//X^bN
+		//スタックを解放する
 		FreeValueList(stack);
 	}
 	return RetSt;
 }
 
 /*
- * ExpandArgument - ̓WJ
+ * ExecSentenseDebug - 解析木の実行 (コールバックまたはプロファイルあり)
+ */
+static int ExecSentenseDebug(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack)
+{
+	return ExecSentenseMain(ei, cu_tk, retvi, retstack, TRUE);
+}
+
+/*
+ * ExecSentenseLean - 解析木の実行 (コールバックとプロファイルなし)
+ */
+static int ExecSentenseLean(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack)
+{
+	return ExecSentenseMain(ei, cu_tk, retvi, retstack, FALSE);
+}
+
+/*
+ * ExecSentense - 解析木の実行
+ *
+ *	コールバックとプロファイルの有無で実行する関数を選択する
+ */
+int ExecSentense(EXECINFO *ei, TOKEN *cu_tk, VALUEINFO **retvi, VALUEINFO **retstack)
+{
+	if (ei->sci->callback != NULL || ei->sci->sci_top->prof != NULL || cur_stat != NULL) {
+		return ExecSentenseDebug(ei, cu_tk, retvi, retstack);
+	}
+	return ExecSentenseLean(ei, cu_tk, retvi, retstack);
+}
+
+/*
+ * ExpandArgument - 引数の展開
  */
 static TOKEN *ExpandArgument(EXECINFO *ei, TOKEN *tk, VALUEINFO *param)
 {
 	VALUEINFO *vi;
 	BOOL eq = FALSE;
+	int ret;
 
 	while (tk != NULL && tk->sym_type != SYM_FUNC && param != NULL) {
 		if (tk->sym_type != SYM_DECLVARIABLE) {
 			Error(ei, ERR_SENTENCE, tk->err, NULL);
 			return NULL;
 		}
-		//ϐɒlݒ
+		//変数に値を設定
 		if (*tk->buf == ARGUMENT_ADDRESS) {
 			vi = DeclVariable(ei, tk->buf + 1, tk->err);
 			if (vi == NULL) {
@@ -1906,7 +2167,10 @@ static TOKEN *ExpandArgument(EXECINFO *ei, TOKEN *tk, VALUEINFO *param)
 			if (vi == NULL) {
 				return NULL;
 			}
-			SetValue(vi->v, param->v);
+			if (SetValue(vi->v, param->v) == FALSE) {
+				Error(ei, ERR_ALLOC, tk->err, NULL);
+				return NULL;
+			}
 		}
 		param = param->next;
 		while (tk->sym_type != SYM_FUNC && tk->sym_type != SYM_WORDEND) {
@@ -1918,16 +2182,17 @@ static TOKEN *ExpandArgument(EXECINFO *ei, TOKEN *tk, VALUEINFO *param)
 	}
 
 	if (tk != NULL && tk->sym_type != SYM_FUNC) {
-		//̈s
+		//未処理の引数を実行
 		ei->decl = TRUE;
 		ei->to_tk = SYM_FUNC;
-		if (ExecSentense(ei, tk, NULL, NULL) == -1) {
+		ret = ExecSentense(ei, tk, NULL, NULL);
+		if (ret == RET_ERROR || ret == RET_LIMIT) {
 			return NULL;
 		}
 		ei->decl = FALSE;
 		ei->to_tk = 0;
 
-		//̃XLbv
+		//引数のスキップ
 		for (; tk != NULL && tk->sym_type != SYM_FUNC; tk = tk->next) {
 			switch (tk->sym_type) {
 			case SYM_EQ:
@@ -1936,7 +2201,7 @@ static TOKEN *ExpandArgument(EXECINFO *ei, TOKEN *tk, VALUEINFO *param)
 
 			case SYM_WORDEND:
 				if (eq == FALSE) {
-					//ftHgl
+					//デフォルト値が無い
 					Error(ei, ERR_ARGUMENTCNT, tk->err, NULL);
 					return NULL;
 				}
@@ -1945,7 +2210,7 @@ static TOKEN *ExpandArgument(EXECINFO *ei, TOKEN *tk, VALUEINFO *param)
 			}
 		}
 		if (eq == FALSE) {
-			//ftHgl
+			//デフォルト値が無い
 			Error(ei, ERR_ARGUMENTCNT, tk->err, NULL);
 			return NULL;
 		}
@@ -1954,38 +2219,57 @@ static TOKEN *ExpandArgument(EXECINFO *ei, TOKEN *tk, VALUEINFO *param)
 }
 
 /*
- * ExecNameFunction - Öv֐̎s
+ * ExecNameFunction - 名前の一致する関数の実行
  */
 static VALUEINFO *ExecNameFunction(EXECINFO *ei, FUNCINFO *fi, VALUEINFO *param)
 {
 	EXECINFO cei;
 	EXECINFO* top;
 	VALUEINFO *vret = NULL;
+	PROFILEINFO *prof = ei->sci->sci_top->prof;
 	TOKEN *tk;
 	int ret;
 
+	if (CHECK_LIMIT(ei) == FALSE) {
+		return (VALUEINFO *)RET_ERROR;
+	}
 	ZeroMemory(&cei, sizeof(EXECINFO));
 	cei.name = fi->name;
 	cei.sci = ei->sci;
 	for (top = ei; top->parent != NULL; top = top->parent);
 	cei.parent = top;
+	STAT_ADD(alloc[STAT_OBJ_FRAME], 1);
 
-	//̓WJ
+	//引数の展開
+	if (prof != NULL) {
+		ProfileEnterFunction(prof, ei->sci, fi);
+	}
+	TRACE_BEGIN(TRACE_FUNC, fi->name, (trace_enable == TRUE) ? CountValueList(param) : -1);
 	tk = ExpandArgument(&cei, fi->tk->next, param);
 	if (tk == NULL || tk->target == NULL) {
+		if (prof != NULL) {
+			ProfileLeave(prof);
+		}
+		TRACE_END(TRACE_FUNC, fi->name);
 		FreeExecInfo(&cei);
+		STAT_ADD(free[STAT_OBJ_FRAME], 1);
 		return AllocValue();
 	}
 
-	//s
+	//実行
 	vret = NULL;
 	ret = ExecSentense(&cei, tk->target, &vret, NULL);
+	if (prof != NULL) {
+		ProfileLeave(prof);
+	}
+	TRACE_END(TRACE_FUNC, fi->name);
 	if (ret == RET_BREAK || ret == RET_CONTINUE) {
 		Error(&cei, ERR_SENTENCE, cei.err, NULL);
 		ret = RET_ERROR;
 	}
-	if (ret == RET_ERROR) {
+	if (ret == RET_ERROR || ret == RET_LIMIT) {
 		FreeExecInfo(&cei);
+		STAT_ADD(free[STAT_OBJ_FRAME], 1);
 		FreeValue(vret);
 		return (VALUEINFO *)RET_ERROR;
 	}
@@ -1993,6 +2277,7 @@ static VALUEINFO *ExecNameFunction(EXECINFO *ei, FUNCINFO *fi, VALUEINFO *param)
 		ei->exit = TRUE;
 	}
 	FreeExecInfo(&cei);
+	STAT_ADD(free[STAT_OBJ_FRAME], 1);
 	if (vret == NULL) {
 		return AllocValue();
 	}
@@ -2000,7 +2285,9 @@ static VALUEINFO *ExecNameFunction(EXECINFO *ei, FUNCINFO *fi, VALUEINFO *param)
 }
 
 /*
- * ExecLibFunction - Cu֐̎s
+ * ExecLibFunction - ライブラリ関数の実行
+ *
+ *	関数の戻り値 -1 は関数のエラー、-2 は引数の数のエラー、-3 はメモリの確保の失敗
  */
 static VALUEINFO *ExecLibFunction(EXECINFO *ei, LIBFUNC StdFunc, TCHAR *name, VALUEINFO *param)
 {
@@ -2014,7 +2301,11 @@ static VALUEINFO *ExecLibFunction(EXECINFO *ei, LIBFUNC StdFunc, TCHAR *name, VA
 		return (VALUEINFO *)RET_ERROR;
 	}
 	*ErrStr = TEXT('\0');
+	TRACE_BEGIN(TRACE_LIB, name, (trace_enable == TRUE) ? CountValueList(param) : -1);
 	ret = StdFunc(ei, param, vret, ErrStr);
+	TRACE_END(TRACE_LIB, name);
+	// ライブラリ関数が作成した文字列を統計に加算
+	StatValueList(vret);
 	if (ret < 0) {
 		switch (ret) {
 		case -1:
@@ -2024,6 +2315,10 @@ static VALUEINFO *ExecLibFunction(EXECINFO *ei, LIBFUNC StdFunc, TCHAR *name, VA
 		case -2:
 			Error(ei, ERR_ARGUMENTCNT, ei->err, NULL);
 			break;
+
+		case -3:
+			Error(ei, ERR_ALLOC, ei->err, NULL);
+			break;
 		}
 		FreeValue(vret);
 		return (VALUEINFO *)RET_ERROR;
@@ -2032,14 +2327,24 @@ static VALUEINFO *ExecLibFunction(EXECINFO *ei, LIBFUNC StdFunc, TCHAR *name, VA
 }
 
 /*
- * SetFuncAddrList - ֐̃AhXۑ
+ * SetFuncAddrList - 関数のアドレスを保存
  */
 static BOOL SetFuncAddrList(EXECINFO *ei, TCHAR *Name, int name_hash, FUNCTION_TYPE func_type, void *addr) {
-	FUNCADDRINFO *funcaddr = mem_calloc(sizeof(FUNCADDRINFO));
+	FUNCADDRINFO *funcaddr;
+	MEMHEAP *mh;
+
+	// スクリプトの実行情報には実行情報と同じヒープから追加する (準備済みスクリプトの実行中は別のヒープ)
+	mh = mem_heap_select((ei == ei->sci->ei) ? mem_heap_owner(ei) : mem_heap_get());
+	funcaddr = mem_calloc(sizeof(FUNCADDRINFO));
+	if (funcaddr != NULL) {
+		funcaddr->name = alloc_copy(Name);
+	}
+	mem_heap_select(mh);
 	if (funcaddr == NULL) {
 		Error(ei, ERR_ALLOC, ei->err, NULL);
 		return FALSE;
 	}
+	STAT_ADD(alloc[STAT_OBJ_FUNCADDR], 1);
 	if (ei->funcaddr == NULL) {
 		ei->funcaddr = funcaddr;
 	} else {
@@ -2047,7 +2352,6 @@ static BOOL SetFuncAddrList(EXECINFO *ei, TCHAR *Name, int name_hash, FUNCTION_T
 		for (fa = ei->funcaddr; fa->next != NULL; fa = fa->next);
 		fa->next = funcaddr;
 	}
-	funcaddr->name = alloc_copy(Name);
 	funcaddr->name_hash = name_hash;
 	funcaddr->addr = addr;
 	funcaddr->func_type = func_type;
@@ -2056,7 +2360,7 @@ static BOOL SetFuncAddrList(EXECINFO *ei, TCHAR *Name, int name_hash, FUNCTION_T
 }
 
 /*
- * ExecFunction - ֐̎s
+ * ExecFunction - 関数の実行
  */
 VALUEINFO *ExecFunction(EXECINFO *ei, TCHAR *name, VALUEINFO *param)
 {
@@ -2070,7 +2374,7 @@ VALUEINFO *ExecFunction(EXECINFO *ei, TCHAR *name, VALUEINFO *param)
 	char *cr;
 	int name_hash;
 
-	// AhXς݂̊֐Ďs
+	// アドレスが解決済みの関数を検索して実行
 	name_hash = str2hash(name);
 	if (ei->funcaddr != NULL) {
 		FUNCADDRINFO *fa;
@@ -2078,10 +2382,12 @@ VALUEINFO *ExecFunction(EXECINFO *ei, TCHAR *name, VALUEINFO *param)
 			if (name_hash == fa->name_hash && lstrcmp(name, fa->name) == 0) {
 				switch (fa->func_type) {
 				case FUNC_SCRIPT:
+					STAT_ADD(func[STAT_FUNC_CACHE_SCRIPT], 1);
 					vret = ExecNameFunction(fa->ei, (FUNCINFO *)fa->addr, param);
 					break;
 
 				case FUNC_LIBRARY:
+					STAT_ADD(func[STAT_FUNC_CACHE_LIBRARY], 1);
 					vret = ExecLibFunction(fa->ei, (LIBFUNC)fa->addr, name, param);
 					break;
 				}
@@ -2090,69 +2396,257 @@ VALUEINFO *ExecFunction(EXECINFO *ei, TCHAR *name, VALUEINFO *param)
 		}
 	}
 
-	// [U֐
+	// ユーザ関数
 	for (; fi != NULL; fi = fi->next) {
 		if (name_hash == fi->name_hash && lstrcmp(name, fi->name) == 0) {
-			// AhX̑ޔ
+			// アドレスの退避
 			SetFuncAddrList(ei, name, name_hash, FUNC_SCRIPT, (void *)fi);
+			STAT_ADD(func[STAT_FUNC_SCRIPT], 1);
 			return ExecNameFunction(ei, fi, param);
 		}
 	}
 
-	// ʃXNvg̃[U֐
+	// 別スクリプトのユーザ関数
 	for (tmp_sci = csci->sci_top; tmp_sci != NULL; tmp_sci = tmp_sci->next) {
 		for (fi = tmp_sci->fi; fi != NULL; fi = fi->next) {
 			if (name_hash == fi->name_hash && lstrcmp(name, fi->name) == 0) {
-				// AhX̑ޔ
+				// アドレスの退避
 				SetFuncAddrList(tmp_sci->ei, name, name_hash, FUNC_SCRIPT, (void *)fi);
+				STAT_ADD(func[STAT_FUNC_MODULE], 1);
 				return ExecNameFunction(tmp_sci->ei, fi, param);
 			}
 		}
 	}
 
-	// Cu֐
+	// ライブラリ関数
 	r = alloc_join(LIB_FUNC_HEAD, name);
 	cr = tchar2char(r);
 	for (lib = csci->sci_top->lib; lib_func == NULL && lib != NULL; lib = lib->next) {
-		// Cǔ
+		// ライブラリの検索
 		lib_func = (LIBFUNC)GetProcAddress(lib->hModul, cr);
 	}
 	mem_free(&cr);
-	if (lib_func == NULL) {
-		// W֐̌
-		lib_func = GetFuncAddress(r);
+	if (lib_func != NULL) {
+		STAT_ADD(func[STAT_FUNC_LIBRARY], 1);
+	} else {
+		// 登録関数と標準関数の検索
+		lib_func = GetInstanceFunc(csci, r);
+		STAT_ADD(func[(lib_func != NULL) ? STAT_FUNC_INSTANCE : STAT_FUNC_NOTFOUND], 1);
 	}
 	mem_free(&r);
 	if (lib_func == NULL) {
 		Error(ei, ERR_FUNCTION, ei->err, NULL);
 		return (VALUEINFO *)RET_ERROR;
 	}
-	// AhX̑ޔ
+	// アドレスの退避
 	SetFuncAddrList(ei, name, name_hash, FUNC_LIBRARY, (void *)lib_func);
 	return ExecLibFunction(ei, lib_func, name, param);
 }
 
 /*
- * ExecScript - XNvg̎s
+ * SetScriptLimit - 実行の上限を設定
+ *
+ *	step_limit はループの繰り返しと関数呼び出しの合計数、timeout はミリ秒
+ *	0 の場合は上限なし
+ *	計測は設定時から開始するため、インポートしたスクリプトの実行も含める場合は読み込み前に設定する
+ */
+void SetScriptLimit(SCRIPTINFO *sci, LONGLONG step_limit, DWORD timeout)
+{
+	SCRIPTINFO *top = sci->sci_top;
+
+	top->step_limit = step_limit;
+	top->timeout = timeout;
+	top->limit = (step_limit > 0 || timeout > 0) ? TRUE : FALSE;
+	top->step = 0;
+	top->limit_over = FALSE;
+	top->deadline = (timeout > 0) ? GetTickCount64() + timeout : 0;
+}
+
+/*
+ * GetMaxLine - 解析木の最大の行番号を取得
+ */
+static int GetMaxLine(TOKEN *tk)
+{
+	int max = -1;
+	int line;
+
+	for (; tk != NULL; tk = tk->next) {
+		if (tk->line > max) {
+			max = tk->line;
+		}
+		if (tk->target != NULL && (line = GetMaxLine(tk->target)) > max) {
+			max = line;
+		}
+	}
+	return max;
+}
+
+/*
+ * CountLineHead - 指定行に入る位置のトークンの数を取得
+ */
+static int CountLineHead(TOKEN *tk, const int line)
+{
+	int cnt = 0;
+
+	for (; tk != NULL; tk = tk->next) {
+		if (tk->line_head != FALSE && tk->line == line) {
+			cnt++;
+		}
+		if (tk->target != NULL) {
+			cnt += CountLineHead(tk->target, line);
+		}
+	}
+	return cnt;
+}
+
+/*
+ * GetBreakInfo - ブレークポイントの取得 (無い場合は作成)
+ *
+ *	実行中のスレッドが参照するため、作成後は再確保しない
+ */
+static BREAKINFO *GetBreakInfo(SCRIPTINFO *sci)
+{
+	BREAKINFO *bi;
+	MEMHEAP *mh;
+	int line_cnt;
+
+	if (sci->brk != NULL) {
+		return sci->brk;
+	}
+	line_cnt = GetMaxLine(sci->tk) + 1;
+	// 実行中のスレッドのヒープは使用できないためプロセスのヒープから確保
+	mh = mem_heap_select(NULL);
+	bi = mem_calloc(sizeof(BREAKINFO) + sizeof(LONG) * (line_cnt / BREAK_BIT_SIZE));
+	mem_heap_select(mh);
+	if (bi == NULL) {
+		return NULL;
+	}
+	bi->line_cnt = line_cnt;
+	InterlockedExchangePointer((PVOID volatile *)&sci->brk, bi);
+	return bi;
+}
+
+/*
+ * SetBreakPoint - ブレークポイントの設定と解除
+ *
+ *	line は 0 から始まる行番号、行に入る位置のトークンの数を返す
+ *	実行中に別スレッドから呼び出すことができる
+ *	ブレークポイントは実行コンテキストごとに保持し、解析結果を共有している他のコンテキストには影響しない
+ *	インポートしたスクリプトにはそのスクリプト情報を指定する
+ */
+int SetBreakPoint(SCRIPTINFO *sci, const int line, const BOOL set)
+{
+	BREAKINFO *bi;
+	LONG mask;
+
+	if (line < 0 || (bi = GetBreakInfo(sci)) == NULL || line >= bi->line_cnt) {
+		return 0;
+	}
+	mask = (LONG)((DWORD)1 << (line % BREAK_BIT_SIZE));
+	if (set == FALSE) {
+		InterlockedAnd(&bi->bit[line / BREAK_BIT_SIZE], ~mask);
+	} else {
+		InterlockedOr(&bi->bit[line / BREAK_BIT_SIZE], mask);
+	}
+	return CountLineHead(sci->tk, line);
+}
+
+/*
+ * IsBreakPoint - トークンがブレークポイントか判定
+ */
+BOOL IsBreakPoint(SCRIPTINFO *sci, TOKEN *tk)
+{
+	return (tk != NULL && IS_BREAK_TOKEN(sci, tk)) ? TRUE : FALSE;
+}
+
+/*
+ * ClearBreakPoint - すべてのブレークポイントを解除
+ *
+ *	インポートしたスクリプトを含めて解除する
+ */
+void ClearBreakPoint(SCRIPTINFO *sci)
+{
+	BREAKINFO *bi;
+	int i;
+
+	for (sci = sci->sci_top; sci != NULL; sci = sci->next) {
+		if ((bi = sci->brk) == NULL) {
+			continue;
+		}
+		for (i = 0; i <= bi->line_cnt / (int)BREAK_BIT_SIZE; i++) {
+			InterlockedExchange(&bi->bit[i], 0);
+		}
+	}
+}
+
+/*
+ * SetBreakOnly - コールバックをブレークポイントのみで呼び出すかを設定
+ *
+ *	TRUE の場合はブレークポイント以外のトークンではコールバックを呼び出さない
+ *	インポートしたスクリプトを含めて設定する
+ */
+void SetBreakOnly(SCRIPTINFO *sci, const BOOL break_only)
+{
+	for (sci = sci->sci_top; sci != NULL; sci = sci->next) {
+		InterlockedExchange(&sci->break_only, (break_only == FALSE) ? FALSE : TRUE);
+	}
+}
+
+/*
+ * ExecTopLevel - 実行情報を指定してトップレベルを実行
+ *
+ *	実行情報は呼び出し側で解放する
+ *	成功時は 0、エラー時は -1、実行の上限に達した場合は RET_LIMIT を返す
+ */
+int ExecTopLevel(EXECINFO *ei, VALUEINFO **ret_vi)
+{
+	SCRIPTINFO *sci = ei->sci;
+	int ret;
+
+	if (sci->sci_top->prof != NULL) {
+		ProfileEnterScript(sci->sci_top->prof, sci);
+	}
+	TRACE_BEGIN(TRACE_EXEC, sci->name, (trace_enable == TRUE) ? CountValueList(ei->vi) : -1);
+	ret = ExecSentense(ei, sci->tk, ret_vi, NULL);
+	TRACE_END(TRACE_EXEC, sci->name);
+	if (sci->sci_top->prof != NULL) {
+		ProfileLeave(sci->sci_top->prof);
+	}
+	if (ret == RET_BREAK || ret == RET_CONTINUE) {
+		Error(ei, ERR_SENTENCE, ei->err, NULL);
+		ret = RET_ERROR;
+	}
+	if (ret == RET_ERROR || ret == RET_LIMIT) {
+		return (ret == RET_LIMIT || sci->sci_top->limit_over == TRUE) ? RET_LIMIT : -1;
+	}
+	return 0;
+}
+
+/*
+ * ExecScript - スクリプトの実行
+ *
+ *	成功時は 0、エラー時は -1、実行の上限に達した場合は RET_LIMIT を返す
  */
 int ExecScript(SCRIPTINFO *sci, VALUEINFO *arg_vi, VALUEINFO **ret_vi)
 {
 	EXECINFO *ei;
 	int ret;
 
+	if (sci->code != NULL && sci->sci_top == sci && ExecCodeModules(sci) == FALSE) {
+		return -1;
+	}
 	ei = mem_calloc(sizeof(EXECINFO));
+	if (ei == NULL) {
+		return -1;
+	}
 	ei->name = sci->name;
 	ei->sci = sci;
 	ei->vi = arg_vi;
-	ret = ExecSentense(ei, sci->tk, ret_vi, NULL);
-	if (ret == RET_BREAK || ret == RET_CONTINUE) {
-		Error(ei, ERR_SENTENCE, ei->err, NULL);
-		ret = RET_ERROR;
-	}
-	if (ret == RET_ERROR) {
+	ret = ExecTopLevel(ei, ret_vi);
+	if (ret != 0) {
 		FreeExecInfo(ei);
 		mem_free(&ei);
-		return -1;
+		return ret;
 	}
 	if (sci->callback != NULL) {
 		sci->callback(ei, NULL);
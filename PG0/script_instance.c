@@ -0,0 +1,258 @@
+/*
+ * PG0
+ *
+ * script_instance.c
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <tchar.h>
+
+#include "script.h"
+#include "script_string.h"
+#include "script_memory.h"
+#include "script_utility.h"
+
+/* Define */
+#ifndef THREAD_LOCAL
+#define THREAD_LOCAL			__declspec(thread)
+#endif
+
+#define FUNCREG_HASH(hash)		((int)((unsigned int)(hash) % FUNCREG_HASH_SIZE))
+
+/* Global Variables */
+//現在のスレッドで使用するインスタンス
+static THREAD_LOCAL INSTANCEINFO *cur_inst = NULL;
+
+/* Local Function Prototypes */
+
+/*
+ * CreateInstance - インスタンスの作成
+ *
+ *	インスタンスは専用のヒープと登録関数を持つ
+ *	1つのインスタンスは同時に1つのスレッドからのみ使用する
+ */
+INSTANCEINFO *CreateInstance(void)
+{
+	INSTANCEINFO *inst;
+	MEMHEAP *mh, *prev;
+
+	InitFuncAddress();
+
+	mh = mem_heap_create();
+	if (mh == NULL) {
+		return NULL;
+	}
+	prev = mem_heap_select(mh);
+	inst = mem_calloc(sizeof(INSTANCEINFO));
+	mem_heap_select(prev);
+	if (inst == NULL) {
+		mem_heap_destroy(mh);
+		return NULL;
+	}
+	inst->mh = mh;
+	return inst;
+}
+
+/*
+ * DestroyInstance - インスタンスの破棄
+ *
+ *	インスタンスで確保したメモリはすべて解放される
+ */
+void DestroyInstance(INSTANCEINFO *inst)
+{
+	if (inst == NULL) {
+		return;
+	}
+	if (cur_inst == inst) {
+		cur_inst = NULL;
+		SelectStat(NULL);
+	}
+	mem_heap_destroy(inst->mh);
+}
+
+/*
+ * SelectInstance - 現在のスレッドで使用するインスタンスを設定
+ *
+ *	以前のインスタンスを返す
+ *	NULLを設定するとプロセス共通のヒープを使用する
+ */
+INSTANCEINFO *SelectInstance(INSTANCEINFO *inst)
+{
+	INSTANCEINFO *prev = cur_inst;
+
+	cur_inst = inst;
+	mem_heap_select((inst != NULL) ? inst->mh : NULL);
+	SelectStat((inst != NULL && inst->stat_enable == TRUE) ? inst->stat : NULL);
+	return prev;
+}
+
+/*
+ * SetInstanceMemoryLimit - インスタンスで使用するメモリの上限を設定
+ *
+ *	上限を超える確保はエラー (ERR_ALLOC) になる
+ *	0 の場合は無制限
+ */
+void SetInstanceMemoryLimit(INSTANCEINFO *inst, SIZE_T limit)
+{
+	mem_heap_set_limit(inst->mh, limit);
+}
+
+/*
+ * GetInstanceMemory - インスタンスで使用中のメモリと最大値を取得
+ */
+void GetInstanceMemory(INSTANCEINFO *inst, SIZE_T *size, SIZE_T *peak)
+{
+	mem_heap_usage(inst->mh, size, peak);
+}
+
+/*
+ * SetInstanceStat - 実行の統計の有効/無効を設定
+ *
+ *	無効にしても集計した値は保持する
+ */
+BOOL SetInstanceStat(INSTANCEINFO *inst, BOOL enable)
+{
+	MEMHEAP *prev;
+
+	if (enable == TRUE && inst->stat == NULL) {
+		prev = mem_heap_select(inst->mh);
+		inst->stat = mem_calloc(sizeof(STATINFO));
+		mem_heap_select(prev);
+		if (inst->stat == NULL) {
+			return FALSE;
+		}
+	}
+	inst->stat_enable = enable;
+	if (cur_inst == inst) {
+		SelectStat((enable == TRUE) ? inst->stat : NULL);
+	}
+	return TRUE;
+}
+
+/*
+ * GetInstanceStat - 実行の統計を取得
+ *
+ *	一度も有効にしていない場合は NULL を返す
+ */
+STATINFO *GetInstanceStat(INSTANCEINFO *inst)
+{
+	return inst->stat;
+}
+
+/*
+ * ResetInstanceStat - 実行の統計を初期化
+ */
+void ResetInstanceStat(INSTANCEINFO *inst)
+{
+	if (inst->stat != NULL) {
+		ZeroMemory(inst->stat, sizeof(STATINFO));
+	}
+}
+
+/*
+ * CreateScriptInfo - インスタンスで実行するスクリプト情報の作成
+ */
+SCRIPTINFO *CreateScriptInfo(INSTANCEINFO *inst, BOOL op_exp, BOOL op_extension)
+{
+	SCRIPTINFO *sci;
+	INSTANCEINFO *prev;
+
+	prev = SelectInstance(inst);
+	sci = mem_alloc(sizeof(SCRIPTINFO));
+	SelectInstance(prev);
+	if (sci == NULL) {
+		return NULL;
+	}
+	InitializeScriptInfo(sci, op_exp, op_extension);
+	sci->inst = inst;
+	return sci;
+}
+
+/*
+ * RegisterFunction - 関数の登録
+ *
+ *	name はスクリプトから呼び出す名前
+ *	登録した関数は標準関数より優先される
+ */
+BOOL RegisterFunction(INSTANCEINFO *inst, TCHAR *name, LIBFUNC func)
+{
+	INSTANCEINFO *prev;
+	FUNCREGINFO *fr;
+	TCHAR *fname;
+	int name_hash;
+
+	prev = SelectInstance(inst);
+	fname = alloc_join(LIB_FUNC_HEAD, name);
+	if (fname == NULL) {
+		SelectInstance(prev);
+		return FALSE;
+	}
+	name_hash = str2hash(fname);
+	for (fr = inst->func[FUNCREG_HASH(name_hash)]; fr != NULL; fr = fr->next) {
+		if (fr->name_hash == name_hash && lstrcmp(fr->name, fname) == 0) {
+			// 登録済みの関数を置き換える
+			fr->func = func;
+			mem_free(&fname);
+			SelectInstance(prev);
+			return TRUE;
+		}
+	}
+	fr = mem_calloc(sizeof(FUNCREGINFO));
+	if (fr == NULL) {
+		mem_free(&fname);
+		SelectInstance(prev);
+		return FALSE;
+	}
+	fr->name = fname;
+	fr->name_hash = name_hash;
+	fr->func = func;
+	fr->next = inst->func[FUNCREG_HASH(name_hash)];
+	inst->func[FUNCREG_HASH(name_hash)] = fr;
+	SelectInstance(prev);
+	return TRUE;
+}
+
+/*
+ * SetInstanceIO - 入出力関数の設定
+ */
+BOOL SetInstanceIO(INSTANCEINFO *inst, LIBFUNC error, LIBFUNC print, LIBFUNC input)
+{
+	if (error != NULL && RegisterFunction(inst, TEXT("error"), error) == FALSE) {
+		return FALSE;
+	}
+	if (print != NULL && RegisterFunction(inst, TEXT("print"), print) == FALSE) {
+		return FALSE;
+	}
+	if (input != NULL && RegisterFunction(inst, TEXT("input"), input) == FALSE) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * GetInstanceFunc - 関数名からアドレスを取得
+ *
+ *	インスタンスの登録関数、関数テーブルの順に検索する
+ */
+LIBFUNC GetInstanceFunc(SCRIPTINFO *sci, TCHAR *FuncName)
+{
+	INSTANCEINFO *inst;
+	FUNCREGINFO *fr;
+	int name_hash;
+
+	if (sci != NULL && sci->sci_top != NULL && (inst = sci->sci_top->inst) != NULL) {
+		name_hash = str2hash(FuncName);
+		for (fr = inst->func[FUNCREG_HASH(name_hash)]; fr != NULL; fr = fr->next) {
+			if (fr->name_hash == name_hash && lstrcmp(fr->name, FuncName) == 0) {
+				return fr->func;
+			}
+		}
+	}
+	return GetFuncAddress(FuncName);
+}
+/* End of source */
@@ -13,12 +13,59 @@
 #include <tchar.h>
 
 #include "script_string.h"
+#include "script_memory.h"
 
 /* Define */
+#ifndef THREAD_LOCAL
+#define THREAD_LOCAL			__declspec(thread)
+#endif
+
+#define HEAP_HANDLE(mh)			(((mh) == NULL) ? GetProcessHeap() : (mh)->heap)
+
+//巻き戻し用のヒープ
+#define ARENA_CHUNK_SIZE		65536
+//解放したブロックを再利用するサイズの上限 (超える場合は個別に確保して解放する)
+#define ARENA_SMALL_MAX			512
+#define ARENA_CLASS_CNT			(ARENA_SMALL_MAX / 16)
+#define ARENA_CLASS(size)		(((size) == 0) ? 0 : (int)(((size) - 1) / 16))
 
 /* Global Variables */
+//確保したメモリの先頭に付加する情報
+typedef struct _MEMHEADER {
+	MEMHEAP *mh;
+	SIZE_T size;
+} MEMHEADER;
+
+//巻き戻し用のヒープのチャンク
+typedef struct _MEMCHUNK {
+	struct _MEMCHUNK *next;
+	SIZE_T size;
+} MEMCHUNK;
+
+//巻き戻し用のヒープで個別に確保したブロック
+typedef struct _MEMLARGE {
+	struct _MEMLARGE *prev;
+	struct _MEMLARGE *next;
+} MEMLARGE;
+
+//巻き戻し用のヒープの管理情報
+typedef struct _MEMARENA {
+	//先頭と確保中のチャンク
+	MEMCHUNK *top;
+	MEMCHUNK *cur;
+	SIZE_T pos;
+	//解放したブロック (サイズごと)
+	MEMHEADER *free_list[ARENA_CLASS_CNT];
+	//個別に確保したブロック
+	MEMLARGE *large;
+} MEMARENA;
+
+//現在のスレッドで使用するヒープ (NULLの場合はプロセスヒープ)
+static THREAD_LOCAL MEMHEAP *cur_heap = NULL;
+
 #ifdef _DEBUG
-static SIZE_T all_alloc_size = 0;
+static volatile LONG all_alloc_size = 0;
+static LONG peak_alloc_size = 0;
 
 //#define MEM_CHECK
 #ifdef MEM_CHECK
@@ -33,97 +80,285 @@ static int address_index;
 /* Local Function Prototypes */
 
 /*
- * mem_alloc - obt@m
+ * check_limit - 上限を超えないかチェック
  */
-void *mem_alloc(const int size)
+static BOOL check_limit(MEMHEAP *mh, const SIZE_T size)
+{
+	for (; mh != NULL; mh = mh->parent) {
+		if (mh->limit > 0 && mh->size + size > mh->limit) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/*
+ * add_size - 使用サイズの加算
+ *
+ *	親のヒープにも加算する
+ */
+static void add_size(MEMHEAP *mh, const SIZE_T size)
 {
+	if (mh != NULL) {
+		for (; mh != NULL; mh = mh->parent) {
+			mh->size += size;
+			if (mh->size > mh->peak) {
+				mh->peak = mh->size;
+			}
+		}
+		return;
+	}
 #ifdef _DEBUG
-	void *mem;
+	if (InterlockedExchangeAdd(&all_alloc_size, (LONG)size) + (LONG)size > peak_alloc_size) {
+		peak_alloc_size = all_alloc_size;
+	}
+#endif	//_DEBUG
+}
 
-	mem = HeapAlloc(GetProcessHeap(), 0, size);
-	if (mem == NULL) {
-		return mem;
+/*
+ * sub_size - 使用サイズの減算
+ */
+static void sub_size(MEMHEAP *mh, const SIZE_T size)
+{
+	if (mh != NULL) {
+		for (; mh != NULL; mh = mh->parent) {
+			mh->size -= size;
+		}
+		return;
 	}
-	all_alloc_size += HeapSize(GetProcessHeap(), 0, mem);
-#ifdef MEM_CHECK
-	if (address_index < ADDRESS_CNT) {
-		if (address_index == DEBUG_ADDRESS) {
-			address[address_index] = (long)mem;
+#ifdef _DEBUG
+	InterlockedExchangeAdd(&all_alloc_size, -(LONG)size);
+#endif	//_DEBUG
+}
+
+/*
+ * heap_lock - 複数のスレッドから使用中のヒープをロック
+ */
+static void heap_lock(MEMHEAP *mh)
+{
+	if (mh != NULL && mh->serialize == TRUE) {
+		EnterCriticalSection(&mh->cs);
+	}
+}
+
+/*
+ * heap_unlock - ヒープのロックを解除
+ */
+static void heap_unlock(MEMHEAP *mh)
+{
+	if (mh != NULL && mh->serialize == TRUE) {
+		LeaveCriticalSection(&mh->cs);
+	}
+}
+
+/*
+ * arena_alloc - 巻き戻し用のヒープからブロックを確保
+ *
+ *	小さいブロックは解放済みのブロックかチャンクの続きから確保する
+ */
+static MEMHEADER *arena_alloc(MEMHEAP *mh, const SIZE_T size)
+{
+	MEMARENA *ma = mh->arena;
+	MEMCHUNK *mc;
+	MEMLARGE *ml;
+	MEMHEADER *hd;
+	SIZE_T need;
+	int c;
+
+	if (size > ARENA_SMALL_MAX) {
+		ml = HeapAlloc(mh->heap, 0, sizeof(MEMLARGE) + sizeof(MEMHEADER) + size);
+		if (ml == NULL) {
+			return NULL;
+		}
+		ml->prev = NULL;
+		ml->next = ma->large;
+		if (ma->large != NULL) {
+			ma->large->prev = ml;
+		}
+		ma->large = ml;
+		return (MEMHEADER *)(ml + 1);
+	}
+	c = ARENA_CLASS(size);
+	if ((hd = ma->free_list[c]) != NULL) {
+		ma->free_list[c] = *(MEMHEADER **)(hd + 1);
+		return hd;
+	}
+	need = sizeof(MEMHEADER) + (c + 1) * 16;
+	while (ma->cur == NULL || ma->pos + need > ma->cur->size) {
+		if (ma->cur != NULL && ma->cur->next != NULL) {
+			// 巻き戻し前に確保したチャンクを再利用
+			ma->cur = ma->cur->next;
+			ma->pos = 0;
+			continue;
+		}
+		mc = HeapAlloc(mh->heap, 0, sizeof(MEMCHUNK) + ARENA_CHUNK_SIZE);
+		if (mc == NULL) {
+			return NULL;
+		}
+		mc->next = NULL;
+		mc->size = ARENA_CHUNK_SIZE;
+		if (ma->cur == NULL) {
+			ma->top = mc;
 		} else {
-			address[address_index] = (long)mem;
+			ma->cur->next = mc;
 		}
-		address_index++;
+		ma->cur = mc;
+		ma->pos = 0;
 	}
-#endif	//MEM_CHECK
-	return mem;
-#else	//_DEBUG
-	return HeapAlloc(GetProcessHeap(), 0, size);
-#endif	//_DEBUG
+	hd = (MEMHEADER *)((char *)(ma->cur + 1) + ma->pos);
+	ma->pos += need;
+	return hd;
 }
 
 /*
- * mem_calloc - obt@m
+ * arena_free - 巻き戻し用のヒープのブロックを解放
+ *
+ *	小さいブロックは再利用のためにサイズごとのリストに戻す
  */
-void *mem_calloc(const int size)
+static void arena_free(MEMHEAP *mh, MEMHEADER *hd)
 {
-#ifdef _DEBUG
-	void *mem;
+	MEMARENA *ma = mh->arena;
+	MEMLARGE *ml;
+	int c;
+
+	if (hd->size > ARENA_SMALL_MAX) {
+		ml = (MEMLARGE *)hd - 1;
+		if (ml->prev != NULL) {
+			ml->prev->next = ml->next;
+		} else {
+			ma->large = ml->next;
+		}
+		if (ml->next != NULL) {
+			ml->next->prev = ml->prev;
+		}
+		HeapFree(mh->heap, 0, ml);
+		return;
+	}
+	c = ARENA_CLASS(hd->size);
+	*(MEMHEADER **)(hd + 1) = ma->free_list[c];
+	ma->free_list[c] = hd;
+}
+
+/*
+ * arena_realloc - 巻き戻し用のヒープのブロックを再確保
+ */
+static MEMHEADER *arena_realloc(MEMHEAP *mh, MEMHEADER *hd, const SIZE_T size)
+{
+	MEMHEADER *new_hd;
+
+	if (hd->size <= ARENA_SMALL_MAX && size <= ARENA_SMALL_MAX && ARENA_CLASS(hd->size) == ARENA_CLASS(size)) {
+		return hd;
+	}
+	new_hd = arena_alloc(mh, size);
+	if (new_hd == NULL) {
+		return NULL;
+	}
+	CopyMemory(new_hd + 1, hd + 1, (hd->size < size) ? hd->size : size);
+	new_hd->mh = mh;
+	arena_free(mh, hd);
+	return new_hd;
+}
+
+/*
+ * heap_alloc - 現在のヒープからバッファを確保
+ */
+static void *heap_alloc(const DWORD flags, const int size)
+{
+	MEMHEAP *mh = cur_heap;
+	MEMHEADER *mem;
 
-	mem = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, size);
+	heap_lock(mh);
+	if (mh != NULL && check_limit(mh, size) == FALSE) {
+		heap_unlock(mh);
+		return NULL;
+	}
+	if (mh != NULL && mh->arena != NULL) {
+		mem = arena_alloc(mh, size);
+		if (mem != NULL && (flags & HEAP_ZERO_MEMORY) != 0) {
+			ZeroMemory(mem + 1, size);
+		}
+	} else {
+		mem = HeapAlloc(HEAP_HANDLE(mh), flags, sizeof(MEMHEADER) + size);
+	}
 	if (mem == NULL) {
-		return mem;
+		heap_unlock(mh);
+		return NULL;
 	}
-	all_alloc_size += HeapSize(GetProcessHeap(), 0, mem);
-#ifdef MEM_CHECK
+	mem->mh = mh;
+	mem->size = size;
+	add_size(mh, size);
+	heap_unlock(mh);
+#if defined(_DEBUG) && defined(MEM_CHECK)
 	if (address_index < ADDRESS_CNT) {
 		if (address_index == DEBUG_ADDRESS) {
-			address[address_index] = (long)mem;
+			address[address_index] = (long)(mem + 1);
 		} else {
-			address[address_index] = (long)mem;
+			address[address_index] = (long)(mem + 1);
 		}
 		address_index++;
 	}
 #endif	//MEM_CHECK
-	return mem;
-#else	//_DEBUG
-	return HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, size);
-#endif	//_DEBUG
+	return mem + 1;
 }
 
 /*
- * mem_realloc - obt@Ċm
+ * mem_alloc - バッファを確保
+ */
+void *mem_alloc(const int size)
+{
+	return heap_alloc(0, size);
+}
+
+/*
+ * mem_calloc - 初期化したバッファを確保
+ */
+void *mem_calloc(const int size)
+{
+	return heap_alloc(HEAP_ZERO_MEMORY, size);
+}
+
+/*
+ * mem_realloc - バッファを再確保
+ *
+ *	確保したヒープで再確保する
  */
 void *mem_realloc(void *mem, const int size)
 {
-#ifdef _DEBUG
-	all_alloc_size -= HeapSize(GetProcessHeap(), 0, mem);
-	mem = HeapReAlloc(GetProcessHeap(), 0, mem, size);
-	all_alloc_size += HeapSize(GetProcessHeap(), 0, mem);
-#ifdef MEM_CHECK
-	if (address_index < ADDRESS_CNT) {
-		if (address_index == DEBUG_ADDRESS) {
-			address[address_index] = (long)mem;
-		} else {
-			address[address_index] = (long)mem;
-		}
-		address_index++;
+	MEMHEADER *hd = (MEMHEADER *)mem - 1;
+	MEMHEAP *mh = hd->mh;
+	SIZE_T old_size = hd->size;
+
+	heap_lock(mh);
+	if (mh != NULL && (SIZE_T)size > old_size && check_limit(mh, size - old_size) == FALSE) {
+		heap_unlock(mh);
+		return NULL;
 	}
-#endif	//MEM_CHECK
-	return mem;
-#else	//_DEBUG
-	return HeapReAlloc(GetProcessHeap(), 0, mem, size);
-#endif	//_DEBUG
+	if (mh != NULL && mh->arena != NULL) {
+		hd = arena_realloc(mh, hd, size);
+	} else {
+		hd = HeapReAlloc(HEAP_HANDLE(mh), 0, hd, sizeof(MEMHEADER) + size);
+	}
+	if (hd == NULL) {
+		heap_unlock(mh);
+		return NULL;
+	}
+	hd->size = size;
+	sub_size(mh, old_size);
+	add_size(mh, size);
+	heap_unlock(mh);
+	return hd + 1;
 }
 
 /*
- * mem_free - obt@
+ * mem_free - バッファを解放
  */
-void mem_free(void **mem)
+void (mem_free)(void **mem)
 {
+	MEMHEADER *hd;
+	MEMHEAP *mh;
+
 	if (*mem != NULL) {
-#ifdef _DEBUG
-		all_alloc_size -= HeapSize(GetProcessHeap(), 0, *mem);
-#ifdef MEM_CHECK
+#if defined(_DEBUG) && defined(MEM_CHECK)
 		{
 			int i;
 			for (i = 0; i < ADDRESS_CNT; i++) {
@@ -134,14 +369,267 @@ void mem_free(void **mem)
 			}
 		}
 #endif	//MEM_CHECK
-#endif	//_DEBUG
-		HeapFree(GetProcessHeap(), 0, *mem);
+		hd = (MEMHEADER *)*mem - 1;
+		mh = hd->mh;
+		heap_lock(mh);
+		sub_size(mh, hd->size);
+		if (mh != NULL && mh->arena != NULL) {
+			arena_free(mh, hd);
+		} else {
+			HeapFree(HEAP_HANDLE(mh), 0, hd);
+		}
+		heap_unlock(mh);
 		*mem = NULL;
 	}
 }
 
 /*
- * mem_debug - ̕\
+ * mem_heap_create - ヒープの作成
+ *
+ *	作成したヒープは1つのスレッドからのみ使用するため排他制御を行わない
+ *	複数のスレッドから使用する間は mem_heap_set_serialize で排他制御を有効にする
+ */
+MEMHEAP *mem_heap_create(void)
+{
+	MEMHEAP *mh;
+
+	mh = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(MEMHEAP));
+	if (mh == NULL) {
+		return NULL;
+	}
+	mh->heap = HeapCreate(HEAP_NO_SERIALIZE, 0, 0);
+	if (mh->heap == NULL) {
+		HeapFree(GetProcessHeap(), 0, mh);
+		return NULL;
+	}
+	InitializeCriticalSection(&mh->cs);
+	return mh;
+}
+
+/*
+ * mem_heap_create_rewind - 巻き戻し用のヒープの作成
+ *
+ *	小さいブロックはチャンクから順に確保し、mem_heap_rewind でまとめて破棄する
+ *	解放したブロックは同じサイズの確保で再利用する
+ */
+MEMHEAP *mem_heap_create_rewind(void)
+{
+	MEMHEAP *mh;
+
+	mh = mem_heap_create();
+	if (mh == NULL) {
+		return NULL;
+	}
+	mh->arena = HeapAlloc(mh->heap, HEAP_ZERO_MEMORY, sizeof(MEMARENA));
+	if (mh->arena == NULL) {
+		mem_heap_destroy(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/*
+ * mem_heap_rewind - 巻き戻し用のヒープから確保したバッファをすべて破棄
+ *
+ *	チャンクは解放せずに先頭から再利用する (個別に確保した大きいブロックのみ解放する)
+ */
+void mem_heap_rewind(MEMHEAP *mh)
+{
+	MEMARENA *ma;
+	MEMLARGE *ml, *next;
+
+	if (mh == NULL || (ma = mh->arena) == NULL) {
+		return;
+	}
+	heap_lock(mh);
+	for (ml = ma->large; ml != NULL; ml = next) {
+		next = ml->next;
+		HeapFree(mh->heap, 0, ml);
+	}
+	ma->large = NULL;
+	ZeroMemory(ma->free_list, sizeof(ma->free_list));
+	ma->cur = ma->top;
+	ma->pos = 0;
+	if (mh->parent != NULL) {
+		sub_size(mh->parent, mh->size);
+	}
+	mh->size = 0;
+	heap_unlock(mh);
+}
+
+/*
+ * mem_heap_destroy - ヒープの破棄
+ *
+ *	ヒープから確保したバッファはすべて解放される
+ */
+void mem_heap_destroy(MEMHEAP *mh)
+{
+	if (mh == NULL) {
+		return;
+	}
+	if (cur_heap == mh) {
+		cur_heap = NULL;
+	}
+	if (mh->parent != NULL) {
+		// 残っているサイズを親のヒープから減算
+		sub_size(mh->parent, mh->size);
+	}
+	HeapDestroy(mh->heap);
+	DeleteCriticalSection(&mh->cs);
+	HeapFree(GetProcessHeap(), 0, mh);
+}
+
+/*
+ * mem_heap_select - 現在のスレッドで使用するヒープを設定
+ */
+MEMHEAP *mem_heap_select(MEMHEAP *mh)
+{
+	MEMHEAP *prev = cur_heap;
+
+	cur_heap = mh;
+	return prev;
+}
+
+/*
+ * mem_heap_get - 現在のスレッドで使用するヒープを取得
+ */
+MEMHEAP *mem_heap_get(void)
+{
+	return cur_heap;
+}
+
+/*
+ * mem_heap_owner - バッファを確保したヒープを取得
+ *
+ *	mem_alloc で確保したバッファのみ指定できる (NULL はプロセスヒープ)
+ */
+MEMHEAP *mem_heap_owner(void *mem)
+{
+	return ((MEMHEADER *)mem - 1)->mh;
+}
+
+/*
+ * mem_heap_set_serialize - ヒープの排他制御を設定
+ *
+ *	ワーカースレッドが同じヒープから確保する間のみ有効にする
+ *	有効にしている間は親のヒープの使用サイズもロック内で更新する
+ */
+void mem_heap_set_serialize(MEMHEAP *mh, const BOOL serialize)
+{
+	if (mh != NULL) {
+		mh->serialize = serialize;
+	}
+}
+
+/*
+ * mem_heap_set_limit - ヒープの使用サイズの上限を設定
+ *
+ *	上限を超える確保は失敗する
+ */
+void mem_heap_set_limit(MEMHEAP *mh, const SIZE_T limit)
+{
+	if (mh != NULL) {
+		mh->limit = limit;
+	}
+}
+
+/*
+ * mem_heap_set_parent - 使用サイズを加算するヒープを設定
+ *
+ *	子のヒープの確保は親のヒープの上限も対象になる
+ */
+void mem_heap_set_parent(MEMHEAP *mh, MEMHEAP *parent)
+{
+	if (mh == NULL) {
+		return;
+	}
+	if (mh->parent != NULL) {
+		sub_size(mh->parent, mh->size);
+	}
+	mh->parent = parent;
+	if (parent != NULL) {
+		add_size(parent, mh->size);
+	}
+}
+
+/*
+ * mem_heap_usage - ヒープの使用サイズを取得
+ */
+void mem_heap_usage(MEMHEAP *mh, SIZE_T *size, SIZE_T *peak)
+{
+	if (size != NULL) {
+		*size = (mh != NULL) ? mh->size : 0;
+	}
+	if (peak != NULL) {
+		*peak = (mh != NULL) ? mh->peak : 0;
+	}
+}
+
+/*
+ * mem_page_alloc - ページ単位でバッファを確保
+ *
+ *	サイズは現在のヒープの使用サイズに加算して上限の対象にする
+ *	解放時は mh に設定したヒープを指定する
+ */
+void *mem_page_alloc(const SIZE_T size, MEMHEAP **mh)
+{
+	void *mem;
+
+	*mh = cur_heap;
+	heap_lock(*mh);
+	if (*mh != NULL && check_limit(*mh, size) == FALSE) {
+		heap_unlock(*mh);
+		return NULL;
+	}
+	mem = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (mem != NULL) {
+		add_size(*mh, size);
+	}
+	heap_unlock(*mh);
+	return mem;
+}
+
+/*
+ * mem_page_decommit - アドレス範囲を残して物理メモリを解放
+ */
+void mem_page_decommit(MEMHEAP *mh, void *mem, const SIZE_T size)
+{
+	if (mem != NULL) {
+		heap_lock(mh);
+		sub_size(mh, size);
+		heap_unlock(mh);
+		VirtualFree(mem, size, MEM_DECOMMIT);
+	}
+}
+
+/*
+ * mem_page_free - ページ単位で確保したバッファを解放
+ */
+void (mem_page_free)(MEMHEAP *mh, void **mem, const SIZE_T size, const BOOL commit)
+{
+	if (*mem != NULL) {
+		if (commit == TRUE) {
+			heap_lock(mh);
+			sub_size(mh, size);
+			heap_unlock(mh);
+		}
+		VirtualFree(*mem, 0, MEM_RELEASE);
+		*mem = NULL;
+	}
+}
+
+/*
+ * mem_peak - 確保したメモリの最大値を取得
+ */
+#ifdef _DEBUG
+SIZE_T mem_peak(void)
+{
+	return (SIZE_T)peak_alloc_size;
+}
+#endif	//_DEBUG
+
+/*
+ * mem_debug - メモリ情報の表示
  */
 #ifdef _DEBUG
 void mem_debug(void)
@@ -169,7 +657,7 @@ void mem_debug(void)
 #endif	//_DEBUG
 
 /*
- * alloc_copy - obt@mۂĕRs[
+ * alloc_copy - バッファを確保して文字列をコピーする
  */
 TCHAR *alloc_copy(const TCHAR *buf)
 {
@@ -186,7 +674,7 @@ TCHAR *alloc_copy(const TCHAR *buf)
 }
 
 /*
- * alloc_copy_n - obt@mۂĎw蒷̕Rs[
+ * alloc_copy_n - バッファを確保して指定長さ分の文字列をコピーする
  */
 TCHAR *alloc_copy_n(TCHAR *buf, const int size)
 {
@@ -203,7 +691,7 @@ TCHAR *alloc_copy_n(TCHAR *buf, const int size)
 }
 
 /*
- * alloc_join - obt@mۂĕA
+ * alloc_join - バッファを確保して文字列を連結する
  */
 TCHAR *alloc_join(const TCHAR *buf1, const TCHAR *buf2)
 {
@@ -16,15 +16,50 @@
 #include <tchar.h>
 
 /* Define */
+//解放後に NULL を設定するため任意の型のポインタのアドレスを受け取る
+#define mem_free(mem)					(mem_free)((void **)(mem))
+#define mem_page_free(mh, mem, size, commit)	(mem_page_free)(mh, (void **)(mem), size, commit)
 
 /* Struct */
+//ヒープ
+typedef struct _MEMHEAP {
+	HANDLE heap;
+	//使用中のサイズ
+	SIZE_T size;
+	//使用サイズの最大値
+	SIZE_T peak;
+	//使用サイズの上限 (0の場合は無制限)
+	SIZE_T limit;
+	//使用サイズを加算するヒープ
+	struct _MEMHEAP *parent;
+	//複数のスレッドから使用する間の排他制御
+	CRITICAL_SECTION cs;
+	BOOL serialize;
+	//巻き戻し用のヒープの管理情報 (mem_heap_create_rewind で作成した場合)
+	struct _MEMARENA *arena;
+} MEMHEAP;
 
 /* Function Prototypes */
 void *mem_alloc(const int size);
 void *mem_calloc(const int size);
 void *mem_realloc(void *mem, const int size);
-void mem_free(void **mem);
+void (mem_free)(void **mem);
+MEMHEAP *mem_heap_create(void);
+MEMHEAP *mem_heap_create_rewind(void);
+void mem_heap_rewind(MEMHEAP *mh);
+void mem_heap_destroy(MEMHEAP *mh);
+MEMHEAP *mem_heap_select(MEMHEAP *mh);
+MEMHEAP *mem_heap_get(void);
+MEMHEAP *mem_heap_owner(void *mem);
+void mem_heap_set_serialize(MEMHEAP *mh, const BOOL serialize);
+void mem_heap_set_limit(MEMHEAP *mh, const SIZE_T limit);
+void mem_heap_set_parent(MEMHEAP *mh, MEMHEAP *parent);
+void mem_heap_usage(MEMHEAP *mh, SIZE_T *size, SIZE_T *peak);
+void *mem_page_alloc(const SIZE_T size, MEMHEAP **mh);
+void mem_page_decommit(MEMHEAP *mh, void *mem, const SIZE_T size);
+void (mem_page_free)(MEMHEAP *mh, void **mem, const SIZE_T size, const BOOL commit);
 #ifdef _DEBUG
+SIZE_T mem_peak(void);
 void mem_debug(void);
 #endif
 
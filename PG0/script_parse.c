@@ -18,6 +18,16 @@
 /* Define */
 #define IS_SPACE(c)				(c == TEXT(' ') || c == TEXT('\t') || c == TEXT('\r'))
 
+#ifndef UNICODE
+#ifdef _WIN32
+//全角空白のバイト数 (CP932)
+#define MB_SPACE_LEN(p)			((*(p) == (TCHAR)0x81 && *((p) + 1) == (TCHAR)0x40) ? 2 : 0)
+#else
+//全角空白のバイト数 (UTF-8)
+#define MB_SPACE_LEN(p)			((*(p) == (TCHAR)0xE3 && *((p) + 1) == (TCHAR)0x80 && *((p) + 2) == (TCHAR)0x80) ? 3 : 0)
+#endif
+#endif
+
 /* Global Variables */
 typedef struct _PARSEINFO {
 	EXECINFO *ei;
@@ -41,7 +51,7 @@ static void GetExtensionKeyword(PARSEINFO *pi, TCHAR *s);
 static BOOL GetToken(PARSEINFO *pi);
 static TOKEN *CreateToken(int type, TCHAR *p, int line);
 
-//
+//式
 static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *Array(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *UnaryOperator(PARSEINFO *pi, TOKEN *cu_tk);
@@ -61,7 +71,7 @@ static TOKEN *Assignment(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *Expression(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *ExpressionStatement(PARSEINFO *pi, TOKEN *cu_tk);
 
-//
+//制御
 static TOKEN *Condition(PARSEINFO *pi, TOKEN *cu_tk, BOOL isDo);
 static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *SwitchStatement(PARSEINFO *pi, TOKEN *cu_tk);
@@ -72,16 +82,17 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *JumpStatement(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *CaseStatement(PARSEINFO *pi, TOKEN *cu_tk);
 
-//`
+//定義
 static TOKEN *VarDeclList(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *VarDecl(PARSEINFO *pi, TOKEN *cu_tk);
 
-//\
+//構文
 static TOKEN *CompoundStatement(PARSEINFO *pi, TOKEN *cu_tk);
 static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk);
+static void SetLineHead(TOKEN *tk, int prev_line);
 
 /*
- * GetExtensionToken - (g)
+ * GetExtensionToken - 字句解析(拡張)
  */
 static BOOL GetExtensionToken(PARSEINFO *pi)
 {
@@ -299,11 +310,11 @@ static BOOL GetExtensionToken(PARSEINFO *pi)
 }
 
 /*
- * GetExtensionKeyword - \(g)
+ * GetExtensionKeyword - 予約語(拡張)
  */
 static void GetExtensionKeyword(PARSEINFO *pi, TCHAR *s)
 {
-	//\
+	//予約語
 	if (str_cmp_i(s, TEXT("for")) == 0) {
 		pi->type = SYM_FOR;
 	} else if (str_cmp_i(s, TEXT("do")) == 0) {
@@ -326,7 +337,7 @@ static void GetExtensionKeyword(PARSEINFO *pi, TCHAR *s)
 }
 
 /*
- * GetToken - 
+ * GetToken - 字句解析
  */
 static BOOL GetToken(PARSEINFO *pi)
 {
@@ -334,12 +345,12 @@ static BOOL GetToken(PARSEINFO *pi)
 	int prev_type = pi->type;
 
 #ifdef UNICODE
-	for (pi->p = pi->r; IS_SPACE(*pi->p) || *pi->p == TEXT('@'); pi->p++);
+	for (pi->p = pi->r; IS_SPACE(*pi->p) || *pi->p == TEXT('　'); pi->p++);
 #else
-	for (pi->p = pi->r; IS_SPACE(*pi->p) || (*pi->p == (TCHAR)0x81 && *(pi->p + 1) == (TCHAR)0x40); pi->p++) {
-		if (*pi->p == (TCHAR)0x81 && *(pi->p + 1) == (TCHAR)0x40) {
-			// Sp
-			pi->p++;
+	for (pi->p = pi->r; IS_SPACE(*pi->p) || MB_SPACE_LEN(pi->p) > 0; pi->p++) {
+		if (MB_SPACE_LEN(pi->p) > 0) {
+			// 全角空白
+			pi->p += MB_SPACE_LEN(pi->p) - 1;
 		}
 	}
 #endif
@@ -550,7 +561,7 @@ static BOOL GetToken(PARSEINFO *pi)
 
 	case TEXT('/'):
 		if (*(pi->p + 1) == TEXT('/')) {
-			//Rg
+			//コメント
 			for (; *pi->r != TEXT('\0') && *pi->r != TEXT('\r') && *pi->r != TEXT('\n'); pi->r++);
 			return GetToken(pi);
 		}
@@ -612,7 +623,7 @@ static BOOL GetToken(PARSEINFO *pi)
 
 	if ((*pi->p >= TEXT('0') && *pi->p <= TEXT('9')) ||
 		(*pi->p == TEXT('.') && *(pi->p + 1) >= TEXT('0') && *(pi->p + 1) <= TEXT('9'))) {
-		//萔
+		//定数
 		pi->type = SYM_CONST_INT;
 		if (pi->extension == TRUE && *pi->p == TEXT('0') && (*(pi->p + 1) == TEXT('x') || *(pi->p + 1) == TEXT('X'))) {
 			for (pi->r += 2; (*pi->r >= TEXT('0') && *pi->r <= TEXT('9')) ||
@@ -654,7 +665,7 @@ static BOOL GetToken(PARSEINFO *pi)
 		return FALSE;
 	}
 
-	//\
+	//予約語
 	if (str_cmp_i(s, TEXT("var")) == 0) {
 		pi->type = SYM_VAR;
 	} else if (str_cmp_i(s, TEXT("exit")) == 0) {
@@ -677,28 +688,28 @@ static BOOL GetToken(PARSEINFO *pi)
 	}
 
 #ifdef UNICODE
-	for (r = pi->r; *r == TEXT(' ') || *r == TEXT('\t') || *r == TEXT('@'); r++);
+	for (r = pi->r; *r == TEXT(' ') || *r == TEXT('\t') || *r == TEXT('　'); r++);
 #else
-	for (r = pi->r; *r == TEXT(' ') || *r == TEXT('\t') || (*r == (TCHAR)0x81 && *(r + 1) == (TCHAR)0x40); r++) {
-		if (*r == (TCHAR)0x81 && *(r + 1) == (TCHAR)0x40) {
-			// Sp
-			r++;
+	for (r = pi->r; *r == TEXT(' ') || *r == TEXT('\t') || MB_SPACE_LEN(r) > 0; r++) {
+		if (MB_SPACE_LEN(r) > 0) {
+			// 全角空白
+			r += MB_SPACE_LEN(r) - 1;
 		}
 	}
 #endif
 	if (pi->extension == TRUE && *r == '(') {
-		// ֐
+		// 関数
 		pi->type = SYM_FUNC;
 		pi->concat = TRUE;
 	} else {
-		// ϐ
+		// 変数
 		pi->type = SYM_VARIABLE;
 	}
 	return TRUE;
 }
 
 /*
- * CreateToken - g[N̍쐬
+ * CreateToken - トークンの作成
  */
 static TOKEN *CreateToken(int type, TCHAR *p, int line)
 {
@@ -715,7 +726,7 @@ static TOKEN *CreateToken(int type, TCHAR *p, int line)
 }
 
 /*
- * Primary - vf
+ * Primary - 要素
  */
 static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -770,7 +781,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 			Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 			return NULL;
 		}
-		//̊Jnʒuݒ
+		//引数の開始位置を設定
 		cu_tk = cu_tk->next = CreateToken(SYM_ARGSTART, pi->p, -1);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -779,7 +790,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 #ifdef DEBUG_SET
 		cu_tk->buf = alloc_copy(TEXT("(argument start)"));
 #endif
-		//֐
+		//関数名
 		tk = CreateToken(pi->type, pi->p, pi->line);
 		if (tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -808,7 +819,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 			return NULL;
 		}
 
-		//
+		//引数
 		cu_tk = Expression(pi, cu_tk);
 		if (cu_tk == NULL) {
 			FreeToken(tk);
@@ -826,14 +837,14 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 			return NULL;
 		}
 
-		//֐ǉ
+		//関数名を追加
 		cu_tk = cu_tk->next = tk;
 		break;
 
 	case SYM_VARIABLE:
-		//ϐ
+		//変数
 		if (pi->decl == TRUE || pi->ei->decl == TRUE) {
-			//ϐ錾
+			//変数宣言
 			cu_tk = cu_tk->next = CreateToken(SYM_DECLVARIABLE, pi->p, pi->line);
 		} else {
 			cu_tk = cu_tk->next = CreateToken(pi->type, pi->p, pi->line);
@@ -853,7 +864,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_CONST_INT:
-		//萔()
+		//定数(整数)
 		cu_tk = cu_tk->next = CreateToken(pi->type, pi->p, pi->line);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -866,14 +877,14 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 		}
 
 		if (*s != TEXT('0') || *(s + 1) == TEXT('\0')) {
-			//10i
+			//10進数
 			cu_tk->i = _ttoi(s);
 
 		} else if (*(s + 1) == TEXT('x') || *(s + 1) == TEXT('X')) {
-			//16i
+			//16進数
 			cu_tk->i = x2d(s + 2);
 		} else {
-			//8i
+			//8進数
 			cu_tk->i = o2d(s + 1);
 		}
 		mem_free(&s);
@@ -888,7 +899,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_CONST_FLOAT:
-		//萔()
+		//定数(実数)
 		cu_tk = cu_tk->next = CreateToken(pi->type, pi->p, pi->line);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -912,7 +923,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_CONST_STRING:
-		//萔
+		//文字列定数
 		cu_tk = cu_tk->next = CreateToken(pi->type, pi->p, pi->line);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -936,7 +947,7 @@ static TOKEN *Primary(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Array - z
+ * Array - 配列
  */
 static TOKEN *Array(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -949,7 +960,7 @@ static TOKEN *Array(PARSEINFO *pi, TOKEN *cu_tk)
 			return NULL;
 		}
 		if (pi->type != SYM_ARRAYCLOSE) {
-			//vf
+			//要素
 			cu_tk = LogicalOR(pi, cu_tk);
 			if (cu_tk == NULL) {
 				return NULL;
@@ -958,7 +969,7 @@ static TOKEN *Array(PARSEINFO *pi, TOKEN *cu_tk)
 				Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 				return NULL;
 			}
-			//z񎯕ʎq̒ǉ
+			//配列識別子の追加
 			cu_tk = cu_tk->next = CreateToken(SYM_ARRAY, pi->p, pi->line);
 			if (cu_tk == NULL) {
 				Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -980,7 +991,7 @@ static TOKEN *Array(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * UnaryOperator - PZq
+ * UnaryOperator - 単項演算子
  */
 static TOKEN *UnaryOperator(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1007,7 +1018,7 @@ static TOKEN *UnaryOperator(PARSEINFO *pi, TOKEN *cu_tk)
 		tmp = alloc_copy_n(pi->p, pi->r - pi->p);
 #endif
 		if (pi->type == SYM_BINC || pi->type == SYM_BDEC) {
-			//u
+			//後置
 #ifdef DEBUG_SET
 			tk->buf = alloc_join(tmp, TEXT("(Postfix)"));
 			mem_free(&tmp);
@@ -1022,7 +1033,7 @@ static TOKEN *UnaryOperator(PARSEINFO *pi, TOKEN *cu_tk)
 				return NULL;
 			}
 		} else {
-			//Ou
+			//前置
 #ifdef DEBUG_SET
 			tk->buf = tmp;
 #endif
@@ -1042,7 +1053,7 @@ static TOKEN *UnaryOperator(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Multiplicative - ZAZA]
+ * Multiplicative - 乗算、割算、剰余
  */
 static TOKEN *Multiplicative(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1076,7 +1087,7 @@ static TOKEN *Multiplicative(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Additive - ZAZ
+ * Additive - 加算、減算
  */
 static TOKEN *Additive(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1110,7 +1121,7 @@ static TOKEN *Additive(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Shift - rbgVtg
+ * Shift - ビットシフト
  */
 static TOKEN *Shift(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1145,7 +1156,7 @@ static TOKEN *Shift(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Relational - r (<, >, <=, >=)
+ * Relational - 比較 (<, >, <=, >=)
  */
 static TOKEN *Relational(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1180,7 +1191,7 @@ static TOKEN *Relational(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Equality - r (==, !=)
+ * Equality - 比較 (==, !=)
  */
 static TOKEN *Equality(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1214,7 +1225,7 @@ static TOKEN *Equality(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * AND - _
+ * AND - 論理積
  */
 static TOKEN *AND(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1248,7 +1259,7 @@ static TOKEN *AND(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * ExclusiveOR - rI_a
+ * ExclusiveOR - 排他的論理和
  */
 static TOKEN *ExclusiveOR(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1282,7 +1293,7 @@ static TOKEN *ExclusiveOR(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * OR - _a
+ * OR - 論理和
  */
 static TOKEN *OR(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1316,7 +1327,7 @@ static TOKEN *OR(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * LogicalAND - _
+ * LogicalAND - 論理積
  */
 static TOKEN *LogicalAND(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1327,7 +1338,7 @@ static TOKEN *LogicalAND(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 	while (pi->type == SYM_CPAND) {
-		//O̎0̏ꍇAND̏IɈړ
+		//前の式が0の場合はANDの終わりに移動
 		jmp_tk = cu_tk = cu_tk->next = CreateToken(SYM_JZE, pi->p, -1);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1369,7 +1380,7 @@ static TOKEN *LogicalAND(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * LogicalOR - _a
+ * LogicalOR - 論理和
  */
 static TOKEN *LogicalOR(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1380,7 +1391,7 @@ static TOKEN *LogicalOR(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 	while (pi->type == SYM_CPOR) {
-		//O̎0ȊȌꍇOȐIɈړ
+		//前の式が0以外の場合はORの終わりに移動
 		jmp_tk = cu_tk = cu_tk->next = CreateToken(SYM_JNZ, pi->p, -1);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1422,7 +1433,7 @@ static TOKEN *LogicalOR(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
-* ArrayKey - z̃L[
+* ArrayKey - 配列のキー
 */
 static TOKEN *ArrayKey(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1459,7 +1470,7 @@ static TOKEN *ArrayKey(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * CompoundAssignment - Z
+ * CompoundAssignment - 複合代入演算式
  */
 static TOKEN *CompoundAssignment(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1472,7 +1483,7 @@ static TOKEN *CompoundAssignment(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 	while (pi->type == SYM_COMP_EQ) {
-		// Zq
+		// 複合代入演算子
 		comp_eqtk = CreateToken(pi->type, pi->p, pi->line);
 		if (comp_eqtk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1481,7 +1492,7 @@ static TOKEN *CompoundAssignment(PARSEINFO *pi, TOKEN *cu_tk)
 #ifdef DEBUG_SET
 		comp_eqtk->buf = alloc_copy(TEXT("(=)"));
 #endif
-		// ZpZq
+		// 算術演算子
 		comptk = CreateToken(pi->compoundType, pi->p, pi->line);
 		if (comptk == NULL) {
 			FreeToken(comp_eqtk);
@@ -1491,7 +1502,7 @@ static TOKEN *CompoundAssignment(PARSEINFO *pi, TOKEN *cu_tk)
 #ifdef DEBUG_SET
 		comptk->buf = alloc_copy_n(pi->p, pi->r - pi->p - 1);
 #endif
-		// Zq
+		// 代入演算子
 		eqtk = CreateToken(SYM_EQ, pi->p, pi->line);
 		if (eqtk == NULL) {
 			FreeToken(comp_eqtk);
@@ -1523,7 +1534,7 @@ static TOKEN *CompoundAssignment(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Assignment - 
+ * Assignment - 代入式
  */
 static TOKEN *Assignment(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1560,7 +1571,7 @@ static TOKEN *Assignment(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Expression - 1 , 2
+ * Expression - 式1 , 式2
  */
 static TOKEN *Expression(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1589,7 +1600,7 @@ static TOKEN *Expression(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * ExpressionStatement - 
+ * ExpressionStatement - 式
  */
 static TOKEN *ExpressionStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -1623,7 +1634,7 @@ static TOKEN *ExpressionStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * Condition - 
+ * Condition - 条件式
  */
 static TOKEN *Condition(PARSEINFO *pi, TOKEN *cu_tk, BOOL isDo)
 {
@@ -1643,7 +1654,7 @@ static TOKEN *Condition(PARSEINFO *pi, TOKEN *cu_tk, BOOL isDo)
 		Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 		return NULL;
 	}
-	//
+	//条件式
 	pi->condition = TRUE;
 	cu_tk = ArrayKey(pi, cu_tk);
 	pi->condition = FALSE;
@@ -1668,14 +1679,14 @@ static TOKEN *Condition(PARSEINFO *pi, TOKEN *cu_tk, BOOL isDo)
 }
 
 /*
- * IfStatement - if
+ * IfStatement - if文
  */
 static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
 	TOKEN *end_tk, *else_tk;
 	int line;
 
-	//CMPJnʒu
+	//CMP開始位置
 	cu_tk = cu_tk->next = CreateToken(SYM_CMPSTART, pi->p, pi->line);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1685,13 +1696,13 @@ static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("CMPSTART:"));
 #endif
 
-	//
+	//条件式
 	line = pi->line;
 	cu_tk = Condition(pi, cu_tk, FALSE);
 	if (cu_tk == NULL) {
 		return NULL;
 	}
-	//CMPǉ
+	//CMPを追加
 	cu_tk = cu_tk->next = CreateToken(SYM_CMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1701,7 +1712,7 @@ static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("CMP"));
 #endif
 
-	//ELSEɈړ
+	//ELSEに移動
 	else_tk = cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1711,14 +1722,14 @@ static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("jump ELSE"));
 #endif
 
-	//Ώ
+	//処理対象
 	cu_tk = StatementList(pi, cu_tk);
 	if (cu_tk == NULL) {
 		return NULL;
 	}
 	line = pi->line;
 
-	//rIʒuɈړ
+	//比較終了位置に移動
 	end_tk = cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1739,7 +1750,7 @@ static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 #endif
 	if (pi->type == SYM_ELSE) {
 		TCHAR *r = pi->p;
-		//Ώ
+		//処理対象
 		pi->concat = TRUE;
 		if (GetToken(pi) == FALSE) {
 			return NULL;
@@ -1761,7 +1772,7 @@ static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		}
 	}
 
-	//rIʒu
+	//比較終了位置
 	end_tk->link = cu_tk = cu_tk->next = CreateToken(SYM_CMPEND, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1774,17 +1785,17 @@ static TOKEN *IfStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * SwitchStatement - switch
+ * SwitchStatement - switch文
  */
 static TOKEN *SwitchStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
 	int line = pi->line;
-	//
+	//条件式
 	cu_tk = Condition(pi, cu_tk, FALSE);
 	if (cu_tk == NULL) {
 		return NULL;
 	}
-	//switch̒ǉ
+	//switchの追加
 	cu_tk = cu_tk->next = CreateToken(SYM_SWITCH, pi->p, line);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1794,7 +1805,7 @@ static TOKEN *SwitchStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("SWITCH"));
 #endif
 
-	//Ώ
+	//処理対象
 	if (pi->type != SYM_BOPEN) {
 		Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 		return NULL;
@@ -1804,13 +1815,13 @@ static TOKEN *SwitchStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * WhileStatement - while
+ * WhileStatement - while文
  */
 static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
 	TOKEN *st_tk, *end_tk, ttk;
 
-	//[vJnʒu
+	//ループ開始位置
 	st_tk = cu_tk = cu_tk->next = CreateToken(SYM_LOOPSTART, pi->p, pi->line);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1820,12 +1831,12 @@ static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("LOOPSTART:"));
 #endif
 
-	//
+	//条件式
 	cu_tk = Condition(pi, cu_tk, FALSE);
 	if (cu_tk == NULL) {
 		return NULL;
 	}
-	//LOOPǉ
+	//LOOPを追加
 	cu_tk = cu_tk->next = CreateToken(SYM_LOOP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1835,7 +1846,7 @@ static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("LOOP"));
 #endif
 
-	//Ώ
+	//処理対象
 	ttk.next = NULL;
 	if (StatementList(pi, &ttk) == NULL) {
 		FreeToken(ttk.next);
@@ -1843,7 +1854,7 @@ static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	}
 	cu_tk->target = ttk.next;
 
-	//[vIʒuɈړ
+	//ループ終了位置に移動
 	end_tk = cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1853,7 +1864,7 @@ static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("jump LOOPEND"));
 #endif
 
-	//[vJnʒuɈړ
+	//ループ開始位置に移動
 	cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1864,7 +1875,7 @@ static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 #endif
 	cu_tk->link = st_tk;
 
-	//[vIʒu
+	//ループ終了位置
 	end_tk->link = cu_tk = cu_tk->next = CreateToken(SYM_LOOPEND, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1877,13 +1888,13 @@ static TOKEN *WhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * DoWhileStatement - do`while
+ * DoWhileStatement - do～while文
  */
 static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
 	TOKEN *st_tk, *end_tk, ttk;
 
-	//[vJnʒu
+	//ループ開始位置
 	st_tk = cu_tk = cu_tk->next = CreateToken(SYM_LOOPSTART, pi->p, pi->line);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1893,7 +1904,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("LOOPSTART:"));
 #endif
 
-	//LOOPǉ
+	//LOOPを追加
 	cu_tk = cu_tk->next = CreateToken(SYM_LOOP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1910,7 +1921,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//Ώ
+	//処理対象
 	ttk.next = NULL;
 	if (StatementList(pi, &ttk) == NULL) {
 		FreeToken(ttk.next);
@@ -1918,7 +1929,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	}
 	cu_tk->target = ttk.next;
 
-	//LOOPp̃_~[
+	//LOOP用のダミー
 	cu_tk = cu_tk->next = CreateToken(SYM_DAMMY, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1928,17 +1939,17 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("DAMMY:"));
 #endif
 
-	//whileĂ邩`FbN
+	//whileが続いているかチェック
 	if (pi->type != SYM_WHILE) {
 		Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 		return NULL;
 	}
-	//
+	//条件式
 	cu_tk = Condition(pi, cu_tk, TRUE);
 	if (cu_tk == NULL) {
 		return NULL;
 	}
-	//CMPǉ
+	//CMPを追加
 	cu_tk = cu_tk->next = CreateToken(SYM_CMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1953,7 +1964,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//[vIʒuɈړ
+	//ループ終了位置に移動
 	end_tk = cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1963,7 +1974,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("jump LOOPEND"));
 #endif
 
-	//[vJnʒuɈړ
+	//ループ開始位置に移動
 	cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1974,7 +1985,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 #endif
 	cu_tk->link = st_tk;
 
-	//[vIʒu
+	//ループ終了位置
 	end_tk->link = cu_tk = cu_tk->next = CreateToken(SYM_LOOPEND, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -1987,7 +1998,7 @@ static TOKEN *DoWhileStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * ForStatement - for
+ * ForStatement - for文
  */
 static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -2007,7 +2018,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//
+	//初期化
 	if (pi->type == SYM_VAR) {
 		//var
 		if (GetToken(pi) == FALSE) {
@@ -2034,7 +2045,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy_n(pi->p, pi->r - pi->p);
 #endif
 
-	//[vJnʒu
+	//ループ開始位置
 	st_tk = cu_tk = cu_tk->next = CreateToken(SYM_LOOPSTART, pi->p, line);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2047,7 +2058,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//
+	//条件
 	pi->condition = TRUE;
 	cu_tk = ArrayKey(pi, cu_tk);
 	pi->condition = FALSE;
@@ -2064,7 +2075,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//ď
+	//再初期化
 	re_tk.next = NULL;
 	if (Expression(pi, &re_tk) == NULL) {
 		return NULL;
@@ -2077,7 +2088,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//LOOPǉ
+	//LOOPを追加
 	cu_tk = cu_tk->next = CreateToken(SYM_LOOP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2093,7 +2104,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	//Ώ
+	//処理対象
 	ttk.next = NULL;
 	if (StatementList(pi, &ttk) == NULL) {
 		FreeToken(re_tk.next);
@@ -2102,7 +2113,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	}
 	cu_tk->target = ttk.next;
 
-	//[vIʒuɈړ
+	//ループ終了位置に移動
 	end_tk = cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2113,7 +2124,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("jump LOOPEND"));
 #endif
 
-	//ďǉ
+	//再初期化を追加
 	for (cu_tk->next = re_tk.next; cu_tk->next != NULL; cu_tk = cu_tk->next);
 	cu_tk = cu_tk->next = CreateToken(SYM_LINESEP, pi->p, -1);
 	if (cu_tk == NULL) {
@@ -2124,7 +2135,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT(";"));
 #endif
 
-	//[vJnʒuɈړ
+	//ループ開始位置に移動
 	cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2135,7 +2146,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 #endif
 	cu_tk->link = st_tk;
 
-	//[vIʒu
+	//ループ終了位置
 	end_tk->link = cu_tk = cu_tk->next = CreateToken(SYM_LOOPEND, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2148,7 +2159,7 @@ static TOKEN *ForStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * JumpStatement - Wv
+ * JumpStatement - ジャンプ
  */
 static TOKEN *JumpStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -2169,7 +2180,7 @@ static TOKEN *JumpStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 	if (type == SYM_EXIT || type == SYM_RETURN) {
-		//l
+		//値
 		pi->condition = TRUE;
 		cu_tk = ArrayKey(pi, cu_tk);
 		pi->condition = FALSE;
@@ -2202,7 +2213,7 @@ static TOKEN *JumpStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * CaseStatement - CASEx
+ * CaseStatement - CASEラベル
  */
 static TOKEN *CaseStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -2220,7 +2231,7 @@ static TOKEN *CaseStatement(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 	if (type == SYM_CASE) {
-		//l
+		//値
 		pi->case_end = pi->condition = TRUE;
 		cu_tk = ArrayKey(pi, cu_tk);
 		pi->case_end = pi->condition = FALSE;
@@ -2247,12 +2258,12 @@ static TOKEN *CaseStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * VarDeclList - ϐXg
+ * VarDeclList - 変数リスト
  */
 static TOKEN *VarDeclList(PARSEINFO *pi, TOKEN *cu_tk)
 {
 	while (1) {
-		//
+		//左辺
 		pi->decl = TRUE;
 		cu_tk = Array(pi, cu_tk);
 		pi->decl = FALSE;
@@ -2288,7 +2299,7 @@ static TOKEN *VarDeclList(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * VarDecl - ϐ
+ * VarDecl - 変数
  */
 static TOKEN *VarDecl(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -2296,7 +2307,7 @@ static TOKEN *VarDecl(PARSEINFO *pi, TOKEN *cu_tk)
 	if (GetToken(pi) == FALSE) {
 		return NULL;
 	}
-	//ϐXg
+	//変数リスト
 	cu_tk = VarDeclList(pi, cu_tk);
 	if (cu_tk == NULL) {
 		return NULL;
@@ -2324,14 +2335,14 @@ static TOKEN *VarDecl(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * FuncDecl - ֐
+ * FuncDecl - 関数
  */
 static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 {
 	FUNCINFO *fi;
 	TOKEN *tk, *end_tk;
 
-	// ֐IʒuɈړ
+	// 関数終了位置に移動
 	end_tk = cu_tk = cu_tk->next = CreateToken(SYM_JUMP, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2341,7 +2352,7 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 	cu_tk->buf = alloc_copy(TEXT("jump FUNCEND"));
 #endif
 
-	// ֐
+	// 関数
 	cu_tk = cu_tk->next = CreateToken(pi->type, pi->p, pi->line);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2354,7 +2365,7 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	// ֐
+	// 関数名
 	if (pi->type != SYM_FUNC) {
 		Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 		return NULL;
@@ -2376,7 +2387,7 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	// Ăяop̐ݒ
+	// 呼び出し用情報の設定
 	if (pi->ei->sci->fi == NULL) {
 		fi = pi->ei->sci->fi = mem_calloc(sizeof(FUNCINFO));
 	} else {
@@ -2409,7 +2420,7 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	// 
+	// 引数
 	cu_tk = VarDeclList(pi, cu_tk);
 
 	// )
@@ -2424,10 +2435,10 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	// ֐̐ݒ
+	// 関数名の設定
 	cu_tk = cu_tk->next = tk;
 
-	// ֐{
+	// 関数本文
 	if (pi->type != SYM_BOPEN) {
 		Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
 		return NULL;
@@ -2437,7 +2448,7 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 		return NULL;
 	}
 
-	// ֐Iʒu
+	// 関数終了位置
 	end_tk->link = cu_tk = cu_tk->next = CreateToken(SYM_FUNCEND, pi->p, -1);
 	if (cu_tk == NULL) {
 		Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2450,7 +2461,7 @@ static TOKEN *FuncDecl(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * CompoundStatement - ubN
+ * CompoundStatement - ブロック
  */
 static TOKEN *CompoundStatement(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -2459,7 +2470,7 @@ static TOKEN *CompoundStatement(PARSEINFO *pi, TOKEN *cu_tk)
 	if (GetToken(pi) == FALSE) {
 		return NULL;
 	}
-	//ubN̏Iʒu܂ŉ
+	//ブロックの終わり位置まで解析
 	ttk.next = NULL;
 	tk = &ttk;
 	while (tk != NULL && pi->type != SYM_EOF && pi->type != SYM_BCLOSE) {
@@ -2493,7 +2504,7 @@ static TOKEN *CompoundStatement(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * StatementList - 
+ * StatementList - 文
  */
 static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 {
@@ -2504,8 +2515,16 @@ static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_PREP:
-		//vvZbT
+		//プリプロセッサ
+		if (pi->ei->sci->hold_error == TRUE) {
+			// 並列解析中は他のスクリプトを実行できないため中断する
+			pi->ei->sci->prep_deferred = TRUE;
+			cu_tk = NULL;
+			break;
+		}
+		TRACE_BEGIN(TRACE_PARSE, TEXT("Preprocessor"), -1);
 		pi->r = Preprocessor(pi->ei->sci, pi->ei->sci->path, pi->r);
+		TRACE_END(TRACE_PARSE, TEXT("Preprocessor"));
 		if (pi->r == NULL) {
 			cu_tk = NULL;
 			break;
@@ -2520,7 +2539,7 @@ static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_BOPEN:
-		//ubN
+		//ブロック
 		cu_tk = cu_tk->next = CreateToken(pi->type, pi->p, pi->line);
 		if (cu_tk == NULL) {
 			Error(pi->ei, ERR_ALLOC, pi->p, NULL);
@@ -2564,7 +2583,7 @@ static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_FUNCSTART:
-		//֐
+		//関数
 #ifndef UNLIMIT_FUNC_LEVEL
 		if (pi->level > 1) {
 			Error(pi->ei, ERR_SENTENCE, pi->p, NULL);
@@ -2580,7 +2599,7 @@ static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 		break;
 
 	case SYM_VAR:
-		//ϐ
+		//変数
 		cu_tk = VarDecl(pi, cu_tk);
 		break;
 
@@ -2598,7 +2617,7 @@ static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 	case SYM_BITNOT:
 	case SYM_INC:
 	case SYM_DEC:
-		//
+		//式
 		cu_tk = ExpressionStatement(pi, cu_tk);
 		break;
 
@@ -2612,7 +2631,28 @@ static TOKEN *StatementList(PARSEINFO *pi, TOKEN *cu_tk)
 }
 
 /*
- * ParseVariable - ϐ擾
+ * SetLineHead - 行に入る位置のトークンを設定
+ *
+ *	ブレークポイントはこの位置でのみ判定する
+ */
+static void SetLineHead(TOKEN *tk, int prev_line)
+{
+	for (; tk != NULL; tk = tk->next) {
+		if (tk->line >= 0 && tk->line != prev_line) {
+			tk->line_head = TRUE;
+		}
+		if (tk->target != NULL) {
+			// 関数の本体は呼び出し元の行から入るため行の先頭として扱う
+			SetLineHead(tk->target, (tk->sym_type == SYM_FUNC) ? -1 : tk->line);
+		}
+		if (tk->line >= 0) {
+			prev_line = tk->line;
+		}
+	}
+}
+
+/*
+ * ParseVariable - 変数取得
  */
 TOKEN *ParseVariable(EXECINFO *ei, TCHAR *buf)
 {
@@ -2629,10 +2669,10 @@ TOKEN *ParseVariable(EXECINFO *ei, TCHAR *buf)
 		return NULL;
 	}
 
-	//
+	//解析
 	ZeroMemory(&tk, sizeof(TOKEN));
 	if (Array(&pi, &tk) == NULL || pi.type != SYM_EOF) {
-		//G[͑Sĉ
+		//エラー時は全て解放
 		FreeToken(tk.next);
 		return NULL;
 	}
@@ -2640,7 +2680,7 @@ TOKEN *ParseVariable(EXECINFO *ei, TCHAR *buf)
 }
 
 /*
- * ParseSentence - \
+ * ParseSentence - 構文解析
  */
 TOKEN *ParseSentence(EXECINFO *ei, TCHAR *buf, int level)
 {
@@ -2655,21 +2695,25 @@ TOKEN *ParseSentence(EXECINFO *ei, TCHAR *buf, int level)
 	if (ei->sci != NULL) {
 		pi.extension = ei->sci->extension;
 	}
+	TRACE_BEGIN(TRACE_PARSE, TEXT("ParseSentence"), (trace_enable == TRUE) ? lstrlen(buf) : -1);
 	if (GetToken(&pi) == FALSE) {
+		TRACE_END(TRACE_PARSE, TEXT("ParseSentence"));
 		return NULL;
 	}
 
-	//
+	//解析
 	ZeroMemory(&tk, sizeof(TOKEN));
 	cu_tk = &tk;
 	while (cu_tk != NULL && pi.type != SYM_EOF) {
 		cu_tk = StatementList(&pi, cu_tk);
 	}
+	TRACE_END(TRACE_PARSE, TEXT("ParseSentence"));
 	if (cu_tk == NULL) {
-		//G[͑Sĉ
+		//エラー時は全て解放
 		FreeToken(tk.next);
 		return NULL;
 	}
+	SetLineHead(tk.next, -1);
 	return tk.next;
 }
 /* End of source */
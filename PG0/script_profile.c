@@ -0,0 +1,827 @@
+/*
+ * PG0
+ *
+ * script_profile.c
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <tchar.h>
+#include <stdlib.h>
+#include <mmsystem.h>
+
+#include "script.h"
+#include "script_string.h"
+#include "script_memory.h"
+
+/* Define */
+#define BUF_SIZE				256
+#define FRAME_ALLOC_CNT			64
+#define OUT_ALLOC_SIZE			4096
+#define SAMPLE_RING_SIZE		65536
+#define SAMPLE_MAX_RATE			1000
+
+#define PTR_HASH(p)				((int)(((ULONG_PTR)(p) >> 4) % PROF_HASH_SIZE))
+#define LINE_HASH(src, line)	((int)((((ULONG_PTR)(src) >> 4) + (unsigned int)(line)) % PROF_HASH_SIZE))
+
+/* Global Variables */
+//出力バッファ
+typedef struct _OUTBUF {
+	TCHAR *buf;
+	int len;
+	int size;
+} OUTBUF;
+
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")
+#endif
+
+/* Local Function Prototypes */
+
+/*
+ * get_counter - カウンタの取得
+ */
+static LONGLONG get_counter(void)
+{
+	LARGE_INTEGER c;
+
+	QueryPerformanceCounter(&c);
+	return c.QuadPart;
+}
+
+/*
+ * counter_to_micro - カウンタをマイクロ秒に変換
+ */
+static LONGLONG counter_to_micro(PROFILEINFO *prof, LONGLONG c)
+{
+	if (prof->freq == 0) {
+		return 0;
+	}
+	return c * 1000000 / prof->freq;
+}
+
+/*
+ * CreateProfile - プロファイルの作成
+ *
+ *	プロファイルのメモリはプロセスのヒープから確保する
+ */
+PROFILEINFO *CreateProfile(void)
+{
+	PROFILEINFO *prof;
+	MEMHEAP *mh;
+	LARGE_INTEGER freq;
+
+	mh = mem_heap_select(NULL);
+	prof = mem_calloc(sizeof(PROFILEINFO));
+	mem_heap_select(mh);
+	if (prof == NULL) {
+		return NULL;
+	}
+	QueryPerformanceFrequency(&freq);
+	prof->freq = freq.QuadPart;
+	return prof;
+}
+
+/*
+ * free_node - 呼び出し経路の解放
+ */
+static void free_node(PROFNODE *node)
+{
+	PROFNODE *next;
+
+	while (node != NULL) {
+		next = node->sibling;
+		free_node(node->child);
+		mem_free(&node);
+		node = next;
+	}
+}
+
+/*
+ * FreeProfile - プロファイルの解放
+ */
+void FreeProfile(PROFILEINFO *prof)
+{
+	PROFLINE *pl, *pl_next;
+	PROFFUNC *pf, *pf_next;
+	PROFSTACK *ps, *ps_next;
+	int i;
+
+	if (prof == NULL) {
+		return;
+	}
+	StopSampling(prof);
+	mem_free(&prof->ring);
+	for (ps = prof->stack.down; ps != NULL; ps = ps_next) {
+		ps_next = ps->down;
+		mem_free(&ps);
+	}
+	for (i = 0; i < PROF_HASH_SIZE; i++) {
+		for (pl = prof->line[i]; pl != NULL; pl = pl_next) {
+			pl_next = pl->next;
+			mem_free(&pl);
+		}
+		for (pf = prof->func[i]; pf != NULL; pf = pf_next) {
+			pf_next = pf->next;
+			mem_free(&pf->name);
+			mem_free(&pf->file);
+			mem_free(&pf);
+		}
+	}
+	free_node(prof->root.child);
+	mem_free(&prof->frame);
+	mem_free(&prof);
+}
+
+/*
+ * get_line - 行の情報を取得
+ *
+ *	同じスクリプトの行は関数が異なっても同じ情報にまとめる
+ */
+static PROFLINE *get_line(PROFILEINFO *prof, PROFFUNC *pf, int line)
+{
+	PROFLINE *pl;
+	MEMHEAP *mh;
+	int i = LINE_HASH(pf->src, line);
+
+	for (pl = prof->line[i]; pl != NULL; pl = pl->next) {
+		if (pl->src == pf->src && pl->line == line) {
+			return pl;
+		}
+	}
+	mh = mem_heap_select(NULL);
+	pl = mem_calloc(sizeof(PROFLINE));
+	mem_heap_select(mh);
+	if (pl == NULL) {
+		return NULL;
+	}
+	pl->src = pf->src;
+	pl->file = pf->file;
+	pl->line = line;
+	pl->next = prof->line[i];
+	prof->line[i] = pl;
+	return pl;
+}
+
+/*
+ * get_func - 関数の情報を取得
+ *
+ *	key は関数 (FUNCINFO) またはスクリプトの解析木、src は定義したスクリプト (SCRIPTINFO)
+ */
+static PROFFUNC *get_func(PROFILEINFO *prof, void *key, TCHAR *name, SCRIPTINFO *src)
+{
+	PROFFUNC *pf;
+	MEMHEAP *mh;
+	int i = PTR_HASH(key);
+
+	for (pf = prof->func[i]; pf != NULL; pf = pf->next) {
+		if (pf->key == key) {
+			return pf;
+		}
+	}
+	mh = mem_heap_select(NULL);
+	pf = mem_calloc(sizeof(PROFFUNC));
+	if (pf != NULL) {
+		pf->name = alloc_copy((name != NULL) ? name : TEXT(""));
+		pf->file = alloc_copy((src->name != NULL) ? src->name : TEXT(""));
+	}
+	mem_heap_select(mh);
+	if (pf == NULL) {
+		return NULL;
+	}
+	pf->key = key;
+	pf->src = src;
+	pf->next = prof->func[i];
+	prof->func[i] = pf;
+	return pf;
+}
+
+/*
+ * get_node - 呼び出し経路の取得
+ */
+static PROFNODE *get_node(PROFNODE *parent, PROFFUNC *pf)
+{
+	PROFNODE *node;
+	MEMHEAP *mh;
+
+	for (node = parent->child; node != NULL; node = node->sibling) {
+		if (node->func == pf) {
+			return node;
+		}
+	}
+	mh = mem_heap_select(NULL);
+	node = mem_calloc(sizeof(PROFNODE));
+	mem_heap_select(mh);
+	if (node == NULL) {
+		return NULL;
+	}
+	node->func = pf;
+	node->parent = parent;
+	node->sibling = parent->child;
+	parent->child = node;
+	return node;
+}
+
+/*
+ * close_line - 実行中の行の時間を加算
+ */
+static void close_line(PROFFRAME *fr, LONGLONG now)
+{
+	if (fr->line == NULL) {
+		return;
+	}
+	fr->line->incl += now - fr->line_start;
+	fr->line->excl += now - fr->line_start - fr->line_child;
+	fr->line = NULL;
+}
+
+/*
+ * enter_frame - 関数の開始
+ */
+static void enter_frame(PROFILEINFO *prof, PROFFUNC *pf)
+{
+	PROFFRAME *fr;
+	PROFSTACK *ps;
+	PROFNODE *parent;
+	PROFNODE *node;
+	MEMHEAP *mh;
+
+	if (prof->sampling == TRUE) {
+		// 呼び出し経路のみ更新する
+		ps = prof->cur_frame;
+		node = (pf != NULL && prof->lost_depth == 0) ? get_node(ps->node, pf) : NULL;
+		if (node != NULL && ps->down == NULL) {
+			mh = mem_heap_select(NULL);
+			ps->down = mem_calloc(sizeof(PROFSTACK));
+			mem_heap_select(mh);
+			if (ps->down != NULL) {
+				ps->down->up = ps;
+			}
+		}
+		if (node == NULL || ps->down == NULL) {
+			prof->lost_depth++;
+		} else {
+			// トークンを消してから経路を設定し、設定後に公開する
+			ps = ps->down;
+			ps->tk = NULL;
+			MemoryBarrier();
+			ps->node = node;
+			MemoryBarrier();
+			prof->cur_frame = ps;
+		}
+		if (pf != NULL) {
+			pf->calls++;
+		}
+		if (prof->head - prof->tail >= prof->ring_size / 2) {
+			DrainSamples(prof);
+		}
+		return;
+	}
+	if (prof->frame_cnt >= prof->frame_size) {
+		mh = mem_heap_select(NULL);
+		fr = (prof->frame == NULL) ? mem_alloc(sizeof(PROFFRAME) * FRAME_ALLOC_CNT) :
+			mem_realloc(prof->frame, sizeof(PROFFRAME) * (prof->frame_size + FRAME_ALLOC_CNT));
+		mem_heap_select(mh);
+		if (fr == NULL) {
+			// 記録できない関数も深さは合わせる
+			prof->frame_cnt++;
+			return;
+		}
+		prof->frame = fr;
+		prof->frame_size += FRAME_ALLOC_CNT;
+	}
+	parent = (prof->frame_cnt > 0) ? (prof->frame + prof->frame_cnt - 1)->node : &prof->root;
+	fr = prof->frame + prof->frame_cnt++;
+	ZeroMemory(fr, sizeof(PROFFRAME));
+	fr->func = pf;
+	fr->node = (parent != NULL && pf != NULL) ? get_node(parent, pf) : NULL;
+	if (pf != NULL) {
+		pf->calls++;
+		pf->depth++;
+	}
+	fr->start = get_counter();
+}
+
+/*
+ * ProfileEnterScript - スクリプトのトップレベルの実行開始
+ */
+void ProfileEnterScript(PROFILEINFO *prof, SCRIPTINFO *sci)
+{
+	enter_frame(prof, get_func(prof, sci->tk, sci->name, sci));
+}
+
+/*
+ * ProfileEnterFunction - ユーザ関数の実行開始
+ *
+ *	関数を定義したスクリプトは初回のみ検索する
+ */
+void ProfileEnterFunction(PROFILEINFO *prof, SCRIPTINFO *sci, FUNCINFO *fi)
+{
+	SCRIPTINFO *fsci;
+	FUNCINFO *f;
+	PROFFUNC *pf;
+	int i = PTR_HASH(fi);
+
+	for (pf = prof->func[i]; pf != NULL && pf->key != fi; pf = pf->next);
+	if (pf == NULL) {
+		for (fsci = sci->sci_top; fsci != NULL; fsci = fsci->next) {
+			for (f = fsci->fi; f != NULL && f != fi; f = f->next);
+			if (f != NULL) {
+				break;
+			}
+		}
+		pf = get_func(prof, fi, fi->name, (fsci != NULL) ? fsci : sci);
+	}
+	enter_frame(prof, pf);
+}
+
+/*
+ * ProfileLeave - 関数の実行終了
+ */
+void ProfileLeave(PROFILEINFO *prof)
+{
+	PROFFRAME *fr;
+	LONGLONG now, elapsed;
+
+	if (prof->sampling == TRUE) {
+		if (prof->lost_depth > 0) {
+			prof->lost_depth--;
+		} else if (prof->cur_frame->up != NULL) {
+			prof->cur_frame = prof->cur_frame->up;
+		}
+		if (prof->head - prof->tail >= prof->ring_size / 2) {
+			DrainSamples(prof);
+		}
+		return;
+	}
+	if (prof->frame_cnt <= 0) {
+		return;
+	}
+	if (prof->frame_cnt > prof->frame_size) {
+		prof->frame_cnt--;
+		return;
+	}
+	now = get_counter();
+	fr = prof->frame + prof->frame_cnt - 1;
+	close_line(fr, now);
+	elapsed = now - fr->start;
+	if (fr->func != NULL) {
+		fr->func->excl += elapsed - fr->child;
+		if (--fr->func->depth == 0) {
+			// 再帰呼び出しは最も外側の呼び出しのみ加算する
+			fr->func->incl += elapsed;
+		}
+	}
+	if (fr->node != NULL) {
+		fr->node->excl += elapsed - fr->child;
+	}
+	prof->frame_cnt--;
+	if (prof->frame_cnt > 0) {
+		fr = prof->frame + prof->frame_cnt - 1;
+		fr->child += elapsed;
+		fr->line_child += elapsed;
+	}
+}
+
+/*
+ * ProfileToken - トークンの実行
+ *
+ *	行が変わった時のみ時刻を取得する
+ *	トークンの行番号は 0 から始まる
+ */
+void ProfileToken(PROFILEINFO *prof, TOKEN *tk)
+{
+	PROFFRAME *fr;
+	LONGLONG now;
+
+	if (prof->sampling == TRUE) {
+		// 記録できない関数のトークンは呼び出し元に設定しない
+		if (prof->lost_depth == 0) {
+			prof->cur_frame->tk = tk;
+		}
+		return;
+	}
+	if (prof->frame_cnt <= 0 || prof->frame_cnt > prof->frame_size) {
+		return;
+	}
+	fr = prof->frame + prof->frame_cnt - 1;
+	if (tk->line >= 0 && fr->func != NULL && (fr->line == NULL || fr->line->line != tk->line)) {
+		now = get_counter();
+		close_line(fr, now);
+		fr->line = get_line(prof, fr->func, tk->line);
+		fr->line_start = now;
+		fr->line_child = 0;
+	}
+	if (fr->line != NULL) {
+		fr->line->count++;
+	}
+}
+
+/*
+ * SampleThread - 一定間隔で実行中の位置を記録するスレッド
+ *
+ *	サンプルの追加のみ行い、集計は実行中のスレッドで行う
+ *	実行中の関数の経路とトークンは同じ PROFSTACK から読み、読む間に経路が
+ *	変わった場合 (関数を抜けて同じ深さの別の関数に入った場合) は読み直す
+ */
+static DWORD WINAPI SampleThread(LPVOID param)
+{
+	PROFILEINFO *prof = (PROFILEINFO *)param;
+	PROFSAMPLE *ps;
+	PROFSTACK *fr;
+	PROFNODE *node;
+	TOKEN *tk;
+	LONGLONG prev, now;
+	LONG head;
+
+	timeBeginPeriod(1);
+	prev = get_counter();
+	while (WaitForSingleObject(prof->hStop, prof->interval) == WAIT_TIMEOUT) {
+		now = get_counter();
+		head = prof->head;
+		if (head - prof->tail >= prof->ring_size) {
+			// 集計が追いつかない場合は破棄
+			InterlockedIncrement(&prof->dropped);
+			continue;
+		}
+		do {
+			fr = prof->cur_frame;
+			node = fr->node;
+			MemoryBarrier();
+			tk = fr->tk;
+			MemoryBarrier();
+		} while (fr->node != node);
+		ps = prof->ring + (head & (prof->ring_size - 1));
+		ps->node = node;
+		ps->tk = tk;
+		ps->ticks = now - prev;
+		prev = now;
+		MemoryBarrier();
+		prof->head = head + 1;
+	}
+	timeEndPeriod(1);
+	return 0;
+}
+
+/*
+ * StartSampling - サンプリングの開始
+ *
+ *	rate は1秒あたりのサンプル数
+ *	スクリプトの実行前に呼び出す
+ */
+BOOL StartSampling(PROFILEINFO *prof, int rate)
+{
+	MEMHEAP *mh;
+
+	if (prof->hThread != NULL) {
+		return TRUE;
+	}
+	if (rate <= 0 || rate > SAMPLE_MAX_RATE) {
+		rate = SAMPLE_MAX_RATE;
+	}
+	if (prof->ring == NULL) {
+		mh = mem_heap_select(NULL);
+		prof->ring = mem_calloc(sizeof(PROFSAMPLE) * SAMPLE_RING_SIZE);
+		mem_heap_select(mh);
+		if (prof->ring == NULL) {
+			return FALSE;
+		}
+		prof->ring_size = SAMPLE_RING_SIZE;
+	}
+	prof->interval = 1000 / rate;
+	prof->sampling = TRUE;
+	prof->stack.node = &prof->root;
+	prof->stack.tk = NULL;
+	prof->cur_frame = &prof->stack;
+	prof->hStop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (prof->hStop == NULL) {
+		return FALSE;
+	}
+	prof->hThread = CreateThread(NULL, 0, SampleThread, prof, 0, NULL);
+	if (prof->hThread == NULL) {
+		CloseHandle(prof->hStop);
+		prof->hStop = NULL;
+		return FALSE;
+	}
+	SetThreadPriority(prof->hThread, THREAD_PRIORITY_HIGHEST);
+	return TRUE;
+}
+
+/*
+ * StopSampling - サンプリングの終了
+ *
+ *	残っているサンプルを集計する
+ */
+void StopSampling(PROFILEINFO *prof)
+{
+	if (prof->hThread == NULL) {
+		return;
+	}
+	SetEvent(prof->hStop);
+	WaitForSingleObject(prof->hThread, INFINITE);
+	CloseHandle(prof->hThread);
+	CloseHandle(prof->hStop);
+	prof->hThread = NULL;
+	prof->hStop = NULL;
+	DrainSamples(prof);
+}
+
+/*
+ * add_sample - サンプルを関数と行に集計
+ */
+static void add_sample(PROFILEINFO *prof, PROFSAMPLE *ps)
+{
+	PROFNODE *node = ps->node;
+	PROFNODE *pn, *qn;
+	PROFLINE *pl;
+
+	prof->samples++;
+	if (node == NULL || node->func == NULL) {
+		return;
+	}
+	node->excl += ps->ticks;
+	node->func->excl += ps->ticks;
+	for (pn = node; pn != NULL && pn->func != NULL; pn = pn->parent) {
+		// 再帰呼び出しは1回のみ加算する
+		for (qn = node; qn != pn && qn->func != pn->func; qn = qn->parent);
+		if (qn == pn) {
+			pn->func->incl += ps->ticks;
+		}
+	}
+	if (ps->tk != NULL && ps->tk->line >= 0) {
+		pl = get_line(prof, node->func, ps->tk->line);
+		if (pl != NULL) {
+			pl->count++;
+			pl->incl += ps->ticks;
+			pl->excl += ps->ticks;
+		}
+	}
+}
+
+/*
+ * DrainSamples - リングバッファのサンプルを集計
+ *
+ *	スクリプトを実行しているスレッドから呼び出す
+ */
+void DrainSamples(PROFILEINFO *prof)
+{
+	LONG head, tail;
+
+	if (prof->ring == NULL) {
+		return;
+	}
+	head = prof->head;
+	MemoryBarrier();
+	for (tail = prof->tail; tail != head; tail++) {
+		add_sample(prof, prof->ring + (tail & (prof->ring_size - 1)));
+	}
+	MemoryBarrier();
+	prof->tail = tail;
+}
+
+/*
+ * out_add - 出力バッファに文字列を追加
+ */
+static BOOL out_add(OUTBUF *ob, TCHAR *str)
+{
+	TCHAR *p;
+	int len = lstrlen(str);
+
+	if (ob->len + len + 1 > ob->size) {
+		int size = ob->size + ((len + 1 > OUT_ALLOC_SIZE) ? len + 1 : OUT_ALLOC_SIZE);
+		p = (ob->buf == NULL) ? mem_alloc(sizeof(TCHAR) * size) : mem_realloc(ob->buf, sizeof(TCHAR) * size);
+		if (p == NULL) {
+			return FALSE;
+		}
+		ob->buf = p;
+		ob->size = size;
+	}
+	lstrcpy(ob->buf + ob->len, str);
+	ob->len += len;
+	return TRUE;
+}
+
+/*
+ * out_name - 区切り文字を置き換えて名前を追加
+ */
+static BOOL out_name(OUTBUF *ob, TCHAR *name)
+{
+	TCHAR buf[BUF_SIZE];
+	TCHAR *p;
+
+	str_cpy_n(buf, name, BUF_SIZE - 1);
+	for (p = buf; *p != TEXT('\0'); p++) {
+		if (*p == TEXT(';') || *p == TEXT(' ') || *p == TEXT('\t')) {
+			*p = TEXT('_');
+		}
+	}
+	return out_add(ob, buf);
+}
+
+/*
+ * out_write - 出力バッファを UTF-8 でファイルに書き込む
+ */
+static BOOL out_write(OUTBUF *ob, TCHAR *path)
+{
+	HANDLE hFile;
+#ifdef UNICODE
+	char *cbuf;
+	int len;
+#endif
+	DWORD ret;
+	BOOL result;
+
+	if (ob->buf == NULL && out_add(ob, TEXT("")) == FALSE) {
+		return FALSE;
+	}
+	hFile = CreateFile(path, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == NULL || hFile == (HANDLE)-1) {
+		return FALSE;
+	}
+#ifdef UNICODE
+	len = WideCharToMultiByte(CP_UTF8, 0, ob->buf, -1, NULL, 0, NULL, NULL);
+	cbuf = mem_alloc(sizeof(char) * len);
+	if (cbuf == NULL) {
+		CloseHandle(hFile);
+		return FALSE;
+	}
+	WideCharToMultiByte(CP_UTF8, 0, ob->buf, -1, cbuf, len, NULL, NULL);
+	result = WriteFile(hFile, cbuf, sizeof(char) * (len - 1), &ret, NULL);
+	mem_free(&cbuf);
+#else
+	result = WriteFile(hFile, ob->buf, sizeof(char) * ob->len, &ret, NULL);
+#endif
+	CloseHandle(hFile);
+	return result;
+}
+
+/*
+ * cmp_func - 関数の並び替え (経過時間の降順)
+ */
+static int cmp_func(const void *a, const void *b)
+{
+	PROFFUNC *f1 = *(PROFFUNC **)a;
+	PROFFUNC *f2 = *(PROFFUNC **)b;
+
+	if (f1->incl != f2->incl) {
+		return (f1->incl < f2->incl) ? 1 : -1;
+	}
+	return (f1->excl < f2->excl) ? 1 : ((f1->excl > f2->excl) ? -1 : 0);
+}
+
+/*
+ * cmp_line - 行の並び替え (経過時間の降順)
+ */
+static int cmp_line(const void *a, const void *b)
+{
+	PROFLINE *l1 = *(PROFLINE **)a;
+	PROFLINE *l2 = *(PROFLINE **)b;
+
+	if (l1->excl != l2->excl) {
+		return (l1->excl < l2->excl) ? 1 : -1;
+	}
+	return (l1->count < l2->count) ? 1 : ((l1->count > l2->count) ? -1 : 0);
+}
+
+/*
+ * out_report - 関数と行ごとの集計を出力
+ */
+static BOOL out_report(PROFILEINFO *prof, OUTBUF *ob)
+{
+	PROFFUNC *pf, **func_list;
+	PROFLINE *pl, **line_list;
+	TCHAR buf[BUF_SIZE];
+	int func_cnt = 0, line_cnt = 0;
+	int i, j;
+
+	for (i = 0; i < PROF_HASH_SIZE; i++) {
+		for (pf = prof->func[i]; pf != NULL; pf = pf->next, func_cnt++);
+		for (pl = prof->line[i]; pl != NULL; pl = pl->next, line_cnt++);
+	}
+	func_list = mem_alloc(sizeof(PROFFUNC *) * (func_cnt + 1));
+	line_list = mem_alloc(sizeof(PROFLINE *) * (line_cnt + 1));
+	if (func_list == NULL || line_list == NULL) {
+		mem_free(&func_list);
+		mem_free(&line_list);
+		return FALSE;
+	}
+	for (i = 0, func_cnt = 0, line_cnt = 0; i < PROF_HASH_SIZE; i++) {
+		for (pf = prof->func[i]; pf != NULL; pf = pf->next) {
+			func_list[func_cnt++] = pf;
+		}
+		for (pl = prof->line[i]; pl != NULL; pl = pl->next) {
+			line_list[line_cnt++] = pl;
+		}
+	}
+	qsort(func_list, func_cnt, sizeof(PROFFUNC *), cmp_func);
+	qsort(line_list, line_cnt, sizeof(PROFLINE *), cmp_line);
+
+	if (prof->sampling == TRUE) {
+		wsprintf(buf, TEXT("Sampling: %I64d samples, %ld dropped, %lu msec interval\r\n\r\n"),
+			prof->samples, prof->dropped, prof->interval);
+		out_add(ob, buf);
+	}
+	out_add(ob, TEXT("Functions\r\n"));
+	out_add(ob, TEXT("       calls    incl(usec)    excl(usec)  name\r\n"));
+	for (j = 0; j < func_cnt; j++) {
+		pf = func_list[j];
+		wsprintf(buf, TEXT("%12I64d  %12I64d  %12I64d  "), pf->calls,
+			counter_to_micro(prof, pf->incl), counter_to_micro(prof, pf->excl));
+		out_add(ob, buf);
+		out_add(ob, pf->name);
+		if (lstrcmp(pf->name, pf->file) != 0) {
+			out_add(ob, TEXT(" ("));
+			out_add(ob, pf->file);
+			out_add(ob, TEXT(")"));
+		}
+		out_add(ob, TEXT("\r\n"));
+	}
+
+	out_add(ob, TEXT("\r\nLines\r\n"));
+	out_add(ob, (prof->sampling == TRUE) ? TEXT("     samples    incl(usec)    excl(usec)  line\r\n") :
+		TEXT("      tokens    incl(usec)    excl(usec)  line\r\n"));
+	for (j = 0; j < line_cnt; j++) {
+		pl = line_list[j];
+		wsprintf(buf, TEXT("%12I64d  %12I64d  %12I64d  "), pl->count,
+			counter_to_micro(prof, pl->incl), counter_to_micro(prof, pl->excl));
+		out_add(ob, buf);
+		out_add(ob, pl->file);
+		wsprintf(buf, TEXT(":%d\r\n"), pl->line + 1);
+		if (out_add(ob, buf) == FALSE) {
+			break;
+		}
+	}
+	mem_free(&func_list);
+	mem_free(&line_list);
+	return TRUE;
+}
+
+/*
+ * out_stack - 呼び出し経路ごとの経過時間を出力 (collapsed stack)
+ */
+static BOOL out_stack(PROFILEINFO *prof, OUTBUF *ob, PROFNODE *node)
+{
+	PROFNODE *pn, *path[FRAME_ALLOC_CNT];
+	TCHAR buf[BUF_SIZE];
+	LONGLONG usec;
+	int cnt, i;
+
+	for (; node != NULL; node = node->sibling) {
+		usec = counter_to_micro(prof, node->excl);
+		if (usec > 0) {
+			// ルートからの経路
+			for (cnt = 0, pn = node; pn != NULL && pn->func != NULL && cnt < FRAME_ALLOC_CNT; pn = pn->parent) {
+				path[cnt++] = pn;
+			}
+			for (i = cnt - 1; i >= 0; i--) {
+				out_name(ob, path[i]->func->name);
+				if (i > 0) {
+					out_add(ob, TEXT(";"));
+				}
+			}
+			wsprintf(buf, TEXT(" %I64d\n"), usec);
+			if (out_add(ob, buf) == FALSE) {
+				return FALSE;
+			}
+		}
+		if (out_stack(prof, ob, node->child) == FALSE) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/*
+ * SaveProfile - プロファイルの結果をファイルに出力
+ *
+ *	report_path には関数と行ごとの集計、stack_path には flamegraph 用の collapsed stack を出力する
+ */
+BOOL SaveProfile(PROFILEINFO *prof, TCHAR *report_path, TCHAR *stack_path)
+{
+	OUTBUF ob;
+	MEMHEAP *mh;
+	BOOL ret = TRUE;
+
+	mh = mem_heap_select(NULL);
+	if (report_path != NULL) {
+		ZeroMemory(&ob, sizeof(OUTBUF));
+		if (out_report(prof, &ob) == FALSE || out_write(&ob, report_path) == FALSE) {
+			ret = FALSE;
+		}
+		mem_free(&ob.buf);
+	}
+	if (stack_path != NULL) {
+		ZeroMemory(&ob, sizeof(OUTBUF));
+		if (out_stack(prof, &ob, prof->root.child) == FALSE || out_write(&ob, stack_path) == FALSE) {
+			ret = FALSE;
+		}
+		mem_free(&ob.buf);
+	}
+	mem_heap_select(mh);
+	return ret;
+}
+/* End of source */
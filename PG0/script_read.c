@@ -25,13 +25,40 @@
 
 #define IS_SPACE(c)				(c == TEXT(' ') || c == TEXT('\t') || c == TEXT('\r') || c == TEXT('\n'))
 
+#define DECODE_BUF_SIZE			4096
+#define LINE_ALLOC_CNT			256
+#define LOAD_TASK_ALLOC_CNT		16
+#define MAX_LOAD_THREAD			MAXIMUM_WAIT_OBJECTS
+
+#define MODULE_HASH_SIZE		64
+#define PATH_HASH(hash)			((int)((unsigned int)(hash) % MODULE_HASH_SIZE))
+#define ID_HASH(src)			((int)(((src)->volume ^ (src)->index_high ^ (src)->index_low) % MODULE_HASH_SIZE))
+
 /* Global Variables */
+//読み込みタスク
+typedef struct _LOADTASK {
+	TCHAR *name;
+	SCRIPTINFO *sci;
+	BOOL load;
+	BOOL parse;
+	//読み込みに失敗した場合のエラー
+	DWORD err;
+} LOADTASK;
+
+//読み込みキュー
+typedef struct _LOADQUEUE {
+	LOADTASK *task;
+	int cnt;
+	volatile LONG index;
+	//解析結果を確保するヒープ (呼び出し元のスレッドのヒープ)
+	MEMHEAP *mh;
+} LOADQUEUE;
 
 /* Local Function Prototypes */
-static BOOL LoadLibraryFile(SCRIPTINFO *sci, TCHAR *FileName);
+static BOOL LoadLibraryFile(SCRIPTINFO *sci, TCHAR *FileName, BOOL *err);
 
 /*
- * GetFilePathName - pXt@CƃfBNgpX擾
+ * GetFilePathName - パスからファイル名とディレクトリパスを取得
  */
 void GetFilePathName(TCHAR *path, TCHAR *dir, TCHAR *name)
 {
@@ -69,101 +96,704 @@ void GetFilePathName(TCHAR *path, TCHAR *dir, TCHAR *name)
 }
 
 /*
- * read_file - t@C̓ǂݍ
+ * get_counter - 高分解能カウンタの取得
  */
-TCHAR *read_file(TCHAR *path)
+static LONGLONG get_counter(void)
+{
+	LARGE_INTEGER c;
+
+	QueryPerformanceCounter(&c);
+	return c.QuadPart;
+}
+
+/*
+ * counter_to_micro - カウンタの差をマイクロ秒に変換
+ */
+static LONGLONG counter_to_micro(LONGLONG c)
+{
+	LARGE_INTEGER f;
+
+	if (QueryPerformanceFrequency(&f) == FALSE || f.QuadPart == 0) {
+		return 0;
+	}
+	return c * 1000000 / f.QuadPart;
+}
+
+/*
+ * map_file - ファイルを読み取り専用でマップ
+ */
+static BYTE *map_file(TCHAR *path, DWORD *size, BY_HANDLE_FILE_INFORMATION *fi)
 {
-	HANDLE hFile;
-	WCHAR *wbuf;
-	BYTE *buf;
-	DWORD fSizeLow, fSizeHigh;
-	DWORD ret;
+	static BYTE empty_view[1];
+	HANDLE hFile, hMap;
+	BYTE *view;
+	DWORD fSizeHigh;
 	DWORD errcode;
-	int len;
-	int bom = 0;
 
-	// t@CJ
+	// ファイルを開く
 	hFile = CreateFile(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
 	if (hFile == NULL || hFile == (HANDLE)-1) {
 		return NULL;
 	}
-	if ((fSizeLow = GetFileSize(hFile, &fSizeHigh)) == 0xFFFFFFFF) {
+	if ((*size = GetFileSize(hFile, &fSizeHigh)) == 0xFFFFFFFF) {
 		errcode = GetLastError();
 		CloseHandle(hFile);
 		SetLastError(errcode);
 		return NULL;
 	}
-	if ((buf = (BYTE *)mem_alloc(fSizeLow + 1)) == NULL) {
-		errcode = GetLastError();
+	if (fi != NULL && GetFileInformationByHandle(hFile, fi) == FALSE) {
+		ZeroMemory(fi, sizeof(BY_HANDLE_FILE_INFORMATION));
+	}
+	if (fSizeHigh != 0 || *size >= 0x7FFFFFFF / sizeof(TCHAR)) {
 		CloseHandle(hFile);
-		SetLastError(errcode);
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
 		return NULL;
 	}
-	// t@Cǂݍ
-	if (ReadFile(hFile, buf, fSizeLow, &ret, NULL) == FALSE) {
+	if (*size == 0) {
+		// 空のファイルはマップできない
+		CloseHandle(hFile);
+		return empty_view;
+	}
+	// ファイルをマップする
+	hMap = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMap == NULL) {
 		errcode = GetLastError();
-		mem_free(&buf);
 		CloseHandle(hFile);
 		SetLastError(errcode);
 		return NULL;
 	}
-	*(buf + ret) = '\0';
+	view = (BYTE *)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+	errcode = GetLastError();
+	CloseHandle(hMap);
 	CloseHandle(hFile);
-	// BOMXLbv
-	if (ret > 3 && *buf == 0xEF && *(buf + 1) == 0xBB && *(buf + 2) == 0xBF) {
-		bom = 3;
-	}
-	// UTF-8UTF-16ɕϊ
-	len = MultiByteToWideChar(CP_UTF8, 0, buf + bom, -1, NULL, 0);
-	if ((wbuf = (WCHAR *)mem_alloc(sizeof(WCHAR) * len)) == NULL) {
-		errcode = GetLastError();
-		mem_free(&buf);
+	if (view == NULL) {
 		SetLastError(errcode);
 		return NULL;
 	}
-	MultiByteToWideChar(CP_UTF8, 0, buf + bom, -1, wbuf, len);
-	mem_free(&buf);
+	return view;
+}
+
+/*
+ * unmap_file - マップしたファイルを解放
+ */
+static void unmap_file(BYTE *view, DWORD size)
+{
+	if (size > 0) {
+		UnmapViewOfFile(view);
+	}
+}
+
+/*
+ * utf8_char - UTF-8の1文字を取得
+ */
+static DWORD utf8_char(const BYTE *p, const BYTE *end, int *n)
+{
+	DWORD c = *p;
+	DWORD min;
+	int cnt, i;
+
+	if ((c & 0xE0) == 0xC0) {
+		cnt = 1;
+		c &= 0x1F;
+		min = 0x80;
+	} else if ((c & 0xF0) == 0xE0) {
+		cnt = 2;
+		c &= 0x0F;
+		min = 0x800;
+	} else if ((c & 0xF8) == 0xF0) {
+		cnt = 3;
+		c &= 0x07;
+		min = 0x10000;
+	} else {
+		// 不正なバイト
+		*n = 1;
+		return 0xFFFD;
+	}
+	if (end - p <= cnt) {
+		*n = 1;
+		return 0xFFFD;
+	}
+	for (i = 1; i <= cnt; i++) {
+		if ((*(p + i) & 0xC0) != 0x80) {
+			*n = i;
+			return 0xFFFD;
+		}
+		c = (c << 6) | (*(p + i) & 0x3F);
+	}
+	*n = cnt + 1;
+	if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+		return 0xFFFD;
+	}
+	return c;
+}
+
+/*
+ * add_line - 行情報の追加
+ */
+static BOOL add_line(SOURCEINFO *src, const int pos, const int fpos)
+{
+	LINEINFO *line;
+
+	if (src->line_cnt % LINE_ALLOC_CNT == 0) {
+		if (src->line == NULL) {
+			line = mem_alloc(sizeof(LINEINFO) * LINE_ALLOC_CNT);
+		} else {
+			line = mem_realloc(src->line, sizeof(LINEINFO) * (src->line_cnt + LINE_ALLOC_CNT));
+		}
+		if (line == NULL) {
+			return FALSE;
+		}
+		src->line = line;
+	}
+	(src->line + src->line_cnt)->pos = pos;
+	(src->line + src->line_cnt)->fpos = fpos;
+	src->line_cnt++;
+	return TRUE;
+}
+
+/*
+ * decode_utf8 - UTF-8からTCHARに1パスで変換
+ *
+ *	src が NULL 以外の場合は行情報を作成する
+ *	ret には (end - p + 1) 文字分の領域が必要
+ */
+static int decode_utf8(const BYTE *top, const BYTE *p, const BYTE *end, TCHAR *ret, SOURCEINFO *src)
+{
+#ifndef UNICODE
+	WCHAR wbuf[DECODE_BUF_SIZE];
+	int wlen = 0;
+	int size = (int)(end - p);
+#endif
+	WCHAR *w;
+	DWORD c;
+	int len = 0;
+	int n;
 
+	if (src != NULL && add_line(src, 0, (int)(p - top)) == FALSE) {
+		return -1;
+	}
+	while (p < end && *p != '\0') {
+		// 1文字の取得
+		if (*p < 0x80) {
+			c = *p;
+			n = 1;
+		} else {
+			c = utf8_char(p, end, &n);
+		}
+		p += n;
 #ifdef UNICODE
-	return wbuf;
+		w = ret + len;
 #else
-	// UTF-16ASCIIɕϊ
-	len = WideCharToMultiByte(CP_ACP, 0, wbuf, -1, NULL, 0, NULL, NULL);
-	if ((buf = (BYTE *)mem_alloc(sizeof(BYTE) * len)) == NULL) {
-		errcode = GetLastError();
-		mem_free(&wbuf);
-		SetLastError(errcode);
+		w = wbuf + wlen;
+#endif
+		if (c >= 0x10000) {
+			// サロゲートペア
+			c -= 0x10000;
+			*(w++) = (WCHAR)(0xD800 + (c >> 10));
+			*w = (WCHAR)(0xDC00 + (c & 0x3FF));
+			n = 2;
+		} else {
+			*w = (WCHAR)c;
+			n = 1;
+		}
+#ifdef UNICODE
+		len += n;
+#else
+		wlen += n;
+		if (c == L'\n' || wlen >= DECODE_BUF_SIZE - 2) {
+			// UTF-16からASCIIに変換
+			len += WideCharToMultiByte(CP_ACP, 0, wbuf, wlen, ret + len, size - len, NULL, NULL);
+			wlen = 0;
+		}
+#endif
+		if (c == L'\n' && src != NULL && add_line(src, len, (int)(p - top)) == FALSE) {
+			return -1;
+		}
+	}
+#ifndef UNICODE
+	if (wlen > 0) {
+		len += WideCharToMultiByte(CP_ACP, 0, wbuf, wlen, ret + len, size - len, NULL, NULL);
+	}
+#endif
+	*(ret + len) = TEXT('\0');
+	return len;
+}
+
+/*
+ * read_file - ファイルの読み込み
+ */
+TCHAR *read_file(TCHAR *path)
+{
+	BYTE *view;
+	TCHAR *buf;
+	DWORD size;
+	int bom = 0;
+
+	// ファイルをマップする
+	view = map_file(path, &size, NULL);
+	if (view == NULL) {
+		return NULL;
+	}
+	// BOMをスキップ
+	if (size >= 3 && *view == 0xEF && *(view + 1) == 0xBB && *(view + 2) == 0xBF) {
+		bom = 3;
+	}
+	// UTF-8から変換
+	if ((buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (size - bom + 1))) == NULL) {
+		unmap_file(view, size);
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
 		return NULL;
 	}
-	WideCharToMultiByte(CP_ACP, 0, wbuf, -1, buf, len, NULL, NULL);
-	mem_free(&wbuf);
+	decode_utf8(view, view + bom, view + size, buf, NULL);
+	unmap_file(view, size);
 	return buf;
+}
+
+/*
+ * LoadScriptSource - スクリプトファイルをソース情報として読み込む
+ */
+static BOOL LoadScriptSource(SCRIPTINFO *sci, TCHAR *path)
+{
+	SOURCEINFO *src;
+	LINEINFO *line;
+	BY_HANDLE_FILE_INFORMATION fi;
+	BYTE *view;
+	DWORD size;
+	LONGLONG start;
+	int bom = 0;
+
+	// ファイルをマップする
+	start = get_counter();
+	view = map_file(path, &size, &fi);
+	if (view == NULL) {
+		return FALSE;
+	}
+	// BOMをスキップ
+	if (size >= 3 && *view == 0xEF && *(view + 1) == 0xBB && *(view + 2) == 0xBF) {
+		bom = 3;
+	}
+	src = mem_calloc(sizeof(SOURCEINFO));
+	if (src == NULL) {
+		unmap_file(view, size);
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+		return FALSE;
+	}
+	src->path = alloc_copy(path);
+	// 解析後に物理メモリのみ解放できるようにページ単位で確保
+	src->size = sizeof(TCHAR) * (size - bom + 1);
+	src->buf = mem_page_alloc(src->size, &src->mh);
+	if (src->path == NULL || src->buf == NULL) {
+		unmap_file(view, size);
+		FreeSourceInfo(src);
+		SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+		return FALSE;
+	}
+	src->commit = TRUE;
+	// ファイルの識別情報
+	src->volume = fi.dwVolumeSerialNumber;
+	src->index_high = fi.nFileIndexHigh;
+	src->index_low = fi.nFileIndexLow;
+	src->file_size = size;
+	src->write_time = fi.ftLastWriteTime;
+	// UTF-8から変換して行情報を作成
+	src->len = decode_utf8(view, view + bom, view + size, src->buf, src);
+	unmap_file(view, size);
+	if (src->len < 0) {
+		FreeSourceInfo(src);
+		return FALSE;
+	}
+	// 行情報を詰める
+	line = mem_realloc(src->line, sizeof(LINEINFO) * src->line_cnt);
+	if (line != NULL) {
+		src->line = line;
+	}
+	sci->src = src;
+	sci->buf = src->buf;
+	src->load_time = counter_to_micro(get_counter() - start);
+	return TRUE;
+}
+
+/*
+ * ReleaseScriptSource - 解析後のソースを解放
+ *
+ *	アドレス範囲は予約したまま残すため、トークンの err はエラー位置の識別に使用できる
+ */
+void ReleaseScriptSource(SCRIPTINFO *sci)
+{
+	if (sci->src == NULL || sci->src->commit == FALSE) {
+		return;
+	}
+	mem_page_decommit(sci->src->mh, sci->src->buf, sci->src->size);
+	sci->src->commit = FALSE;
+	sci->buf = NULL;
+}
+
+/*
+ * FreeSourceInfo - ソース情報の解放
+ */
+void FreeSourceInfo(SOURCEINFO *src)
+{
+	if (src == NULL) return;
+	mem_page_free(src->mh, &src->buf, src->size, src->commit);
+	mem_free(&src->line);
+	mem_free(&src->path);
+	mem_free(&src);
+}
+
+/*
+ * GetSourcePosition - ソース上の位置から行と桁を取得
+ */
+BOOL GetSourcePosition(SCRIPTINFO *sci, TCHAR *p, int *line, int *col)
+{
+	SOURCEINFO *src = sci->src;
+	TCHAR *r, *s;
+	int pos;
+	int low, high, mid;
+
+	if (p == NULL) {
+		return FALSE;
+	}
+	if (src == NULL) {
+		// 行情報が無い場合はバッファを検索
+		if (sci->buf == NULL || p < sci->buf || p > (sci->buf + lstrlen(sci->buf))) {
+			return FALSE;
+		}
+		low = 1;
+		for (s = r = sci->buf; r < p; r++) {
+			if (*r == TEXT('\n')) {
+				low++;
+				s = r + 1;
+			}
+		}
+		if (line != NULL) *line = low;
+		if (col != NULL) *col = (int)(p - s) + 1;
+		return TRUE;
+	}
+	// 解放後のバッファはアドレスの比較のみに使用する
+	if ((UINT_PTR)p < (UINT_PTR)src->buf || (UINT_PTR)p > (UINT_PTR)(src->buf + src->len)) {
+		return FALSE;
+	}
+	pos = (int)(((UINT_PTR)p - (UINT_PTR)src->buf) / sizeof(TCHAR));
+	// 行情報を二分探索
+	low = 0;
+	high = src->line_cnt - 1;
+	while (low < high) {
+		mid = (low + high + 1) / 2;
+		if ((src->line + mid)->pos <= pos) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+	if (line != NULL) *line = low + 1;
+	if (col != NULL) *col = pos - (src->line + low)->pos + 1;
+	return TRUE;
+}
+
+/*
+ * IsReleasedSource - 解放済みのソースを指す位置か判定
+ *
+ *	解放後のアドレス範囲は読み込めないため、文字列として参照する前に確認する
+ */
+BOOL IsReleasedSource(SCRIPTINFO *sci, TCHAR *p)
+{
+	SOURCEINFO *src;
+
+	for (sci = sci->sci_top; sci != NULL; sci = sci->next) {
+		src = sci->src;
+		if (src != NULL && src->commit == FALSE &&
+			(UINT_PTR)p >= (UINT_PTR)src->buf && (UINT_PTR)p < (UINT_PTR)src->buf + src->size) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * GetSourceLine - 指定行のソースを取得
+ *
+ *	解析後でソースを解放している場合はファイルから該当行のみ読み込む
+ */
+TCHAR *GetSourceLine(SCRIPTINFO *sci, int line)
+{
+	SOURCEINFO *src = sci->src;
+	BY_HANDLE_FILE_INFORMATION fi;
+	BYTE *view;
+	TCHAR *buf, *p, *r;
+	DWORD size;
+	int st, en;
+
+	if (src == NULL) {
+		// 行情報が無い場合はバッファを検索
+		if (sci->buf == NULL) {
+			return NULL;
+		}
+		for (p = sci->buf; line > 1 && *p != TEXT('\0'); p++) {
+			if (*p == TEXT('\n')) {
+				line--;
+			}
+		}
+		buf = alloc_copy(p);
+	} else if (line < 1 || line > src->line_cnt) {
+		return NULL;
+	} else if (src->commit == TRUE) {
+		st = (src->line + line - 1)->pos;
+		en = (line < src->line_cnt) ? (src->line + line)->pos : src->len;
+		buf = alloc_copy_n(src->buf + st, en - st);
+	} else {
+		// ファイルから該当行を読み込む
+		view = map_file(src->path, &size, &fi);
+		if (view == NULL) {
+			return NULL;
+		}
+		if (size != src->file_size ||
+			fi.ftLastWriteTime.dwLowDateTime != src->write_time.dwLowDateTime ||
+			fi.ftLastWriteTime.dwHighDateTime != src->write_time.dwHighDateTime) {
+			// 読み込み後に変更されたファイルの行情報は使用できない
+			unmap_file(view, size);
+			return NULL;
+		}
+		st = (src->line + line - 1)->fpos;
+		en = (line < src->line_cnt) ? (src->line + line)->fpos : (int)size;
+		if (en > (int)size) en = (int)size;
+		if (st > en) st = en;
+		buf = mem_alloc(sizeof(TCHAR) * (en - st + 1));
+		if (buf != NULL) {
+			decode_utf8(view, view + st, view + en, buf, NULL);
+		}
+		unmap_file(view, size);
+	}
+	if (buf == NULL) {
+		return NULL;
+	}
+	// 前後の空白と改行を除去
+	for (p = buf; *p == TEXT('\r') || *p == TEXT('\n') || *p == TEXT('\t') || *p == TEXT(' '); p++);
+	for (r = p; *r != TEXT('\0') && *r != TEXT('\r') && *r != TEXT('\n'); r++);
+	*r = TEXT('\0');
+	if (p != buf) {
+		lstrcpy(buf, p);
+	}
+	return buf;
+}
+
+/*
+ * GetModulePath - 正規化したフルパスを取得
+ */
+static BOOL GetModulePath(TCHAR *path, TCHAR *name, TCHAR *ret)
+{
+	TCHAR buf[MAX_PATH + 1];
+	TCHAR *p;
+	DWORD len;
+
+	if (path == NULL || name == NULL || lstrlen(path) + lstrlen(name) > MAX_PATH) {
+		return FALSE;
+	}
+	str_cpy(str_cpy(buf, path), name);
+	len = GetFullPathName(buf, MAX_PATH + 1, ret, &p);
+	if (len == 0 || len > MAX_PATH) {
+		return FALSE;
+	}
+#ifdef _WIN32
+	// 大文字と小文字を区別しないファイルシステム
+	str_lower(ret);
 #endif
+	return TRUE;
 }
 
 /*
- * ReadScriptFile - XNvgt@Cǂݍ
+ * FindScriptInfo - 読み込み済みのスクリプト情報をパスから検索
  */
-SCRIPTINFO *ReadScriptFile(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
+static SCRIPTINFO *FindScriptInfo(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
+{
+	MODULEINFO *mi;
+	TCHAR fpath[MAX_PATH + 1];
+	int hash;
+
+	sci = sci->sci_top;
+	if (sci->module_hash == NULL || GetModulePath(path, name, fpath) == FALSE) {
+		return NULL;
+	}
+	hash = str2hash(fpath);
+	for (mi = *(sci->module_hash + PATH_HASH(hash)); mi != NULL; mi = mi->path_next) {
+		if (mi->path_hash == hash && lstrcmp(mi->path, fpath) == 0) {
+			return mi->sci;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * FindScriptInfoById - 読み込み済みのスクリプト情報をファイルの識別情報から検索
+ */
+static SCRIPTINFO *FindScriptInfoById(SCRIPTINFO *sci, SOURCEINFO *src)
+{
+	MODULEINFO *mi;
+
+	sci = sci->sci_top;
+	if (sci->module_hash == NULL || src == NULL || (src->index_high == 0 && src->index_low == 0)) {
+		return NULL;
+	}
+	for (mi = *(sci->module_hash + MODULE_HASH_SIZE + ID_HASH(src)); mi != NULL; mi = mi->id_next) {
+		if (mi->sci->src != NULL &&
+			mi->sci->src->volume == src->volume &&
+			mi->sci->src->index_high == src->index_high &&
+			mi->sci->src->index_low == src->index_low) {
+			return mi->sci;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * AddModuleInfo - モジュールの登録
+ */
+static BOOL AddModuleInfo(SCRIPTINFO *sci, SCRIPTINFO *csci)
+{
+	MODULEINFO *mi, *pmi;
+	MODULEINFO **hash;
+	TCHAR fpath[MAX_PATH + 1];
+
+	sci = sci->sci_top;
+	if (GetModulePath(csci->path, csci->name, fpath) == FALSE) {
+		return FALSE;
+	}
+	if (sci->module_hash == NULL) {
+		// パスと識別情報のハッシュ
+		sci->module_hash = mem_calloc(sizeof(MODULEINFO *) * MODULE_HASH_SIZE * 2);
+		if (sci->module_hash == NULL) {
+			return FALSE;
+		}
+	}
+	mi = mem_calloc(sizeof(MODULEINFO));
+	if (mi == NULL) {
+		return FALSE;
+	}
+	mi->path = alloc_copy(fpath);
+	if (mi->path == NULL) {
+		mem_free(&mi);
+		return FALSE;
+	}
+	mi->path_hash = str2hash(fpath);
+	mi->sci = csci;
+
+	hash = sci->module_hash + PATH_HASH(mi->path_hash);
+	mi->path_next = *hash;
+	*hash = mi;
+	if (csci->src != NULL && (csci->src->index_high != 0 || csci->src->index_low != 0)) {
+		hash = sci->module_hash + MODULE_HASH_SIZE + ID_HASH(csci->src);
+		mi->id_next = *hash;
+		*hash = mi;
+	}
+	// 読み込み順に追加
+	if (sci->module == NULL) {
+		sci->module = mi;
+	} else {
+		for (pmi = sci->module; pmi->next != NULL; pmi = pmi->next);
+		pmi->next = mi;
+	}
+	return TRUE;
+}
+
+/*
+ * GetModuleList - 読み込んだモジュールの一覧を取得
+ */
+MODULEINFO *GetModuleList(SCRIPTINFO *sci)
+{
+	return sci->sci_top->module;
+}
+
+/*
+ * FreeModuleInfo - モジュール情報の解放
+ */
+void FreeModuleInfo(SCRIPTINFO *sci)
+{
+	MODULEINFO *mi, *tmi;
+
+	for (mi = sci->module; mi != NULL; mi = tmi) {
+		tmi = mi->next;
+		mem_free(&mi->path);
+		mem_free(&mi);
+	}
+	sci->module = NULL;
+	mem_free(&sci->module_hash);
+}
+
+/*
+ * SetScriptInfo - 読み込むスクリプト情報の設定
+ */
+static void SetScriptInfo(SCRIPTINFO *sci, SCRIPTINFO *csci, TCHAR *path, TCHAR *name)
+{
+	csci->name = alloc_copy(name);
+	csci->path = alloc_copy(path);
+	csci->buf = NULL;
+	csci->src = NULL;
+	csci->next = NULL;
+	csci->callback = NULL;
+	csci->break_only = sci->sci_top->break_only;
+	csci->sci_top = sci->sci_top;
+	csci->strict_val_op = sci->strict_val_op;
+	csci->strict_val = sci->strict_val_op;
+	csci->extension = sci->extension;
+}
+
+/*
+ * LoadScript - スクリプトファイルの読み込み
+ */
+static BOOL LoadScript(SCRIPTINFO *csci)
+{
+	TCHAR fpath[MAX_PATH + 1];
+
+	if (csci->path == NULL || csci->name == NULL ||
+		lstrlen(csci->path) + lstrlen(csci->name) > MAX_PATH) {
+		return FALSE;
+	}
+	str_cpy(str_cpy(fpath, csci->path), csci->name);
+	return LoadScriptSource(csci, fpath);
+}
+
+/*
+ * ParseScript - 読み込んだスクリプトの構文解析
+ */
+static void ParseScript(SCRIPTINFO *csci)
+{
+	EXECINFO ei;
+
+	LONGLONG start;
+
+	ZeroMemory(&ei, sizeof(EXECINFO));
+	ei.name = csci->name;
+	ei.sci = csci;
+	start = get_counter();
+	csci->tk = ParseSentence(&ei, csci->buf, 0);
+	if (csci->src != NULL) {
+		csci->src->parse_time = counter_to_micro(get_counter() - start);
+	}
+	if (csci->prep_deferred == FALSE) {
+		ReleaseScriptSource(csci);
+	}
+}
+
+/*
+ * read_script_file - スクリプトファイルを読み込む
+ */
+static SCRIPTINFO *read_script_file(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
 {
 	SCRIPTINFO *csci = sci;
+	SCRIPTINFO *tsci;
 	EXECINFO ei;
 	TCHAR fpath[MAX_PATH + 1];
+	DWORD err;
 
 	lstrcpy(fpath, path);
 	if (*path != TEXT('\0') && *(path + lstrlen(path) - 1) != TEXT('\\')) {
 		lstrcat(fpath, TEXT("\\"));
 	}
-	if (csci->buf != NULL) {
-		//Xg̍쐬
-		while (csci->next != NULL) {
-			csci = csci->next;
-			if (csci->name != NULL && str_cmp_i(name, csci->name) == 0 &&
-				csci->path != NULL && str_cmp_i(fpath, csci->path) == 0) {
-				return csci;
-			}
+	if (csci->buf != NULL || csci->src != NULL) {
+		// 読み込み済みのモジュールを検索
+		if ((csci = FindScriptInfo(sci, fpath, name)) != NULL) {
+			return csci;
 		}
-		csci = csci->next = mem_calloc(sizeof(SCRIPTINFO));
+		csci = mem_calloc(sizeof(SCRIPTINFO));
 		if (csci == NULL) {
 			ZeroMemory(&ei, sizeof(EXECINFO));
 			ei.sci = sci;
@@ -171,42 +801,67 @@ SCRIPTINFO *ReadScriptFile(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
 			return NULL;
 		}
 	}
-	csci->name = alloc_copy(name);
-	csci->path = alloc_copy(fpath);
-	csci->buf = NULL;
-	csci->next = NULL;
-	csci->callback = NULL;
-	csci->sci_top = sci->sci_top;
-	csci->strict_val_op = sci->strict_val_op;
-	csci->strict_val = sci->strict_val_op;
-	csci->extension = sci->extension;
+	SetScriptInfo(sci, csci, fpath, name);
 
-	//t@C̓ǂݍ
+	//ファイルの読み込み
 	lstrcat(fpath, name);
-	csci->buf = read_file(fpath);
-	if (csci->buf == NULL) {
+	if (LoadScriptSource(csci, fpath) == FALSE) {
+		err = GetLastError();
+		if (csci != sci) {
+			for (tsci = sci; tsci->next != NULL; tsci = tsci->next);
+			tsci->next = csci;
+			if (err == ERROR_NOT_ENOUGH_MEMORY) {
+				// 別のパスから読み直さないように登録する
+				AddModuleInfo(sci, csci);
+			}
+		}
 		ZeroMemory(&ei, sizeof(EXECINFO));
 		ei.sci = csci;
-		Error(&ei, ERR_FILEOPEN, fpath, NULL);
+		Error(&ei, (err == ERROR_NOT_ENOUGH_MEMORY) ? ERR_ALLOC : ERR_FILEOPEN, fpath, NULL);
 		return NULL;
 	}
-	//\
-	ZeroMemory(&ei, sizeof(EXECINFO));
-	ei.name = name;
-	ei.sci = csci;
-	csci->tk = ParseSentence(&ei, csci->buf, 0);
+	if (csci != sci) {
+		// 別のパスで読み込み済みの場合
+		if ((tsci = FindScriptInfoById(sci, csci->src)) != NULL) {
+			FreeScriptInfo(csci);
+			return tsci;
+		}
+		//リストの作成
+		for (tsci = sci; tsci->next != NULL; tsci = tsci->next);
+		tsci->next = csci;
+	}
+	AddModuleInfo(sci, csci);
+	//構文解析
+	ParseScript(csci);
 	return csci;
 }
 
 /*
- * LoadLibraryFile - Cuǂݍ
+ * ReadScriptFile - スクリプトファイルを読み込む
+ */
+SCRIPTINFO *ReadScriptFile(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
+{
+	SCRIPTINFO *ret;
+
+	TRACE_BEGIN(TRACE_READ, name, -1);
+	ret = read_script_file(sci, path, name);
+	TRACE_END(TRACE_READ, name);
+	return ret;
+}
+
+/*
+ * LoadLibraryFile - ライブラリを読み込む
+ *
+ *	インターフェースのバージョンが異なるライブラリはエラーを出力して err に TRUE を設定する
  */
-static BOOL LoadLibraryFile(SCRIPTINFO *sci, TCHAR *FileName)
+static BOOL LoadLibraryFile(SCRIPTINFO *sci, TCHAR *FileName, BOOL *err)
 {
 	SCRIPTINFO *tsci = sci->sci_top;
 	EXECINFO ei;
 	LIBRARYINFO *lib, *pl;
+	LIBFUNC lib_version;
 
+	*err = FALSE;
 	lib = mem_calloc(sizeof(LIBRARYINFO));
 	if(lib == NULL){
 		ZeroMemory(&ei, sizeof(EXECINFO));
@@ -214,12 +869,23 @@ static BOOL LoadLibraryFile(SCRIPTINFO *sci, TCHAR *FileName)
 		Error(&ei, ERR_ALLOC, FileName, NULL);
 		return FALSE;
 	}
-	//Cu̓ǂݍ
+	//ライブラリの読み込み
 	lib->hModul = LoadLibrary(FileName);
 	if(lib->hModul == NULL){
 		mem_free(&lib);
 		return FALSE;
 	}
+	// 以前のバージョンのライブラリが返すバッファは解放できないため読み込まない
+	lib_version = (LIBFUNC)GetProcAddress(lib->hModul, LIB_VERSION_FUNC);
+	if (lib_version == NULL || lib_version() != LIB_VERSION) {
+		FreeLibrary(lib->hModul);
+		mem_free(&lib);
+		ZeroMemory(&ei, sizeof(EXECINFO));
+		ei.sci = sci;
+		Error(&ei, ERR_LIBVERSION, FileName, NULL);
+		*err = TRUE;
+		return FALSE;
+	}
 	if (tsci->lib == NULL) {
 		tsci->lib = lib;
 	} else {
@@ -230,32 +896,203 @@ static BOOL LoadLibraryFile(SCRIPTINFO *sci, TCHAR *FileName)
 }
 
 /*
- * ReadScriptFiles - XNvgt@Cēǂݍ
+ * HasDirectiveLine - 行頭 (空白を除く) にプリプロセッサがあるか
+ */
+static BOOL HasDirectiveLine(TCHAR *p)
+{
+	while (*p != TEXT('\0')) {
+		for (; *p == TEXT(' ') || *p == TEXT('\t'); p++);
+		if (*p == TEXT('#')) {
+			return TRUE;
+		}
+		for (; *p != TEXT('\0') && *p != TEXT('\n'); p++);
+		if (*p == TEXT('\n')) {
+			p++;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * LoadTask - 1ファイル分の読み込みと構文解析 (ワーカースレッド)
+ */
+static void LoadTask(LOADTASK *lt)
+{
+	if (lt->sci == NULL || LoadScript(lt->sci) == FALSE) {
+		lt->err = GetLastError();
+		return;
+	}
+	lt->load = TRUE;
+	if (HasDirectiveLine(lt->sci->buf) == TRUE) {
+		// プリプロセッサは他のスクリプトを実行するため順番に処理する
+		return;
+	}
+	// エラーは実行順に出力するため保留する
+	lt->sci->hold_error = TRUE;
+	ParseScript(lt->sci);
+	if (lt->sci->prep_deferred == TRUE) {
+		// 行の途中のプリプロセッサは解析を中断したため順番に解析し直す
+		lt->sci->prep_deferred = FALSE;
+		lt->sci->hold_error = FALSE;
+		mem_free(&lt->sci->hold_err_str);
+		return;
+	}
+	lt->parse = TRUE;
+}
+
+/*
+ * LoadThread - 読み込みスレッド
+ */
+static DWORD WINAPI LoadThread(LPVOID param)
+{
+	LOADQUEUE *lq = (LOADQUEUE *)param;
+	MEMHEAP *prev;
+	LONG i;
+
+	// 呼び出し元と同じヒープから確保して上限と使用サイズの対象にする
+	prev = mem_heap_select(lq->mh);
+	while ((i = InterlockedIncrement(&lq->index) - 1) < lq->cnt) {
+		LoadTask(lq->task + i);
+	}
+	mem_heap_select(prev);
+	return 0;
+}
+
+/*
+ * LoadTasks - 読み込みと構文解析を並列に実行
+ */
+static void LoadTasks(LOADQUEUE *lq)
+{
+	SYSTEM_INFO si;
+	HANDLE hThread[MAX_LOAD_THREAD];
+	int cnt = 0;
+	int max;
+	int i;
+
+	GetSystemInfo(&si);
+	max = (int)si.dwNumberOfProcessors;
+	if (max > lq->cnt) max = lq->cnt;
+	if (max > MAX_LOAD_THREAD) max = MAX_LOAD_THREAD;
+	// ワーカースレッドと共有する間は呼び出し元のヒープを排他制御する
+	lq->mh = mem_heap_get();
+	if (max > 1) {
+		mem_heap_set_serialize(lq->mh, TRUE);
+	}
+	// 呼び出し元のスレッドも処理を行う
+	for (i = 1; i < max; i++) {
+		hThread[cnt] = CreateThread(NULL, 0, LoadThread, lq, 0, NULL);
+		if (hThread[cnt] == NULL) {
+			break;
+		}
+		cnt++;
+	}
+	LoadThread(lq);
+	if (cnt > 0) {
+		WaitForMultipleObjects(cnt, hThread, TRUE, INFINITE);
+		for (i = 0; i < cnt; i++) {
+			CloseHandle(hThread[i]);
+		}
+	}
+	mem_heap_set_serialize(lq->mh, FALSE);
+}
+
+/*
+ * ImportScript - 読み込んだスクリプトをリストに追加して実行
+ */
+static BOOL ImportScript(SCRIPTINFO *sci, TCHAR *path, TCHAR *name, LOADTASK *lt)
+{
+	SCRIPTINFO *csci, *tsci;
+	EXECINFO ei;
+	VALUEINFO *rvi = NULL;
+	TCHAR fpath[MAX_PATH + 1];
+
+	if (lt != NULL && lt->sci != NULL && FindScriptInfo(sci->sci_top, path, name) != NULL) {
+		// 先に実行したスクリプトから読み込まれている場合は破棄
+		FreeScriptInfo(lt->sci);
+		lt->sci = NULL;
+	}
+	if (lt != NULL && lt->sci != NULL && (csci = FindScriptInfoById(sci, lt->sci->src)) != NULL) {
+		// 別のパスで読み込み済みの場合
+		FreeScriptInfo(lt->sci);
+		lt->sci = NULL;
+	} else if (lt == NULL || lt->sci == NULL) {
+		csci = ReadScriptFile(sci->sci_top, path, name);
+	} else {
+		// 検索順でリストに追加
+		csci = lt->sci;
+		lt->sci = NULL;
+		for (tsci = sci->sci_top; tsci->next != NULL; tsci = tsci->next);
+		tsci->next = csci;
+		if (lt->load == FALSE) {
+			if (lstrlen(path) + lstrlen(name) <= MAX_PATH) {
+				str_cpy(str_cpy(fpath, path), name);
+			} else {
+				lstrcpyn(fpath, name, MAX_PATH + 1);
+			}
+			if (lt->err == ERROR_NOT_ENOUGH_MEMORY) {
+				// 別のパスから読み直さないように登録する
+				AddModuleInfo(sci, csci);
+			}
+			ZeroMemory(&ei, sizeof(EXECINFO));
+			ei.sci = csci;
+			Error(&ei, (lt->err == ERROR_NOT_ENOUGH_MEMORY) ? ERR_ALLOC : ERR_FILEOPEN, fpath, NULL);
+			return FALSE;
+		}
+		AddModuleInfo(sci, csci);
+		if (lt->parse == FALSE) {
+			ParseScript(csci);
+		}
+		FlushError(csci);
+	}
+	if (csci == NULL || csci->tk == NULL) {
+		return FALSE;
+	}
+	if (sci->sci_top->compile != NULL) {
+		// コンパイル時は実行順のみ記録する
+		return AddCodeModule(sci->sci_top->compile, csci);
+	}
+	if (csci->ei == NULL && ExecScript(csci, NULL, &rvi) != 0) {
+		FreeValueList(rvi);
+		return FALSE;
+	}
+	FreeValueList(rvi);
+	return TRUE;
+}
+
+/*
+ * ReadScriptFiles - スクリプトファイルを検索して読み込む
+ *
+ *	複数のファイルに一致した場合は読み込みと構文解析を並列に行い、実行は検索順に行う
  */
 BOOL ReadScriptFiles(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
 {
 	WIN32_FIND_DATA FindData;
 	HANDLE hFindFile;
+	LOADQUEUE lq;
+	LOADTASK *lt;
 	TCHAR buf[MAX_PATH + 1];
 	TCHAR sPath[MAX_PATH + 1];
 	TCHAR *p, *r;
+	BOOL ret = TRUE;
+	int size = 0;
+	int i;
 
 	if (lstrlen(path) + lstrlen(name) >= MAX_PATH) {
 		return FALSE;
 	}
 
-	// ΃pX
+	// 相対パスを結合
 	p = str_cpy(buf, path);
 	p = str_cpy(p, name);
 	for (p = r = buf; *p != TEXT('\0'); p++) {
 #ifdef UNICODE
-		if (*p == TEXT('\\')) {
+		if (*p == TEXT('\\') || *p == TEXT('/')) {
 			r = p + 1;
 		}
 #else
 		if (IsDBCSLeadByte(*p) == TRUE && *(p + 1) != TEXT('\0')) {
 			p++;
-		} else if (*p == TEXT('\\')) {
+		} else if (*p == TEXT('\\') || *p == TEXT('/')) {
 			r = p + 1;
 		}
 #endif
@@ -266,38 +1103,73 @@ BOOL ReadScriptFiles(SCRIPTINFO *sci, TCHAR *path, TCHAR *name)
 	if (hFindFile == INVALID_HANDLE_VALUE) {
 		return FALSE;
 	}
+	// 一致したファイルの列挙
+	ZeroMemory(&lq, sizeof(LOADQUEUE));
 	do {
 		if ((FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
-			SCRIPTINFO *csci;
-			VALUEINFO *rvi = NULL;
 			if (sci->path != NULL && str_cmp_i(sci->path, sPath) == 0 &&
 				sci->name != NULL && str_cmp_i(sci->name, FindData.cFileName) == 0) {
-				// t@C͓ǂݍ܂Ȃ
+				// 同一ファイルは読み込まない
 				continue;
 			}
-			csci = ReadScriptFile(sci->sci_top, sPath, FindData.cFileName);
-			if (csci == NULL || csci->tk == NULL) {
-				return FALSE;
+			if (lq.cnt >= size) {
+				size += LOAD_TASK_ALLOC_CNT;
+				lt = (lq.task == NULL) ? mem_alloc(sizeof(LOADTASK) * size) : mem_realloc(lq.task, sizeof(LOADTASK) * size);
+				if (lt == NULL) {
+					ret = FALSE;
+					break;
+				}
+				lq.task = lt;
 			}
-			if (csci->ei == NULL && ExecScript(csci, NULL, &rvi) == -1) {
-				FreeValueList(rvi);
-				return FALSE;
+			lt = lq.task + lq.cnt;
+			ZeroMemory(lt, sizeof(LOADTASK));
+			if ((lt->name = alloc_copy(FindData.cFileName)) == NULL) {
+				ret = FALSE;
+				break;
 			}
-			FreeValueList(rvi);
+			lq.cnt++;
 		}
 	} while (FindNextFile(hFindFile, &FindData) == TRUE);
 	FindClose(hFindFile);
-	return TRUE;
+
+	if (ret == TRUE && lq.cnt == 1) {
+		// 1ファイルの場合は順番に処理
+		ret = ImportScript(sci, sPath, lq.task->name, NULL);
+	} else if (ret == TRUE && lq.cnt > 1) {
+		// 読み込み済みで無いファイルを並列に読み込み
+		for (i = 0; i < lq.cnt; i++) {
+			lt = lq.task + i;
+			if (FindScriptInfo(sci->sci_top, sPath, lt->name) != NULL) {
+				continue;
+			}
+			lt->sci = mem_calloc(sizeof(SCRIPTINFO));
+			if (lt->sci != NULL) {
+				SetScriptInfo(sci->sci_top, lt->sci, sPath, lt->name);
+			}
+		}
+		LoadTasks(&lq);
+		// 検索順に実行
+		for (i = 0; i < lq.cnt && ret == TRUE; i++) {
+			ret = ImportScript(sci, sPath, (lq.task + i)->name, lq.task + i);
+		}
+	}
+	for (i = 0; i < lq.cnt; i++) {
+		FreeScriptInfo((lq.task + i)->sci);
+		mem_free(&(lq.task + i)->name);
+	}
+	mem_free(&lq.task);
+	return ret;
 }
 
 /*
- * Preprocessor - vvZbT
+ * Preprocessor - プリプロセッサ
  */
 TCHAR *Preprocessor(SCRIPTINFO *sci, TCHAR *path, TCHAR *p)
 {
 	EXECINFO ei;
 	TCHAR *str;
 	TCHAR *r, *s, *t;
+	BOOL lib_err = FALSE;
 
 	for (t = p; *p != TEXT('\0') && *p != TEXT('('); p++);
 	if (*p == TEXT('\0')) {
@@ -337,44 +1209,53 @@ TCHAR *Preprocessor(SCRIPTINFO *sci, TCHAR *path, TCHAR *p)
 		if (GetCurrentDirectory(MAX_PATH, cdir) != 0) {
 			lstrcat(cdir, TEXT("\\"));
 		}
-		// XNvgt@C܂̓CũC|[g
-		// ͈ȉ
-		// 1) XNvgpX̑΃pX(XNvg)
-		// 2) JgfBNg̑΃pX(XNvg)
-		// 3) Cu
-		if (ReadScriptFiles(sci, path, str) == FALSE &&
+		// スクリプトファイルまたはライブラリのインポート
+		// 検索順序は以下
+		// 1) スクリプトパスからの相対パス(スクリプト)
+		// 2) カレントディレクトリからの相対パス(スクリプト)
+		// 3) ライブラリ
+		if (ReadScriptFiles(sci, path, str) == FALSE && sci->sci_top->limit_over == FALSE &&
 			(*cdir == TEXT('\0') || ReadScriptFiles(sci, cdir, str) == FALSE) &&
-			LoadLibraryFile(sci, str) == FALSE) {
+			LoadLibraryFile(sci, str, &lib_err) == FALSE) {
 #ifndef IGNORE_IMPORT_ERROR
 			mem_free(&str);
-			ZeroMemory(&ei, sizeof(EXECINFO));
-			ei.sci = sci;
-			Error(&ei, ERR_SCRIPT, t, NULL);
+			if (lib_err == FALSE) {
+				ZeroMemory(&ei, sizeof(EXECINFO));
+				ei.sci = sci;
+				Error(&ei, ERR_SCRIPT, t, NULL);
+			}
 			return NULL;
 #endif
 		}
+		if (sci->sci_top->limit_over == TRUE) {
+			// インポートしたスクリプトの実行が上限に達した場合は解析を中止する
+			mem_free(&str);
+			return NULL;
+		}
 	} else if (str_cmp_ni(t, PREP_LIBRARY, lstrlen(PREP_LIBRARY)) == 0) {
 		sci->extension = TRUE;
-		// Cu̓ǂݍ
-		if (LoadLibraryFile(sci, str) == FALSE) {
+		// ライブラリの読み込み
+		if (LoadLibraryFile(sci, str, &lib_err) == FALSE) {
 #ifndef IGNORE_IMPORT_ERROR
 			mem_free(&str);
-			ZeroMemory(&ei, sizeof(EXECINFO));
-			ei.sci = sci;
-			Error(&ei, ERR_FILEOPEN, t, NULL);
+			if (lib_err == FALSE) {
+				ZeroMemory(&ei, sizeof(EXECINFO));
+				ei.sci = sci;
+				Error(&ei, ERR_FILEOPEN, t, NULL);
+			}
 			return NULL;
 #endif
 		}
 	} else if (str_cmp_ni(t, PREP_OPTION, lstrlen(PREP_OPTION)) == 0) {
-		//IvV
+		//オプション
 		if (str_cmp_i(str, TEXT("pg0.5")) == 0) {
 			// PG0.5
 			sci->extension = TRUE;
 		} else if (str_cmp_i(str, TEXT("strict")) == 0) {
-			// Iȕϐ錾̋
+			// 明示的な変数宣言の強制
 			sci->strict_val = TRUE;
 		} else {
-			// sȎʎq
+			// 不正な識別子
 			mem_free(&str);
 			ZeroMemory(&ei, sizeof(EXECINFO));
 			ei.sci = sci;
@@ -382,7 +1263,7 @@ TCHAR *Preprocessor(SCRIPTINFO *sci, TCHAR *path, TCHAR *p)
 			return NULL;
 		}
 	} else {
-		// sȎʎq
+		// 不正な識別子
 		mem_free(&str);
 		ZeroMemory(&ei, sizeof(EXECINFO));
 		ei.sci = sci;
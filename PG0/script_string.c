@@ -25,7 +25,7 @@
 /* Local Function Prototypes */
 
 /*
-* tchar2char - mۂ char  char ɕϊ
+* tchar2char - メモリを確保して char を char に変換する
 */
 char *tchar2char(const TCHAR *str)
 {
@@ -49,7 +49,7 @@ char *tchar2char(const TCHAR *str)
 }
 
 /*
- * char2tchar - mۂ char  char ɕϊ
+ * char2tchar - メモリを確保して char を char に変換する
  */
 TCHAR *char2tchar(const char *str)
 {
@@ -73,7 +73,7 @@ TCHAR *char2tchar(const char *str)
 }
 
 /*
- * str_cpy - Rs[čŌ̃̕AhXԂ
+ * str_cpy - 文字列をコピーして最後の文字のアドレスを返す
  */
 TCHAR *str_cpy(TCHAR *ret, const TCHAR *buf)
 {
@@ -87,7 +87,7 @@ TCHAR *str_cpy(TCHAR *ret, const TCHAR *buf)
 }
 
 /*
- * str_cpy_n - w肳ꂽ܂ŕRs[
+ * str_cpy_n - 指定された文字数まで文字列をコピーする
  */
 TCHAR *str_cpy_n(TCHAR *ret, TCHAR *buf, const int len)
 {
@@ -104,7 +104,7 @@ TCHAR *str_cpy_n(TCHAR *ret, TCHAR *buf, const int len)
 }
 
 /*
- * str_cmp_n - Q̕𕶎rs
+ * str_cmp_n - ２つの文字列を文字数分比較を行う
  */
 int str_cmp_n(const TCHAR *buf1, const TCHAR *buf2, const int len)
 {
@@ -115,7 +115,7 @@ int str_cmp_n(const TCHAR *buf1, const TCHAR *buf2, const int len)
 }
 
 /*
- * str_cmp_i - ̑啶ʂȂrs
+ * str_cmp_i - 文字列の大文字小文字を区別しない比較を行う
  */
 int str_cmp_i(const TCHAR *buf1, const TCHAR *buf2)
 {
@@ -124,7 +124,7 @@ int str_cmp_i(const TCHAR *buf1, const TCHAR *buf2)
 }
 
 /*
- * str_cmp_ni - Q̕啶AʂȂŔrs
+ * str_cmp_ni - ２つの文字列を大文字、小文字を区別しないで比較を行う
  */
 int str_cmp_ni(const TCHAR *buf1, const TCHAR *buf2, const int len)
 {
@@ -135,7 +135,7 @@ int str_cmp_ni(const TCHAR *buf1, const TCHAR *buf2, const int len)
 }
 
 /*
- * f2a - 10i\L̕ɕϊ
+ * f2a - 実数を10進表記の文字列に変換する
  */
 TCHAR *f2a(const double f)
 {
@@ -145,12 +145,12 @@ TCHAR *f2a(const double f)
 	if (buf == NULL) {
 		return NULL;
 	}
-	swprintf_s(buf, FLOAT_LENGTH, TEXT("%.16f"), f);
+	_stprintf_s(buf, FLOAT_LENGTH, TEXT("%.16f"), f);
 	return buf;
 }
 
 /*
- * i2a - 10i\L̕ɕϊ
+ * i2a - 整数を10進表記の文字列に変換する
  */
 TCHAR *i2a(const int i)
 {
@@ -165,7 +165,7 @@ TCHAR *i2a(const int i)
 }
 
 /*
- * x2d - 16i\L̕𐔒lɕϊ
+ * x2d - 16進表記の文字列を数値に変換する
  */
 int x2d(const TCHAR *str)
 {
@@ -188,7 +188,7 @@ int x2d(const TCHAR *str)
 }
 
 /*
- * o2d - 8i\L̕𐔒lɕϊ
+ * o2d - 8進表記の文字列を数値に変換する
  */
 int o2d(const TCHAR *str)
 {
@@ -207,7 +207,7 @@ int o2d(const TCHAR *str)
 }
 
 /*
- * conv_ctrl - 䕶ϊ
+ * conv_ctrl - 制御文字を変換
  */
 BOOL conv_ctrl(TCHAR *buf)
 {
@@ -222,13 +222,13 @@ BOOL conv_ctrl(TCHAR *buf)
 	while (*p != TEXT('\0')) {
 #ifndef UNICODE
 		if (IsDBCSLeadByte((BYTE)*p) == TRUE && *(p + 1) != TEXT('\0')) {
-			//2oCgR[hXLbv
+			//2バイトコードをスキップ
 			p += 2;
 			continue;
 		}
 #endif
 		if (*p == TEXT('\\') && *(p + 1) != TEXT('\0')) {
-			//䕶̕ϊ
+			//制御文字の変換
 			r = p + 1;
 			switch (*r) {
 			case TEXT('r'):
@@ -244,13 +244,13 @@ BOOL conv_ctrl(TCHAR *buf)
 				break;
 
 			case TEXT('t'):
-				//^u
+				//タブ
 				r++;
 				*(p++) = TEXT('\t');
 				break;
 
 			case TEXT('b'):
-				//obNXy[X
+				//バックスペース
 				r++;
 				*(p++) = TEXT('\b');
 				break;
@@ -316,7 +316,7 @@ BOOL conv_ctrl(TCHAR *buf)
 }
 
 /*
- * reconv_ctrl - 䕶𕶎ɕϊ
+ * reconv_ctrl - 制御文字を文字に変換
  */
 TCHAR *reconv_ctrl(TCHAR *buf)
 {
@@ -376,13 +376,13 @@ TCHAR *reconv_ctrl(TCHAR *buf)
 				break;
 
 			case TEXT('\t'):
-				//^u
+				//タブ
 				*(r++) = TEXT('\\');
 				*(r++) = TEXT('t');
 				break;
 
 			case TEXT('\b'):
-				//obNXy[X
+				//バックスペース
 				*(r++) = TEXT('\\');
 				*(r++) = TEXT('b');
 				break;
@@ -417,13 +417,13 @@ TCHAR *reconv_ctrl(TCHAR *buf)
 			break;
 
 		case TEXT('\t'):
-			//^u
+			//タブ
 			*(r++) = TEXT('\\');
 			*(r++) = TEXT('t');
 			break;
 
 		case TEXT('\b'):
-			//obNXy[X
+			//バックスペース
 			*(r++) = TEXT('\\');
 			*(r++) = TEXT('b');
 			break;
@@ -449,15 +449,15 @@ TCHAR *reconv_ctrl(TCHAR *buf)
 }
 
 /*
- * str_skip - ̏Iʒu̎擾
+ * str_skip - 文字列の終わり位置の取得
  */
 TCHAR *str_skip(TCHAR *p, TCHAR end)
 {
-	//̓XLbv
+	//文字列はスキップ
 	for (p++; *p != TEXT('\0') && *p != end; p++) {
 #ifndef UNICODE
 		if (IsDBCSLeadByte((BYTE)*p) == TRUE && *(p + 1) != TEXT('\0')) {
-			//2oCgR[hXLbv
+			//2バイトコードをスキップ
 			p++;
 			if (*p == TEXT('\0')) break;
 			continue;
@@ -474,7 +474,7 @@ TCHAR *str_skip(TCHAR *p, TCHAR end)
 }
 
 /*
- * GetPairtBrace - Ή銇ʂ擾
+ * GetPairtBrace - 対応する括弧を取得
  */
 TCHAR *get_pair_brace(TCHAR *buf)
 {
@@ -502,7 +502,7 @@ TCHAR *get_pair_brace(TCHAR *buf)
 	for (buf++; *buf != TEXT('\0'); buf++) {
 #ifndef UNICODE
 		if (IsDBCSLeadByte((BYTE)*buf) == TRUE && *(buf + 1) != TEXT('\0')) {
-			//2oCgR[hXLbv
+			//2バイトコードをスキップ
 			buf++;
 			if (*buf == TEXT('\0')) {
 				break;
@@ -511,14 +511,14 @@ TCHAR *get_pair_brace(TCHAR *buf)
 		}
 #endif
 		if (*buf == TEXT('\"') || *buf == TEXT('\'')) {
-			//̓XLbv
+			//文字列はスキップ
 			buf = str_skip(buf, *buf);
 			if (*buf == TEXT('\0')) {
 				break;
 			}
 		}
 		if (*buf == TEXT('/') && *(buf + 1) == TEXT('/')) {
-			//RgXLbv
+			//コメントをスキップ
 			for (; *buf != TEXT('\0') && *buf != TEXT('\r') && *buf != TEXT('\n'); buf++);
 			if (*buf == TEXT('\0')) {
 				break;
@@ -535,24 +535,24 @@ TCHAR *get_pair_brace(TCHAR *buf)
 }
 
 /*
- * str_trim - ̑Ő, Tab
+ * str_trim - 文字列の前後の空白, Tabを除去する
  */
 BOOL str_trim(TCHAR *buf)
 {
 	TCHAR *p, *r;
 
-	//Ő󔒂|C^擾
+	//前後の空白を除いたポインタを取得
 	for (p = buf; (*p == TEXT(' ') || *p == TEXT('\t')) && *p != TEXT('\0'); p++);
 	for (r = buf + lstrlen(buf) - 1; (*r == TEXT(' ') || *r == TEXT('\t')) && r > p; r--);
 	*(r + 1) = TEXT('\0');
 
-	//̕ɃRs[s
+	//元の文字列にコピーを行う
 	lstrcpy(buf, p);
 	return TRUE;
 }
 
 /*
- * str_lower - ɕϊ
+ * str_lower - 文字列を小文字に変換
  */
 void str_lower(TCHAR *p)
 {
@@ -562,7 +562,7 @@ void str_lower(TCHAR *p)
 }
 
 /*
- * str2hash - ̃nbVl擾
+ * str2hash - 文字列のハッシュ値を取得
  */
 int str2hash(TCHAR *str)
 {
@@ -19,8 +19,18 @@
 #define SFUNC					__stdcall
 typedef int (SFUNC *LIBFUNC)();
 
+// ライブラリのインターフェースのバージョン
+// 2: mem_alloc で確保したバッファの先頭にヒープの情報を付加
+// 3: 巻き戻し用のヒープ (mem_free で解放しないブロック) を追加
+#define LIB_VERSION				3
+#define LIB_VERSION_FUNC		"_lib_version"
+
+#define FUNCREG_HASH_SIZE		64
+#define PROF_HASH_SIZE			256
+#define STAT_DEPTH_SIZE			8
+
 /* Struct */
-// G[^Cv
+// エラータイプ
 typedef enum {
 	ERR_SENTENCE = 0,
 	ERR_SENTENCE_PREV,
@@ -38,10 +48,13 @@ typedef enum {
 	ERR_SCRIPT,
 	ERR_FUNCTION,
 	ERR_FUNCTION_EXEC,
+	ERR_LIMIT,
+	ERR_LIBVERSION,
 } ERROR_CODE;
 
-// ߂l^Cv
+// 戻り値タイプ
 typedef enum {
+	RET_LIMIT = -4,
 	RET_RETURN = -3,
 	RET_EXIT = -2,
 	RET_ERROR = -1,
@@ -50,14 +63,14 @@ typedef enum {
 	RET_CONTINUE
 } RET_TYPE;
 
-// ֐^Cv
+// 関数タイプ
 typedef enum {
 	FUNC_NONE = 0,
 	FUNC_SCRIPT,
 	FUNC_LIBRARY
 } FUNCTION_TYPE;
 
-// ϐ^Cv
+// 変数タイプ
 typedef enum {
 	TYPE_INTEGER = 0,
 	TYPE_FLOAT,
@@ -65,7 +78,7 @@ typedef enum {
 	TYPE_ARRAY
 } VALUE_TYPE;
 
-//V{
+//シンボル
 typedef enum {
 	SYM_NONE = 0,
 	SYM_EOF,				// '\0'
@@ -110,12 +123,12 @@ typedef enum {
 	SYM_PLUS,				// +
 	SYM_MINS,				// -
 
-	SYM_CONST_INT,			// l萔
-	SYM_DECLVARIABLE,		// ϐ`
-	SYM_VARIABLE,			// ϐ
-	SYM_ARRAY,				// z
+	SYM_CONST_INT,			// 数値定数
+	SYM_DECLVARIABLE,		// 変数定義
+	SYM_VARIABLE,			// 変数
+	SYM_ARRAY,				// 配列
 
-	//\
+	//予約語
 	SYM_VAR,				// var
 	SYM_IF,					// if
 	SYM_ELSE,				// else
@@ -148,11 +161,11 @@ typedef enum {
 
 	SYM_INC,				// ++
 	SYM_DEC,				// --
-	SYM_BINC,				// ++ (u)
-	SYM_BDEC,				// -- (u)
+	SYM_BINC,				// ++ (後置)
+	SYM_BDEC,				// -- (後置)
 
-	SYM_CONST_FLOAT,		// 萔()
-	SYM_CONST_STRING,		// 萔
+	SYM_CONST_FLOAT,		// 定数(実数)
+	SYM_CONST_STRING,		// 文字列定数
 
 	SYM_FOR,				// for
 	SYM_DO,					// do
@@ -170,28 +183,60 @@ typedef enum {
 	SYM_RETURN,				// return
 } SYM_TYPE;
 
-//g[N
+//統計 (確保と解放の対象)
+typedef enum {
+	STAT_OBJ_VALUE = 0,		// 変数
+	STAT_OBJ_STRING,		// 文字列の値
+	STAT_OBJ_FRAME,			// 関数呼び出しの実行情報
+	STAT_OBJ_FUNCADDR,		// 関数アドレスの保存
+	STAT_OBJ_SIZE
+} STAT_OBJ;
+
+//統計 (関数の検索方法)
+typedef enum {
+	STAT_FUNC_CACHE_SCRIPT = 0,	// 保存済みのアドレス (ユーザ関数)
+	STAT_FUNC_CACHE_LIBRARY,	// 保存済みのアドレス (ライブラリ関数)
+	STAT_FUNC_SCRIPT,			// 同じスクリプトのユーザ関数
+	STAT_FUNC_MODULE,			// 別スクリプトのユーザ関数
+	STAT_FUNC_LIBRARY,			// ライブラリ関数
+	STAT_FUNC_INSTANCE,			// 登録関数と標準関数
+	STAT_FUNC_NOTFOUND,			// 見つからない
+	STAT_FUNC_SIZE
+} STAT_FUNC;
+
+//トレースの分類
+typedef enum {
+	TRACE_READ = 0,			// 読み込み
+	TRACE_PARSE,			// 構文解析
+	TRACE_EXEC,				// スクリプトの実行
+	TRACE_FUNC,				// ユーザ関数
+	TRACE_LIB,				// ライブラリ関数
+} TRACE_CAT;
+
+//トークン
 typedef struct _TOKEN {
 	SYM_TYPE sym_type;
 	TCHAR *buf;
 	int i;
 	double f;
 
-	//G[ʒu (link)
+	//エラー位置 (link)
 	TCHAR *err;
 
-	//̃g[N
+	//次のトークン
 	struct _TOKEN *next;
-	//ubN
+	//ブロック
 	struct _TOKEN *target;
-	//SYM_JUMP̃N
+	//SYM_JUMPのリンク先
 	struct _TOKEN *link;
 
-	// sԍ
+	// 行番号
 	int line;
+	// 行に入る位置のトークン (ブレークポイントを判定する位置)
+	BOOL line_head;
 } TOKEN;
 
-// l
+// 値
 typedef struct _VALUE {
 	union {
 		struct _VALUEINFO *array;
@@ -200,27 +245,31 @@ typedef struct _VALUE {
 		double fValue;
 	} u;
 	VALUE_TYPE type;
-	// {
+	// 本体
 	struct _VALUEINFO *vi;
+	// 更新カウンタ (確保・更新時の mod_count、配列は要素の更新も含む)
+	unsigned int mod;
+	// 変数の配列の要素として参照された場合の配列 (更新カウンタの伝搬用)
+	struct _VALUE *parent;
 } VALUE;
 
-// l
+// 値情報
 typedef struct _VALUEINFO {
-	// O
+	// 名前
 	TCHAR *name;
 	TCHAR *org_name;
 	int name_hash;
 
-	// l
+	// 値
 	struct _VALUE *v;
 
-	//Xg
+	//リスト
 	struct _VALUEINFO *next;
 } VALUEINFO;
 
-// ֐AhX
+// 関数アドレス情報
 typedef struct _FUNCADDRINFO {
-	//֐
+	//関数名
 	TCHAR *name;
 	int name_hash;
 
@@ -231,77 +280,337 @@ typedef struct _FUNCADDRINFO {
 	struct _FUNCADDRINFO *next;
 } FUNCADDRINFO;
 
-//s
+//実行情報
 typedef struct _EXECINFO {
 	TCHAR *name;
 	TCHAR *err;
 
-	//ϐ錾tO
+	//変数宣言フラグ
 	BOOL decl;
-	//ʒuws
+	//位置指定実行
 	SYM_TYPE to_tk;
 
-	//XNvg
+	//スクリプト情報
 	struct _SCRIPTINFO *sci;
-	//[Jϐ
+	//ローカル変数
 	struct _VALUEINFO *vi;
-	// ֐AhX
+	// 関数アドレス情報
 	struct _FUNCADDRINFO *funcaddr;
-	//e
+	//親
 	struct _EXECINFO *parent;
 
-	//u
+	//後置
 	struct _VALUEINFO *inc_vi;
 	struct _VALUEINFO *dec_vi;
 
-	// EXITtO
+	// EXITフラグ
 	BOOL exit;
 	BOOL line_mode;
 } EXECINFO;
 
-//֐
+//関数情報
 typedef struct _FUNCINFO {
-	//֐
+	//関数名
 	TCHAR *name;
 	int name_hash;
-	//͖ (link)
+	//解析木 (link)
 	struct _TOKEN *tk;
 
 	struct _FUNCINFO *next;
 } FUNCINFO;
 
-//Cu
+//ライブラリ情報
 typedef struct _LIBRARYINFO {
 	HANDLE hModul;
 
 	struct _LIBRARYINFO *next;
 } LIBRARYINFO;
 
-//XNvg
+//行情報
+typedef struct _LINEINFO {
+	//行頭の位置 (文字単位)
+	int pos;
+	//行頭のファイル位置 (バイト単位)
+	int fpos;
+} LINEINFO;
+
+//ソース情報
+typedef struct _SOURCEINFO {
+	//ファイルのフルパス
+	TCHAR *path;
+	//変換後のソース (解析後は解放してアドレス範囲のみ保持)
+	TCHAR *buf;
+	int len;
+	SIZE_T size;
+	BOOL commit;
+	//buf のサイズを加算したヒープ
+	struct _MEMHEAP *mh;
+
+	//行情報
+	struct _LINEINFO *line;
+	int line_cnt;
+
+	//ファイルの識別情報
+	DWORD volume;
+	DWORD index_high;
+	DWORD index_low;
+	//読み込み時のファイルサイズと更新日時 (行情報のファイル位置の検証用)
+	DWORD file_size;
+	FILETIME write_time;
+	//読み込み時間と解析時間 (マイクロ秒)
+	LONGLONG load_time;
+	LONGLONG parse_time;
+} SOURCEINFO;
+
+//モジュール情報
+typedef struct _MODULEINFO {
+	//正規化したフルパス
+	TCHAR *path;
+	int path_hash;
+	struct _SCRIPTINFO *sci;
+
+	//読み込み順のリスト
+	struct _MODULEINFO *next;
+	//ハッシュのリスト
+	struct _MODULEINFO *path_next;
+	struct _MODULEINFO *id_next;
+} MODULEINFO;
+
+//登録関数
+typedef struct _FUNCREGINFO {
+	TCHAR *name;
+	int name_hash;
+	LIBFUNC func;
+	struct _FUNCREGINFO *next;
+} FUNCREGINFO;
+
+//実行の統計
+typedef struct _STATINFO {
+	//実行したトークン (SYM_TYPEごと)
+	LONGLONG sym[SYM_RETURN + 1];
+	//確保と解放 (STAT_OBJごと)
+	LONGLONG alloc[STAT_OBJ_SIZE];
+	LONGLONG free[STAT_OBJ_SIZE];
+	//変数の検索回数と辿った実行情報の数
+	LONGLONG var_lookup;
+	LONGLONG var_depth;
+	//辿った実行情報の数ごとの検索回数 (0は見つからない、最後はそれ以上)
+	LONGLONG var_hist[STAT_DEPTH_SIZE];
+	//関数の検索方法 (STAT_FUNCごと)
+	LONGLONG func[STAT_FUNC_SIZE];
+	//変数リストのコピー
+	LONGLONG copy_list;
+	LONGLONG copy_elem;
+	//コピーした文字列のバイト数
+	LONGLONG copy_bytes;
+} STATINFO;
+
+//インタプリタのインスタンス
+typedef struct _INSTANCEINFO {
+	//メモリ
+	struct _MEMHEAP *mh;
+	//登録関数 (ハッシュ)
+	struct _FUNCREGINFO *func[FUNCREG_HASH_SIZE];
+	//統計
+	struct _STATINFO *stat;
+	BOOL stat_enable;
+
+	//ホストのデータ
+	void *param;
+} INSTANCEINFO;
+
+//コンパイル済みスクリプト (読み取り専用で共有)
+typedef struct _CODEINFO {
+	//コンパイル用のヒープ
+	struct _MEMHEAP *mh;
+	//参照数
+	volatile LONG ref;
+	//解析済みのスクリプト情報のリスト
+	struct _SCRIPTINFO *sci;
+	//インポートしたスクリプトの実行順 (リストの位置)
+	int *order;
+	int order_cnt;
+} CODEINFO;
+
+//実行準備済みスクリプト (ホストからの繰り返し実行用)
+typedef struct _PREPAREINFO {
+	//実行する解析結果
+	struct _CODEINFO *code;
+	struct _INSTANCEINFO *inst;
+	//トップレベルの実行結果 (グローバル変数) を保持するヒープ
+	struct _MEMHEAP *mh;
+	//実行ごとに巻き戻すヒープ
+	struct _MEMHEAP *run_mh;
+	//実行コンテキスト (準備時にトップレベルを実行済み)
+	struct _SCRIPTINFO *sci;
+	//実行ごとの実行情報、引数、戻り値 (次の実行時に破棄)
+	struct _EXECINFO *ei;
+	struct _VALUEINFO *param;
+	struct _VALUEINFO *ret;
+	//実行の上限
+	LONGLONG step_limit;
+	DWORD timeout;
+} PREPAREINFO;
+
+//プロファイル (行)
+typedef struct _PROFLINE {
+	//行を含むスクリプト (集計のキー) と出力する名前
+	void *src;
+	TCHAR *file;
+	int line;
+	//実行したトークン数
+	LONGLONG count;
+	//経過時間 (呼び出した関数を含む / 含まない)
+	LONGLONG incl;
+	LONGLONG excl;
+	struct _PROFLINE *next;
+} PROFLINE;
+
+//プロファイル (関数)
+typedef struct _PROFFUNC {
+	void *key;
+	TCHAR *name;
+	TCHAR *file;
+	//関数を定義したスクリプト (行の集計のキー)
+	void *src;
+	//呼び出し回数
+	LONGLONG calls;
+	//経過時間 (呼び出した関数を含む / 含まない)
+	LONGLONG incl;
+	LONGLONG excl;
+	//再帰呼び出しの深さ
+	int depth;
+	struct _PROFFUNC *next;
+} PROFFUNC;
+
+//プロファイル (呼び出し経路)
+typedef struct _PROFNODE {
+	struct _PROFFUNC *func;
+	LONGLONG excl;
+	struct _PROFNODE *parent;
+	struct _PROFNODE *child;
+	struct _PROFNODE *sibling;
+} PROFNODE;
+
+//プロファイル (実行中の関数)
+typedef struct _PROFFRAME {
+	struct _PROFFUNC *func;
+	struct _PROFNODE *node;
+	LONGLONG start;
+	LONGLONG child;
+	//実行中の行
+	struct _PROFLINE *line;
+	LONGLONG line_start;
+	LONGLONG line_child;
+} PROFFRAME;
+
+//プロファイル (サンプリング中の関数、サンプリング用のスレッドから参照)
+typedef struct _PROFSTACK {
+	//呼び出し経路と実行中のトークン
+	struct _PROFNODE * volatile node;
+	struct _TOKEN * volatile tk;
+	//呼び出し元と呼び出し先 (呼び出し先は解放せずに再利用する)
+	struct _PROFSTACK *up;
+	struct _PROFSTACK *down;
+} PROFSTACK;
+
+//プロファイル (サンプル)
+typedef struct _PROFSAMPLE {
+	struct _PROFNODE *node;
+	struct _TOKEN *tk;
+	//前回のサンプルからの経過時間
+	LONGLONG ticks;
+} PROFSAMPLE;
+
+//プロファイル
+typedef struct _PROFILEINFO {
+	struct _PROFLINE *line[PROF_HASH_SIZE];
+	struct _PROFFUNC *func[PROF_HASH_SIZE];
+	struct _PROFNODE root;
+	struct _PROFFRAME *frame;
+	int frame_cnt;
+	int frame_size;
+	LONGLONG freq;
+
+	//サンプリング
+	BOOL sampling;
+	//実行中の関数 (サンプリング用のスレッドから参照)
+	struct _PROFSTACK stack;
+	struct _PROFSTACK * volatile cur_frame;
+	int lost_depth;
+	//サンプルのリングバッファ (サンプリング用のスレッドが追加、実行中のスレッドが集計)
+	struct _PROFSAMPLE *ring;
+	LONG ring_size;
+	volatile LONG head;
+	volatile LONG tail;
+	volatile LONG dropped;
+	LONGLONG samples;
+	DWORD interval;
+	HANDLE hThread;
+	HANDLE hStop;
+} PROFILEINFO;
+
+//ブレークポイント (行番号ごとのビット)
+typedef struct _BREAKINFO {
+	int line_cnt;
+	volatile LONG bit[1];
+} BREAKINFO;
+
+//スクリプト情報
 typedef struct _SCRIPTINFO {
-	//t@C
+	//ファイル名
 	TCHAR *name;
 	TCHAR *path;
 	TCHAR *buf;
-
-	//IvV
+	//ソース情報
+	struct _SOURCEINFO *src;
+	//保留中のエラー (並列解析時)
+	BOOL hold_error;
+	TCHAR *hold_err_str;
+	int hold_err_line;
+	//並列解析中に行の途中のプリプロセッサがあった (順番に解析し直す)
+	BOOL prep_deferred;
+
+	//オプション
 	BOOL strict_val_op;
 	BOOL strict_val;
 	BOOL extension;
 
-	//͖
+	//解析木
 	struct _TOKEN *tk;
-	//֐Xg
+	//関数リスト
 	struct _FUNCINFO *fi;
-	//Cu
+	//ライブラリ
 	struct _LIBRARYINFO *lib;
-	//s
+	//実行情報
 	struct _EXECINFO *ei;
-	//R[obN
+	//コールバック
 	LIBFUNC callback;
-	//XNvg̃Xg
+	//コールバックをブレークポイントのみで呼び出す
+	volatile LONG break_only;
+	//ブレークポイント (実行コンテキストごと)
+	struct _BREAKINFO *brk;
+	//スクリプト情報のリスト
 	struct _SCRIPTINFO *sci_top;
 	struct _SCRIPTINFO *next;
+	//モジュールの登録 (sci_topのみ)
+	struct _MODULEINFO *module;
+	struct _MODULEINFO **module_hash;
+	//インスタンス (sci_topのみ)
+	struct _INSTANCEINFO *inst;
+	//共有している解析結果 (実行コンテキストの場合)
+	struct _CODEINFO *code;
+	//コンパイル中の解析結果 (sci_topのみ)
+	struct _CODEINFO *compile;
+	//実行の上限 (sci_topのみ)
+	BOOL limit;
+	BOOL limit_over;
+	LONGLONG step_limit;
+	LONGLONG step;
+	DWORD timeout;
+	ULONGLONG deadline;
+	//プロファイル (sci_topのみ)
+	struct _PROFILEINFO *prof;
 
 	long param1;
 	long param2;
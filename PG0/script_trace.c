@@ -0,0 +1,410 @@
+/*
+ * PG0
+ *
+ * script_trace.c
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <tchar.h>
+
+#include "script.h"
+#include "script_memory.h"
+
+/* Define */
+#define TRACE_NAME_SIZE			48
+#define TRACE_CHUNK_CNT			1024
+#define TRACE_OUT_SIZE			(64 * 1024)
+
+/* Global Variables */
+//トレースのイベント
+typedef struct _TRACEEVENT {
+	TCHAR name[TRACE_NAME_SIZE];
+	LONGLONG ts;
+	//引数のサイズ (-1の場合は無し)
+	LONGLONG arg;
+	char ph;
+	char cat;
+} TRACEEVENT;
+
+//スレッドごとのイベントの塊
+typedef struct _TRACECHUNK {
+	DWORD tid;
+	int cnt;
+	TRACEEVENT *ev;
+	struct _TRACECHUNK *next;
+} TRACECHUNK;
+
+//スレッドごとのバッファ
+typedef struct _TRACEBUF {
+	DWORD tid;
+	int cnt;
+	TRACEEVENT *ev;
+	struct _TRACEBUF *next;
+} TRACEBUF;
+
+//トレースの出力
+typedef struct _TRACEINFO {
+	HANDLE hFile;
+	HANDLE hThread;
+	HANDLE hWrite;
+	BOOL stop;
+	CRITICAL_SECTION cs;
+	//書き込み待ちの塊
+	TRACECHUNK *queue;
+	TRACECHUNK *queue_last;
+	//すべてのスレッドのバッファ
+	TRACEBUF *buf;
+	LONGLONG start;
+	LONGLONG freq;
+	BOOL first;
+	char *out;
+	int out_len;
+} TRACEINFO;
+
+//トレースの有効フラグ
+volatile BOOL trace_enable = FALSE;
+
+static TRACEINFO *trace;
+//バッファの世代 (開始ごとに更新)
+static volatile LONG trace_gen;
+static THREAD_LOCAL TRACEBUF *trace_buf;
+static THREAD_LOCAL LONG trace_buf_gen;
+
+static const char *trace_cat[] = {
+	"read", "parse", "exec", "function", "library",
+};
+
+/* Local Function Prototypes */
+
+/*
+ * trace_alloc - プロセスのヒープから確保
+ */
+static void *trace_alloc(const int size)
+{
+	MEMHEAP *mh;
+	void *mem;
+
+	mh = mem_heap_select(NULL);
+	mem = mem_alloc(size);
+	mem_heap_select(mh);
+	return mem;
+}
+
+/*
+ * out_flush - 出力バッファをファイルに書き込む
+ */
+static void out_flush(TRACEINFO *tr)
+{
+	DWORD ret;
+
+	if (tr->out_len > 0) {
+		WriteFile(tr->hFile, tr->out, tr->out_len, &ret, NULL);
+		tr->out_len = 0;
+	}
+}
+
+/*
+ * out_str - 出力バッファに文字列を追加
+ */
+static void out_str(TRACEINFO *tr, const char *str, int len)
+{
+	if (len < 0) {
+		len = lstrlenA(str);
+	}
+	if (tr->out_len + len > TRACE_OUT_SIZE) {
+		out_flush(tr);
+	}
+	CopyMemory(tr->out + tr->out_len, str, len);
+	tr->out_len += len;
+}
+
+/*
+ * out_json_str - JSONの文字列を出力
+ */
+static void out_json_str(TRACEINFO *tr, const TCHAR *str)
+{
+	char buf[TRACE_NAME_SIZE * 4];
+	char esc[8];
+	char *p;
+#ifdef UNICODE
+	int len;
+
+	len = WideCharToMultiByte(CP_UTF8, 0, str, -1, buf, sizeof(buf), NULL, NULL);
+	if (len <= 0) {
+		*buf = '\0';
+	}
+#else
+
+	lstrcpynA(buf, str, sizeof(buf));
+#endif
+	out_str(tr, "\"", 1);
+	for (p = buf; *p != '\0'; p++) {
+		if (*p == '"' || *p == '\\') {
+			esc[0] = '\\';
+			esc[1] = *p;
+			out_str(tr, esc, 2);
+		} else if ((unsigned char)*p < 0x20) {
+			wsprintfA(esc, "\\u%04x", (unsigned char)*p);
+			out_str(tr, esc, -1);
+		} else {
+			out_str(tr, p, 1);
+		}
+	}
+	out_str(tr, "\"", 1);
+}
+
+/*
+ * out_chunk - イベントの塊を出力
+ */
+static void out_chunk(TRACEINFO *tr, TRACECHUNK *tc)
+{
+	TRACEEVENT *te;
+	char buf[256];
+	LONGLONG c;
+	LONGLONG us;
+	int i;
+
+	for (i = 0; i < tc->cnt; i++) {
+		te = tc->ev + i;
+		out_str(tr, (tr->first == TRUE) ? "\n{\"name\":" : ",\n{\"name\":", -1);
+		tr->first = FALSE;
+		out_json_str(tr, te->name);
+		// マイクロ秒 (小数点以下3桁、周波数が高くても桁あふれしないように分けて計算)
+		c = te->ts - tr->start;
+		us = (tr->freq > 0) ? c / tr->freq * 1000000000 + c % tr->freq * 1000000000 / tr->freq : 0;
+		wsprintfA(buf, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%I64d.%03d,\"pid\":1,\"tid\":%lu",
+			trace_cat[(int)te->cat], te->ph, us / 1000, (int)(us % 1000), tc->tid);
+		out_str(tr, buf, -1);
+		if (te->arg >= 0) {
+			wsprintfA(buf, ",\"args\":{\"size\":%I64d}", te->arg);
+			out_str(tr, buf, -1);
+		}
+		out_str(tr, "}", 1);
+	}
+}
+
+/*
+ * WriteThread - 書き込み待ちのイベントを出力するスレッド
+ */
+static DWORD WINAPI WriteThread(LPVOID param)
+{
+	TRACEINFO *tr = (TRACEINFO *)param;
+	TRACECHUNK *tc, *next;
+	BOOL stop;
+
+	while (1) {
+		WaitForSingleObject(tr->hWrite, INFINITE);
+		EnterCriticalSection(&tr->cs);
+		tc = tr->queue;
+		tr->queue = tr->queue_last = NULL;
+		stop = tr->stop;
+		LeaveCriticalSection(&tr->cs);
+
+		for (; tc != NULL; tc = next) {
+			next = tc->next;
+			out_chunk(tr, tc);
+			mem_free(&tc->ev);
+			mem_free(&tc);
+		}
+		out_flush(tr);
+		if (stop == TRUE) {
+			break;
+		}
+	}
+	return 0;
+}
+
+/*
+ * push_chunk - バッファのイベントを書き込み待ちに追加
+ *
+ *	tr->cs を取得して呼び出す
+ */
+static void push_chunk(TRACEINFO *tr, TRACEBUF *tb)
+{
+	TRACECHUNK *tc;
+
+	if (tb->cnt == 0) {
+		return;
+	}
+	tc = trace_alloc(sizeof(TRACECHUNK));
+	if (tc == NULL) {
+		tb->cnt = 0;
+		return;
+	}
+	tc->tid = tb->tid;
+	tc->cnt = tb->cnt;
+	tc->ev = tb->ev;
+	tc->next = NULL;
+	if (tr->queue_last == NULL) {
+		tr->queue = tc;
+	} else {
+		tr->queue_last->next = tc;
+	}
+	tr->queue_last = tc;
+	tb->ev = NULL;
+	tb->cnt = 0;
+}
+
+/*
+ * get_buf - 現在のスレッドのバッファを取得
+ */
+static TRACEBUF *get_buf(TRACEINFO *tr)
+{
+	TRACEBUF *tb = trace_buf;
+
+	if (tb != NULL && trace_buf_gen == trace_gen) {
+		return tb;
+	}
+	tb = trace_alloc(sizeof(TRACEBUF));
+	if (tb == NULL) {
+		return NULL;
+	}
+	ZeroMemory(tb, sizeof(TRACEBUF));
+	tb->tid = GetCurrentThreadId();
+	EnterCriticalSection(&tr->cs);
+	tb->next = tr->buf;
+	tr->buf = tb;
+	LeaveCriticalSection(&tr->cs);
+	trace_buf = tb;
+	trace_buf_gen = trace_gen;
+	return tb;
+}
+
+/*
+ * TraceEvent - イベントの追加
+ *
+ *	現在のスレッドのバッファに追加し、満杯になったら書き込み待ちに渡す
+ *	通常は TRACE_BEGIN, TRACE_END から呼び出す
+ */
+void TraceEvent(const char ph, TRACE_CAT cat, const TCHAR *name, LONGLONG arg)
+{
+	TRACEINFO *tr = trace;
+	TRACEBUF *tb;
+	TRACEEVENT *te;
+	LARGE_INTEGER c;
+
+	if (tr == NULL || (tb = get_buf(tr)) == NULL) {
+		return;
+	}
+	if (tb->ev == NULL) {
+		tb->ev = trace_alloc(sizeof(TRACEEVENT) * TRACE_CHUNK_CNT);
+		if (tb->ev == NULL) {
+			return;
+		}
+	}
+	te = tb->ev + tb->cnt;
+	QueryPerformanceCounter(&c);
+	te->ts = c.QuadPart;
+	te->ph = ph;
+	te->cat = (char)cat;
+	te->arg = arg;
+	lstrcpyn(te->name, (name != NULL) ? name : TEXT(""), TRACE_NAME_SIZE);
+	if (++tb->cnt >= TRACE_CHUNK_CNT) {
+		EnterCriticalSection(&tr->cs);
+		push_chunk(tr, tb);
+		LeaveCriticalSection(&tr->cs);
+		SetEvent(tr->hWrite);
+	}
+}
+
+/*
+ * StartTrace - トレースの開始
+ *
+ *	path に Chrome のトレース形式 (JSON) で出力する
+ */
+BOOL StartTrace(TCHAR *path)
+{
+	TRACEINFO *tr;
+	LARGE_INTEGER c;
+
+	if (trace != NULL) {
+		return FALSE;
+	}
+	tr = trace_alloc(sizeof(TRACEINFO));
+	if (tr == NULL) {
+		return FALSE;
+	}
+	ZeroMemory(tr, sizeof(TRACEINFO));
+	tr->out = trace_alloc(TRACE_OUT_SIZE);
+	if (tr->out == NULL) {
+		mem_free(&tr);
+		return FALSE;
+	}
+	tr->hFile = CreateFile(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (tr->hFile == INVALID_HANDLE_VALUE) {
+		mem_free(&tr->out);
+		mem_free(&tr);
+		return FALSE;
+	}
+	InitializeCriticalSection(&tr->cs);
+	tr->hWrite = CreateEvent(NULL, FALSE, FALSE, NULL);
+	tr->first = TRUE;
+	QueryPerformanceFrequency(&c);
+	tr->freq = c.QuadPart;
+	QueryPerformanceCounter(&c);
+	tr->start = c.QuadPart;
+	out_str(tr, "{\"traceEvents\":[", -1);
+	tr->hThread = CreateThread(NULL, 0, WriteThread, tr, 0, NULL);
+	if (tr->hWrite == NULL || tr->hThread == NULL) {
+		if (tr->hWrite != NULL) {
+			CloseHandle(tr->hWrite);
+		}
+		DeleteCriticalSection(&tr->cs);
+		CloseHandle(tr->hFile);
+		mem_free(&tr->out);
+		mem_free(&tr);
+		return FALSE;
+	}
+	InterlockedIncrement(&trace_gen);
+	trace = tr;
+	trace_enable = TRUE;
+	return TRUE;
+}
+
+/*
+ * StopTrace - トレースの終了
+ *
+ *	すべてのスレッドの残りのイベントを出力してファイルを閉じる
+ *	スクリプトを実行しているスレッドが終了してから呼び出す
+ */
+void StopTrace(void)
+{
+	TRACEINFO *tr = trace;
+	TRACEBUF *tb, *next;
+
+	if (tr == NULL) {
+		return;
+	}
+	trace_enable = FALSE;
+	trace = NULL;
+
+	EnterCriticalSection(&tr->cs);
+	for (tb = tr->buf; tb != NULL; tb = tb->next) {
+		push_chunk(tr, tb);
+	}
+	tr->stop = TRUE;
+	LeaveCriticalSection(&tr->cs);
+	SetEvent(tr->hWrite);
+	WaitForSingleObject(tr->hThread, INFINITE);
+	CloseHandle(tr->hThread);
+	CloseHandle(tr->hWrite);
+	DeleteCriticalSection(&tr->cs);
+
+	out_str(tr, "\n]}\n", -1);
+	out_flush(tr);
+	CloseHandle(tr->hFile);
+
+	for (tb = tr->buf; tb != NULL; tb = next) {
+		next = tb->next;
+		mem_free(&tb->ev);
+		mem_free(&tb);
+	}
+	mem_free(&tr->out);
+	mem_free(&tr);
+}
+/* End of source */
@@ -19,11 +19,69 @@
 /* Define */
 
 /* Global Variables */
+//現在のスレッドで集計する統計 (NULLの場合は集計しない)
+THREAD_LOCAL STATINFO *cur_stat = NULL;
+//現在のスレッドの値の更新カウンタ
+THREAD_LOCAL unsigned int mod_count = 0;
+
+//サイズ制限付きの出力先
+typedef struct _LIMIT_WRITE {
+	TCHAR *p;
+	TCHAR *end;
+} LIMIT_WRITE;
 
 /* Local Function Prototypes */
+static BOOL CopyValueData(VALUEINFO *To, VALUEINFO *From);
+
+/*
+ * SelectStat - 現在のスレッドで集計する統計を設定
+ *
+ *	以前の統計を返す
+ */
+STATINFO *SelectStat(STATINFO *stat)
+{
+	STATINFO *prev = cur_stat;
+
+	cur_stat = stat;
+	return prev;
+}
 
 /*
- * AllocValue - ϐ̊m
+ * StatString - 文字列のコピーを統計に加算
+ */
+void StatString(const TCHAR *str)
+{
+	if (cur_stat == NULL || str == NULL) {
+		return;
+	}
+	cur_stat->alloc[STAT_OBJ_STRING]++;
+	cur_stat->copy_bytes += sizeof(TCHAR) * (lstrlen(str) + 1);
+}
+
+/*
+ * StatValueList - 変数リストに含まれる文字列を統計に加算
+ *
+ *	ライブラリ関数など統計の外で作成した値を受け取った時に使用する
+ */
+void StatValueList(VALUEINFO *vi)
+{
+	if (cur_stat == NULL) {
+		return;
+	}
+	for (; vi != NULL && vi != (VALUEINFO *)RET_ERROR; vi = vi->next) {
+		if (vi->v == NULL || vi->v->vi != vi) {
+			continue;
+		}
+		if (vi->v->type == TYPE_ARRAY) {
+			StatValueList(vi->v->u.array);
+		} else if (vi->v->type == TYPE_STRING && vi->v->u.sValue != NULL) {
+			cur_stat->alloc[STAT_OBJ_STRING]++;
+		}
+	}
+}
+
+/*
+ * AllocValue - 変数の確保
  */
 VALUEINFO *AllocValue()
 {
@@ -39,11 +97,13 @@ VALUEINFO *AllocValue()
 		return NULL;
 	}
 	vi->v->vi = vi;
+	VALUE_MODIFIED(vi->v);
+	STAT_ADD(alloc[STAT_OBJ_VALUE], 1);
 	return vi;
 }
 
 /*
- * FreeValue - ϐ̉
+ * FreeValue - 変数の解放
  */
 void FreeValue(VALUEINFO *vi)
 {
@@ -55,16 +115,18 @@ void FreeValue(VALUEINFO *vi)
 	if (vi->v != NULL && vi->v->vi == vi) {
 		if (vi->v->type == TYPE_ARRAY) {
 			FreeValueList(vi->v->u.array);
-		} else if (vi->v->type == TYPE_STRING) {
+		} else if (vi->v->type == TYPE_STRING && vi->v->u.sValue != NULL) {
 			mem_free(&(vi->v->u.sValue));
+			STAT_ADD(free[STAT_OBJ_STRING], 1);
 		}
 		mem_free(&(vi->v));
 	}
 	mem_free(&vi);
+	STAT_ADD(free[STAT_OBJ_VALUE], 1);
 }
 
 /*
- * FreeValueList - ϐXg̉
+ * FreeValueList - 変数リストの解放
  */
 void FreeValueList(VALUEINFO *vi)
 {
@@ -81,7 +143,61 @@ void FreeValueList(VALUEINFO *vi)
 }
 
 /*
- * CopyValueList - ϐXg̃Rs[
+ * CopyValueData - 変数の名前と値のコピー
+ *
+ *	メモリの確保に失敗した場合は FALSE を返す (To は解放できる状態)
+ */
+static BOOL CopyValueData(VALUEINFO *To, VALUEINFO *From)
+{
+	VALUEINFO *array;
+
+	if (From->name != NULL) {
+		To->name = alloc_copy(From->name);
+		if (To->name == NULL) {
+			return FALSE;
+		}
+		To->name_hash = From->name_hash;
+	}
+#ifndef PG0_CMD
+	if (From->org_name != NULL) {
+		To->org_name = alloc_copy(From->org_name);
+		if (To->org_name == NULL) {
+			return FALSE;
+		}
+	}
+#endif
+	switch (From->v->type) {
+	case TYPE_ARRAY:
+		array = CopyValueList(From->v->u.array);
+		if (array == (VALUEINFO *)RET_ERROR) {
+			return FALSE;
+		}
+		To->v->u.array = array;
+		break;
+	case TYPE_STRING:
+		if (From->v->u.sValue != NULL) {
+			To->v->u.sValue = alloc_copy(From->v->u.sValue);
+			if (To->v->u.sValue == NULL) {
+				return FALSE;
+			}
+			StatString(From->v->u.sValue);
+		}
+		break;
+	case TYPE_FLOAT:
+		To->v->u.fValue = From->v->u.fValue;
+		break;
+	default:
+		To->v->u.iValue = From->v->u.iValue;
+		break;
+	}
+	To->v->type = From->v->type;
+	return TRUE;
+}
+
+/*
+ * CopyValueList - 変数リストのコピー
+ *
+ *	メモリの確保に失敗した場合はコピーした分を解放して RET_ERROR を返す
  */
 VALUEINFO *CopyValueList(VALUEINFO *From)
 {
@@ -89,80 +205,67 @@ VALUEINFO *CopyValueList(VALUEINFO *From)
 
 	To = &Top;
 	To->next = NULL;
+	STAT_ADD(copy_list, 1);
 	for (; From != NULL; From = From->next) {
 		if (From->v == NULL) {
 			continue;
 		}
+		STAT_ADD(copy_elem, 1);
 		To = To->next = AllocValue();
-		if (To == NULL) {
-			return Top.next;
-		}
-		if (From->name != NULL) {
-			To->name = alloc_copy(From->name);
-			To->name_hash = From->name_hash;
-		}
-#ifndef PG0_CMD
-		if (From->org_name != NULL) {
-			To->org_name = alloc_copy(From->org_name);
+		if (To == NULL || CopyValueData(To, From) == FALSE) {
+			FreeValueList(Top.next);
+			return (VALUEINFO *)RET_ERROR;
 		}
-#endif
-		switch (From->v->type) {
-		case TYPE_ARRAY:
-			To->v->u.array = CopyValueList(From->v->u.array);
-			break;
-		case TYPE_STRING:
-			To->v->u.sValue = alloc_copy(From->v->u.sValue);
-			break;
-		case TYPE_FLOAT:
-			To->v->u.fValue = From->v->u.fValue;
-			break;
-		default:
-			To->v->u.iValue = From->v->u.iValue;
-			break;
-		}
-		To->v->type = From->v->type;
 	}
 	return Top.next;
 }
 
 /*
- * CopyValue - ϐ̃Rs[
+ * CountValueList - 変数リストの要素数
+ */
+int CountValueList(VALUEINFO *vi)
+{
+	int cnt = 0;
+
+	for (; vi != NULL; vi = vi->next) {
+		cnt++;
+	}
+	return cnt;
+}
+
+/*
+ * CopyValue - 変数のコピー
+ *
+ *	メモリの確保に失敗した場合は NULL を返す
  */
 VALUEINFO *CopyValue(VALUEINFO *From)
 {
 	VALUEINFO *To;
 
 	To = AllocValue();
-	To->next = NULL;
-	if (From->name != NULL) {
-		To->name = alloc_copy(From->name);
-		To->name_hash = From->name_hash;
-	}
-#ifndef PG0_CMD
-	if (From->org_name != NULL) {
-		To->org_name = alloc_copy(From->org_name);
+	if (To == NULL) {
+		return NULL;
 	}
-#endif
-	switch (From->v->type) {
-	case TYPE_ARRAY:
-		To->v->u.array = CopyValueList(From->v->u.array);
-		break;
-	case TYPE_STRING:
-		To->v->u.sValue = alloc_copy(From->v->u.sValue);
-		break;
-	case TYPE_FLOAT:
-		To->v->u.fValue = From->v->u.fValue;
-		break;
-	default:
-		To->v->u.iValue = From->v->u.iValue;
-		break;
+	To->next = NULL;
+	if (CopyValueData(To, From) == FALSE) {
+		FreeValue(To);
+		return NULL;
 	}
-	To->v->type = From->v->type;
 	return To;
 }
 
 /*
- * GetValueInt - ̎擾
+ * GetValueModCount - 値の更新カウンタを取得
+ *
+ *	配列の要素の更新は VALUE_MODIFIED で配列にも設定されるため要素は走査しない
+ */
+unsigned int GetValueModCount(VALUE *v)
+{
+	return v->mod;
+}
+
+/*
+ * GetValueInt - 整数の取得
  */
 int GetValueInt(VALUE *v)
 {
@@ -176,7 +279,7 @@ int GetValueInt(VALUE *v)
 }
 
 /*
- * GetValueString - ̎擾
+ * GetValueString - 文字列の取得
  */
 TCHAR *GetValueString(VALUE *v)
 {
@@ -200,7 +303,7 @@ TCHAR *GetValueString(VALUE *v)
 }
 
 /*
- * GetValueFloat - ̎擾
+ * GetValueFloat - 実数の取得
  */
 double GetValueFloat(VALUE *v)
 {
@@ -214,8 +317,8 @@ double GetValueFloat(VALUE *v)
 }
 
 /*
- * GetValueBoolean - ^U̎擾
- * 0, 0.0, ""UƂ
+ * GetValueBoolean - 真偽の取得
+ * 0, 0.0, ""を偽とする
  */
 BOOL GetValueBoolean(VALUE *v)
 {
@@ -240,7 +343,7 @@ BOOL GetValueBoolean(VALUE *v)
 }
 
 /*
- * IntToVariable - lϐɕϊ
+ * IntToVariable - 数値を変数に変換
  */
 VALUEINFO *IntToVariable(TCHAR *name, const int i)
 {
@@ -262,7 +365,7 @@ VALUEINFO *IntToVariable(TCHAR *name, const int i)
 }
 
 /*
- * VariableToInt - ϐ𐔒lɕϊ
+ * VariableToInt - 変数を数値に変換
  */
 int VariableToInt(VALUEINFO *vi)
 {
@@ -273,7 +376,7 @@ int VariableToInt(VALUEINFO *vi)
 }
 
 /*
- * StringToVariable - ϐɕϊ
+ * StringToVariable - 文字列を変数に変換
  */
 VALUEINFO *StringToVariable(TCHAR *name, const TCHAR *buf)
 {
@@ -291,11 +394,12 @@ VALUEINFO *StringToVariable(TCHAR *name, const TCHAR *buf)
 	vi->org_name = alloc_copy(name);
 	vi->v->u.sValue = alloc_copy(buf);
 	vi->v->type = TYPE_STRING;
+	StatString(vi->v->u.sValue);
 	return vi;
 }
 
 /*
- * VariableToString - ϐ𕶎ɕϊ
+ * VariableToString - 変数を文字列に変換
  */
 TCHAR *VariableToString(VALUEINFO *vi)
 {
@@ -306,99 +410,161 @@ TCHAR *VariableToString(VALUEINFO *vi)
 }
 
 /*
- * _ArrayToStringSize - z̏o̓TCY擾
+ * _WriteArray - 配列の要素を文字列にして出力
  */
-int _ArrayToStringSize(VALUEINFO *vi, BOOL hex_mode)
+static BOOL _WriteArray(VALUEINFO *vi, BOOL hex_mode, WRITE_FUNC func, void *param)
 {
-	TCHAR buf[BUF_SIZE];
+	TCHAR buf[FLOAT_LENGTH];
+	TCHAR *name;
+	TCHAR *tmp;
 	BOOL first = TRUE;
-	int ret = 0;
-	for(; vi != NULL; vi = vi->next){
-		if (first != TRUE) {
-			ret++;
+	BOOL ret;
+
+	for (; vi != NULL; vi = vi->next) {
+		if (first != TRUE && func(param, TEXT(","), 1) == FALSE) {
+			return FALSE;
 		}
 		first = FALSE;
-		if (vi->org_name != NULL) {
-			ret += lstrlen(vi->org_name) + 3;
-		} else if (vi->name != NULL) {
-			ret += lstrlen(vi->name) + 3;
+
+		name = (vi->org_name != NULL) ? vi->org_name : vi->name;
+		if (name != NULL) {
+			if (func(param, TEXT("\""), 1) == FALSE ||
+				func(param, name, lstrlen(name)) == FALSE ||
+				func(param, TEXT("\":"), 2) == FALSE) {
+				return FALSE;
+			}
 		}
 		if (vi->v->type == TYPE_ARRAY) {
-			ret += _ArrayToStringSize(vi->v->u.array, hex_mode) + 2;
+			if (func(param, TEXT("{"), 1) == FALSE ||
+				_WriteArray(vi->v->u.array, hex_mode, func, param) == FALSE ||
+				func(param, TEXT("}"), 1) == FALSE) {
+				return FALSE;
+			}
 		} else if (vi->v->type == TYPE_STRING) {
-			TCHAR *tmp = reconv_ctrl(vi->v->u.sValue);
-			ret += lstrlen(tmp) + 2;
-			mem_free(&tmp);
+			if (func(param, TEXT("\""), 1) == FALSE) {
+				return FALSE;
+			}
+			tmp = reconv_ctrl(vi->v->u.sValue);
+			if (tmp != NULL) {
+				ret = func(param, tmp, lstrlen(tmp));
+				mem_free(&tmp);
+				if (ret == FALSE) {
+					return FALSE;
+				}
+			}
+			if (func(param, TEXT("\""), 1) == FALSE) {
+				return FALSE;
+			}
 		} else if (vi->v->type == TYPE_FLOAT) {
-			TCHAR tmp[FLOAT_LENGTH];
-			swprintf_s(tmp, FLOAT_LENGTH, TEXT("%.16f"), vi->v->u.fValue);
-			ret += lstrlen(tmp);
+			_stprintf_s(buf, FLOAT_LENGTH, TEXT("%.16f"), vi->v->u.fValue);
+			if (func(param, buf, lstrlen(buf)) == FALSE) {
+				return FALSE;
+			}
 		} else {
 			if (hex_mode == FALSE) {
 				wsprintf(buf, TEXT("%ld"), vi->v->u.iValue);
 			} else {
 				wsprintf(buf, TEXT("0x%X"), vi->v->u.iValue);
 			}
-			ret += lstrlen(buf);
+			if (func(param, buf, lstrlen(buf)) == FALSE) {
+				return FALSE;
+			}
 		}
 	}
-	return ret;
+	return TRUE;
 }
-int ArrayToStringSize(VALUEINFO *vi, BOOL hex_mode)
+
+/*
+ * WriteArray - 配列を文字列にして出力
+ *
+ *	文字列を作成せずに、区切りごとに func に渡す
+ *	func が FALSE を返した場合は中断して FALSE を返す
+ */
+BOOL WriteArray(VALUEINFO *vi, BOOL hex_mode, WRITE_FUNC func, void *param)
 {
-	return _ArrayToStringSize(vi, hex_mode) + 2;
+	return (func(param, TEXT("{"), 1) == TRUE &&
+		_WriteArray(vi, hex_mode, func, param) == TRUE &&
+		func(param, TEXT("}"), 1) == TRUE) ? TRUE : FALSE;
 }
 
 /*
- * _ArrayToString - z̏o
+ * count_write - 出力サイズの加算
  */
-static void _ArrayToString(VALUEINFO *vi, TCHAR *buf, BOOL hex_mode)
+static BOOL count_write(void *param, const TCHAR *str, int len)
 {
-	TCHAR tmp[BUF_SIZE];
-	BOOL first = TRUE;
-	for(; vi != NULL; vi = vi->next){
-		if (first != TRUE) {
-			lstrcat(buf, TEXT(","));
-		}
-		first = FALSE;
+	*((int *)param) += len;
+	return TRUE;
+}
 
-		if (vi->org_name != NULL) {
-			lstrcat(buf, TEXT("\""));
-			lstrcat(buf, vi->org_name);
-			lstrcat(buf, TEXT("\":"));
-		} else if (vi->name != NULL) {
-			lstrcat(buf, TEXT("\""));
-			lstrcat(buf, vi->name);
-			lstrcat(buf, TEXT("\":"));
-		}
-		if (vi->v->type == TYPE_ARRAY) {
-			lstrcat(buf, TEXT("{"));
-			_ArrayToString(vi->v->u.array, buf, hex_mode);
-			lstrcat(buf, TEXT("}"));
-		} else if (vi->v->type == TYPE_STRING) {
-			TCHAR *tmp = reconv_ctrl(vi->v->u.sValue);
-			lstrcat(buf, TEXT("\""));
-			lstrcat(buf, tmp);
-			lstrcat(buf, TEXT("\""));
-			mem_free(&tmp);
-		} else if (vi->v->type == TYPE_FLOAT) {
-			TCHAR ftmp[FLOAT_LENGTH];
-			_stprintf_s(ftmp, FLOAT_LENGTH, TEXT("%.16f"), vi->v->u.fValue);
-			lstrcat(buf, ftmp);
-		} else {
-			if (hex_mode == FALSE) {
-				wsprintf(tmp, TEXT("%ld"), vi->v->u.iValue);
-			} else {
-				wsprintf(tmp, TEXT("0x%X"), vi->v->u.iValue);
-			}
-			lstrcat(buf, tmp);
-		}
+/*
+ * copy_write - バッファにコピー
+ */
+static BOOL copy_write(void *param, const TCHAR *str, int len)
+{
+	TCHAR **p = (TCHAR **)param;
+
+	CopyMemory(*p, str, sizeof(TCHAR) * len);
+	*p += len;
+	return TRUE;
+}
+
+/*
+ * limit_write - バッファの残りの分だけコピー
+ */
+static BOOL limit_write(void *param, const TCHAR *str, int len)
+{
+	LIMIT_WRITE *lw = (LIMIT_WRITE *)param;
+
+	if (len > lw->end - lw->p) {
+		len = (int)(lw->end - lw->p);
+		CopyMemory(lw->p, str, sizeof(TCHAR) * len);
+		lw->p += len;
+		return FALSE;
 	}
+	CopyMemory(lw->p, str, sizeof(TCHAR) * len);
+	lw->p += len;
+	return TRUE;
 }
+
+/*
+ * ArrayToStringSize - 配列の出力サイズ取得
+ */
+int ArrayToStringSize(VALUEINFO *vi, BOOL hex_mode)
+{
+	int ret = 0;
+
+	WriteArray(vi, hex_mode, count_write, &ret);
+	return ret;
+}
+
+/*
+ * ArrayToString - 配列の出力
+ *
+ *	buf には ArrayToStringSize + 1 文字分の領域が必要
+ */
 void ArrayToString(VALUEINFO *vi, TCHAR *buf, BOOL hex_mode)
 {
-	lstrcpy(buf, TEXT("{"));
-	_ArrayToString(vi, buf, hex_mode);
-	lstrcat(buf, TEXT("}"));
+	TCHAR *p = buf;
+
+	WriteArray(vi, hex_mode, copy_write, &p);
+	*p = TEXT('\0');
+}
+
+/*
+ * ArrayToStringLimit - 配列を size 文字まで出力
+ *
+ *	buf には size + 1 文字分の領域が必要
+ *	size を超える場合は残りの要素を走査せずに FALSE を返す
+ */
+BOOL ArrayToStringLimit(VALUEINFO *vi, TCHAR *buf, const int size, BOOL hex_mode)
+{
+	LIMIT_WRITE lw;
+	BOOL ret;
+
+	lw.p = buf;
+	lw.end = buf + size;
+	ret = WriteArray(vi, hex_mode, limit_write, &lw);
+	*lw.p = TEXT('\0');
+	return ret;
 }
 /* End of source */
@@ -18,14 +18,22 @@
 /* Define */
 
 /* Struct */
+//文字列の出力先 (FALSE を返すと出力を中断する)
+typedef BOOL (*WRITE_FUNC)(void *param, const TCHAR *str, int len);
 
 /* Function Prototypes */
+STATINFO *SelectStat(STATINFO *stat);
+void StatString(const TCHAR *str);
+void StatValueList(VALUEINFO *vi);
+
 VALUEINFO *AllocValue();
 void FreeValue(VALUEINFO *vi);
 void FreeValueList(VALUEINFO *vi);
 
 VALUEINFO *CopyValueList(VALUEINFO *From);
 VALUEINFO *CopyValue(VALUEINFO *From);
+int CountValueList(VALUEINFO *vi);
+unsigned int GetValueModCount(VALUE *v);
 
 int GetValueInt(VALUE *v);
 TCHAR *GetValueString(VALUE *v);
@@ -39,6 +47,8 @@ TCHAR *VariableToString(VALUEINFO *vi);
 
 int ArrayToStringSize(VALUEINFO *vi, BOOL hex_mode);
 void ArrayToString(VALUEINFO *vi, TCHAR *buf, BOOL hex_mode);
+BOOL ArrayToStringLimit(VALUEINFO *vi, TCHAR *buf, const int size, BOOL hex_mode);
+BOOL WriteArray(VALUEINFO *vi, BOOL hex_mode, WRITE_FUNC func, void *param);
 
 #endif
 /* End of source */
@@ -32,7 +32,7 @@ static TBBUTTON tbb[] = {
 /* Local Function Prototypes */
 
 /*
- * toolbar_create - StatusBar̍쐬
+ * toolbar_create - StatusBarの作成
  */
 HWND toolbar_create(const HINSTANCE hInst, const HWND hWnd, const int id)
 {
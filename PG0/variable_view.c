@@ -23,18 +23,21 @@
 #include "frame.h"
 
 /* Define */
-/* zC[bZ[W */
+/* ホイールメッセージ */
 #ifndef WM_MOUSEWHEEL
 #define WM_MOUSEWHEEL			0x020A
 #endif
-// XPe[}ύXʒm
+// XPテーマ変更通知
 #ifndef WM_THEMECHANGED
 #define WM_THEMECHANGED			0x031A
 #endif
 
-// ^C}[ID
+// タイマーID
 #define TIMER_SEP				1
 
+// 配列を開いた時に一度に作成する要素数
+#define VIEW_PAGE_SIZE			256
+
 /* Global Variables */
 VALUE_VIEW_INFO *vi_list;
 int vi_list_count;
@@ -46,30 +49,38 @@ BOOL hex_mode;
 static HFONT CreateViewFont(const HDC hdc, const VARIABLE_BUFFER *bf);
 static void SetScrollBar(HWND hWnd, VARIABLE_BUFFER *bf);
 static BOOL Variable2Clipboard(const HWND hWnd, const VALUE_VIEW_INFO *vvi);
-static int getNameMaxWidth(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int count);
-static int getDrawMaxWidth(HDC mdc, VARIABLE_BUFFER *bf);
+static int getVisibleLast(HWND hWnd, VARIABLE_BUFFER *bf);
+static int getNameMaxWidth(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf);
+static int getDrawMaxWidth(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf);
 static RECT getTreeIconRect(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi);
 static void DrawHeader(HDC mdc, VARIABLE_BUFFER *bf);
 static void DrawSeparator(HDC mdc, VARIABLE_BUFFER *bf, int height);
 static void DrawTreeIcon(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int top);
 static BOOL DrawLine(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int count, int index);
 static void initValueList(VALUE_VIEW_INFO *vvi, int vvi_count);
-static int findValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int vvi_count);
+static int findValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int vvi_count, int hint);
 static void deselectValueList(VALUE_VIEW_INFO *vvi, int vvi_count);
 static void trimValueList(VALUE_VIEW_INFO *vvi, int *count);
+static void validValueList(VALUE_VIEW_INFO *vvi, int vvi_count);
+static void resetValueList(VALUE_VIEW_INFO *vvi, int vvi_count);
 static int getValueCount(VALUEINFO *vi);
-static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count);
-static void listValueinfo(EXECINFO *ei);
+static void freeChildValueList(VALUE_VIEW_INFO *vvi);
+static void setChildValueList(VALUE_VIEW_INFO *vvi, VALUEINFO *vi, const BOOL all);
+static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count, const int limit, const BOOL all);
+static void listValueinfo(EXECINFO *ei, const BOOL all);
 static void freeValueinfo(VALUE_VIEW_INFO *vvi, int count);
 static void setValueIndex(VALUE_VIEW_INFO *vvi, int count, int *index, int indent);
 static int getValueDrawCount(VALUE_VIEW_INFO *vvi, int count);
 static VALUE_VIEW_INFO *indexToValueViewInfo(VALUE_VIEW_INFO *vvi, int count, int index);
 static VALUE_VIEW_INFO *getSelectValueViewInfo(VALUE_VIEW_INFO *vvi, int count);
+static VALUE_VIEW_INFO *getParentValueViewInfo(VALUE_VIEW_INFO *vvi, int count, VALUE_VIEW_INFO *target);
 static void ShowSelectValueViewInfo(HWND hWnd, VARIABLE_BUFFER *bf);
+static void RequestValueViewInfo(HWND hWnd, VALUE_VIEW_INFO *vvi);
+static void ToggleValueViewInfo(HWND hWnd, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi);
 static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 /*
- * CreateViewFont - tHg쐬
+ * CreateViewFont - フォントを作成する
  */
 static HFONT CreateViewFont(const HDC hdc, const VARIABLE_BUFFER *bf)
 {
@@ -77,7 +88,7 @@ static HFONT CreateViewFont(const HDC hdc, const VARIABLE_BUFFER *bf)
 }
 
 /*
- * SetScrollBar - XN[o[̐ݒ
+ * SetScrollBar - スクロールバーの設定
  */
 static void SetScrollBar(HWND hWnd, VARIABLE_BUFFER *bf)
 {
@@ -86,7 +97,7 @@ static void SetScrollBar(HWND hWnd, VARIABLE_BUFFER *bf)
 
 	GetClientRect(hWnd, &rect);
 
-	// XN[o[
+	// 横スクロールバー
 	if (rect.right < bf->draw_width) {
 		EnableScrollBar(hWnd, SB_HORZ, ESB_ENABLE_BOTH);
 
@@ -112,7 +123,7 @@ static void SetScrollBar(HWND hWnd, VARIABLE_BUFFER *bf)
 		SetScrollInfo(hWnd, SB_HORZ, &si, TRUE);
 	}
 
-	// cXN[o[
+	// 縦スクロールバー
 	if(((rect.bottom - bf->header_height) / bf->FontHeight) < bf->view_line){
 		EnableScrollBar(hWnd, SB_VERT, ESB_ENABLE_BOTH);
 
@@ -140,14 +151,14 @@ static void SetScrollBar(HWND hWnd, VARIABLE_BUFFER *bf)
 }
 
 /*
- * Variable2Clipboard - ϐƒlNbv{[hɐݒ
+ * Variable2Clipboard - 変数名と値をクリップボードに設定
  */
 static BOOL Variable2Clipboard(const HWND hWnd, const VALUE_VIEW_INFO *vvi)
 {
 	HANDLE hMem;
 	TCHAR *buf;
 
-	//Nbv{[hJ
+	//クリップボードを開く
 	if(OpenClipboard(hWnd) == FALSE){
 		return FALSE;
 	}
@@ -176,7 +187,7 @@ static BOOL Variable2Clipboard(const HWND hWnd, const VALUE_VIEW_INFO *vvi)
 }
 
 /*
- * createVariableName - Cfgt̕ϐ쐬
+ * createVariableName - インデント付の変数名を作成
  */
 static TCHAR *createVariableName(VALUE_VIEW_INFO *vvi)
 {
@@ -190,18 +201,47 @@ static TCHAR *createVariableName(VALUE_VIEW_INFO *vvi)
 }
 
 /*
- * getNameMaxWidth - ϐ̕`撷擾
+ * getVisibleLast - 表示範囲の次の行を取得
  */
-static int _getNameMaxWidth(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int count)
+static int getVisibleLast(HWND hWnd, VARIABLE_BUFFER *bf)
 {
+	RECT rect;
+	int last;
+
+	if (bf->FontHeight <= 0) {
+		return bf->pos_y;
+	}
+	GetClientRect(hWnd, &rect);
+	last = bf->pos_y + (rect.bottom - bf->header_height) / bf->FontHeight + 1;
+	if (last > bf->view_line) {
+		last = bf->view_line;
+	}
+	return last;
+}
+
+/*
+ * getNameMaxWidth - 変数名の描画長さ取得 (表示範囲の行のみ)
+ */
+static int getNameMaxWidth(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf)
+{
+	VALUE_VIEW_INFO *vvi;
+	HFONT hFont;
+	HFONT hRetFont;
 	TCHAR *p;
 	SIZE sz;
 	int lineWidth;
+	int last;
 	int i;
 	int ret = 0;
 
-	for (i = 0; i < count; i++) {
-		p = createVariableName(vvi + i);
+	hFont = CreateViewFont(mdc, bf);
+	hRetFont = SelectObject(mdc, hFont);
+	last = getVisibleLast(hWnd, bf);
+	for (i = bf->pos_y; i < last; i++) {
+		if ((vvi = indexToValueViewInfo(vi_list, vi_list_count, i)) == NULL) {
+			continue;
+		}
+		p = createVariableName(vvi);
 		GetTextExtentPoint32(mdc, p, lstrlen(p), &sz);
 		mem_free(&p);
 
@@ -209,70 +249,46 @@ static int _getNameMaxWidth(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi,
 		if (ret < lineWidth) {
 			ret = lineWidth;
 		}
-		if (vvi[i].child != NULL && vvi[i].open == TRUE) {
-			lineWidth = _getNameMaxWidth(mdc, bf, vvi[i].child, vvi[i].child_count);
-			if (ret < lineWidth) {
-				ret = lineWidth;
-			}
-		}
 	}
-	return ret;
-}
-static int getNameMaxWidth(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int count)
-{
-	HFONT hFont;
-	HFONT hRetFont;
-	int ret;
-
-	hFont = CreateViewFont(mdc, bf);
-	hRetFont = SelectObject(mdc, hFont);
-	ret = _getNameMaxWidth(mdc, bf, vvi, count);
 	hFont = SelectObject(mdc, hRetFont);
 	DeleteObject(hFont);
 	return ret;
 }
 
 /*
- * getDrawMaxWidth - 1s̕`撷擾
+ * getDrawMaxWidth - 1行の描画長さ取得 (表示範囲の行のみ)
  */
-static int _getDrawMaxWidth(HDC mdc, VARIABLE_BUFFER* bf, VALUE_VIEW_INFO* vvi, int count)
+static int getDrawMaxWidth(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf)
 {
+	VALUE_VIEW_INFO *vvi;
+	HFONT hFont;
+	HFONT hRetFont;
 	SIZE sz;
 	int lineWidth;
+	int last;
 	int i;
 	int ret = 0;
 
-	for (i = 0; i < count; i++) {
-		GetTextExtentPoint32(mdc, vvi[i].buf, lstrlen(vvi[i].buf), &sz);
+	hFont = CreateViewFont(mdc, bf);
+	hRetFont = SelectObject(mdc, hFont);
+	last = getVisibleLast(hWnd, bf);
+	for (i = bf->pos_y; i < last; i++) {
+		if ((vvi = indexToValueViewInfo(vi_list, vi_list_count, i)) == NULL) {
+			continue;
+		}
+		GetTextExtentPoint32(mdc, vvi->buf, lstrlen(vvi->buf), &sz);
 		lineWidth = bf->sep_size + bf->CharWidth + sz.cx + bf->RightMargin;
 		if (ret < lineWidth) {
 			ret = lineWidth;
 		}
-		if (vvi[i].child != NULL && vvi[i].open == TRUE) {
-			lineWidth = _getDrawMaxWidth(mdc, bf, vvi[i].child, vvi[i].child_count);
-			if (ret < lineWidth) {
-				ret = lineWidth;
-			}
-		}
 	}
-	return ret;
-}
-static int getDrawMaxWidth(HDC mdc, VARIABLE_BUFFER *bf)
-{
-	HFONT hFont;
-	HFONT hRetFont;
-	int ret;
-
-	hFont = CreateViewFont(mdc, bf);
-	hRetFont = SelectObject(mdc, hFont);
-	ret = _getDrawMaxWidth(mdc, bf, vi_list, vi_list_count);
 	hFont = SelectObject(mdc, hRetFont);
 	DeleteObject(hFont);
 	return ret;
 }
 
 /*
- * getTreeIconRect - c[JACR̈ʒu擾
+ * getTreeIconRect - ツリー開閉アイコンの位置を取得
  */
 static RECT getTreeIconRect(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi)
 {
@@ -306,7 +322,7 @@ static RECT getTreeIconRect(HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi)
 }
 
 /*
- * DrawHeader - wb_[`
+ * DrawHeader - ヘッダー描画
  */
 static void DrawHeader(HDC mdc, VARIABLE_BUFFER *bf)
 {
@@ -335,7 +351,7 @@ static void DrawHeader(HDC mdc, VARIABLE_BUFFER *bf)
 }
 
 /*
- * DrawSeparator - E̕`
+ * DrawSeparator - 境界線の描画
  */
 static void DrawSeparator(HDC mdc, VARIABLE_BUFFER *bf, int height)
 {
@@ -353,7 +369,7 @@ static void DrawSeparator(HDC mdc, VARIABLE_BUFFER *bf, int height)
 }
 
 /*
- * DrawTreeIcon - c[JACR̕`
+ * DrawTreeIcon - ツリー開閉アイコンの描画
  */
 static void DrawTreeIcon(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int top)
 {
@@ -401,7 +417,7 @@ static void DrawTreeIcon(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INF
 }
 
 /*
- * _DrawLine - 1s`
+ * _DrawLine - 1行描画
  */
 static void _DrawLine(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int i)
 {
@@ -426,7 +442,7 @@ static void _DrawLine(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *
 		FillRect(mdc, &trect, hBrush);
 		DeleteObject(hBrush);
 	}
-	// ϐ
+	// 変数名
 	p = createVariableName(vvi);
 
 	offset = bf->LeftMargin - (bf->pos_x * bf->CharWidth);
@@ -445,11 +461,11 @@ static void _DrawLine(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *
 	DrawText(mdc, p, lstrlen(p),
 		&drect, DT_VCENTER | DT_SINGLELINE | DT_NOCLIP | DT_WORD_ELLIPSIS);
 	mem_free(&p);
-	if (vvi->vi->v->type == TYPE_ARRAY) {
+	if (vvi->type == TYPE_ARRAY) {
 		DrawTreeIcon(hWnd, mdc, bf, vvi, drect.top);
 	}
 
-	// l
+	// 値
 	offset = bf->sep_size + bf->CharWidth - (bf->pos_x * bf->CharWidth);
 	p = vvi->buf;
 	drect.left = offset;
@@ -474,27 +490,20 @@ static void _DrawLine(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *
 }
 
 /*
- * DrawLine - 1s`
+ * DrawLine - 1行描画
  */
 static BOOL DrawLine(HWND hWnd, HDC mdc, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi, int count, int index)
 {
-	int i;
-	for (i = 0; i < count; i++) {
-		if (vvi[i].index == index) {
-			_DrawLine(hWnd, mdc, bf, vvi + i, index);
-			return TRUE;
-		}
-		if (vvi[i].child != NULL && vvi[i].open == TRUE) {
-			if (DrawLine(hWnd, mdc, bf, vvi[i].child, vvi[i].child_count, index) == TRUE) {
-				return TRUE;
-			}
-		}
+	VALUE_VIEW_INFO *draw_vvi = indexToValueViewInfo(vvi, count, index);
+	if (draw_vvi == NULL) {
+		return FALSE;
 	}
-	return FALSE;
+	_DrawLine(hWnd, mdc, bf, draw_vvi, index);
+	return TRUE;
 }
 
 /*
- * initValueList - ϐXg̏
+ * initValueList - 変数リストの初期化
  */
 static void initValueList(VALUE_VIEW_INFO *vvi, int vvi_count)
 {
@@ -509,11 +518,15 @@ static void initValueList(VALUE_VIEW_INFO *vvi, int vvi_count)
 }
 
 /*
- * findValueList - ϐXgIWiϐƓ̕ϐ
+ * findValueList - 変数リストからオリジナル変数と同一の変数を検索
  */
-static int findValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int vvi_count)
+static int findValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int vvi_count, int hint)
 {
 	int i;
+	// 前回と同じ位置を先に確認
+	if (hint >= 0 && hint < vvi_count && vvi[hint].org_vi == vi) {
+		return hint;
+	}
 	for (i = 0; i < vvi_count; i++) {
 		if (vvi[i].org_vi == vi) {
 			return i;
@@ -523,7 +536,7 @@ static int findValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int vvi_count)
 }
 
 /*
- * deselectValueList - ϐXg̑I
+ * deselectValueList - 変数リストの選択解除
  */
 static void deselectValueList(VALUE_VIEW_INFO *vvi, int vvi_count)
 {
@@ -537,7 +550,7 @@ static void deselectValueList(VALUE_VIEW_INFO *vvi, int vvi_count)
 }
 
 /*
- * trimValueList - ϐXg̐`
+ * trimValueList - 変数リストの整形
  */
 static void trimValueList(VALUE_VIEW_INFO *vvi, int *count)
 {
@@ -547,7 +560,6 @@ static void trimValueList(VALUE_VIEW_INFO *vvi, int *count)
 			trimValueList(vvi[i].child, &vvi[i].child_count);
 		}
 		if (vvi[i].valid == FALSE) {
-			FreeValue(vvi[i].vi);
 			mem_free(&(vvi[i].name));
 			mem_free(&(vvi[i].buf));
 			if (vvi[i].child != NULL) {
@@ -563,7 +575,7 @@ static void trimValueList(VALUE_VIEW_INFO *vvi, int *count)
 	}
 	for (i = 0; i < *count; i++) {
 		if (vvi[i].name == NULL) {
-			// z̏ꍇ͖OCfbNXƂ
+			// 配列の場合は名前をインデックスとする
 			TCHAR tmp[BUF_SIZE];
 			wsprintf(tmp, TEXT("[%d]"), i);
 			vvi[i].name = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(tmp) + 1));
@@ -575,7 +587,35 @@ static void trimValueList(VALUE_VIEW_INFO *vvi, int *count)
 }
 
 /*
- * getValueCount - ϐ̐擾
+ * validValueList - 変数リストを有効にする (変化のない配列の要素)
+ */
+static void validValueList(VALUE_VIEW_INFO *vvi, int vvi_count)
+{
+	int i;
+	for (i = 0; i < vvi_count; i++) {
+		vvi[i].valid = TRUE;
+		if (vvi[i].child != NULL) {
+			validValueList(vvi[i].child, vvi[i].child_count);
+		}
+	}
+}
+
+/*
+ * resetValueList - 変数リストの表示内容を次回の更新で作り直す
+ */
+static void resetValueList(VALUE_VIEW_INFO *vvi, int vvi_count)
+{
+	int i;
+	for (i = 0; i < vvi_count; i++) {
+		vvi[i].org_v = NULL;
+		if (vvi[i].child != NULL) {
+			resetValueList(vvi[i].child, vvi[i].child_count);
+		}
+	}
+}
+
+/*
+ * getValueCount - 変数の数を取得
  */
 static int getValueCount(VALUEINFO *vi)
 {
@@ -587,73 +627,146 @@ static int getValueCount(VALUEINFO *vi)
 }
 
 /*
- * setValueList - ϐXg̍쐬
+ * freeChildValueList - 配列要素の変数リストを解放
  */
-static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count)
+static void freeChildValueList(VALUE_VIEW_INFO *vvi)
 {
-	for(; vi != NULL; vi = vi->next){
+	if (vvi->child != NULL) {
+		freeValueinfo(vvi->child, vvi->child_count);
+		mem_free(&(vvi->child));
+	}
+	vvi->child_count = 0;
+	vvi->alloc_count = 0;
+}
+
+/*
+ * setChildValueList - 配列要素の変数リストを作成
+ *
+ *	作成する要素は child_limit まで、残りは続きの要素の行で表す
+ */
+static void setChildValueList(VALUE_VIEW_INFO *vvi, VALUEINFO *vi, const BOOL all)
+{
+	VALUE_VIEW_INFO *more;
+	TCHAR tmp[BUF_SIZE];
+	BOOL select = FALSE;
+	int cnt;
+	int size;
+
+	if (vvi->child_limit <= 0) {
+		vvi->child_limit = VIEW_PAGE_SIZE;
+	}
+	// 続きの要素の行は作り直す
+	if (vvi->child_count > 0 && vvi->child[vvi->child_count - 1].more == TRUE) {
+		(vvi->child_count)--;
+		select = vvi->child[vvi->child_count].select;
+		mem_free(&(vvi->child[vvi->child_count].name));
+		mem_free(&(vvi->child[vvi->child_count].buf));
+	}
+	cnt = getValueCount(vi);
+	size = ((cnt < vvi->child_limit) ? cnt : vvi->child_limit) + 1;
+	if (vvi->child == NULL) {
+		vvi->alloc_count = size;
+		vvi->child = mem_calloc(sizeof(VALUE_VIEW_INFO) * vvi->alloc_count);
+		vvi->child_count = 0;
+	} else if (vvi->child_count + size > vvi->alloc_count) {
+		VALUE_VIEW_INFO *tmp_list;
+		vvi->alloc_count = vvi->child_count + size;
+		tmp_list = mem_alloc(sizeof(VALUE_VIEW_INFO) * vvi->alloc_count);
+		CopyMemory(tmp_list, vvi->child, sizeof(VALUE_VIEW_INFO) * vvi->child_count);
+		mem_free(&(vvi->child));
+		vvi->child = tmp_list;
+	}
+	if (vvi->child == NULL) {
+		vvi->child_count = vvi->alloc_count = 0;
+		return;
+	}
+	setValueList(vi, vvi->child, &(vvi->child_count), vvi->child_limit, all);
+	if (cnt > vvi->child_limit) {
+		more = vvi->child + vvi->child_count;
+		(vvi->child_count)++;
+		ZeroMemory(more, sizeof(VALUE_VIEW_INFO));
+		more->name = alloc_copy(TEXT("..."));
+		wsprintf(tmp, TEXT("(%d / %d)"), vvi->child_limit, cnt);
+		more->buf = alloc_copy(tmp);
+		more->type = TYPE_ARRAY;
+		more->more = TRUE;
+		more->valid = TRUE;
+		more->select = select;
+	}
+}
+
+/*
+ * setValueList - 変数リストの作成
+ *
+ *	前回から更新カウンタが変わっていない変数は表示内容を作り直さない
+ *	配列の要素は開いている配列のみ作成する (all が TRUE の場合はすべての配列)
+ */
+static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count, const int limit, const BOOL all)
+{
+	int i;
+	for(i = 0; vi != NULL && (limit < 0 || i < limit); vi = vi->next, i++){
 		TCHAR *name;
 		TCHAR *buf;
-		// O̕ϐ
-		int index = findValueList(vi, vvi, *vvi_count);
+		unsigned int mod;
+		// 前回の変数を検索
+		int index = findValueList(vi, vvi, *vvi_count, i);
+		mod = GetValueModCount(vi->v);
 		if (index == -1) {
-			// VKϐ
+			// 新規変数
 			index = *vvi_count;
 			(*vvi_count)++;
 			ZeroMemory(vvi + index, sizeof(VALUE_VIEW_INFO));
 			vvi[index].org_vi = vi;
 			vvi[index].change = TRUE;
+		} else if (vvi[index].org_v == vi->v && vvi[index].mod == mod && vvi[index].buf != NULL &&
+			!(all == TRUE && vi->v->type == TYPE_ARRAY)) {
+			// 前回から変化なし
+			vvi[index].valid = TRUE;
+			if (vvi[index].child != NULL && vvi[index].open == FALSE && all == FALSE) {
+				// 閉じている配列の要素は保持しない
+				freeChildValueList(vvi + index);
+			} else if (vvi[index].child != NULL) {
+				validValueList(vvi[index].child, vvi[index].child_count);
+			}
+			continue;
 		} else {
-			FreeValue(vvi[index].vi);
 			if (vvi[index].child != NULL && vi->v->type != TYPE_ARRAY) {
-				freeValueinfo(vvi[index].child, vvi[index].child_count);
-				mem_free(&(vvi[index].child));
-				vvi[index].child_count = 0;
+				freeChildValueList(vvi + index);
 			}
 		}
 		vvi[index].valid = TRUE;
-		// ϐ̃Rs[
-		vvi[index].vi = CopyValue(vi);
-		if (vvi[index].vi == NULL) {
-			return;
-		}
-		mem_free(&(vvi[index].name));
-
-		name = vvi[index].vi->org_name;
+		vvi[index].org_v = vi->v;
+		vvi[index].mod = mod;
+		vvi[index].type = vi->v->type;
+		name = vi->org_name;
 		if (name == NULL) {
-			name = vvi[index].vi->name;
-		}
-		vvi[index].name = alloc_copy(name);
-		// ϐe̍쐬
-		if (vvi[index].vi->v->type == TYPE_ARRAY) {
-			int cnt;
-			int size = ArrayToStringSize(vvi[index].vi->v->u.array, hex_mode);
-			buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (size + 1));
-			if (buf != NULL) {
-				ArrayToString(vvi[index].vi->v->u.array, buf, hex_mode);
+			name = vi->name;
+		}
+		if (name != NULL && (vvi[index].name == NULL || lstrcmp(vvi[index].name, name) != 0)) {
+			mem_free(&(vvi[index].name));
+			vvi[index].name = alloc_copy(name);
+		}
+		// 変数内容の作成
+		if (vi->v->type == TYPE_ARRAY) {
+			// 表示する長さまで作成
+			buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (BUF_SIZE + 4 + 1));
+			if (buf != NULL && ArrayToStringLimit(vi->v->u.array, buf, BUF_SIZE + 4, hex_mode) == FALSE) {
+				lstrcpy(buf + BUF_SIZE + 1, TEXT("..."));
 			}
-			cnt = getValueCount(vi->v->u.array);
-			if (vvi[index].child == NULL) {
-				vvi[index].alloc_count = cnt;
-				vvi[index].child = mem_calloc(sizeof(VALUE_VIEW_INFO) * vvi[index].alloc_count);
-				vvi[index].child_count = 0;
-			} else if (vvi[index].child_count + cnt > vvi[index].alloc_count) {
-				VALUE_VIEW_INFO *tmp_list;
-				vvi[index].alloc_count = vvi[index].child_count + cnt;
-				tmp_list = mem_alloc(sizeof(VALUE_VIEW_INFO) * vvi[index].alloc_count);
-				CopyMemory(tmp_list, vvi[index].child, sizeof(VALUE_VIEW_INFO) * vvi[index].child_count);
-				mem_free(&(vvi[index].child));
-				vvi[index].child = tmp_list;
+			if (vvi[index].open == TRUE || all == TRUE) {
+				setChildValueList(vvi + index, vi->v->u.array, all);
+			} else if (vvi[index].child != NULL) {
+				// 閉じている配列の要素は保持しない
+				freeChildValueList(vvi + index);
 			}
-			setValueList(vi->v->u.array, vvi[index].child, &(vvi[index].child_count));
-		} else if (vvi[index].vi->v->type == TYPE_STRING) {
-			TCHAR *tmp = reconv_ctrl(vvi[index].vi->v->u.sValue);
+		} else if (vi->v->type == TYPE_STRING) {
+			TCHAR *tmp = reconv_ctrl(vi->v->u.sValue);
 			buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(tmp) + 2 + 1));
 			wsprintf(buf, TEXT("\"%s\""), tmp);
 			mem_free(&tmp);
-		} else if (vvi[index].vi->v->type == TYPE_FLOAT) {
+		} else if (vi->v->type == TYPE_FLOAT) {
 			TCHAR tmp[FLOAT_LENGTH];
-			_stprintf_s(tmp, FLOAT_LENGTH, TEXT("%.16f"), vvi[index].vi->v->u.fValue);
+			_stprintf_s(tmp, FLOAT_LENGTH, TEXT("%.16f"), vi->v->u.fValue);
 			buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(tmp) + 1));
 			if (buf != NULL) {
 				lstrcpy(buf, tmp);
@@ -661,9 +774,9 @@ static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count)
 		} else {
 			TCHAR tmp[BUF_SIZE];
 			if (hex_mode == FALSE) {
-				wsprintf(tmp, TEXT("%ld"), vvi[index].vi->v->u.iValue);
+				wsprintf(tmp, TEXT("%ld"), vi->v->u.iValue);
 			} else {
-				wsprintf(tmp, TEXT("0x%X"), vvi[index].vi->v->u.iValue);
+				wsprintf(tmp, TEXT("0x%X"), vi->v->u.iValue);
 			}
 			buf = (TCHAR *)mem_alloc(sizeof(TCHAR) * (lstrlen(tmp) + 1));
 			if (buf != NULL) {
@@ -677,7 +790,7 @@ static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count)
 			buf[BUF_SIZE + 4] = TEXT('\0');
 		}
 		if (buf != NULL && vvi[index].buf != NULL && lstrcmp(vvi[index].buf, buf) != 0) {
-			// O񂩂ω
+			// 前回から変化あり
 			vvi[index].change = TRUE;
 		}
 		mem_free(&(vvi[index].buf));
@@ -686,9 +799,9 @@ static void setValueList(VALUEINFO *vi, VALUE_VIEW_INFO *vvi, int *vvi_count)
 }
 
 /*
- * listValueinfo - ϐzɃRs[
+ * listValueinfo - 変数を配列にコピー
  */
-static void listValueinfo(EXECINFO *ei)
+static void listValueinfo(EXECINFO *ei, const BOOL all)
 {
 	VALUE_VIEW_INFO *tmp_list;
 	int cnt;
@@ -696,7 +809,7 @@ static void listValueinfo(EXECINFO *ei)
 	if (ei == NULL) {
 		return;
 	}
-	listValueinfo(ei->parent);
+	listValueinfo(ei->parent, all);
 
 	cnt = getValueCount(ei->vi);
 	if (vi_list == NULL) {
@@ -710,17 +823,16 @@ static void listValueinfo(EXECINFO *ei)
 		mem_free(&(vi_list));
 		vi_list = tmp_list;
 	}
-	setValueList(ei->vi, vi_list, &vi_list_count);
+	setValueList(ei->vi, vi_list, &vi_list_count, -1, all);
 }
 
 /*
- * freeValueinfo - ϐXg̉
+ * freeValueinfo - 変数リストの解放
  */
 static void freeValueinfo(VALUE_VIEW_INFO *vvi, int count)
 {
 	int i;
 	for (i = 0; i < count; i++) {
-		FreeValue(vvi[i].vi);
 		mem_free(&(vvi[i].name));
 		mem_free(&(vvi[i].buf));
 		if (vvi[i].child != NULL) {
@@ -732,7 +844,7 @@ static void freeValueinfo(VALUE_VIEW_INFO *vvi, int count)
 }
 
 /*
- * setValueIndex - ϐɕ\pCfbNXݒ
+ * setValueIndex - 変数に表示用インデックスを設定
  */
 static void setValueIndex(VALUE_VIEW_INFO *vvi, int count, int *index, int indent)
 {
@@ -748,7 +860,7 @@ static void setValueIndex(VALUE_VIEW_INFO *vvi, int count, int *index, int inden
 }
 
 /*
- * getValueDrawCount - ϐ̕\擾
+ * getValueDrawCount - 変数の表示数を取得
  */
 static int getValueDrawCount(VALUE_VIEW_INFO *vvi, int count)
 {
@@ -764,17 +876,50 @@ static int getValueDrawCount(VALUE_VIEW_INFO *vvi, int count)
 }
 
 /*
- * indexToValueViewInfo - \CfbNXɑΉϐ\擾
+ * indexToValueViewInfo - 表示インデックスに対応する変数表示情報を取得
+ *
+ *	各階層は表示インデックス順に並んでいるため二分探索で辿る
  */
 static VALUE_VIEW_INFO *indexToValueViewInfo(VALUE_VIEW_INFO *vvi, int count, int index)
+{
+	int low, high, mid;
+
+	while (vvi != NULL && count > 0) {
+		// 表示インデックスが index 以下の最後の変数を検索
+		low = 0;
+		high = count - 1;
+		while (low < high) {
+			mid = (low + high + 1) / 2;
+			if (vvi[mid].index <= index) {
+				low = mid;
+			} else {
+				high = mid - 1;
+			}
+		}
+		if (vvi[low].index == index) {
+			return vvi + low;
+		}
+		if (vvi[low].index > index || vvi[low].open == FALSE) {
+			break;
+		}
+		count = vvi[low].child_count;
+		vvi = vvi[low].child;
+	}
+	return NULL;
+}
+
+/*
+ * getSelectValueViewInfo - 選択中の変数表示情報を取得
+ */
+static VALUE_VIEW_INFO *getSelectValueViewInfo(VALUE_VIEW_INFO *vvi, int count)
 {
 	int i;
 	for (i = 0; i < count; i++) {
-		if (vvi[i].index == index) {
+		if (vvi[i].select == TRUE) {
 			return vvi + i;
 		}
 		if (vvi[i].child != NULL && vvi[i].open == TRUE) {
-			VALUE_VIEW_INFO *ret = indexToValueViewInfo(vvi[i].child, vvi[i].child_count, index);
+			VALUE_VIEW_INFO *ret = getSelectValueViewInfo(vvi[i].child, vvi[i].child_count);
 			if (ret != NULL) {
 				return ret;
 			}
@@ -784,17 +929,20 @@ static VALUE_VIEW_INFO *indexToValueViewInfo(VALUE_VIEW_INFO *vvi, int count, in
 }
 
 /*
- * getSelectValueViewInfo - I𒆂̕ϐ\擾
+ * getParentValueViewInfo - 親の変数表示情報を取得
  */
-static VALUE_VIEW_INFO *getSelectValueViewInfo(VALUE_VIEW_INFO *vvi, int count)
+static VALUE_VIEW_INFO *getParentValueViewInfo(VALUE_VIEW_INFO *vvi, int count, VALUE_VIEW_INFO *target)
 {
 	int i;
 	for (i = 0; i < count; i++) {
-		if (vvi[i].select == TRUE) {
+		if (vvi[i].child == NULL) {
+			continue;
+		}
+		if (target >= vvi[i].child && target < vvi[i].child + vvi[i].child_count) {
 			return vvi + i;
 		}
-		if (vvi[i].child != NULL && vvi[i].open == TRUE) {
-			VALUE_VIEW_INFO *ret = getSelectValueViewInfo(vvi[i].child, vvi[i].child_count);
+		if (vvi[i].open == TRUE) {
+			VALUE_VIEW_INFO *ret = getParentValueViewInfo(vvi[i].child, vvi[i].child_count, target);
 			if (ret != NULL) {
 				return ret;
 			}
@@ -804,7 +952,7 @@ static VALUE_VIEW_INFO *getSelectValueViewInfo(VALUE_VIEW_INFO *vvi, int count)
 }
 
 /*
- * ShowSelectValueViewInfo - I𒆂̕ϐ\\ʒuɃXN[
+ * ShowSelectValueViewInfo - 選択中の変数表示情報を表示位置にスクロールする
  */
 static void ShowSelectValueViewInfo(HWND hWnd, VARIABLE_BUFFER *bf)
 {
@@ -828,7 +976,49 @@ static void ShowSelectValueViewInfo(HWND hWnd, VARIABLE_BUFFER *bf)
 }
 
 /*
- * VariableProc - EBhEvV[W
+ * RequestValueViewInfo - 変数の再取得を要求
+ *
+ *	次回の更新で対象の変数と親をたどって作り直す
+ */
+static void RequestValueViewInfo(HWND hWnd, VALUE_VIEW_INFO *vvi)
+{
+	for (; vvi != NULL; vvi = getParentValueViewInfo(vi_list, vi_list_count, vvi)) {
+		vvi->org_v = NULL;
+	}
+	SendMessage(GetParent(hWnd), WM_VIEW_NOTIFY_REFRESH, 0, (LPARAM)hWnd);
+}
+
+/*
+ * ToggleValueViewInfo - 配列の開閉
+ *
+ *	要素が未作成の場合は親ウィンドウに変数の再取得を要求する
+ */
+static void ToggleValueViewInfo(HWND hWnd, VARIABLE_BUFFER *bf, VALUE_VIEW_INFO *vvi)
+{
+	VALUE_VIEW_INFO *parent;
+	int index = 0;
+
+	if (vvi->more == TRUE) {
+		// 続きの要素を作成
+		if ((parent = getParentValueViewInfo(vi_list, vi_list_count, vvi)) != NULL) {
+			parent->child_limit += VIEW_PAGE_SIZE;
+			RequestValueViewInfo(hWnd, parent);
+		}
+		return;
+	}
+	vvi->open = !vvi->open;
+	if (vvi->open == TRUE && vvi->child == NULL) {
+		vvi->child_limit = VIEW_PAGE_SIZE;
+		RequestValueViewInfo(hWnd, vvi);
+	}
+	setValueIndex(vi_list, vi_list_count, &index, 0);
+	bf->view_line = getValueDrawCount(vi_list, vi_list_count);
+	bf->draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
+	SetScrollBar(hWnd, bf);
+}
+
+/*
+ * VariableProc - ウィンドウプロシージャ
  */
 static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -1036,6 +1226,16 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			break;
 		}
 		SetScrollPos(hWnd, SB_VERT, bf->pos_y, TRUE);
+		if (i != bf->pos_y) {
+			// 表示範囲の行から横幅を再計算
+			int draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
+			if (draw_width != bf->draw_width) {
+				bf->draw_width = draw_width;
+				SetScrollBar(hWnd, bf);
+				InvalidateRect(hWnd, NULL, FALSE);
+				break;
+			}
+		}
 		rect.top = bf->header_height;
 		ScrollWindowEx(hWnd, 0, (i - bf->pos_y) * bf->FontHeight, NULL, &rect, NULL, NULL, SW_INVALIDATE | SW_ERASE);
 		break;
@@ -1048,26 +1248,21 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		{
 		case TEXT('C'):
 			if(GetKeyState(VK_CONTROL) < 0){
-				//Rs[
+				//コピー
 				SendMessage(hWnd, WM_COPY, 0, 0);
 			}
 			break;
 
 		case VK_SPACE:
 			if(GetKeyState(VK_CONTROL) < 0){
-				// I
+				// 選択解除
 				deselectValueList(vi_list, vi_list_count);
 				InvalidateRect(hWnd, NULL, FALSE);
 				UpdateWindow(hWnd);
 			} else {
 				VALUE_VIEW_INFO *vvi = getSelectValueViewInfo(vi_list, vi_list_count);
-				if (vvi != NULL && vvi->vi->v->type == TYPE_ARRAY) {
-					int index = 0;
-					vvi->open = !vvi->open;
-					setValueIndex(vi_list, vi_list_count, &index, 0);
-					bf->view_line = getValueDrawCount(vi_list, vi_list_count);
-					bf->draw_width = getDrawMaxWidth(bf->mdc, bf);
-					SetScrollBar(hWnd, bf);
+				if (vvi != NULL && vvi->type == TYPE_ARRAY) {
+					ToggleValueViewInfo(hWnd, bf, vvi);
 					InvalidateRect(hWnd, NULL, FALSE);
 					UpdateWindow(hWnd);
 				}
@@ -1085,7 +1280,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			break;
 
 		case VK_END:
-			//Ŝ̖
+			//全体の末尾
 			SetScrollPos(hWnd, SB_VERT, bf->view_line, TRUE);
 			InvalidateRect(hWnd, NULL, FALSE);
 			UpdateWindow(hWnd);
@@ -1162,22 +1357,17 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		if (!(apos.x - rect.left - GetSystemMetrics(SM_CXFRAME) + (bf->pos_x * bf->CharWidth) > bf->sep_size - 10 &&
 			apos.x - rect.left - GetSystemMetrics(SM_CXFRAME) + (bf->pos_x * bf->CharWidth) < bf->sep_size + 10)) {
 			if ((apos.y - rect.top - bf->header_height) >= 0) {
-				// sI
+				// 行選択
 				RECT iconRect;
 				int click_line = (apos.y - rect.top - bf->header_height) / bf->FontHeight + bf->pos_y;
 				VALUE_VIEW_INFO *vvi = indexToValueViewInfo(vi_list, vi_list_count, click_line);
-				if (vvi != NULL && vvi->vi->v->type == TYPE_ARRAY) {
+				if (vvi != NULL && vvi->type == TYPE_ARRAY) {
 					iconRect = getTreeIconRect(bf->mdc, bf, vvi);
 				}
-				if (vvi != NULL && vvi->vi->v->type == TYPE_ARRAY && iconRect.left <= apos.x - rect.left - GetSystemMetrics(SM_CXFRAME) && iconRect.right >= apos.x - rect.left - GetSystemMetrics(SM_CXFRAME)) {
-					int index = 0;
-					vvi->open = !vvi->open;
-					setValueIndex(vi_list, vi_list_count, &index, 0);
-					bf->view_line = getValueDrawCount(vi_list, vi_list_count);
-					bf->draw_width = getDrawMaxWidth(bf->mdc, bf);
-					SetScrollBar(hWnd, bf);
+				if (vvi != NULL && vvi->type == TYPE_ARRAY && iconRect.left <= apos.x - rect.left - GetSystemMetrics(SM_CXFRAME) && iconRect.right >= apos.x - rect.left - GetSystemMetrics(SM_CXFRAME)) {
+					ToggleValueViewInfo(hWnd, bf, vvi);
 				} else if (vvi == NULL) {
-					// I
+					// 選択解除
 					deselectValueList(vi_list, vi_list_count);
 				} else if (vvi->select == TRUE) {
 					if (focus_flag == TRUE) {
@@ -1229,7 +1419,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			FreeFrame();
 			sep_move = FALSE;
 
-			bf->draw_width = getDrawMaxWidth(bf->mdc, bf);
+			bf->draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
 			SendMessage(hWnd, WM_SIZE, 0, 0);
 		}
 		break;
@@ -1266,11 +1456,11 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			}
 			break;
 		}
-		bf->sep_size = getNameMaxWidth(bf->mdc, bf, vi_list, vi_list_count) + bf->CharWidth;
+		bf->sep_size = getNameMaxWidth(hWnd, bf->mdc, bf) + bf->CharWidth;
 		if (bf->sep_size < 50) {
 			bf->sep_size = 50;
 		}
-		bf->draw_width = getDrawMaxWidth(bf->mdc, bf);
+		bf->draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
 		SendMessage(hWnd, WM_SIZE, 0, 0);
 		break;
 
@@ -1325,14 +1515,14 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			if ((bf = (VARIABLE_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->hTheme == NULL) {
 				return DefWindowProc(hWnd, message, wParam, lParam);
 			}
-			// XPp̔wi`
+			// XP用の背景描画
 			if (_DrawThemeBackground == NULL) {
 				_DrawThemeBackground = GetProcAddress(bf->hModThemes, "DrawThemeBackground");
 			}
 			if (_DrawThemeBackground == NULL) {
 				return DefWindowProc(hWnd, message, wParam, lParam);
 			}
-			// Ԃ̐ݒ
+			// 状態の設定
 			if (IsWindowEnabled(hWnd) == 0) {
 				stats = ETS_DISABLED;
 			} else if (GetFocus() == hWnd) {
@@ -1340,7 +1530,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			} else {
 				stats = ETS_NORMAL;
 			}
-			// EBhEg̕`
+			// ウィンドウ枠の描画
 			hDC = GetDCEx(hWnd, (HRGN)wParam, DCX_WINDOW | DCX_INTERSECTRGN);
 			if (hDC == NULL) {
 				hDC = GetWindowDC(hWnd);
@@ -1353,7 +1543,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			_DrawThemeBackground(bf->hTheme, hDC, EP_EDITTEXT, stats, &rect, &clip_rect);
 			ReleaseDC(hWnd, hDC);
 
-			// XN[o[̕`
+			// スクロールバーの描画
 			GetWindowRect(hWnd, (LPRECT)&rect);
 			hrgn = CreateRectRgn(rect.left + GetSystemMetrics(SM_CXEDGE), rect.top + GetSystemMetrics(SM_CYEDGE),
 				rect.right - GetSystemMetrics(SM_CXEDGE), rect.bottom - GetSystemMetrics(SM_CYEDGE));
@@ -1367,7 +1557,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		if ((bf = (VARIABLE_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA)) == NULL || bf->hModThemes == NULL) {
 			break;
 		}
-		// XPe[}̕ύX
+		// XPテーマの変更
 		if (bf->hTheme != NULL) {
 			if (_CloseThemeData == NULL) {
 				_CloseThemeData = GetProcAddress(bf->hModThemes, "CloseThemeData");
@@ -1392,6 +1582,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 	case WM_SIZE:
 		bf = (VARIABLE_BUFFER *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
 		if(bf == NULL) break;
+		bf->draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
 		SetScrollBar(hWnd, bf);
 
 		GetClientRect(hWnd, &rect);
@@ -1419,12 +1610,12 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		} else {
 			int index = 0;
 			initValueList(vi_list, vi_list_count);
-			listValueinfo((EXECINFO *)lParam);
+			listValueinfo((EXECINFO *)lParam, (BOOL)wParam);
 			trimValueList(vi_list, &vi_list_count);
 			setValueIndex(vi_list, vi_list_count, &index, 0);
 		}
 		bf->view_line = getValueDrawCount(vi_list, vi_list_count);
-		bf->draw_width = getDrawMaxWidth(bf->mdc, bf);
+		bf->draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
 		SetScrollBar(hWnd, bf);
 		InvalidateRect(hWnd, NULL, FALSE);
 		UpdateWindow(hWnd);
@@ -1466,7 +1657,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			SelectObject(bf->mdc, hRetFont);
 			DeleteObject(hFont);
 
-			bf->draw_width = getDrawMaxWidth(bf->mdc, bf);
+			bf->draw_width = getDrawMaxWidth(hWnd, bf->mdc, bf);
 			bf->width = 0;
 			SendMessage(hWnd, WM_SIZE, 0, 0);
 		}
@@ -1541,6 +1732,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 
 	case WM_VIEW_SET_HEX_MODE:
 		hex_mode = (BOOL)wParam;
+		resetValueList(vi_list, vi_list_count);
 		SendMessage(hWnd, WM_VIEW_REFLECT, 0, 0);
 		break;
 
@@ -1551,12 +1743,12 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 			WORD lang = PRIMARYLANGID(LANGIDFROMLCID(GetThreadLocale()));
 			VALUE_VIEW_INFO *vvi = getSelectValueViewInfo(vi_list, vi_list_count);
 
-			// j[̍쐬
+			// メニューの作成
 			hMenu = CreatePopupMenu();
 			AppendMenu(hMenu, MF_STRING | ((vvi != NULL) ? 0 : MF_GRAYED), WM_COPY,
-				(lang != LANG_JAPANESE) ? TEXT("&Copy") : TEXT("Rs[(&C)"));
+				(lang != LANG_JAPANESE) ? TEXT("&Copy") : TEXT("コピー(&C)"));
 
-			// j[̕\
+			// メニューの表示
 			GetCursorPos((LPPOINT)&apos);
 			i = TrackPopupMenu(hMenu, TPM_TOPALIGN | TPM_RETURNCMD, apos.x, apos.y, 0, hWnd, NULL);
 			DestroyMenu(hMenu);
@@ -1573,7 +1765,7 @@ static LRESULT CALLBACK VariableProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 }
 
 /*
- * RegisterVariableWindow - 1NX̓o^
+ * RegisterVariableWindow - 1クラスの登録
  */
 BOOL RegisterVariableWindow(HINSTANCE hInstance)
 {
@@ -26,7 +26,7 @@
 #define VARIABLE_WND_CLASS		TEXT("VariableViewClass")
 #endif
 
-//mۂTCY
+//確保するサイズ
 #ifndef DEF_RESERVE
 #define DEF_RESERVE
 #define RESERVE_SZIE			4096
@@ -40,22 +40,22 @@
 #define MSG_NOTIFY_OFFSET		WM_APP + 500
 #endif
 
-//̒ǉ
+//文字列の追加
 #define WM_VIEW_ADDTEXT			(MSG_OFFSET + 0)
-//struct _BUFFER ̎擾
+//struct _BUFFER の取得
 #define WM_VIEW_GETBUFFERINFO	(MSG_OFFSET + 1)
-//eLXgFƔwiF̐ݒ (wParam - TextColor, lParam - BackColor)
+//テキスト色と背景色の設定 (wParam - TextColor, lParam - BackColor)
 #define WM_VIEW_SETCOLOR		(MSG_OFFSET + 2)
-//sԂ̐ݒ (wParam - sԂ̃hbg)
+//行間の設定 (wParam - 行間のドット数)
 #define WM_VIEW_SETSPACING		(MSG_OFFSET + 4)
-//_s̐ݒ
+//論理行数制限の設定
 #define WM_VIEW_SETLINELIMIT	(MSG_OFFSET + 5)
-//tHgsԕύX̔f
+//フォントや行間変更の反映
 #define WM_VIEW_REFLECT			(MSG_OFFSET + 6)
-//XN[̃bN (wPrama - 0ŃXN[ʒuŒA1ŕ\ʒuŒ)
+//スクロールのロック (wPrama - 0でスクロール位置固定、1で表示位置固定)
 #define WM_VIEW_IS_SELECTION	(MSG_OFFSET + 7)
 
-//ϐ̒ǉ
+//変数の追加
 #define WM_VIEW_SETVARIABLE		(MSG_OFFSET + 10)
 
 #define WM_VIEW_SET_SEPSIZE		(MSG_OFFSET + 11)
@@ -66,7 +66,10 @@
 
 #define WM_VIEW_SET_HEX_MODE	(MSG_OFFSET + 15)
 
-//R[h
+//変数の再取得の要求 (親ウィンドウへ通知、lParam - 変数ビューのウィンドウハンドル)
+#define WM_VIEW_NOTIFY_REFRESH	(MSG_NOTIFY_OFFSET + 0)
+
+//文字装飾コード
 #ifndef DEF_ORN
 #define DEF_ORN
 #define ORN_COLOR				0x03
@@ -76,7 +79,7 @@
 #define ORN_ITALIC				0x14
 #endif
 
-//X^C}XN
+//スタイルマスク
 #ifndef DEF_STYLE
 #define DEF_STYLE
 #define STYLE_TEXTCOLOR			1
@@ -89,17 +92,24 @@
 #endif
 
 /* Struct */
-//l
+//値情報
 typedef struct _VALUE_VIEW_INFO {
-	VALUEINFO *vi;
 	TCHAR *name;
 	TCHAR *buf;
+	VALUE_TYPE type;
 
 	struct _VALUE_VIEW_INFO *child;
 	int child_count;
 	int alloc_count;
+	//要素を作成する上限 (配列を開いた時にページ単位で増やす)
+	int child_limit;
+	//続きの要素を表示する行
+	BOOL more;
 
+	//表示内容を作成した時点のオリジナル変数と更新カウンタ
 	VALUEINFO *org_vi;
+	VALUE *org_v;
+	unsigned int mod;
 	BOOL change;
 	BOOL valid;
 	BOOL select;
@@ -111,52 +121,52 @@ typedef struct _VALUE_VIEW_INFO {
 #ifndef DECL_VARIABLE_BUFFER
 #define DECL_VARIABLE_BUFFER
 typedef struct _VARIABLE_BUFFER {
-	//s (\s)
+	//行数 (表示行)
 	int view_line;
 	int draw_width;
-	//EBhE̕
+	//ウィンドウの幅
 	int width;
-	//wb_[̍
+	//ヘッダーの高さ
 	int header_height;
 	long sep_size;
 
-	//XN[ o[̂܂݂݂̌̈ʒu
+	//スクロール バーのつまみの現在の位置
 	int pos_x;
-	//XN[ o[݂̌̂܂݂̈ʒu̍ől
+	//スクロール バーの現在のつまみの位置の最大値
 	int max_x;
-	//XN[ o[̂܂݂݂̌̈ʒu
+	//スクロール バーのつまみの現在の位置
 	int pos_y;
-	//XN[ o[݂̌̂܂݂̈ʒu̍ől
+	//スクロール バーの現在のつまみの位置の最大値
 	int max_y;
 
-	//}[W
+	//左マージン
 	int LeftMargin;
-	//E}[W
+	//右マージン
 	int RightMargin;
-	//s
+	//行間
 	int Spacing;
 
-	//`p
+	//描画用情報
 	HDC mdc;
 	HBITMAP hBmp;
 	HBITMAP hRetBmp;
 
-	//tHg
+	//フォント情報
 	LOGFONT lf;
-	//tHg̍
+	//フォントの高さ
 	int FontHeight;
-	//1̃tHg̕
+	//1文字のフォントの幅
 	int CharWidth;
-	//Œsb` - TRUE, σsb` - FALSE
+	//固定ピッチ - TRUE, 可変ピッチ - FALSE
 	BOOL Fixed;
-	//LN^Zbg (default - SHIFTJIS_CHARSET)
+	//キャラクタセット (default - SHIFTJIS_CHARSET)
 	BYTE CharSet;
 
-	//eLXg̐F
+	//テキストの色
 	COLORREF TextColor;
-	//wiF
+	//背景色
 	COLORREF BackClolor;
-	//wiF̃uV
+	//背景色のブラシ
 	HBRUSH hBkBrush;
 
 	TCHAR header_name[BUF_SIZE];
@@ -11,6 +11,7 @@
 /* Include Files */
 #include <windows.h>
 #include <stdio.h>
+#include <io.h>
 #include <locale.h>
 
 #include "../PG0/script.h"
@@ -18,50 +19,280 @@
 #include "../PG0/script_memory.h"
 #include "../PG0/script_utility.h"
 
+#ifdef _MSC_VER
 #pragma comment(lib, "Version.lib")
+#endif
 
 /* Define */
 #define APP_NAME						TEXT("PG0cmd")
 
 #define BUF_SIZE	256
 #define LINE_SIZE	32768
+#define FLOAT_BUF_SIZE	512
+
+#define OUT_BUF_SIZE	65536
+
+#define JOB_ALLOC_CNT	64
+#define JOB_ARG_MAX		64
+#define JOB_HASH_SIZE	256
+#define JOB_HASH(hash)	((int)((unsigned int)(hash) % JOB_HASH_SIZE))
+
+#ifdef _WIN32
+#define IS_OPTION(c)	((c) == TEXT('/') || (c) == TEXT('-'))
+#else
+// '/' は絶対パスと区別できないため '-' のみ
+#define IS_OPTION(c)	((c) == TEXT('-'))
+#endif
+
+#ifdef _WIN32
+// 大文字と小文字を区別しないファイルシステム
+#define JOB_PATH_CMP	lstrcmpi
+#else
+#define JOB_PATH_CMP	lstrcmp
+#endif
 
 /* Global Variables */
 TCHAR AppDir[MAX_PATH + 1];
 BOOL op_pg0 = FALSE;
 BOOL op_hex = FALSE;
+BOOL op_module = FALSE;
+LONGLONG op_step = 0;
+DWORD op_timeout = 0;
+SIZE_T op_memory = 0;
+BOOL op_stats = FALSE;
+TCHAR *op_profile = NULL;
+int op_sample = 0;
+TCHAR *op_trace = NULL;
+
+//標準出力のバッファ
+typedef struct _OUTBUF {
+	TCHAR buf[OUT_BUF_SIZE + 1];
+	int len;
+	//端末の場合は改行ごとに出力する
+	BOOL tty;
+	//標準入力が端末の場合は入力の前に出力する
+	BOOL tty_in;
+} OUTBUF;
+static OUTBUF out;
+
+//バッチ実行のジョブ
+typedef struct _JOBINFO {
+	TCHAR *line;
+	int argc;
+	TCHAR *argv[JOB_ARG_MAX];
+
+	//共有する解析結果
+	CODEINFO *code;
+	//スクリプトのパスのハッシュ
+	int path_hash;
+	struct _JOBINFO *path_next;
+
+	//出力
+	TCHAR *out;
+	int out_len;
+	int out_size;
+	int ret;
+	//実行後のインスタンスのメモリ使用量の最大値
+	SIZE_T mem_peak;
+	volatile LONG done;
+} JOBINFO;
+
+//バッチ実行のキュー
+typedef struct _JOBQUEUE {
+	JOBINFO *job;
+	int cnt;
+	volatile LONG index;
+	HANDLE hDone;
+} JOBQUEUE;
+
+//統計の表示名 (SYM_TYPEの順)
+static const TCHAR *sym_name[SYM_RETURN + 1] = {
+	TEXT("none"), TEXT("eof"), TEXT("comment"), TEXT("prep"), TEXT("lineend"), TEXT("linesep"), TEXT("wordend"),
+	TEXT("bopen"), TEXT("bopen_primary"), TEXT("bclose"), TEXT("open"), TEXT("close"),
+	TEXT("arrayopen"), TEXT("arrayclose"), TEXT("eq"), TEXT("cpand"), TEXT("cpor"),
+	TEXT("left"), TEXT("lefteq"), TEXT("right"), TEXT("righteq"), TEXT("eqeq"), TEXT("nteq"),
+	TEXT("add"), TEXT("sub"), TEXT("multi"), TEXT("div"), TEXT("mod"), TEXT("not"), TEXT("plus"), TEXT("mins"),
+	TEXT("const_int"), TEXT("declvariable"), TEXT("variable"), TEXT("array"),
+	TEXT("var"), TEXT("if"), TEXT("else"), TEXT("while"), TEXT("exit"),
+	TEXT("jump"), TEXT("jze"), TEXT("jnz"), TEXT("cmp"), TEXT("cmpstart"), TEXT("cmpend"),
+	TEXT("loop"), TEXT("loopstart"), TEXT("loopend"), TEXT("labelend"),
+	TEXT("and"), TEXT("or"), TEXT("xor"), TEXT("leftshift"), TEXT("rightshift"),
+	TEXT("leftshift_logical"), TEXT("rightshift_logical"), TEXT("bitnot"), TEXT("comp_eq"),
+	TEXT("inc"), TEXT("dec"), TEXT("binc"), TEXT("bdec"), TEXT("const_float"), TEXT("const_string"),
+	TEXT("for"), TEXT("do"), TEXT("break"), TEXT("continue"), TEXT("switch"), TEXT("case"), TEXT("default"),
+	TEXT("dammy"), TEXT("funcstart"), TEXT("funcend"), TEXT("func"), TEXT("argstart"), TEXT("return"),
+};
+static const TCHAR *stat_obj_name[STAT_OBJ_SIZE] = {
+	TEXT("value"), TEXT("string"), TEXT("frame"), TEXT("funcaddr"),
+};
+static const TCHAR *stat_func_name[STAT_FUNC_SIZE] = {
+	TEXT("cache(script)"), TEXT("cache(library)"), TEXT("script"), TEXT("module"),
+	TEXT("library"), TEXT("registered"), TEXT("not found"),
+};
+static STATINFO *sort_stat;
 
 /* Local Function Prototypes */
 
 /*
- * _lib_func_error - G[o
+ * OutInit - 標準出力のバッファの初期化
  */
-int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+static void OutInit(void)
+{
+	out.len = 0;
+	out.tty = _isatty(_fileno(stdout)) ? TRUE : FALSE;
+	out.tty_in = _isatty(_fileno(stdin)) ? TRUE : FALSE;
+	if (out.tty == FALSE) {
+		// パイプやファイルの場合はまとめて書き込む
+		setvbuf(stdout, NULL, _IOFBF, OUT_BUF_SIZE);
+	}
+}
+
+/*
+ * OutFlush - 標準出力のバッファを書き出す
+ */
+static void OutFlush(void)
+{
+	if (out.len > 0) {
+		out.buf[out.len] = TEXT('\0');
+		_fputts(out.buf, stdout);
+		out.len = 0;
+	}
+	fflush(stdout);
+}
+
+/*
+ * OutWrite - 標準出力のバッファに追加
+ *
+ *	端末の場合は改行を含むと書き出し、それ以外はバッファが一杯になると書き出す
+ */
+static void OutWrite(const TCHAR *str, int len)
+{
+	BOOL nl = FALSE;
+	int n, i;
+
+	while (len > 0) {
+		if (out.len >= OUT_BUF_SIZE) {
+			OutFlush();
+		}
+		n = (len < OUT_BUF_SIZE - out.len) ? len : OUT_BUF_SIZE - out.len;
+		if (out.tty == TRUE) {
+			for (i = 0; i < n && str[i] != TEXT('\n'); i++);
+			if (i < n) {
+				nl = TRUE;
+			}
+		}
+		CopyMemory(out.buf + out.len, str, sizeof(TCHAR) * n);
+		out.len += n;
+		str += n;
+		len -= n;
+	}
+	if (nl == TRUE) {
+		OutFlush();
+	}
+}
+
+/*
+ * OutputWrite - 文字列の出力
+ *
+ *	バッチ実行時はジョブの出力バッファに追加する
+ */
+static BOOL OutputWrite(void *param, const TCHAR *str, int len)
+{
+	JOBINFO *job = (JOBINFO *)param;
+	MEMHEAP *prev;
+	TCHAR *p;
+	int size;
+
+	if (job == NULL) {
+		OutWrite(str, len);
+		return TRUE;
+	}
+	if (job->out_len + len + 1 > job->out_size) {
+		// インスタンスの破棄後も使用するためプロセスのヒープに確保する
+		size = (job->out_len + len + 1) * 2;
+		prev = mem_heap_select(NULL);
+		p = (job->out == NULL) ? mem_alloc(sizeof(TCHAR) * size) : mem_realloc(job->out, sizeof(TCHAR) * size);
+		mem_heap_select(prev);
+		if (p == NULL) {
+			return FALSE;
+		}
+		job->out = p;
+		job->out_size = size;
+	}
+	CopyMemory(job->out + job->out_len, str, sizeof(TCHAR) * len);
+	job->out_len += len;
+	*(job->out + job->out_len) = TEXT('\0');
+	return TRUE;
+}
+
+/*
+ * OutputString - 文字列の出力
+ */
+static void OutputString(JOBINFO *job, TCHAR *str)
+{
+	if (str == NULL) {
+		return;
+	}
+	OutputWrite(job, str, lstrlen(str));
+}
+
+/*
+ * OutputValue - 値の出力
+ */
+static void OutputValue(JOBINFO *job, VALUEINFO *vi)
+{
+	TCHAR buf[FLOAT_BUF_SIZE];
+
+	switch (vi->v->type) {
+	case TYPE_ARRAY:
+		// 文字列を作成せずに出力する
+		WriteArray(vi->v->u.array, op_hex, OutputWrite, job);
+		break;
+	case TYPE_STRING:
+		OutputString(job, vi->v->u.sValue);
+		break;
+	case TYPE_FLOAT:
+		_sntprintf(buf, FLOAT_BUF_SIZE - 1, TEXT("%.16f"), vi->v->u.fValue);
+		buf[FLOAT_BUF_SIZE - 1] = TEXT('\0');
+		OutputString(job, buf);
+		break;
+	default:
+		if (op_hex == TRUE) {
+			wsprintf(buf, TEXT("0x%X"), vi->v->u.iValue);
+		} else {
+			wsprintf(buf, TEXT("%d"), vi->v->u.iValue);
+		}
+		OutputString(job, buf);
+		break;
+	}
+	OutputString(job, TEXT("\n"));
+}
+
+/*
+ * OutputError - エラー出力
+ */
+static int OutputError(JOBINFO *job, VALUEINFO *param)
 {
 	TCHAR *str;
-	int line = 0;
 
 	if (param == NULL) {
 		return -2;
 	}
 	if (param->v->type == TYPE_ARRAY) {
-		int size = ArrayToStringSize(param->v->u.array, op_hex);
-		str = (TCHAR *)mem_alloc(sizeof(TCHAR) * (size + 1));
-		if (str != NULL) {
-			ArrayToString(param->v->u.array, str, op_hex);
-		}
+		WriteArray(param->v->u.array, op_hex, OutputWrite, job);
 	} else {
 		str = VariableToString(param);
+		OutputString(job, str);
+		mem_free(&str);
 	}
-	_tprintf(TEXT("%s\n"), str);
-	mem_free(&str);
+	OutputString(job, TEXT("\n"));
 	return 0;
 }
 
 /*
- * _lib_func_print - Wo
+ * OutputPrint - 標準出力
  */
-int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+static int OutputPrint(JOBINFO *job, VALUEINFO *param)
 {
 	TCHAR *str;
 
@@ -69,27 +300,45 @@ int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 		return -2;
 	}
 	str = VariableToString(param);
-	_tprintf(TEXT("%s"), str);
+	OutputString(job, str);
 	mem_free(&str);
 	return 0;
 }
 
 /*
- * _lib_func_input - W
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return OutputError(NULL, param);
+}
+
+/*
+ * _lib_func_print - 標準出力
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return OutputPrint(NULL, param);
+}
+
+/*
+ * _lib_func_input - 標準入力
  */
 int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
 	HANDLE ih;
 	TCHAR *buf, *p;
-	int mode, rmode;
-	int size;
+	DWORD mode, rmode;
+	DWORD size;
 	int len = 1024;
 
-	//W͂當ǂݎ
+	//入力の前にそれまでの出力を表示する
+	OutFlush();
+	//標準入力から文字列を読み取る
 	ih = GetStdHandle(STD_INPUT_HANDLE);
 	GetConsoleMode(ih, &mode);
 	rmode = mode;
-	//s̓[hɐݒ
+	//行入力モードに設定
 	mode |= ENABLE_LINE_INPUT;
 	SetConsoleMode(ih, mode);
 	buf = mem_alloc(sizeof(TCHAR) * (len + 1));
@@ -106,18 +355,24 @@ int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR
 }
 
 /*
- * FormatValue - l̏o
+ * PrintModuleList - 読み込んだモジュールの一覧を出力
  */
-void FormatValue(VALUEINFO *vi) {
-	if (op_hex == TRUE) {
-		_tprintf(TEXT("0x%X"), vi->v->u.iValue);
-	} else {
-		_tprintf(TEXT("%d"), vi->v->u.iValue);
+static void PrintModuleList(SCRIPTINFO *sci)
+{
+	MODULEINFO *mi;
+
+	for (mi = GetModuleList(sci); mi != NULL; mi = mi->next) {
+		if (mi->sci->src != NULL) {
+			_ftprintf(stderr, TEXT("%s\tload %.3f ms\tparse %.3f ms\n"), mi->path,
+				(double)mi->sci->src->load_time / 1000, (double)mi->sci->src->parse_time / 1000);
+		} else {
+			_ftprintf(stderr, TEXT("%s\n"), mi->path);
+		}
 	}
 }
 
 /*
- * LineExecLoop - Ps͂́Ass
+ * LineExecLoop - １行入力し解析、実行を行う
  */
 static void LineExecLoop()
 {
@@ -137,14 +392,20 @@ static void LineExecLoop()
 	ei.sci = sci;
 	ei.line_mode = TRUE;
 
-	while (_fgetts(buf, LINE_SIZE - 1, stdin) != NULL) {
-		//
+	while (1) {
+		if (out.tty_in == TRUE) {
+			OutFlush();
+		}
+		if (_fgetts(buf, LINE_SIZE - 1, stdin) == NULL) {
+			break;
+		}
+		//解析
 		sci->buf = buf;
 		tk = ParseSentence(&ei, buf, 0);
 		if (tk == NULL) {
 			continue;
 		}
-		//s
+		//実行
 		svi = NULL;
 		ret = ExecSentense(&ei, tk, NULL, &svi);
 		FreeToken(tk);
@@ -153,83 +414,580 @@ static void LineExecLoop()
 			break;
 		}
 		if (ret != RET_ERROR) {
-			vi = svi;
-			while (vi != NULL) {
-				switch (vi->v->type) {
-				case TYPE_ARRAY:
-				{
-					int size = ArrayToStringSize(vi->v->u.array, op_hex);
-					TCHAR *str = (TCHAR *)mem_alloc(sizeof(TCHAR) * (size + 1));
-					if (str != NULL) {
-						ArrayToString(vi->v->u.array, str, op_hex);
-						_tprintf(TEXT("%s"), str);
-						mem_free(&str);
-					}
-				}
-					break;
-				case TYPE_STRING:
-					_tprintf(TEXT("%s"), vi->v->u.sValue);
-					break;
-				case TYPE_FLOAT:
-					_tprintf(TEXT("%.16f"), vi->v->u.fValue);
-					break;
-				default:
-					FormatValue(vi);
-					break;
-				}
-				_tprintf(TEXT("\n"));
-				vi = vi->next;
+			for (vi = svi; vi != NULL; vi = vi->next) {
+				OutputValue(NULL, vi);
 			}
 		}
 		FreeValueList(svi);
 	}
+	OutFlush();
 	FreeExecInfo(&ei);
 	sci->buf = NULL;
 	FreeScriptInfo(sci);
 }
 
 /*
- * _tmain - C
+ * CreateArgs - スクリプトに渡す引数の作成
+ */
+static VALUEINFO *CreateArgs(int argc, TCHAR **argv)
+{
+	VALUEINFO *vi, *pvi;
+	int i;
+
+	if (argc <= 0) {
+		return NULL;
+	}
+	// argv
+	pvi = AllocValue();
+	if (pvi == NULL) {
+		return NULL;
+	}
+	pvi->name = alloc_copy(TEXT("argv"));
+	pvi->name_hash = str2hash(TEXT("argv"));
+	pvi->v->type = TYPE_ARRAY;
+	vi = pvi->v->u.array = StringToVariable(NULL, argv[0]);
+	for (i = 1; vi != NULL && i < argc; i++) {
+		vi = vi->next = StringToVariable(NULL, argv[i]);
+	}
+	// argc
+	pvi->next = AllocValue();
+	if (pvi->next == NULL) {
+		FreeValueList(pvi);
+		return NULL;
+	}
+	pvi->next->name = alloc_copy(TEXT("argc"));
+	pvi->next->name_hash = str2hash(TEXT("argc"));
+	pvi->next->v->u.iValue = argc;
+	pvi->next->v->type = TYPE_INTEGER;
+	return pvi;
+}
+
+/*
+ * batch_func_error - バッチ実行時のエラー出力
+ */
+static int SFUNC batch_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return OutputError((JOBINFO *)ei->sci->sci_top->inst->param, param);
+}
+
+/*
+ * batch_func_print - バッチ実行時の標準出力
+ */
+static int SFUNC batch_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return OutputPrint((JOBINFO *)ei->sci->sci_top->inst->param, param);
+}
+
+/*
+ * batch_func_input - バッチ実行時の標準入力
+ *
+ *	標準入力はジョブの読み込みに使用するため空文字を返す
+ */
+static int SFUNC batch_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * SplitJobLine - ジョブの行を引数に分割
+ */
+static int SplitJobLine(TCHAR *line, TCHAR **argv)
+{
+	TCHAR *p = line;
+	int argc = 0;
+
+	while (argc < JOB_ARG_MAX) {
+		for (; *p == TEXT(' ') || *p == TEXT('\t'); p++);
+		if (*p == TEXT('\0') || *p == TEXT('\r') || *p == TEXT('\n')) {
+			break;
+		}
+		if (*p == TEXT('\"')) {
+			argv[argc++] = ++p;
+			for (; *p != TEXT('\0') && *p != TEXT('\"'); p++);
+		} else {
+			argv[argc++] = p;
+			for (; *p != TEXT('\0') && *p != TEXT(' ') && *p != TEXT('\t') && *p != TEXT('\r') && *p != TEXT('\n'); p++);
+		}
+		if (*p == TEXT('\0')) {
+			break;
+		}
+		*(p++) = TEXT('\0');
+	}
+	return argc;
+}
+
+/*
+ * AddJob - ジョブの追加
+ */
+static BOOL AddJob(JOBQUEUE *jq, TCHAR *line)
+{
+	JOBINFO *job;
+	TCHAR *p;
+
+	for (p = line; *p == TEXT(' ') || *p == TEXT('\t'); p++);
+	if (*p == TEXT('\0') || *p == TEXT('\r') || *p == TEXT('\n') || *p == TEXT('#')) {
+		// 空行とコメント
+		return TRUE;
+	}
+	if (jq->cnt % JOB_ALLOC_CNT == 0) {
+		job = (jq->job == NULL) ? mem_alloc(sizeof(JOBINFO) * JOB_ALLOC_CNT) :
+			mem_realloc(jq->job, sizeof(JOBINFO) * (jq->cnt + JOB_ALLOC_CNT));
+		if (job == NULL) {
+			return FALSE;
+		}
+		jq->job = job;
+	}
+	job = jq->job + jq->cnt;
+	ZeroMemory(job, sizeof(JOBINFO));
+	job->line = alloc_copy(p);
+	if (job->line == NULL) {
+		return FALSE;
+	}
+	job->argc = SplitJobLine(job->line, job->argv);
+	jq->cnt++;
+	return TRUE;
+}
+
+/*
+ * ReadJobs - ジョブの読み込み
+ *
+ *	path が NULL の場合は標準入力から1行1ジョブで読み込む
+ */
+static BOOL ReadJobs(JOBQUEUE *jq, TCHAR *path)
+{
+	TCHAR buf[LINE_SIZE];
+	TCHAR *mbuf, *p, *r;
+
+	if (path == NULL) {
+		while (_fgetts(buf, LINE_SIZE - 1, stdin) != NULL) {
+			if (AddJob(jq, buf) == FALSE) {
+				return FALSE;
+			}
+		}
+		return TRUE;
+	}
+	mbuf = read_file(path);
+	if (mbuf == NULL) {
+		return FALSE;
+	}
+	for (p = mbuf; *p != TEXT('\0'); p = r) {
+		for (r = p; *r != TEXT('\0') && *r != TEXT('\n'); r++);
+		if (*r == TEXT('\n')) {
+			*(r++) = TEXT('\0');
+		}
+		if (AddJob(jq, p) == FALSE) {
+			mem_free(&mbuf);
+			return FALSE;
+		}
+	}
+	mem_free(&mbuf);
+	return TRUE;
+}
+
+/*
+ * CompileJobs - ジョブのスクリプトを解析
+ *
+ *	同じスクリプトの解析結果はジョブ間で共有する (パスのハッシュで検索)
+ */
+static void CompileJobs(JOBQUEUE *jq, BOOL op_strict)
+{
+	JOBINFO *job_hash[JOB_HASH_SIZE];
+	JOBINFO *job, *pjob;
+	TCHAR dir[MAX_PATH + 1];
+	TCHAR fname[MAX_PATH + 1];
+	int i;
+
+	ZeroMemory(job_hash, sizeof(job_hash));
+	for (i = 0; i < jq->cnt; i++) {
+		job = jq->job + i;
+		if (job->argc <= 0 || lstrlen(job->argv[0]) > MAX_PATH) {
+			continue;
+		}
+#ifdef _WIN32
+		lstrcpy(fname, job->argv[0]);
+		str_lower(fname);
+		job->path_hash = str2hash(fname);
+#else
+		job->path_hash = str2hash(job->argv[0]);
+#endif
+		for (pjob = job_hash[JOB_HASH(job->path_hash)]; pjob != NULL; pjob = pjob->path_next) {
+			if (pjob->path_hash == job->path_hash && JOB_PATH_CMP(pjob->argv[0], job->argv[0]) == 0) {
+				break;
+			}
+		}
+		if (pjob != NULL) {
+			job->code = pjob->code;
+			if (job->code != NULL) {
+				AddRefCode(job->code);
+			}
+			continue;
+		}
+		job->path_next = job_hash[JOB_HASH(job->path_hash)];
+		job_hash[JOB_HASH(job->path_hash)] = job;
+
+		GetFilePathName(job->argv[0], dir, fname);
+		job->code = CompileScript(NULL, dir, fname, op_strict, !op_pg0);
+	}
+}
+
+/*
+ * RunJob - ジョブの実行
+ */
+static void RunJob(INSTANCEINFO *inst, JOBINFO *job)
+{
+	SCRIPTINFO *sci;
+	VALUEINFO *pvi;
+	VALUEINFO *rvi = NULL;
+
+	job->ret = -1;
+	if (job->code == NULL) {
+		return;
+	}
+	inst->param = job;
+	sci = CreateScriptContext(inst, job->code);
+	if (sci == NULL) {
+		return;
+	}
+	SetScriptLimit(sci, op_step, op_timeout);
+	pvi = CreateArgs(job->argc - 1, job->argv + 1);
+	job->ret = ExecScript(sci, pvi, &rvi);
+	if (job->ret == 0 && rvi != NULL && rvi->v != NULL) {
+		OutputValue(job, rvi);
+	}
+	FreeValueList(rvi);
+	FreeScriptInfo(sci);
+	inst->param = NULL;
+}
+
+/*
+ * BatchThread - バッチ実行のワーカースレッド
+ *
+ *	スレッドごとに1つのインスタンスを使用する
+ */
+static DWORD WINAPI BatchThread(LPVOID param)
+{
+	JOBQUEUE *jq = (JOBQUEUE *)param;
+	INSTANCEINFO *inst;
+	LONG i;
+
+	inst = CreateInstance();
+	if (inst != NULL) {
+		SetInstanceIO(inst, (LIBFUNC)batch_func_error, (LIBFUNC)batch_func_print, (LIBFUNC)batch_func_input);
+		SetInstanceMemoryLimit(inst, op_memory);
+		SelectInstance(inst);
+	}
+	while ((i = InterlockedIncrement(&jq->index) - 1) < jq->cnt) {
+		if (inst != NULL) {
+			RunJob(inst, jq->job + i);
+			GetInstanceMemory(inst, NULL, &(jq->job + i)->mem_peak);
+		}
+		InterlockedExchange(&(jq->job + i)->done, 1);
+		SetEvent(jq->hDone);
+	}
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+	return 0;
+}
+
+/*
+ * BatchExec - ジョブを並列に実行
+ *
+ *	出力はジョブの順番に表示する
+ */
+static int BatchExec(TCHAR *path, int thread_cnt, BOOL op_strict)
+{
+	JOBQUEUE jq;
+	JOBINFO *job;
+	HANDLE *hThread;
+	LARGE_INTEGER freq, start, end;
+	double sec;
+	SIZE_T mem_peak = 0;
+	int cnt = 0;
+	int err = 0;
+	int i;
+
+	ZeroMemory(&jq, sizeof(JOBQUEUE));
+	if (ReadJobs(&jq, path) == FALSE) {
+		_ftprintf(stderr, TEXT("%s: job read error\n"), (path != NULL) ? path : TEXT("stdin"));
+		return -1;
+	}
+	if (thread_cnt <= 0) {
+		SYSTEM_INFO si;
+		GetSystemInfo(&si);
+		thread_cnt = (int)si.dwNumberOfProcessors;
+	}
+	if (thread_cnt > jq.cnt) thread_cnt = jq.cnt;
+	if (thread_cnt > MAXIMUM_WAIT_OBJECTS) thread_cnt = MAXIMUM_WAIT_OBJECTS;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+	CompileJobs(&jq, op_strict);
+	hThread = mem_calloc(sizeof(HANDLE) * (thread_cnt + 1));
+	jq.hDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (hThread != NULL && jq.hDone != NULL) {
+		for (cnt = 0; cnt < thread_cnt; cnt++) {
+			hThread[cnt] = CreateThread(NULL, 0, BatchThread, &jq, 0, NULL);
+			if (hThread[cnt] == NULL) {
+				break;
+			}
+		}
+	}
+	if (cnt == 0) {
+		// スレッドを作成できない場合は順番に実行
+		BatchThread(&jq);
+	}
+	// ジョブの順番に出力
+	for (i = 0; i < jq.cnt; i++) {
+		job = jq.job + i;
+		while (job->done == 0) {
+			WaitForSingleObject(jq.hDone, INFINITE);
+		}
+		if (job->out != NULL) {
+			OutWrite(job->out, job->out_len);
+		}
+		if (job->ret != 0) {
+			err++;
+		}
+		if (job->mem_peak > mem_peak) {
+			mem_peak = job->mem_peak;
+		}
+		mem_free(&job->out);
+	}
+	if (cnt > 0) {
+		WaitForMultipleObjects(cnt, hThread, TRUE, INFINITE);
+		for (i = 0; i < cnt; i++) {
+			CloseHandle(hThread[i]);
+		}
+	}
+	OutFlush();
+	QueryPerformanceCounter(&end);
+	for (i = 0; i < jq.cnt; i++) {
+		ReleaseCode((jq.job + i)->code);
+		mem_free(&(jq.job + i)->line);
+	}
+	if (jq.hDone != NULL) {
+		CloseHandle(jq.hDone);
+	}
+	mem_free(&hThread);
+	mem_free(&jq.job);
+
+	sec = (freq.QuadPart != 0) ? (double)(end.QuadPart - start.QuadPart) / freq.QuadPart : 0;
+	_ftprintf(stderr, TEXT("%d jobs, %d threads, %d errors, %.3f sec, %.1f jobs/sec\n"),
+		jq.cnt, (cnt > 0) ? cnt : 1, err, sec, (sec > 0) ? jq.cnt / sec : 0);
+	if (op_stats == TRUE) {
+		_ftprintf(stderr, TEXT("memory: peak %llu bytes (per instance)\n"), (unsigned long long)mem_peak);
+	}
+	return (err > 0) ? -1 : 0;
+}
+
+/*
+ * cmp_sym - 実行回数の多い順に比較
+ */
+static int cmp_sym(const void *a, const void *b)
+{
+	LONGLONG ca = sort_stat->sym[*(const int *)a];
+	LONGLONG cb = sort_stat->sym[*(const int *)b];
+
+	return (ca < cb) ? 1 : ((ca > cb) ? -1 : 0);
+}
+
+/*
+ * PrintStats - 実行の統計を標準エラーに出力
+ */
+static void PrintStats(INSTANCEINFO *inst)
+{
+	STATINFO *stat;
+	SIZE_T size, peak;
+	LONGLONG total;
+	int idx[SYM_RETURN + 1];
+	int i;
+
+	GetInstanceMemory(inst, &size, &peak);
+	_ftprintf(stderr, TEXT("memory: current %llu bytes, peak %llu bytes\n"),
+		(unsigned long long)size, (unsigned long long)peak);
+
+	stat = GetInstanceStat(inst);
+	if (stat == NULL) {
+		return;
+	}
+	//実行したトークン (多い順)
+	total = 0;
+	for (i = 0; i <= SYM_RETURN; i++) {
+		idx[i] = i;
+		total += stat->sym[i];
+	}
+	sort_stat = stat;
+	qsort(idx, SYM_RETURN + 1, sizeof(int), cmp_sym);
+	_ftprintf(stderr, TEXT("tokens: %lld\n"), total);
+	for (i = 0; i <= SYM_RETURN && stat->sym[idx[i]] > 0; i++) {
+		_ftprintf(stderr, TEXT("  %-20s %12lld %6.2f%%\n"), sym_name[idx[i]], stat->sym[idx[i]],
+			(double)stat->sym[idx[i]] * 100 / total);
+	}
+	//確保と解放
+	_ftprintf(stderr, TEXT("objects:               alloc         free\n"));
+	for (i = 0; i < STAT_OBJ_SIZE; i++) {
+		_ftprintf(stderr, TEXT("  %-12s %12lld %12lld\n"), stat_obj_name[i], stat->alloc[i], stat->free[i]);
+	}
+	//変数の検索
+	_ftprintf(stderr, TEXT("variable lookups: %lld, frames walked %lld (avg %.2f)\n"),
+		stat->var_lookup, stat->var_depth, (stat->var_lookup > 0) ? (double)stat->var_depth / stat->var_lookup : 0);
+	for (i = 1; i < STAT_DEPTH_SIZE; i++) {
+		if (stat->var_hist[i] > 0) {
+			_ftprintf(stderr, TEXT("  depth %d%s %12lld\n"), i, (i == STAT_DEPTH_SIZE - 1) ? TEXT("+") : TEXT(" "), stat->var_hist[i]);
+		}
+	}
+	if (stat->var_hist[0] > 0) {
+		_ftprintf(stderr, TEXT("  not found %12lld\n"), stat->var_hist[0]);
+	}
+	//関数の検索
+	_ftprintf(stderr, TEXT("function calls:\n"));
+	for (i = 0; i < STAT_FUNC_SIZE; i++) {
+		_ftprintf(stderr, TEXT("  %-16s %12lld\n"), stat_func_name[i], stat->func[i]);
+	}
+	//コピー
+	_ftprintf(stderr, TEXT("copy: %lld lists, %lld elements, %lld string bytes\n"),
+		stat->copy_list, stat->copy_elem, stat->copy_bytes);
+}
+
+/*
+ * SaveProfileFiles - プロファイルの出力
+ */
+static void SaveProfileFiles(PROFILEINFO *prof, TCHAR *name)
+{
+	TCHAR report_path[MAX_PATH + 1];
+	TCHAR stack_path[MAX_PATH + 1];
+
+	if (lstrlen(name) + 8 > MAX_PATH) {
+		_ftprintf(stderr, TEXT("%s: profile name too long\n"), name);
+		return;
+	}
+	wsprintf(report_path, TEXT("%s.txt"), name);
+	wsprintf(stack_path, TEXT("%s.folded"), name);
+	if (SaveProfile(prof, report_path, stack_path) == FALSE) {
+		_ftprintf(stderr, TEXT("%s: profile write error\n"), name);
+	}
+}
+
+/*
+ * _tmain - メイン
  */
 int _tmain(int argc, TCHAR **argv)
 {
+	INSTANCEINFO *inst;
 	SCRIPTINFO *ScriptInfo;
-	VALUEINFO *vi, *pvi;
+	PROFILEINFO *prof = NULL;
+	VALUEINFO *pvi;
 	VALUEINFO *rvi = NULL;
 	TCHAR fname[MAX_PATH];
 	int i = 1;
 	int ret;
 	TCHAR *c;
 	BOOL op_strict = FALSE;
+	BOOL op_batch = FALSE;
+	int op_jobs = 0;
 
 	setlocale(LC_CTYPE, "");
+	OutInit();
 
-	if (argc > i && (*(argv[i]) == TEXT('/') || *(argv[i]) == TEXT('-'))) {
+	while (argc > i && IS_OPTION(*(argv[i]))) {
+		//並列数
+		if (lstrcmpi(argv[i] + 1, TEXT("j")) == 0 && argc > i + 1) {
+			op_jobs = _ttoi(argv[i + 1]);
+			i += 2;
+			continue;
+		}
+		//実行の上限
+		if (lstrcmpi(argv[i] + 1, TEXT("f")) == 0 && argc > i + 1) {
+			op_step = _ttoi64(argv[i + 1]);
+			i += 2;
+			continue;
+		}
+		if (lstrcmpi(argv[i] + 1, TEXT("t")) == 0 && argc > i + 1) {
+			op_timeout = (DWORD)_ttoi(argv[i + 1]);
+			i += 2;
+			continue;
+		}
+		if (lstrcmpi(argv[i] + 1, TEXT("l")) == 0 && argc > i + 1) {
+			op_memory = (SIZE_T)_ttoi64(argv[i + 1]) * 1024;
+			i += 2;
+			continue;
+		}
+		//統計
+		if (lstrcmpi(argv[i], TEXT("--stats")) == 0) {
+			op_stats = TRUE;
+			i++;
+			continue;
+		}
+		//プロファイル
+		if (lstrcmpi(argv[i], TEXT("--profile")) == 0 && argc > i + 1) {
+			op_profile = argv[i + 1];
+			i += 2;
+			continue;
+		}
+		if (lstrcmpi(argv[i], TEXT("--sample")) == 0 && argc > i + 1) {
+			op_sample = _ttoi(argv[i + 1]);
+			i += 2;
+			continue;
+		}
+		//トレース
+		if (lstrcmpi(argv[i], TEXT("--trace")) == 0 && argc > i + 1) {
+			op_trace = argv[i + 1];
+			i += 2;
+			continue;
+		}
 		//help
 		for (c = argv[i]; *c != TEXT('\0') && *c != TEXT('?'); c++);
 		if (*c != TEXT('\0')) {
 			WORD lang = PRIMARYLANGID(LANGIDFROMLCID(GetThreadLocale()));
 			if (lang == LANG_JAPANESE) {
-				_tprintf(TEXT("pg0cmd [/psxv] [file.pg0] [arg1[ arg2...]]\n"));
+				_tprintf(TEXT("pg0cmd [/psxmbv] [-j N] [-f N] [-t MS] [-l KB] [--stats] [--profile NAME [--sample HZ]] [--trace FILE] [file.pg0] [arg1[ arg2...]]\n"));
 				_tprintf(TEXT("\n"));
 				_tprintf(TEXT("  p\t\tPG0 Mode\n"));
-				_tprintf(TEXT("  s\t\tϐ錾 (ʏs)\n"));
-				_tprintf(TEXT("  x\t\tʂ16iŕ\\n"));
-				_tprintf(TEXT("  v\t\to[W\\n"));
+				_tprintf(TEXT("  s\t\t変数宣言を強制 (通常実行時)\n"));
+				_tprintf(TEXT("  x\t\t結果を16進数で表示\n"));
+				_tprintf(TEXT("  m\t\t読み込んだモジュールと読み込み時間を表示\n"));
+				_tprintf(TEXT("  b\t\tバッチ実行 (fileはジョブ一覧、省略時は標準入力)\n"));
+				_tprintf(TEXT("         \t1行に「スクリプト 引数1 引数2...」を記述\n"));
+				_tprintf(TEXT("  v\t\tバージョン表示\n"));
+				_tprintf(TEXT("  -j N\t\tバッチ実行の並列数 (省略時はCPU数)\n"));
+				_tprintf(TEXT("  -f N\t\tループの繰り返しと関数呼び出しの上限数\n"));
+				_tprintf(TEXT("  -t MS\t\t実行時間の上限 (ミリ秒)\n"));
+				_tprintf(TEXT("  -l KB\t\tメモリ使用量の上限 (バッチ実行時はワーカーごと)\n"));
+				_tprintf(TEXT("  --stats\t終了時に統計を標準エラーに表示\n"));
+				_tprintf(TEXT("  --profile NAME\tプロファイルを NAME.txt (関数と行ごとの集計) と\n"));
+				_tprintf(TEXT("         \tNAME.folded (flamegraph 用) に出力\n"));
+				_tprintf(TEXT("  --sample HZ\tプロファイルを1秒あたり HZ 回のサンプリングで取得\n"));
+				_tprintf(TEXT("  --trace FILE\t読み込み、構文解析、関数呼び出しのトレースを FILE に出力\n"));
+				_tprintf(TEXT("         \t(Chrome のトレース形式)\n"));
 				_tprintf(TEXT("\n"));
-				_tprintf(TEXT("  file.pg0\tsXNvgt@C\n"));
-				_tprintf(TEXT("         \tt@C̎w肪ꍇ̓Css\n"));
+				_tprintf(TEXT("  file.pg0\t実行するスクリプトファイル\n"));
+				_tprintf(TEXT("         \tファイル名の指定が無い場合はライン実行を行う\n"));
 				_tprintf(TEXT("\n"));
-				_tprintf(TEXT("  arg1\t\tXNvgɓn\n"));
-				_tprintf(TEXT("         \targvň̔zAargcň̐\n"));
+				_tprintf(TEXT("  arg1\t\tスクリプトに渡す引数\n"));
+				_tprintf(TEXT("         \targvで引数の配列、argcで引数の数\n"));
 				_tprintf(TEXT("\n"));
 			} else {
-				_tprintf(TEXT("pg0cmd [/psxv] [file.pg0] [arg1[ arg2...]]\n"));
+				_tprintf(TEXT("pg0cmd [/psxmbv] [-j N] [-f N] [-t MS] [-l KB] [--stats] [--profile NAME [--sample HZ]] [--trace FILE] [file.pg0] [arg1[ arg2...]]\n"));
 				_tprintf(TEXT("\n"));
 				_tprintf(TEXT("  p\t\tPG0 Mode\n"));
 				_tprintf(TEXT("  s\t\tStrict\n"));
 				_tprintf(TEXT("  x\t\tHex result\n"));
+				_tprintf(TEXT("  m\t\tList loaded modules with load time\n"));
+				_tprintf(TEXT("  b\t\tBatch mode (file is a job list, stdin if omitted)\n"));
+				_tprintf(TEXT("         \tOne \"script arg1 arg2...\" per line\n"));
 				_tprintf(TEXT("  v\t\tVersion\n"));
+				_tprintf(TEXT("  -j N\t\tBatch parallelism (default: number of CPUs)\n"));
+				_tprintf(TEXT("  -f N\t\tLimit loop iterations and function calls\n"));
+				_tprintf(TEXT("  -t MS\t\tLimit execution time (msec)\n"));
+				_tprintf(TEXT("  -l KB\t\tLimit memory usage (per worker in batch mode)\n"));
+				_tprintf(TEXT("  --stats\tPrint statistics to stderr at exit\n"));
+				_tprintf(TEXT("  --profile NAME\tWrite a profile to NAME.txt (per function and line)\n"));
+				_tprintf(TEXT("         \tand NAME.folded (collapsed stacks for flamegraph)\n"));
+				_tprintf(TEXT("  --sample HZ\tProfile by sampling HZ times per second\n"));
+				_tprintf(TEXT("  --trace FILE\tWrite load, parse and call events to FILE\n"));
+				_tprintf(TEXT("         \t(Chrome trace event format)\n"));
 				_tprintf(TEXT("\n"));
 				_tprintf(TEXT("  file.pg0\tExecution script file\n"));
 				_tprintf(TEXT("\n"));
@@ -254,7 +1012,7 @@ int _tmain(int argc, TCHAR **argv)
 					BYTE *buf = mem_alloc(size);
 					if (buf != NULL) {
 						GetFileVersionInfo(path, 0, size, buf);
-						VerQueryValue(buf, TEXT("\\"), &FileInfo, &len);
+						VerQueryValue(buf, TEXT("\\"), (LPVOID *)&FileInfo, &len);
 						wsprintf(var_msg + lstrlen(var_msg), TEXT(" Ver %d.%d.%d"),
 							HIWORD(FileInfo->dwFileVersionMS),
 							LOWORD(FileInfo->dwFileVersionMS),
@@ -281,13 +1039,39 @@ int _tmain(int argc, TCHAR **argv)
 		if (*c != '\0') {
 			op_hex = TRUE;
 		}
+		//module
+		for (c = argv[i]; *c != '\0' && *c != 'm' && *c != 'M'; c++);
+		if (*c != '\0') {
+			op_module = TRUE;
+		}
+		//batch
+		for (c = argv[i]; *c != '\0' && *c != 'b' && *c != 'B'; c++);
+		if (*c != '\0') {
+			op_batch = TRUE;
+		}
 		i++;
 	}
 
+	if (op_trace != NULL && StartTrace(op_trace) == FALSE) {
+		_ftprintf(stderr, TEXT("%s: trace open error\n"), op_trace);
+	}
+	if (op_batch == TRUE) {
+		//バッチ実行モード
+		InitializeScript();
+		ret = BatchExec((argc > i) ? argv[i] : NULL, op_jobs, op_strict);
+		StopTrace();
+		EndScript();
+#ifdef _DEBUG
+		mem_debug();
+#endif
+		return ret;
+	}
+
 	if (argc <= i) {
-		//1ss[h
+		//1行実行モード
 		InitializeScript();
 		LineExecLoop();
+		StopTrace();
 		EndScript();
 #ifdef _DEBUG
 		mem_debug();
@@ -298,85 +1082,80 @@ int _tmain(int argc, TCHAR **argv)
 	GetFilePathName(argv[i], AppDir, fname);
 	i++;
 
-	//
+	//初期化
 	InitializeScript();
+	inst = CreateInstance();
+	if (inst == NULL) {
+		StopTrace();
+		return -1;
+	}
+	SetInstanceMemoryLimit(inst, op_memory);
+	if (op_stats == TRUE) {
+		SetInstanceStat(inst, TRUE);
+	}
+	SelectInstance(inst);
 
-	//ǂݍ
-	ScriptInfo = mem_calloc(sizeof(SCRIPTINFO));
+	//読み込み
+	ScriptInfo = CreateScriptInfo(inst, op_strict, !op_pg0);
 	if (ScriptInfo == NULL) {
+		StopTrace();
+		SelectInstance(NULL);
+		DestroyInstance(inst);
 		return -1;
 	}
-	InitializeScriptInfo(ScriptInfo, op_strict, !op_pg0);
-	ScriptInfo->sci_top = ScriptInfo;
+	if (op_profile != NULL) {
+		prof = CreateProfile();
+		if (prof != NULL && op_sample > 0 && StartSampling(prof, op_sample) == FALSE) {
+			_ftprintf(stderr, TEXT("%s: sampling start error\n"), op_profile);
+		}
+		ScriptInfo->prof = prof;
+	}
+	// インポートしたスクリプトの実行も上限の対象にする
+	SetScriptLimit(ScriptInfo, op_step, op_timeout);
 	ReadScriptFile(ScriptInfo, AppDir, fname);
 	if (ScriptInfo->tk == NULL) {
+		ret = (ScriptInfo->limit_over == TRUE) ? RET_LIMIT : -1;
+		OutFlush();
+		StopTrace();
+		FreeProfile(prof);
 		FreeScriptInfo(ScriptInfo);
+		SelectInstance(NULL);
+		DestroyInstance(inst);
 #ifdef _DEBUG
 		mem_debug();
 #endif
-		return -1;
+		return ret;
 	}
 
-	//
-	if (argc <= i) {
-		pvi = NULL;
-	} else {
-		int arg_cnt = argc - i;
-		// argv
-		pvi = AllocValue();
-		if (pvi == NULL) {
-			return -1;
-		}
-		pvi->name = alloc_copy(TEXT("argv"));
-		pvi->name_hash = str2hash(TEXT("argv"));
-		pvi->v->type = TYPE_ARRAY;
-		vi = pvi->v->u.array = StringToVariable(NULL, argv[i]);
-		for (i++; i < argc; i++) {
-			vi = vi->next = StringToVariable(NULL, argv[i]);
-		}
-		// argc
-		pvi->next = AllocValue();
-		if (pvi->next == NULL) {
-			return -1;
-		}
-		pvi->next->name = alloc_copy(TEXT("argc"));
-		pvi->next->name_hash = str2hash(TEXT("argc"));
-		pvi->next->v->u.iValue = arg_cnt;
-		pvi->next->v->type = TYPE_INTEGER;
-	}
-	//߂l̊m
+	//引数
+	pvi = CreateArgs(argc - i, argv + i);
+	//戻り値の確保
 	rvi = NULL;
 	ret = ExecScript(ScriptInfo, pvi, &rvi);
-	if (ret != -1 && rvi != NULL && rvi->v != NULL) {
-		switch (rvi->v->type) {
-		case TYPE_ARRAY:
-		{
-			int size = ArrayToStringSize(rvi->v->u.array, op_hex);
-			TCHAR *str = (TCHAR *)mem_alloc(sizeof(TCHAR) * (size + 1));
-			if (str != NULL) {
-				ArrayToString(rvi->v->u.array, str, op_hex);
-				_tprintf(TEXT("%s"), str);
-				mem_free(&str);
-			}
-		}
-			break;
-		case TYPE_STRING:
-			_tprintf(TEXT("%s"), rvi->v->u.sValue);
-			break;
-		case TYPE_FLOAT:
-			_tprintf(TEXT("%.16f"), rvi->v->u.fValue);
-			break;
-		default:
-			FormatValue(rvi);
-			break;
-		}
-		_tprintf(TEXT("\n"));
+	StopTrace();
+	if (ret == 0 && rvi != NULL && rvi->v != NULL) {
+		OutputValue(NULL, rvi);
 	}
+	OutFlush();
 	FreeValueList(rvi);
+	if (op_module == TRUE) {
+		PrintModuleList(ScriptInfo);
+	}
+	if (prof != NULL) {
+		StopSampling(prof);
+		SaveProfileFiles(prof, op_profile);
+		FreeProfile(prof);
+	}
 	FreeScriptInfo(ScriptInfo);
+	if (op_stats == TRUE) {
+		// スクリプト情報の解放後に出力して確保と解放の数を対応させる
+		PrintStats(inst);
+	}
+	SelectInstance(NULL);
+	DestroyInstance(inst);
 	EndScript();
 #ifdef _DEBUG
 	mem_debug();
 #endif
-	return 0;
+	return (ret == RET_LIMIT || ret == RET_ERROR) ? ret : 0;
 }
\ No newline at end of file
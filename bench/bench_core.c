@@ -0,0 +1,465 @@
+/*
+ * PG0 bench
+ *
+ * bench_core.c
+ *
+ *	インタプリタのコア関数単体の速度を計測する
+ *	1回あたりの時間とサイクル数を表示し、Linux では perf_event_open による
+ *	命令数、分岐予測ミス、キャッシュミスも表示する
+ *
+ *	cl /O2 /DUNICODE /D_UNICODE /DPG0_CMD bench_core.c ..\PG0\script_*.c ..\PG0\func_std.c ..\PG0\functbl.c
+ *	bench_core [count]
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define DEFAULT_COUNT		100000
+#define PERF_CNT			3
+
+/* Global Variables */
+//計測値
+typedef struct _COUNTER {
+	LARGE_INTEGER start;
+	LARGE_INTEGER end;
+	ULONGLONG cycle_start;
+	ULONGLONG cycle_end;
+	//命令数、分岐予測ミス、キャッシュミス (取得できない場合は0)
+	ULONGLONG perf[PERF_CNT];
+	BOOL perf_valid;
+} COUNTER;
+
+static LARGE_INTEGER freq;
+#ifdef __linux__
+static int perf_fd[PERF_CNT] = { -1, -1, -1 };
+#endif
+
+//構文解析の入力
+static TCHAR *parse_src =
+	TEXT("s = 0\n")
+	TEXT("for (i = 0; i < 10; i++) {\n")
+	TEXT("\tif (i % 2 == 0) {\n")
+	TEXT("\t\ts += i * 3 + 1\n")
+	TEXT("\t} else {\n")
+	TEXT("\t\ts -= i\n")
+	TEXT("\t}\n")
+	TEXT("}\n")
+	TEXT("a[] = {1, 2, \"abc\", {\"key\": 10}}\n")
+	TEXT("str = \"value: \" + s + a[2]\n");
+
+//実行する解析木の入力
+static TCHAR *exec_src =
+	TEXT("s = 0\n")
+	TEXT("for (i = 0; i < 100; i++) {\n")
+	TEXT("\ts += i * 2\n")
+	TEXT("}\n");
+
+//制御文字の変換の入力
+static TCHAR *ctrl_src = TEXT("line1\\nline2\\tTab \\\"quoted\\\" \\x41\\101 end\\r\\n");
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		_ftprintf(stderr, TEXT("%s\n"), param->v->u.sValue);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (計測中は出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * get_cycle - サイクル数の取得
+ */
+static ULONGLONG get_cycle(void)
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+/*
+ * PerfOpen - ハードウェアカウンタの準備 (Linux)
+ */
+static void PerfOpen(void)
+{
+#ifdef __linux__
+	static const unsigned long long config[PERF_CNT] = {
+		PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES,
+	};
+	struct perf_event_attr attr;
+	int i;
+
+	for (i = 0; i < PERF_CNT; i++) {
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = config[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		perf_fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+#endif
+}
+
+/*
+ * PerfClose - ハードウェアカウンタの終了 (Linux)
+ */
+static void PerfClose(void)
+{
+#ifdef __linux__
+	int i;
+
+	for (i = 0; i < PERF_CNT; i++) {
+		if (perf_fd[i] >= 0) {
+			close(perf_fd[i]);
+			perf_fd[i] = -1;
+		}
+	}
+#endif
+}
+
+/*
+ * CounterStart - 計測の開始
+ */
+static void CounterStart(COUNTER *c)
+{
+#ifdef __linux__
+	int i;
+
+	for (i = 0; i < PERF_CNT; i++) {
+		if (perf_fd[i] >= 0) {
+			ioctl(perf_fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(perf_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+	QueryPerformanceCounter(&c->start);
+	c->cycle_start = get_cycle();
+}
+
+/*
+ * CounterStop - 計測の終了
+ */
+static void CounterStop(COUNTER *c)
+{
+#ifdef __linux__
+	unsigned long long v;
+	int i;
+#endif
+
+	c->cycle_end = get_cycle();
+	QueryPerformanceCounter(&c->end);
+	c->perf_valid = FALSE;
+#ifdef __linux__
+	c->perf_valid = TRUE;
+	for (i = 0; i < PERF_CNT; i++) {
+		c->perf[i] = 0;
+		if (perf_fd[i] < 0) {
+			c->perf_valid = FALSE;
+			continue;
+		}
+		ioctl(perf_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		if (read(perf_fd[i], &v, sizeof(v)) == sizeof(v)) {
+			c->perf[i] = v;
+		}
+	}
+#endif
+}
+
+/*
+ * Report - 計測結果の表示
+ */
+static void Report(TCHAR *title, COUNTER *c, int cnt)
+{
+	double nsec;
+
+	if (cnt <= 0) {
+		return;
+	}
+	nsec = (double)(c->end.QuadPart - c->start.QuadPart) * 1000000000.0 / (double)freq.QuadPart / cnt;
+	_tprintf(TEXT("%-22s %10d %12.1f %12.1f"), title, cnt, nsec, (double)(c->cycle_end - c->cycle_start) / cnt);
+	if (c->perf_valid == TRUE) {
+		_tprintf(TEXT(" %12.1f %10.2f %10.2f"),
+			(double)c->perf[0] / cnt, (double)c->perf[1] / cnt, (double)c->perf[2] / cnt);
+	}
+	_tprintf(TEXT("\n"));
+}
+
+/*
+ * CreateIntList - 整数のN要素の配列を作成
+ */
+static VALUEINFO *CreateIntList(int n)
+{
+	VALUEINFO top, *vi;
+	int i;
+
+	top.next = NULL;
+	vi = &top;
+	for (i = 0; i < n; i++) {
+		vi = vi->next = AllocValue();
+		if (vi == NULL) {
+			break;
+		}
+		vi->v->u.iValue = i;
+		vi->v->type = TYPE_INTEGER;
+	}
+	return top.next;
+}
+
+/*
+ * BenchParse - ParseSentence
+ */
+static void BenchParse(SCRIPTINFO *sci, int cnt)
+{
+	COUNTER c;
+	EXECINFO ei;
+	TOKEN *tk;
+	int i;
+
+	ZeroMemory(&ei, sizeof(EXECINFO));
+	ei.sci = sci;
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		tk = ParseSentence(&ei, parse_src, 0);
+		FreeToken(tk);
+	}
+	CounterStop(&c);
+	Report(TEXT("ParseSentence"), &c, cnt);
+}
+
+/*
+ * BenchExec - 解析済みの ExecSentense
+ */
+static void BenchExec(SCRIPTINFO *sci, int cnt)
+{
+	COUNTER c;
+	EXECINFO ei;
+	TOKEN *tk;
+	VALUEINFO *rvi;
+	int i;
+
+	ZeroMemory(&ei, sizeof(EXECINFO));
+	ei.sci = sci;
+	tk = ParseSentence(&ei, exec_src, 0);
+	if (tk == NULL) {
+		return;
+	}
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		ZeroMemory(&ei, sizeof(EXECINFO));
+		ei.sci = sci;
+		rvi = NULL;
+		ExecSentense(&ei, tk, &rvi, NULL);
+		FreeValueList(rvi);
+		FreeExecInfo(&ei);
+	}
+	CounterStop(&c);
+	FreeToken(tk);
+	Report(TEXT("ExecSentense"), &c, cnt);
+}
+
+/*
+ * BenchAlloc - AllocValue/FreeValue
+ */
+static void BenchAlloc(int cnt)
+{
+	COUNTER c;
+	VALUEINFO *vi[16];
+	int i, j;
+
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		for (j = 0; j < 16; j++) {
+			vi[j] = AllocValue();
+		}
+		for (j = 0; j < 16; j++) {
+			FreeValue(vi[j]);
+		}
+	}
+	CounterStop(&c);
+	Report(TEXT("AllocValue/FreeValue"), &c, cnt * 16);
+}
+
+/*
+ * BenchCopy - N要素の CopyValueList
+ */
+static void BenchCopy(int n, int cnt)
+{
+	COUNTER c;
+	VALUEINFO *from, *to;
+	TCHAR title[BUF_SIZE];
+	int i;
+
+	from = CreateIntList(n);
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		to = CopyValueList(from);
+		FreeValueList(to);
+	}
+	CounterStop(&c);
+	FreeValueList(from);
+	wsprintf(title, TEXT("CopyValueList(%d)"), n);
+	Report(title, &c, cnt);
+}
+
+/*
+ * BenchArrayToString - ArrayToString
+ */
+static void BenchArrayToString(int n, int cnt)
+{
+	COUNTER c;
+	VALUEINFO *vi;
+	TCHAR title[BUF_SIZE];
+	TCHAR *buf;
+	int i;
+
+	vi = CreateIntList(n);
+	buf = mem_alloc(sizeof(TCHAR) * (ArrayToStringSize(vi, FALSE) + 1));
+	if (buf == NULL) {
+		FreeValueList(vi);
+		return;
+	}
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		ArrayToString(vi, buf, FALSE);
+	}
+	CounterStop(&c);
+	mem_free(&buf);
+	FreeValueList(vi);
+	wsprintf(title, TEXT("ArrayToString(%d)"), n);
+	Report(title, &c, cnt);
+}
+
+/*
+ * BenchHash - str2hash
+ */
+static void BenchHash(int cnt)
+{
+	static TCHAR *names[] = {
+		TEXT("i"), TEXT("count"), TEXT("argv"), TEXT("ArrayToString"), TEXT("very_long_variable_name_for_hash"),
+	};
+	COUNTER c;
+	volatile int h = 0;
+	int i, j;
+
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		for (j = 0; j < sizeof(names) / sizeof(TCHAR *); j++) {
+			h += str2hash(names[j]);
+		}
+	}
+	CounterStop(&c);
+	Report(TEXT("str2hash"), &c, cnt * (int)(sizeof(names) / sizeof(TCHAR *)));
+}
+
+/*
+ * BenchConvCtrl - conv_ctrl (入力のコピーを含む)
+ */
+static void BenchConvCtrl(int cnt)
+{
+	COUNTER c;
+	TCHAR buf[BUF_SIZE];
+	int i;
+
+	CounterStart(&c);
+	for (i = 0; i < cnt; i++) {
+		lstrcpy(buf, ctrl_src);
+		conv_ctrl(buf);
+	}
+	CounterStop(&c);
+	Report(TEXT("conv_ctrl"), &c, cnt);
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	INSTANCEINFO *inst;
+	SCRIPTINFO *sci;
+	int cnt = DEFAULT_COUNT;
+
+	if (argc > 1) {
+		cnt = _ttoi(argv[1]);
+	}
+	QueryPerformanceFrequency(&freq);
+	PerfOpen();
+
+	InitializeScript();
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return 1;
+	}
+	SelectInstance(inst);
+	sci = CreateScriptInfo(inst, FALSE, TRUE);
+	if (sci == NULL) {
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return 1;
+	}
+
+	_tprintf(TEXT("%-22s %10s %12s %12s %12s %10s %10s\n"), TEXT("function"), TEXT("count"),
+		TEXT("nsec/op"), TEXT("cycles/op"), TEXT("inst/op"), TEXT("br-miss"), TEXT("cache-miss"));
+	BenchParse(sci, cnt / 10);
+	BenchExec(sci, cnt / 100);
+	BenchAlloc(cnt);
+	BenchCopy(10, cnt);
+	BenchCopy(100, cnt / 10);
+	BenchCopy(1000, cnt / 100);
+	BenchArrayToString(100, cnt / 10);
+	BenchHash(cnt * 10);
+	BenchConvCtrl(cnt);
+
+	FreeScriptInfo(sci);
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+	EndScript();
+	PerfClose();
+	return 0;
+}
+/* End of source */
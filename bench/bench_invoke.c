@@ -0,0 +1,246 @@
+/*
+ * PG0 bench
+ *
+ * bench_invoke.c
+ *
+ *	準備済みスクリプトの繰り返し実行の速度を計測する
+ *	callback はデバッガのコールバックを設定した場合の速度
+ *
+ *	cl /O2 /DUNICODE /D_UNICODE /DPG0_CMD bench_invoke.c ..\PG0\script_*.c ..\PG0\func_std.c ..\PG0\functbl.c
+ *	bench_invoke [script] [count]
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define DEFAULT_SCRIPT		TEXT("invoke.pg0")
+#define DEFAULT_COUNT		100000
+#define FUNC_NAME			TEXT("score")
+
+/* Global Variables */
+TCHAR AppDir[MAX_PATH + 1];
+static LARGE_INTEGER freq;
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		_ftprintf(stderr, TEXT("%s\n"), param->v->u.sValue);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (計測中は出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * BenchCallback - 何もしないコールバック
+ */
+static int SFUNC BenchCallback(EXECINFO *ei, TOKEN *tk)
+{
+	return 0;
+}
+
+/*
+ * CreateParam - トップレベルに渡す変数 argv と argc の作成 (引数は整数1つ)
+ */
+static VALUEINFO *CreateParam(int i)
+{
+	VALUEINFO *vi;
+
+	vi = AllocValue();
+	if (vi == NULL) {
+		return NULL;
+	}
+	vi->next = AllocValue();
+	vi->v->u.array = AllocValue();
+	if (vi->next == NULL || vi->v->u.array == NULL) {
+		FreeValueList(vi);
+		return NULL;
+	}
+	vi->name = alloc_copy(TEXT("argv"));
+	vi->name_hash = str2hash(TEXT("argv"));
+	vi->v->type = TYPE_ARRAY;
+	vi->v->u.array->v->u.iValue = i;
+	vi->v->u.array->v->type = TYPE_INTEGER;
+	vi->next->name = alloc_copy(TEXT("argc"));
+	vi->next->name_hash = str2hash(TEXT("argc"));
+	vi->next->v->u.iValue = 1;
+	vi->next->v->type = TYPE_INTEGER;
+	return vi;
+}
+
+/*
+ * Report - 計測結果の表示
+ */
+static void Report(TCHAR *title, LARGE_INTEGER *start, LARGE_INTEGER *end, int cnt, int err)
+{
+	double sec;
+
+	sec = (double)(end->QuadPart - start->QuadPart) / (double)freq.QuadPart;
+	_tprintf(TEXT("%-10s %10d runs %8.3f sec %12.0f runs/sec %8.3f usec/run"),
+		title, cnt, sec, (sec > 0) ? cnt / sec : 0.0, (cnt > 0) ? sec * 1000000.0 / cnt : 0.0);
+	if (err > 0) {
+		_tprintf(TEXT(" (%d errors)"), err);
+	}
+	_tprintf(TEXT("\n"));
+}
+
+/*
+ * BenchContext - 実行ごとにコンテキストを作成して解放
+ */
+static void BenchContext(INSTANCEINFO *inst, CODEINFO *code, int cnt, LIBFUNC callback)
+{
+	LARGE_INTEGER start, end;
+	SCRIPTINFO *sci;
+	VALUEINFO *rvi;
+	int err = 0;
+	int i;
+
+	QueryPerformanceCounter(&start);
+	for (i = 0; i < cnt; i++) {
+		sci = CreateScriptContext(inst, code);
+		if (sci == NULL) {
+			err++;
+			continue;
+		}
+		sci->callback = callback;
+		rvi = NULL;
+		if (ExecScript(sci, CreateParam(i % 16), &rvi) != 0) {
+			err++;
+		}
+		FreeValueList(rvi);
+		FreeScriptInfo(sci);
+	}
+	QueryPerformanceCounter(&end);
+	Report((callback != NULL) ? TEXT("callback") : TEXT("context"), &start, &end, cnt, err);
+}
+
+/*
+ * BenchInvoke - 準備済みスクリプトのトップレベルを実行
+ */
+static void BenchInvoke(PREPAREINFO *pp, int cnt)
+{
+	LARGE_INTEGER start, end;
+	VALUE argv[1];
+	VALUE *rv;
+	int err = 0;
+	int i;
+
+	ZeroMemory(argv, sizeof(argv));
+	argv[0].type = TYPE_INTEGER;
+	QueryPerformanceCounter(&start);
+	for (i = 0; i < cnt; i++) {
+		argv[0].u.iValue = i % 16;
+		if (InvokeScript(pp, NULL, argv, 1, &rv) != 0) {
+			err++;
+		}
+	}
+	QueryPerformanceCounter(&end);
+	ResetPrepared(pp);
+	Report(TEXT("invoke"), &start, &end, cnt, err);
+}
+
+/*
+ * BenchFunction - 準備済みスクリプトの関数を実行
+ */
+static void BenchFunction(PREPAREINFO *pp, int cnt)
+{
+	LARGE_INTEGER start, end;
+	VALUE argv[2];
+	VALUE *rv;
+	int err = 0;
+	int i;
+
+	ZeroMemory(argv, sizeof(argv));
+	argv[0].type = TYPE_INTEGER;
+	argv[1].type = TYPE_INTEGER;
+	argv[1].u.iValue = 3;
+	QueryPerformanceCounter(&start);
+	for (i = 0; i < cnt; i++) {
+		argv[0].u.iValue = i % 16;
+		if (InvokeScript(pp, FUNC_NAME, argv, 2, &rv) != 0 || rv == NULL) {
+			err++;
+		}
+	}
+	QueryPerformanceCounter(&end);
+	ResetPrepared(pp);
+	Report(TEXT("function"), &start, &end, cnt, err);
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	INSTANCEINFO *inst;
+	CODEINFO *code;
+	PREPAREINFO *pp;
+	TCHAR *path = DEFAULT_SCRIPT;
+	TCHAR name[MAX_PATH + 1];
+	int cnt = DEFAULT_COUNT;
+
+	if (argc > 1) {
+		path = argv[1];
+	}
+	if (argc > 2) {
+		cnt = _ttoi(argv[2]);
+	}
+	GetFilePathName(path, AppDir, name);
+	QueryPerformanceFrequency(&freq);
+
+	InitializeScript();
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return 1;
+	}
+	SelectInstance(inst);
+	code = CompileScript(inst, AppDir, name, FALSE, TRUE);
+	if (code == NULL) {
+		_ftprintf(stderr, TEXT("%s: compile error\n"), path);
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		EndScript();
+		return 1;
+	}
+	pp = PrepareScript(inst, code);
+	if (pp != NULL) {
+		BenchContext(inst, code, cnt, NULL);
+		BenchContext(inst, code, cnt, (LIBFUNC)BenchCallback);
+		BenchInvoke(pp, cnt);
+		BenchFunction(pp, cnt);
+		FreePrepared(pp);
+	}
+	ReleaseCode(code);
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+	EndScript();
+	return 0;
+}
+/* End of source */
@@ -0,0 +1,365 @@
+/*
+ * PG0 bench
+ *
+ * bench_run.c
+ *
+ *	ベンチマークスイートの実行と基準値との比較
+ *	suite.txt に記載したスクリプトを読み込みから実行まで繰り返し計測し、
+ *	実行時間の中央値と95パーセンタイル、確保回数、メモリ使用量の最大値を表示する
+ *
+ *	cl /O2 /DUNICODE /D_UNICODE /DPG0_CMD bench_run.c ..\PG0\script_*.c ..\PG0\func_std.c ..\PG0\functbl.c
+ *	bench_run [-w N] [-n N] [-o result.json] [-b baseline.json] [-r PCT] [suite\suite.txt]
+ *
+ *	-w N	計測前に捨てる実行回数
+ *	-n N	計測する実行回数
+ *	-o	結果をJSONで出力 (-b の基準値として使用できる)
+ *	-b	基準値と比較し、中央値が PCT% を超えて遅い場合と確保回数が増えた場合は
+ *		REGRESSION を表示して終了コード 1 を返す
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define DEFAULT_SUITE		TEXT("suite\\suite.txt")
+#define DEFAULT_WARMUP		2
+#define DEFAULT_COUNT		10
+#define DEFAULT_THRESHOLD	5.0
+#define BENCH_MAX			64
+
+/* Global Variables */
+//ベンチマークの結果
+typedef struct _BENCHRESULT {
+	TCHAR name[MAX_PATH + 1];
+	TCHAR expect[BUF_SIZE];
+	double median;
+	double p95;
+	LONGLONG allocs;
+	SIZE_T peak;
+	BOOL error;
+} BENCHRESULT;
+
+TCHAR AppDir[MAX_PATH + 1];
+static LARGE_INTEGER freq;
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		_ftprintf(stderr, TEXT("%s\n"), param->v->u.sValue);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (計測中は出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * cmp_double - 実行時間の比較
+ */
+static int cmp_double(const void *a, const void *b)
+{
+	double da = *(const double *)a;
+	double db = *(const double *)b;
+
+	return (da < db) ? -1 : ((da > db) ? 1 : 0);
+}
+
+/*
+ * RunOnce - スクリプトを新しいインスタンスで1回実行
+ *
+ *	実行時間 (マイクロ秒) を返す、エラー時は -1
+ */
+static double RunOnce(TCHAR *dir, BENCHRESULT *br, BOOL stat, BOOL check)
+{
+	INSTANCEINFO *inst;
+	SCRIPTINFO *sci;
+	STATINFO *st;
+	VALUEINFO *rvi = NULL;
+	LARGE_INTEGER start, end;
+	TCHAR *buf;
+	int ret;
+	int i;
+
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return -1;
+	}
+	if (stat == TRUE) {
+		SetInstanceStat(inst, TRUE);
+	}
+	SelectInstance(inst);
+
+	QueryPerformanceCounter(&start);
+	sci = CreateScriptInfo(inst, FALSE, TRUE);
+	ret = -1;
+	if (sci != NULL) {
+		ReadScriptFile(sci, dir, br->name);
+		if (sci->tk != NULL) {
+			ret = ExecScript(sci, NULL, &rvi);
+		}
+	}
+	QueryPerformanceCounter(&end);
+
+	if (ret == 0 && check == TRUE && *br->expect != TEXT('\0')) {
+		buf = VariableToString(rvi);
+		if (buf == NULL || lstrcmp(buf, br->expect) != 0) {
+			_ftprintf(stderr, TEXT("%s: result %s, expected %s\n"),
+				br->name, (buf != NULL) ? buf : TEXT(""), br->expect);
+			ret = -1;
+		}
+		mem_free(&buf);
+	}
+	FreeValueList(rvi);
+	if (sci != NULL) {
+		FreeScriptInfo(sci);
+	}
+	if (stat == TRUE && (st = GetInstanceStat(inst)) != NULL) {
+		br->allocs = 0;
+		for (i = 0; i < STAT_OBJ_SIZE; i++) {
+			br->allocs += st->alloc[i];
+		}
+	}
+	GetInstanceMemory(inst, NULL, &br->peak);
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+	if (ret != 0) {
+		return -1;
+	}
+	return (double)(end.QuadPart - start.QuadPart) * 1000000.0 / (double)freq.QuadPart;
+}
+
+/*
+ * RunBench - 1つのスクリプトの計測
+ */
+static void RunBench(TCHAR *dir, BENCHRESULT *br, int warmup, int cnt)
+{
+	double *t;
+	int i;
+
+	// 確保回数の集計と結果の確認 (統計の集計は実行速度に影響するため計測しない)
+	if (RunOnce(dir, br, TRUE, TRUE) < 0) {
+		br->error = TRUE;
+		return;
+	}
+	for (i = 0; i < warmup; i++) {
+		RunOnce(dir, br, FALSE, FALSE);
+	}
+	t = mem_alloc(sizeof(double) * cnt);
+	if (t == NULL) {
+		br->error = TRUE;
+		return;
+	}
+	for (i = 0; i < cnt; i++) {
+		t[i] = RunOnce(dir, br, FALSE, FALSE);
+		if (t[i] < 0) {
+			br->error = TRUE;
+			mem_free(&t);
+			return;
+		}
+	}
+	qsort(t, cnt, sizeof(double), cmp_double);
+	br->median = (cnt % 2 == 0) ? (t[cnt / 2 - 1] + t[cnt / 2]) / 2 : t[cnt / 2];
+	br->p95 = t[(cnt * 95 + 99) / 100 - 1];
+	mem_free(&t);
+}
+
+/*
+ * ReadSuite - スイートの読み込み
+ *
+ *	1行に「スクリプト [期待する結果]」を記述、// で始まる行はコメント
+ */
+static int ReadSuite(TCHAR *path, BENCHRESULT *br)
+{
+	TCHAR *buf, *p, *s;
+	int cnt = 0;
+
+	buf = read_file(path);
+	if (buf == NULL) {
+		return -1;
+	}
+	for (p = buf; *p != TEXT('\0') && cnt < BENCH_MAX; ) {
+		for (; *p == TEXT(' ') || *p == TEXT('\t') || *p == TEXT('\r') || *p == TEXT('\n'); p++);
+		if (*p == TEXT('\0')) {
+			break;
+		}
+		if (*p == TEXT('/') && *(p + 1) == TEXT('/')) {
+			for (; *p != TEXT('\0') && *p != TEXT('\n'); p++);
+			continue;
+		}
+		ZeroMemory(br + cnt, sizeof(BENCHRESULT));
+		for (s = p; *p != TEXT('\0') && *p != TEXT(' ') && *p != TEXT('\t') && *p != TEXT('\r') && *p != TEXT('\n'); p++);
+		lstrcpyn(br[cnt].name, s, (int)(p - s + 1 > MAX_PATH ? MAX_PATH : p - s + 1));
+		for (; *p == TEXT(' ') || *p == TEXT('\t'); p++);
+		for (s = p; *p != TEXT('\0') && *p != TEXT(' ') && *p != TEXT('\t') && *p != TEXT('\r') && *p != TEXT('\n'); p++);
+		lstrcpyn(br[cnt].expect, s, (int)(p - s + 1 > BUF_SIZE ? BUF_SIZE : p - s + 1));
+		for (; *p != TEXT('\0') && *p != TEXT('\n'); p++);
+		cnt++;
+	}
+	mem_free(&buf);
+	return cnt;
+}
+
+/*
+ * WriteResult - 結果をJSONで出力
+ *
+ *	基準値の読み込みを簡単にするため1行に1つのベンチマークを出力する
+ */
+static BOOL WriteResult(TCHAR *path, BENCHRESULT *br, int cnt)
+{
+	FILE *fp;
+	BOOL first = TRUE;
+	int i;
+
+	fp = _tfopen(path, TEXT("w"));
+	if (fp == NULL) {
+		return FALSE;
+	}
+	_ftprintf(fp, TEXT("{\"benchmarks\":[\n"));
+	for (i = 0; i < cnt; i++) {
+		if (br[i].error == TRUE) {
+			continue;
+		}
+		_ftprintf(fp, TEXT("%s{\"name\":\"%s\",\"median_us\":%.1f,\"p95_us\":%.1f,\"allocs\":%lld,\"peak_bytes\":%llu}"),
+			(first == TRUE) ? TEXT("") : TEXT(",\n"),
+			br[i].name, br[i].median, br[i].p95, br[i].allocs, (unsigned long long)br[i].peak);
+		first = FALSE;
+	}
+	_ftprintf(fp, TEXT("\n]}\n"));
+	fclose(fp);
+	return TRUE;
+}
+
+/*
+ * GetBaseline - 基準値から名前の一致する値を取得
+ */
+static BOOL GetBaseline(TCHAR *buf, TCHAR *name, TCHAR *key, double *ret)
+{
+	TCHAR tmp[MAX_PATH + 32];
+	TCHAR *p, *q;
+
+	wsprintf(tmp, TEXT("\"name\":\"%s\""), name);
+	p = _tcsstr(buf, tmp);
+	if (p == NULL) {
+		return FALSE;
+	}
+	for (q = p; *q != TEXT('\0') && *q != TEXT('\n'); q++);
+	wsprintf(tmp, TEXT("\"%s\":"), key);
+	p = _tcsstr(p, tmp);
+	if (p == NULL || p > q) {
+		return FALSE;
+	}
+	*ret = _tcstod(p + lstrlen(tmp), NULL);
+	return TRUE;
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	BENCHRESULT br[BENCH_MAX];
+	TCHAR *suite = DEFAULT_SUITE;
+	TCHAR *out = NULL;
+	TCHAR *base = NULL;
+	TCHAR *base_buf = NULL;
+	TCHAR name[MAX_PATH + 1];
+	double threshold = DEFAULT_THRESHOLD;
+	double bm, ba;
+	int warmup = DEFAULT_WARMUP;
+	int cnt = DEFAULT_COUNT;
+	int bench_cnt;
+	int regress = 0;
+	int err = 0;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (lstrcmp(argv[i], TEXT("-w")) == 0 && i + 1 < argc) {
+			warmup = _ttoi(argv[++i]);
+		} else if (lstrcmp(argv[i], TEXT("-n")) == 0 && i + 1 < argc) {
+			cnt = _ttoi(argv[++i]);
+		} else if (lstrcmp(argv[i], TEXT("-o")) == 0 && i + 1 < argc) {
+			out = argv[++i];
+		} else if (lstrcmp(argv[i], TEXT("-b")) == 0 && i + 1 < argc) {
+			base = argv[++i];
+		} else if (lstrcmp(argv[i], TEXT("-r")) == 0 && i + 1 < argc) {
+			threshold = _tcstod(argv[++i], NULL);
+		} else {
+			suite = argv[i];
+		}
+	}
+	if (cnt <= 0) {
+		cnt = 1;
+	}
+	GetFilePathName(suite, AppDir, name);
+	QueryPerformanceFrequency(&freq);
+
+	InitializeScript();
+	bench_cnt = ReadSuite(suite, br);
+	if (bench_cnt < 0) {
+		_ftprintf(stderr, TEXT("%s: open error\n"), suite);
+		EndScript();
+		return 1;
+	}
+	if (base != NULL && (base_buf = read_file(base)) == NULL) {
+		_ftprintf(stderr, TEXT("%s: open error\n"), base);
+	}
+
+	_tprintf(TEXT("%-20s %12s %12s %12s %12s\n"), TEXT("script"), TEXT("median(us)"), TEXT("p95(us)"), TEXT("allocs"), TEXT("peak(bytes)"));
+	for (i = 0; i < bench_cnt; i++) {
+		RunBench(AppDir, br + i, warmup, cnt);
+		if (br[i].error == TRUE) {
+			_tprintf(TEXT("%-20s error\n"), br[i].name);
+			err++;
+			continue;
+		}
+		_tprintf(TEXT("%-20s %12.1f %12.1f %12lld %12llu"), br[i].name,
+			br[i].median, br[i].p95, br[i].allocs, (unsigned long long)br[i].peak);
+		if (base_buf != NULL && GetBaseline(base_buf, br[i].name, TEXT("median_us"), &bm) == TRUE && bm > 0) {
+			_tprintf(TEXT("  %+6.1f%%"), (br[i].median - bm) * 100 / bm);
+			if (br[i].median > bm * (1 + threshold / 100)) {
+				_tprintf(TEXT(" REGRESSION(time)"));
+				regress++;
+			}
+			if (GetBaseline(base_buf, br[i].name, TEXT("allocs"), &ba) == TRUE && (double)br[i].allocs > ba) {
+				_tprintf(TEXT(" REGRESSION(allocs)"));
+				regress++;
+			}
+		}
+		_tprintf(TEXT("\n"));
+	}
+	mem_free(&base_buf);
+	if (out != NULL && WriteResult(out, br, bench_cnt) == FALSE) {
+		_ftprintf(stderr, TEXT("%s: write error\n"), out);
+		err++;
+	}
+	EndScript();
+	return (regress > 0 || err > 0) ? 1 : 0;
+}
+/* End of source */
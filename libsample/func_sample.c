@@ -24,7 +24,17 @@
 /* Local Function Prototypes */
 
 /*
- * _lib_func_sum - 2̐l̑Z
+ * _lib_version - ライブラリのインターフェースのバージョン
+ *
+ *	インタプリタと異なるバージョンのライブラリは読み込まれない
+ */
+int SFUNC _lib_version(void)
+{
+	return LIB_VERSION;
+}
+
+/*
+ * _lib_func_sum - 2つの数値の足し算
  */
 int SFUNC _lib_func_sum(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -46,7 +56,7 @@ int SFUNC _lib_func_sum(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *E
 }
 
 /*
- * _lib_func_tolower - 񒆂̉p啶ɕϊ
+ * _lib_func_tolower - 文字列中の英大文字を小文字に変換
  */
 int SFUNC _lib_func_tolower(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -72,7 +82,7 @@ int SFUNC _lib_func_tolower(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHA
 }
 
 /*
- * _lib_func_toupper - 񒆂̉p啶啶ɕϊ
+ * _lib_func_toupper - 文字列中の英大文字を大文字に変換
  */
 int SFUNC _lib_func_toupper(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
 {
@@ -0,0 +1,25 @@
+/*
+ * PG0
+ *
+ * posix/io.h
+ *
+ *	低水準入出力の関数を POSIX の関数に対応付ける
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+#ifndef PG0_POSIX_IO_H
+#define PG0_POSIX_IO_H
+
+/* Include Files */
+#include <stdio.h>
+#include <unistd.h>
+
+/* Define */
+#define _isatty					isatty
+#define _fileno					fileno
+
+#endif	//PG0_POSIX_IO_H
+/* End of source */
@@ -0,0 +1,27 @@
+/*
+ * PG0
+ *
+ * posix/mmsystem.h
+ *
+ *	タイマーの分解能は変更できないため何もしない
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+#ifndef PG0_POSIX_MMSYSTEM_H
+#define PG0_POSIX_MMSYSTEM_H
+
+/* Include Files */
+#include <windows.h>
+
+/* Define */
+#define TIMERR_NOERROR			0
+
+/* Function Prototypes */
+static inline UINT timeBeginPeriod(UINT period) { return TIMERR_NOERROR; }
+static inline UINT timeEndPeriod(UINT period) { return TIMERR_NOERROR; }
+
+#endif	//PG0_POSIX_MMSYSTEM_H
+/* End of source */
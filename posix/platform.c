@@ -0,0 +1,1463 @@
+/*
+ * PG0
+ *
+ * posix/platform.c
+ *
+ *	windows.h で宣言した Win32 API のサブセットを POSIX で実装
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+/* Include Files */
+#define _GNU_SOURCE
+#include <windows.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+/* Define */
+#define FORMAT_SIZE				1024
+
+//ハンドルの種類
+typedef enum {
+	HT_STD = 1,
+	HT_FILE,
+	HT_MAP,
+	HT_FIND,
+	HT_EVENT,
+	HT_THREAD,
+	HT_HEAP,
+} HANDLE_TYPE;
+
+/* Global Variables */
+//待機可能なオブジェクト (イベントとスレッド)
+typedef struct _WAITOBJ {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	BOOL manual;
+	BOOL signaled;
+} WAITOBJ;
+
+//ハンドル
+typedef struct _POSIXHANDLE {
+	HANDLE_TYPE type;
+	int fd;
+	//HT_FIND
+	glob_t gl;
+	size_t index;
+	//HT_EVENT, HT_THREAD
+	WAITOBJ wo;
+	LONG ref;
+	LPTHREAD_START_ROUTINE func;
+	LPVOID param;
+} POSIXHANDLE;
+
+//ヒープのブロックのヘッダ (16バイト境界を保つ)
+typedef struct _HEAPBLOCK {
+	struct _HEAPBLOCK *prev;
+	struct _HEAPBLOCK *next;
+} HEAPBLOCK;
+
+//ヒープ
+typedef struct _POSIXHEAP {
+	HANDLE_TYPE type;
+	BOOL serialize;
+	pthread_mutex_t mutex;
+	HEAPBLOCK *top;
+} POSIXHEAP;
+
+//マップした領域 (解放時にサイズが必要なため保持する)
+typedef struct _MAPREGION {
+	void *addr;
+	size_t size;
+	struct _MAPREGION *next;
+} MAPREGION;
+
+static THREAD_LOCAL DWORD last_error;
+
+static POSIXHANDLE std_handle[3] = {
+	{ HT_STD, 0 }, { HT_STD, 1 }, { HT_STD, 2 },
+};
+//プロセスのヒープは malloc をそのまま使用する
+static POSIXHEAP process_heap = { HT_HEAP, FALSE };
+
+static pthread_mutex_t region_mutex = PTHREAD_MUTEX_INITIALIZER;
+static MAPREGION *region_top;
+
+/* Local Function Prototypes */
+
+/*
+ * set_errno_error - errno からエラーコードを設定
+ */
+static void set_errno_error(void)
+{
+	switch (errno) {
+	case ENOENT:
+	case ENOTDIR:
+		last_error = ERROR_FILE_NOT_FOUND;
+		break;
+	case ENOMEM:
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		break;
+	default:
+		last_error = (DWORD)errno;
+		break;
+	}
+}
+
+/*
+ * GetLastError - 最後のエラーコードを取得
+ */
+DWORD GetLastError(void)
+{
+	return last_error;
+}
+
+/*
+ * SetLastError - エラーコードを設定
+ */
+void SetLastError(DWORD err)
+{
+	last_error = err;
+}
+
+/*
+ * wsprintfA - 書式付き文字列の作成
+ *
+ *	Windows の書式 (%I64d, LONG に対する %ld) を LP64 の書式に変換する
+ */
+int wsprintfA(LPSTR buf, LPCSTR format, ...)
+{
+	char fmt[FORMAT_SIZE];
+	const char *p;
+	char *r;
+	va_list args;
+	int ret;
+
+	for (p = format, r = fmt; *p != '\0' && r < fmt + FORMAT_SIZE - 3; p++) {
+		*(r++) = *p;
+		if (*p != '%') {
+			continue;
+		}
+		if (*(p + 1) == '%') {
+			*(r++) = *(++p);
+			continue;
+		}
+		// フラグと幅
+		for (p++; *p != '\0' && strchr("-+ #0123456789.", *p) != NULL && r < fmt + FORMAT_SIZE - 3; p++) {
+			*(r++) = *p;
+		}
+		if (*p == 'I' && *(p + 1) == '6' && *(p + 2) == '4') {
+			*(r++) = 'l';
+			*(r++) = 'l';
+			p += 2;
+		} else if (*p == 'l' && *(p + 1) == 'l') {
+			*(r++) = 'l';
+			*(r++) = 'l';
+			p++;
+		} else if (*p == 'l') {
+			// LONG, DWORD は32ビット
+		} else {
+			p--;
+		}
+	}
+	*r = '\0';
+
+	va_start(args, format);
+	ret = vsprintf(buf, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/*
+ * posix_ltot_s - 数値を文字列に変換
+ */
+int posix_ltot_s(long value, char *buf, size_t size, int radix)
+{
+	char tmp[72];
+	unsigned long v;
+	int len = 0;
+	int i;
+
+	if (buf == NULL || size == 0 || radix < 2 || radix > 36) {
+		return EINVAL;
+	}
+	v = (value < 0 && radix == 10) ? (unsigned long)(-(value + 1)) + 1 : (unsigned long)value;
+	do {
+		tmp[len++] = "0123456789abcdefghijklmnopqrstuvwxyz"[v % radix];
+		v /= radix;
+	} while (v != 0);
+	if (value < 0 && radix == 10) {
+		tmp[len++] = '-';
+	}
+	if ((size_t)len + 1 > size) {
+		*buf = '\0';
+		return ERANGE;
+	}
+	for (i = 0; i < len; i++) {
+		buf[i] = tmp[len - i - 1];
+	}
+	buf[len] = '\0';
+	return 0;
+}
+
+/*
+ * IsDBCSLeadByte - マルチバイトの先頭バイトか判定
+ *
+ *	UTF-8 の後続バイトは '\\' や '/' と一致しないため常に FALSE
+ */
+BOOL IsDBCSLeadByte(BYTE c)
+{
+	return FALSE;
+}
+
+/*
+ * MultiByteToWideChar - UTF-8 から UTF-16 に変換
+ *
+ *	コードページは常に UTF-8 として扱う
+ */
+int MultiByteToWideChar(UINT cp, DWORD flags, LPCSTR str, int len, LPWSTR ret, int size)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	const unsigned char *end;
+	DWORD c;
+	int cnt, n, i;
+	int wlen = 0;
+
+	if (len < 0) {
+		len = (int)strlen(str) + 1;
+	}
+	end = p + len;
+	while (p < end) {
+		c = *p;
+		if (c < 0x80) {
+			cnt = 0;
+		} else if ((c & 0xE0) == 0xC0) {
+			cnt = 1;
+			c &= 0x1F;
+		} else if ((c & 0xF0) == 0xE0) {
+			cnt = 2;
+			c &= 0x0F;
+		} else if ((c & 0xF8) == 0xF0) {
+			cnt = 3;
+			c &= 0x07;
+		} else {
+			cnt = -1;
+		}
+		n = 1;
+		if (cnt < 0 || end - p <= cnt) {
+			c = 0xFFFD;
+		} else {
+			for (i = 1; i <= cnt; i++) {
+				if ((*(p + i) & 0xC0) != 0x80) {
+					break;
+				}
+				c = (c << 6) | (*(p + i) & 0x3F);
+			}
+			if (i <= cnt) {
+				c = 0xFFFD;
+				n = i;
+			} else {
+				n = cnt + 1;
+			}
+		}
+		p += n;
+		n = (c >= 0x10000) ? 2 : 1;
+		if (size > 0) {
+			if (wlen + n > size) {
+				last_error = ERROR_NOT_ENOUGH_MEMORY;
+				return 0;
+			}
+			if (n == 2) {
+				c -= 0x10000;
+				*(ret + wlen) = (WCHAR)(0xD800 + (c >> 10));
+				*(ret + wlen + 1) = (WCHAR)(0xDC00 + (c & 0x3FF));
+			} else {
+				*(ret + wlen) = (WCHAR)c;
+			}
+		}
+		wlen += n;
+	}
+	return wlen;
+}
+
+/*
+ * WideCharToMultiByte - UTF-16 から UTF-8 に変換
+ *
+ *	コードページは常に UTF-8 として扱う
+ */
+int WideCharToMultiByte(UINT cp, DWORD flags, LPCWSTR str, int len, LPSTR ret, int size, LPCSTR def, LPBOOL used)
+{
+	const WCHAR *p = str;
+	const WCHAR *end;
+	unsigned char buf[4];
+	DWORD c;
+	int clen = 0;
+	int n, i;
+
+	if (len < 0) {
+		for (len = 0; *(str + len) != 0; len++);
+		len++;
+	}
+	end = p + len;
+	while (p < end) {
+		c = *(p++);
+		if (c >= 0xD800 && c <= 0xDBFF && p < end && *p >= 0xDC00 && *p <= 0xDFFF) {
+			// サロゲートペア
+			c = 0x10000 + ((c - 0xD800) << 10) + (*(p++) - 0xDC00);
+		} else if (c >= 0xD800 && c <= 0xDFFF) {
+			c = 0xFFFD;
+		}
+		if (c < 0x80) {
+			buf[0] = (unsigned char)c;
+			n = 1;
+		} else if (c < 0x800) {
+			buf[0] = (unsigned char)(0xC0 | (c >> 6));
+			buf[1] = (unsigned char)(0x80 | (c & 0x3F));
+			n = 2;
+		} else if (c < 0x10000) {
+			buf[0] = (unsigned char)(0xE0 | (c >> 12));
+			buf[1] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+			buf[2] = (unsigned char)(0x80 | (c & 0x3F));
+			n = 3;
+		} else {
+			buf[0] = (unsigned char)(0xF0 | (c >> 18));
+			buf[1] = (unsigned char)(0x80 | ((c >> 12) & 0x3F));
+			buf[2] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+			buf[3] = (unsigned char)(0x80 | (c & 0x3F));
+			n = 4;
+		}
+		if (size > 0) {
+			if (clen + n > size) {
+				last_error = ERROR_NOT_ENOUGH_MEMORY;
+				return 0;
+			}
+			for (i = 0; i < n; i++) {
+				*(ret + clen + i) = (char)buf[i];
+			}
+		}
+		clen += n;
+	}
+	if (used != NULL) {
+		*used = FALSE;
+	}
+	return clen;
+}
+
+/*
+ * conv_path - パスの区切りを '/' に変換してコピー
+ */
+static char *conv_path(const char *path, char *buf)
+{
+	char *r;
+
+	if (strlen(path) >= MAX_PATH) {
+		last_error = ERROR_FILE_NOT_FOUND;
+		return NULL;
+	}
+	for (r = buf; *path != '\0'; path++, r++) {
+		*r = (*path == '\\') ? '/' : *path;
+	}
+	*r = '\0';
+	return buf;
+}
+
+/*
+ * handle_alloc - ハンドルの確保
+ */
+static POSIXHANDLE *handle_alloc(HANDLE_TYPE type)
+{
+	POSIXHANDLE *ph;
+
+	ph = calloc(1, sizeof(POSIXHANDLE));
+	if (ph == NULL) {
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		return NULL;
+	}
+	ph->type = type;
+	ph->fd = -1;
+	return ph;
+}
+
+/*
+ * waitobj_init - 待機可能なオブジェクトの初期化
+ */
+static void waitobj_init(WAITOBJ *wo, BOOL manual, BOOL initial)
+{
+	pthread_condattr_t attr;
+
+	pthread_mutex_init(&wo->mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&wo->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	wo->manual = manual;
+	wo->signaled = initial;
+}
+
+/*
+ * waitobj_wait - シグナル状態になるまで待機
+ */
+static DWORD waitobj_wait(WAITOBJ *wo, DWORD msec)
+{
+	struct timespec ts;
+	DWORD ret = WAIT_OBJECT_0;
+
+	if (msec != INFINITE) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		ts.tv_sec += msec / 1000;
+		ts.tv_nsec += (long)(msec % 1000) * 1000000;
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+	}
+	pthread_mutex_lock(&wo->mutex);
+	while (wo->signaled == FALSE) {
+		if (msec == INFINITE) {
+			pthread_cond_wait(&wo->cond, &wo->mutex);
+		} else if (pthread_cond_timedwait(&wo->cond, &wo->mutex, &ts) == ETIMEDOUT) {
+			ret = WAIT_TIMEOUT;
+			break;
+		}
+	}
+	if (ret == WAIT_OBJECT_0 && wo->manual == FALSE) {
+		wo->signaled = FALSE;
+	}
+	pthread_mutex_unlock(&wo->mutex);
+	return ret;
+}
+
+/*
+ * waitobj_set - シグナル状態に設定
+ */
+static void waitobj_set(WAITOBJ *wo)
+{
+	pthread_mutex_lock(&wo->mutex);
+	wo->signaled = TRUE;
+	if (wo->manual == TRUE) {
+		pthread_cond_broadcast(&wo->cond);
+	} else {
+		pthread_cond_signal(&wo->cond);
+	}
+	pthread_mutex_unlock(&wo->mutex);
+}
+
+/*
+ * handle_release - 待機可能なハンドルの参照を解放
+ */
+static void handle_release(POSIXHANDLE *ph)
+{
+	if (__atomic_sub_fetch(&ph->ref, 1, __ATOMIC_ACQ_REL) == 0) {
+		pthread_cond_destroy(&ph->wo.cond);
+		pthread_mutex_destroy(&ph->wo.mutex);
+		free(ph);
+	}
+}
+
+/*
+ * CloseHandle - ハンドルを閉じる
+ */
+BOOL CloseHandle(HANDLE h)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+
+	if (ph == NULL || h == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+	switch (ph->type) {
+	case HT_STD:
+		break;
+	case HT_FILE:
+	case HT_MAP:
+		close(ph->fd);
+		free(ph);
+		break;
+	case HT_EVENT:
+	case HT_THREAD:
+		handle_release(ph);
+		break;
+	default:
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * GetStdHandle - 標準入出力のハンドルを取得
+ */
+HANDLE GetStdHandle(DWORD id)
+{
+	switch (id) {
+	case STD_INPUT_HANDLE:
+		return &std_handle[0];
+	case STD_OUTPUT_HANDLE:
+		return &std_handle[1];
+	case STD_ERROR_HANDLE:
+		return &std_handle[2];
+	}
+	return INVALID_HANDLE_VALUE;
+}
+
+/*
+ * GetConsoleMode - コンソールのモードを取得
+ *
+ *	端末は常に行入力として扱う
+ */
+BOOL GetConsoleMode(HANDLE h, LPDWORD mode)
+{
+	*mode = ENABLE_LINE_INPUT;
+	return TRUE;
+}
+
+/*
+ * SetConsoleMode - コンソールのモードを設定
+ */
+BOOL SetConsoleMode(HANDLE h, DWORD mode)
+{
+	return TRUE;
+}
+
+/*
+ * ReadConsoleA - 標準入力から1行読み込む
+ */
+BOOL ReadConsoleA(HANDLE h, LPVOID buf, DWORD len, LPDWORD ret, LPVOID reserved)
+{
+	*ret = 0;
+	if (fgets((char *)buf, (int)len + 1, stdin) == NULL) {
+		return FALSE;
+	}
+	*ret = (DWORD)strlen((char *)buf);
+	return TRUE;
+}
+
+/*
+ * MessageBoxA - メッセージを標準エラーに出力
+ */
+int MessageBoxA(HWND hWnd, LPCSTR text, LPCSTR caption, UINT type)
+{
+	fprintf(stderr, "%s: %s\n", (caption != NULL) ? caption : "", (text != NULL) ? text : "");
+	return 1;
+}
+
+/*
+ * CreateFileA - ファイルを開く
+ */
+HANDLE CreateFileA(LPCSTR path, DWORD access, DWORD share, LPVOID sa, DWORD disposition, DWORD flags, HANDLE tmpl)
+{
+	POSIXHANDLE *ph;
+	char buf[MAX_PATH];
+	int mode;
+	int fd;
+
+	if (conv_path(path, buf) == NULL) {
+		return INVALID_HANDLE_VALUE;
+	}
+	mode = ((access & GENERIC_READ) && (access & GENERIC_WRITE)) ? O_RDWR : ((access & GENERIC_WRITE) ? O_WRONLY : O_RDONLY);
+	if (disposition == CREATE_ALWAYS) {
+		mode |= O_CREAT | O_TRUNC;
+	}
+	fd = open(buf, mode | O_CLOEXEC, 0666);
+	if (fd < 0) {
+		set_errno_error();
+		return INVALID_HANDLE_VALUE;
+	}
+	if ((ph = handle_alloc(HT_FILE)) == NULL) {
+		close(fd);
+		return INVALID_HANDLE_VALUE;
+	}
+	ph->fd = fd;
+	return ph;
+}
+
+/*
+ * WriteFile - ファイルに書き込む
+ */
+BOOL WriteFile(HANDLE h, LPCVOID buf, DWORD len, LPDWORD ret, LPVOID ov)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+	const char *p = (const char *)buf;
+	ssize_t n;
+	DWORD done = 0;
+
+	if (ph == NULL || h == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+	if (ph->type == HT_STD) {
+		// stdio のバッファと順序を合わせる
+		fflush((ph->fd == 2) ? stderr : stdout);
+	}
+	while (done < len) {
+		n = write(ph->fd, p + done, len - done);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			set_errno_error();
+			break;
+		}
+		done += (DWORD)n;
+	}
+	if (ret != NULL) {
+		*ret = done;
+	}
+	return (done == len) ? TRUE : FALSE;
+}
+
+/*
+ * GetFileSize - ファイルサイズの取得
+ */
+DWORD GetFileSize(HANDLE h, LPDWORD high)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+	struct stat st;
+
+	if (fstat(ph->fd, &st) != 0) {
+		set_errno_error();
+		return 0xFFFFFFFF;
+	}
+	if (high != NULL) {
+		*high = (DWORD)((unsigned long long)st.st_size >> 32);
+	}
+	return (DWORD)st.st_size;
+}
+
+/*
+ * GetFileInformationByHandle - ファイルの識別情報を取得
+ *
+ *	ボリュームとファイルインデックスにデバイス番号と i-node 番号を設定
+ */
+BOOL GetFileInformationByHandle(HANDLE h, BY_HANDLE_FILE_INFORMATION *fi)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+	struct stat st;
+	unsigned long long t;
+
+	if (fstat(ph->fd, &st) != 0) {
+		set_errno_error();
+		return FALSE;
+	}
+	memset(fi, 0, sizeof(BY_HANDLE_FILE_INFORMATION));
+	fi->dwFileAttributes = S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+	fi->dwVolumeSerialNumber = (DWORD)st.st_dev;
+	fi->nFileSizeHigh = (DWORD)((unsigned long long)st.st_size >> 32);
+	fi->nFileSizeLow = (DWORD)st.st_size;
+	fi->nNumberOfLinks = (DWORD)st.st_nlink;
+	fi->nFileIndexHigh = (DWORD)((unsigned long long)st.st_ino >> 32);
+	fi->nFileIndexLow = (DWORD)st.st_ino;
+	// 1601年からの100ナノ秒単位
+	t = ((unsigned long long)st.st_mtime * 10000000ULL) + 116444736000000000ULL;
+#ifdef __linux__
+	t += (unsigned long long)st.st_mtim.tv_nsec / 100;
+#endif
+	fi->ftLastWriteTime.dwLowDateTime = (DWORD)t;
+	fi->ftLastWriteTime.dwHighDateTime = (DWORD)(t >> 32);
+	return TRUE;
+}
+
+/*
+ * region_add - マップした領域の登録
+ */
+static BOOL region_add(void *addr, size_t size)
+{
+	MAPREGION *mr;
+
+	mr = malloc(sizeof(MAPREGION));
+	if (mr == NULL) {
+		return FALSE;
+	}
+	mr->addr = addr;
+	mr->size = size;
+	pthread_mutex_lock(&region_mutex);
+	mr->next = region_top;
+	region_top = mr;
+	pthread_mutex_unlock(&region_mutex);
+	return TRUE;
+}
+
+/*
+ * region_remove - マップした領域の登録を解除してサイズを返す
+ */
+static size_t region_remove(const void *addr)
+{
+	MAPREGION *mr, *prev = NULL;
+	size_t size = 0;
+
+	pthread_mutex_lock(&region_mutex);
+	for (mr = region_top; mr != NULL; prev = mr, mr = mr->next) {
+		if (mr->addr == addr) {
+			if (prev == NULL) {
+				region_top = mr->next;
+			} else {
+				prev->next = mr->next;
+			}
+			size = mr->size;
+			free(mr);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&region_mutex);
+	return size;
+}
+
+/*
+ * CreateFileMappingA - ファイルのマッピングを作成
+ */
+HANDLE CreateFileMappingA(HANDLE h, LPVOID sa, DWORD protect, DWORD high, DWORD low, LPCSTR name)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+	POSIXHANDLE *map;
+
+	if ((map = handle_alloc(HT_MAP)) == NULL) {
+		return NULL;
+	}
+	map->fd = dup(ph->fd);
+	if (map->fd < 0) {
+		set_errno_error();
+		free(map);
+		return NULL;
+	}
+	return map;
+}
+
+/*
+ * MapViewOfFile - ファイル全体を読み取り専用でマップ
+ */
+LPVOID MapViewOfFile(HANDLE h, DWORD access, DWORD high, DWORD low, SIZE_T size)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+	struct stat st;
+	void *view;
+
+	if (fstat(ph->fd, &st) != 0 || st.st_size == 0) {
+		set_errno_error();
+		return NULL;
+	}
+	view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, ph->fd, 0);
+	if (view == MAP_FAILED) {
+		set_errno_error();
+		return NULL;
+	}
+	if (region_add(view, (size_t)st.st_size) == FALSE) {
+		munmap(view, (size_t)st.st_size);
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		return NULL;
+	}
+	return view;
+}
+
+/*
+ * UnmapViewOfFile - マップしたファイルの解放
+ */
+BOOL UnmapViewOfFile(LPCVOID view)
+{
+	size_t size = region_remove(view);
+
+	if (size == 0) {
+		return FALSE;
+	}
+	return (munmap((void *)view, size) == 0) ? TRUE : FALSE;
+}
+
+/*
+ * set_find_data - 検索結果の設定
+ */
+static void set_find_data(const char *path, WIN32_FIND_DATA *fd)
+{
+	struct stat st;
+	const char *p;
+
+	memset(fd, 0, sizeof(WIN32_FIND_DATA));
+	p = strrchr(path, '/');
+	lstrcpynA(fd->cFileName, (p != NULL) ? p + 1 : path, MAX_PATH);
+	if (stat(path, &st) == 0) {
+		fd->dwFileAttributes = S_ISDIR(st.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+		fd->nFileSizeHigh = (DWORD)((unsigned long long)st.st_size >> 32);
+		fd->nFileSizeLow = (DWORD)st.st_size;
+	}
+}
+
+/*
+ * FindFirstFileA - ワイルドカードに一致するファイルの検索
+ */
+HANDLE FindFirstFileA(LPCSTR path, WIN32_FIND_DATA *fd)
+{
+	POSIXHANDLE *ph;
+	char buf[MAX_PATH];
+
+	if (conv_path(path, buf) == NULL || (ph = handle_alloc(HT_FIND)) == NULL) {
+		return INVALID_HANDLE_VALUE;
+	}
+	if (glob(buf, GLOB_NOESCAPE, NULL, &ph->gl) != 0 || ph->gl.gl_pathc == 0) {
+		globfree(&ph->gl);
+		free(ph);
+		last_error = ERROR_FILE_NOT_FOUND;
+		return INVALID_HANDLE_VALUE;
+	}
+	set_find_data(ph->gl.gl_pathv[0], fd);
+	ph->index = 1;
+	return ph;
+}
+
+/*
+ * FindNextFileA - 次のファイルを取得
+ */
+BOOL FindNextFileA(HANDLE h, WIN32_FIND_DATA *fd)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+
+	if (ph->index >= ph->gl.gl_pathc) {
+		last_error = ERROR_FILE_NOT_FOUND;
+		return FALSE;
+	}
+	set_find_data(ph->gl.gl_pathv[ph->index++], fd);
+	return TRUE;
+}
+
+/*
+ * FindClose - 検索の終了
+ */
+BOOL FindClose(HANDLE h)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+
+	if (ph == NULL || h == INVALID_HANDLE_VALUE || ph->type != HT_FIND) {
+		return FALSE;
+	}
+	globfree(&ph->gl);
+	free(ph);
+	return TRUE;
+}
+
+/*
+ * GetCurrentDirectoryA - カレントディレクトリの取得
+ */
+DWORD GetCurrentDirectoryA(DWORD size, LPSTR buf)
+{
+	char tmp[MAX_PATH];
+	DWORD len;
+
+	if (getcwd(tmp, sizeof(tmp)) == NULL) {
+		set_errno_error();
+		return 0;
+	}
+	len = (DWORD)strlen(tmp);
+	if (len + 1 > size) {
+		return len + 1;
+	}
+	memcpy(buf, tmp, len + 1);
+	return len;
+}
+
+/*
+ * GetFullPathNameA - 絶対パスに変換
+ *
+ *	Windows と同じくシンボリックリンクは解決せず "." と ".." のみ正規化する
+ */
+DWORD GetFullPathNameA(LPCSTR path, DWORD size, LPSTR buf, LPSTR *name)
+{
+	char tmp[MAX_PATH * 2];
+	char *p, *r, *s;
+	DWORD len;
+
+	if (conv_path(path, tmp + MAX_PATH) == NULL) {
+		return 0;
+	}
+	if (*(tmp + MAX_PATH) == '/') {
+		lstrcpyA(tmp, tmp + MAX_PATH);
+	} else {
+		if (getcwd(tmp, MAX_PATH) == NULL) {
+			set_errno_error();
+			return 0;
+		}
+		len = (DWORD)strlen(tmp);
+		if (len + 1 + strlen(tmp + MAX_PATH) >= MAX_PATH) {
+			last_error = ERROR_FILE_NOT_FOUND;
+			return 0;
+		}
+		memmove(tmp + len + 1, tmp + MAX_PATH, strlen(tmp + MAX_PATH) + 1);
+		tmp[len] = '/';
+	}
+	// 要素ごとに正規化
+	for (p = r = tmp; *p != '\0';) {
+		for (; *p == '/'; p++);
+		for (s = p; *s != '\0' && *s != '/'; s++);
+		if (s - p == 1 && *p == '.') {
+		} else if (s - p == 2 && *p == '.' && *(p + 1) == '.') {
+			for (; r > tmp && *(r - 1) != '/'; r--);
+			if (r > tmp) {
+				r--;
+			}
+		} else if (s > p) {
+			*(r++) = '/';
+			memmove(r, p, s - p);
+			r += s - p;
+		}
+		p = s;
+	}
+	if (r == tmp) {
+		*(r++) = '/';
+	}
+	*r = '\0';
+	len = (DWORD)(r - tmp);
+	if (len + 1 > size) {
+		return len + 1;
+	}
+	memcpy(buf, tmp, len + 1);
+	if (name != NULL) {
+		p = strrchr(buf, '/');
+		*name = (p != NULL && *(p + 1) != '\0') ? p + 1 : NULL;
+	}
+	return len;
+}
+
+/*
+ * GetModuleFileNameA - 実行ファイルのパスを取得
+ */
+DWORD GetModuleFileNameA(HMODULE hModule, LPSTR buf, DWORD size)
+{
+	ssize_t len;
+
+	if (size == 0) {
+		return 0;
+	}
+	len = readlink("/proc/self/exe", buf, size - 1);
+	if (len < 0) {
+		set_errno_error();
+		*buf = '\0';
+		return 0;
+	}
+	buf[len] = '\0';
+	return (DWORD)len;
+}
+
+/*
+ * GetFileVersionInfoSizeA - バージョン情報のサイズ
+ *
+ *	実行ファイルにバージョンリソースは無い
+ */
+DWORD GetFileVersionInfoSizeA(LPCSTR path, LPDWORD handle)
+{
+	last_error = ERROR_FILE_NOT_FOUND;
+	return 0;
+}
+
+/*
+ * GetFileVersionInfoA - バージョン情報の取得
+ */
+BOOL GetFileVersionInfoA(LPCSTR path, DWORD handle, DWORD size, LPVOID buf)
+{
+	return FALSE;
+}
+
+/*
+ * VerQueryValueA - バージョン情報の値を取得
+ */
+BOOL VerQueryValueA(LPCVOID buf, LPCSTR sub, LPVOID *ret, UINT *len)
+{
+	return FALSE;
+}
+
+/*
+ * LoadLibraryA - 共有ライブラリの読み込み
+ */
+HMODULE LoadLibraryA(LPCSTR path)
+{
+	char buf[MAX_PATH];
+	void *lib;
+
+	if (conv_path(path, buf) == NULL) {
+		return NULL;
+	}
+	lib = dlopen(buf, RTLD_NOW | RTLD_LOCAL);
+	if (lib == NULL) {
+		last_error = ERROR_FILE_NOT_FOUND;
+	}
+	return lib;
+}
+
+/*
+ * GetProcAddress - 関数のアドレスを取得
+ */
+FARPROC GetProcAddress(HMODULE hModule, LPCSTR name)
+{
+	return dlsym(hModule, name);
+}
+
+/*
+ * FreeLibrary - 共有ライブラリの解放
+ */
+BOOL FreeLibrary(HMODULE hModule)
+{
+	return (dlclose(hModule) == 0) ? TRUE : FALSE;
+}
+
+/*
+ * GetProcessHeap - プロセスのヒープを取得
+ */
+HANDLE GetProcessHeap(void)
+{
+	return &process_heap;
+}
+
+/*
+ * HeapCreate - ヒープの作成
+ *
+ *	ブロックをリストで保持して HeapDestroy でまとめて解放する
+ */
+HANDLE HeapCreate(DWORD flags, SIZE_T init, SIZE_T max)
+{
+	POSIXHEAP *heap;
+
+	heap = calloc(1, sizeof(POSIXHEAP));
+	if (heap == NULL) {
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		return NULL;
+	}
+	heap->type = HT_HEAP;
+	heap->serialize = (flags & HEAP_NO_SERIALIZE) ? FALSE : TRUE;
+	pthread_mutex_init(&heap->mutex, NULL);
+	return heap;
+}
+
+/*
+ * HeapDestroy - ヒープの破棄
+ */
+BOOL HeapDestroy(HANDLE h)
+{
+	POSIXHEAP *heap = (POSIXHEAP *)h;
+	HEAPBLOCK *hb, *next;
+
+	if (heap == NULL || heap == &process_heap) {
+		return FALSE;
+	}
+	for (hb = heap->top; hb != NULL; hb = next) {
+		next = hb->next;
+		free(hb);
+	}
+	pthread_mutex_destroy(&heap->mutex);
+	free(heap);
+	return TRUE;
+}
+
+/*
+ * heap_link - ブロックをヒープのリストに追加
+ */
+static void heap_link(POSIXHEAP *heap, HEAPBLOCK *hb)
+{
+	if (heap->serialize == TRUE) {
+		pthread_mutex_lock(&heap->mutex);
+	}
+	hb->prev = NULL;
+	hb->next = heap->top;
+	if (heap->top != NULL) {
+		heap->top->prev = hb;
+	}
+	heap->top = hb;
+	if (heap->serialize == TRUE) {
+		pthread_mutex_unlock(&heap->mutex);
+	}
+}
+
+/*
+ * heap_unlink - ブロックをヒープのリストから削除
+ */
+static void heap_unlink(POSIXHEAP *heap, HEAPBLOCK *hb)
+{
+	if (heap->serialize == TRUE) {
+		pthread_mutex_lock(&heap->mutex);
+	}
+	if (hb->prev != NULL) {
+		hb->prev->next = hb->next;
+	} else {
+		heap->top = hb->next;
+	}
+	if (hb->next != NULL) {
+		hb->next->prev = hb->prev;
+	}
+	if (heap->serialize == TRUE) {
+		pthread_mutex_unlock(&heap->mutex);
+	}
+}
+
+/*
+ * HeapAlloc - ヒープからメモリを確保
+ */
+LPVOID HeapAlloc(HANDLE h, DWORD flags, SIZE_T size)
+{
+	POSIXHEAP *heap = (POSIXHEAP *)h;
+	HEAPBLOCK *hb;
+
+	if (heap == &process_heap) {
+		return (flags & HEAP_ZERO_MEMORY) ? calloc(1, size) : malloc(size);
+	}
+	hb = (flags & HEAP_ZERO_MEMORY) ? calloc(1, sizeof(HEAPBLOCK) + size) : malloc(sizeof(HEAPBLOCK) + size);
+	if (hb == NULL) {
+		return NULL;
+	}
+	heap_link(heap, hb);
+	return hb + 1;
+}
+
+/*
+ * HeapReAlloc - ヒープのメモリを再確保
+ *
+ *	HEAP_ZERO_MEMORY による拡張部分の初期化には対応しない
+ */
+LPVOID HeapReAlloc(HANDLE h, DWORD flags, LPVOID mem, SIZE_T size)
+{
+	POSIXHEAP *heap = (POSIXHEAP *)h;
+	HEAPBLOCK *hb;
+
+	if (heap == &process_heap) {
+		return realloc(mem, size);
+	}
+	hb = (HEAPBLOCK *)mem - 1;
+	heap_unlink(heap, hb);
+	mem = realloc(hb, sizeof(HEAPBLOCK) + size);
+	if (mem == NULL) {
+		heap_link(heap, hb);
+		return NULL;
+	}
+	hb = (HEAPBLOCK *)mem;
+	heap_link(heap, hb);
+	return hb + 1;
+}
+
+/*
+ * HeapFree - ヒープのメモリを解放
+ */
+BOOL HeapFree(HANDLE h, DWORD flags, LPVOID mem)
+{
+	POSIXHEAP *heap = (POSIXHEAP *)h;
+	HEAPBLOCK *hb;
+
+	if (mem == NULL) {
+		return TRUE;
+	}
+	if (heap == &process_heap) {
+		free(mem);
+		return TRUE;
+	}
+	hb = (HEAPBLOCK *)mem - 1;
+	heap_unlink(heap, hb);
+	free(hb);
+	return TRUE;
+}
+
+/*
+ * VirtualAlloc - ページ単位でメモリを確保
+ */
+LPVOID VirtualAlloc(LPVOID addr, SIZE_T size, DWORD type, DWORD protect)
+{
+	void *mem;
+
+	mem = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		return NULL;
+	}
+	if (region_add(mem, size) == FALSE) {
+		munmap(mem, size);
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		return NULL;
+	}
+	return mem;
+}
+
+/*
+ * VirtualFree - ページ単位のメモリを解放
+ *
+ *	MEM_DECOMMIT は物理ページのみ返却し、アドレスの範囲は保持する
+ */
+BOOL VirtualFree(LPVOID addr, SIZE_T size, DWORD type)
+{
+	if (type & MEM_DECOMMIT) {
+		return (madvise(addr, size, MADV_DONTNEED) == 0) ? TRUE : FALSE;
+	}
+	size = region_remove(addr);
+	if (size == 0) {
+		return FALSE;
+	}
+	return (munmap(addr, size) == 0) ? TRUE : FALSE;
+}
+
+/*
+ * thread_proc - スレッドの開始関数
+ */
+static void *thread_proc(void *param)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)param;
+
+	ph->func(ph->param);
+	waitobj_set(&ph->wo);
+	handle_release(ph);
+	return NULL;
+}
+
+/*
+ * CreateThread - スレッドの作成
+ *
+ *	スレッドは切り離して作成し、終了はハンドルのシグナルで待機する
+ */
+HANDLE CreateThread(LPVOID sa, SIZE_T stack, LPTHREAD_START_ROUTINE func, LPVOID param, DWORD flags, LPDWORD id)
+{
+	POSIXHANDLE *ph;
+	pthread_attr_t attr;
+	pthread_t th;
+	int ret;
+
+	if ((ph = handle_alloc(HT_THREAD)) == NULL) {
+		return NULL;
+	}
+	waitobj_init(&ph->wo, TRUE, FALSE);
+	ph->func = func;
+	ph->param = param;
+	// 呼び出し元とスレッドの参照
+	ph->ref = 2;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if (stack > 0) {
+		pthread_attr_setstacksize(&attr, stack);
+	}
+	ret = pthread_create(&th, &attr, thread_proc, ph);
+	pthread_attr_destroy(&attr);
+	if (ret != 0) {
+		ph->ref = 1;
+		handle_release(ph);
+		last_error = ERROR_NOT_ENOUGH_MEMORY;
+		return NULL;
+	}
+	if (id != NULL) {
+		*id = 0;
+	}
+	return ph;
+}
+
+/*
+ * SetThreadPriority - スレッドの優先度を設定
+ *
+ *	一般ユーザーでは上げられないため何もしない
+ */
+BOOL SetThreadPriority(HANDLE h, int priority)
+{
+	return TRUE;
+}
+
+/*
+ * GetCurrentThreadId - スレッドIDの取得
+ */
+DWORD GetCurrentThreadId(void)
+{
+	return (DWORD)syscall(SYS_gettid);
+}
+
+/*
+ * CreateEventA - イベントの作成
+ */
+HANDLE CreateEventA(LPVOID sa, BOOL manual, BOOL initial, LPCSTR name)
+{
+	POSIXHANDLE *ph;
+
+	if ((ph = handle_alloc(HT_EVENT)) == NULL) {
+		return NULL;
+	}
+	waitobj_init(&ph->wo, manual, initial);
+	ph->ref = 1;
+	return ph;
+}
+
+/*
+ * SetEvent - イベントをシグナル状態に設定
+ */
+BOOL SetEvent(HANDLE h)
+{
+	waitobj_set(&((POSIXHANDLE *)h)->wo);
+	return TRUE;
+}
+
+/*
+ * ResetEvent - イベントを非シグナル状態に設定
+ */
+BOOL ResetEvent(HANDLE h)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+
+	pthread_mutex_lock(&ph->wo.mutex);
+	ph->wo.signaled = FALSE;
+	pthread_mutex_unlock(&ph->wo.mutex);
+	return TRUE;
+}
+
+/*
+ * WaitForSingleObject - シグナル状態になるまで待機
+ */
+DWORD WaitForSingleObject(HANDLE h, DWORD msec)
+{
+	POSIXHANDLE *ph = (POSIXHANDLE *)h;
+
+	if (ph == NULL || (ph->type != HT_EVENT && ph->type != HT_THREAD)) {
+		return WAIT_FAILED;
+	}
+	return waitobj_wait(&ph->wo, msec);
+}
+
+/*
+ * WaitForMultipleObjects - 複数のオブジェクトを待機
+ *
+ *	すべてを待機する場合のみ対応
+ */
+DWORD WaitForMultipleObjects(DWORD cnt, const HANDLE *h, BOOL all, DWORD msec)
+{
+	DWORD i;
+
+	if (all == FALSE || msec != INFINITE) {
+		return WAIT_FAILED;
+	}
+	for (i = 0; i < cnt; i++) {
+		if (WaitForSingleObject(h[i], INFINITE) == WAIT_FAILED) {
+			return WAIT_FAILED;
+		}
+	}
+	return WAIT_OBJECT_0;
+}
+
+/*
+ * InitializeCriticalSection - クリティカルセクションの初期化
+ *
+ *	Win32 と同じく同一スレッドからの再入を許可する
+ */
+void InitializeCriticalSection(CRITICAL_SECTION *cs)
+{
+	pthread_mutexattr_t attr;
+
+	_Static_assert(sizeof(pthread_mutex_t) <= sizeof(CRITICAL_SECTION), "CRITICAL_SECTION is too small");
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init((pthread_mutex_t *)cs, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+/*
+ * DeleteCriticalSection - クリティカルセクションの破棄
+ */
+void DeleteCriticalSection(CRITICAL_SECTION *cs)
+{
+	pthread_mutex_destroy((pthread_mutex_t *)cs);
+}
+
+/*
+ * EnterCriticalSection - クリティカルセクションに入る
+ */
+void EnterCriticalSection(CRITICAL_SECTION *cs)
+{
+	pthread_mutex_lock((pthread_mutex_t *)cs);
+}
+
+/*
+ * LeaveCriticalSection - クリティカルセクションから出る
+ */
+void LeaveCriticalSection(CRITICAL_SECTION *cs)
+{
+	pthread_mutex_unlock((pthread_mutex_t *)cs);
+}
+
+/*
+ * Sleep - 指定ミリ秒待機
+ */
+void Sleep(DWORD msec)
+{
+	struct timespec ts;
+
+	ts.tv_sec = msec / 1000;
+	ts.tv_nsec = (long)(msec % 1000) * 1000000;
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+/*
+ * GetSystemInfo - システム情報の取得
+ */
+void GetSystemInfo(SYSTEM_INFO *si)
+{
+	long n;
+
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+	si->dwNumberOfProcessors = (n > 0) ? (DWORD)n : 1;
+	n = sysconf(_SC_PAGESIZE);
+	si->dwPageSize = (n > 0) ? (DWORD)n : 4096;
+}
+
+/*
+ * GetThreadLocale - ロケールの取得
+ *
+ *	環境変数の言語が日本語かどうかのみ判定する
+ */
+LCID GetThreadLocale(void)
+{
+	const char *env[] = { "LC_ALL", "LC_MESSAGES", "LANG" };
+	const char *lang;
+	int i;
+
+	for (i = 0; i < (int)(sizeof(env) / sizeof(env[0])); i++) {
+		lang = getenv(env[i]);
+		if (lang != NULL && *lang != '\0') {
+			return (strncmp(lang, "ja", 2) == 0) ? MAKELANGID(LANG_JAPANESE, 1) : MAKELANGID(LANG_ENGLISH, 1);
+		}
+	}
+	return MAKELANGID(LANG_ENGLISH, 1);
+}
+
+/*
+ * GetTickCount64 - 起動からのミリ秒
+ */
+ULONGLONG GetTickCount64(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ULONGLONG)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * GetTickCount - 起動からのミリ秒 (32ビット)
+ */
+DWORD GetTickCount(void)
+{
+	return (DWORD)GetTickCount64();
+}
+
+/*
+ * QueryPerformanceCounter - 高分解能カウンタの取得 (ナノ秒)
+ */
+BOOL QueryPerformanceCounter(LARGE_INTEGER *c)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	c->QuadPart = (LONGLONG)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	return TRUE;
+}
+
+/*
+ * QueryPerformanceFrequency - 高分解能カウンタの周波数
+ */
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *f)
+{
+	f->QuadPart = 1000000000;
+	return TRUE;
+}
+/* End of source */
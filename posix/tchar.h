@@ -0,0 +1,44 @@
+/*
+ * PG0
+ *
+ * posix/tchar.h
+ *
+ *	TCHAR = char としてCRTの関数に対応付ける
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+#ifndef PG0_POSIX_TCHAR_H
+#define PG0_POSIX_TCHAR_H
+
+/* Include Files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Define */
+#define _tmain					main
+#define _tprintf				printf
+#define _ftprintf				fprintf
+#define _stprintf_s				snprintf
+#define _sntprintf				snprintf
+#define _fgetts					fgets
+#define _fputts					fputs
+#define _tfopen					fopen
+#define _tcslen					strlen
+#define _tcsstr					strstr
+#define _tcstod					strtod
+#define _tcstol					strtol
+#define _ttoi					atoi
+#define _ttoi64					atoll
+#define _ttof					atof
+
+#define _ltot_s				posix_ltot_s
+
+/* Function Prototypes */
+int posix_ltot_s(long value, char *buf, size_t size, int radix);
+
+#endif	//PG0_POSIX_TCHAR_H
+/* End of source */
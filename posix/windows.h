@@ -0,0 +1,405 @@
+/*
+ * PG0
+ *
+ * posix/windows.h
+ *
+ *	POSIX 環境でコアをビルドするための Win32 API のサブセット
+ *	文字列は TCHAR = char (UTF-8) として扱う
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+#ifndef PG0_POSIX_WINDOWS_H
+#define PG0_POSIX_WINDOWS_H
+
+/* Include Files */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <alloca.h>
+
+/* Define */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WINAPI
+#define CALLBACK
+#define APIENTRY
+#define __stdcall
+#define __cdecl
+#define __forceinline			inline __attribute__((always_inline))
+#define FORCEINLINE				__forceinline
+#define __declspec(x)			__declspec_##x
+#define __declspec_thread		__thread
+#define __declspec_dllexport	__attribute__((visibility("default")))
+#define __declspec_noinline		__attribute__((noinline))
+
+#ifndef THREAD_LOCAL
+#define THREAD_LOCAL			__thread
+#endif
+
+#define TRUE					1
+#define FALSE					0
+#define CONST					const
+#define VOID					void
+
+#define MAX_PATH				4096
+
+#define TEXT(x)					x
+#define _T(x)					x
+
+//Win32 の型 (LP64 でも Windows と同じ幅にする)
+typedef int						BOOL;
+typedef unsigned char			BYTE;
+typedef unsigned short			WORD;
+typedef unsigned int			DWORD;
+typedef int						LONG;
+typedef unsigned int			ULONG;
+typedef unsigned int			UINT;
+typedef int						INT;
+typedef long long				LONGLONG;
+typedef unsigned long long		ULONGLONG;
+typedef long long				LONG64;
+typedef unsigned long long		DWORD64;
+typedef intptr_t				INT_PTR;
+typedef uintptr_t				UINT_PTR;
+typedef intptr_t				LONG_PTR;
+typedef uintptr_t				ULONG_PTR;
+typedef uintptr_t				DWORD_PTR;
+typedef size_t					SIZE_T;
+typedef char					CHAR;
+typedef unsigned short			WCHAR;
+typedef char					TCHAR;
+typedef unsigned char			TBYTE;
+typedef void					*LPVOID;
+typedef const void				*LPCVOID;
+typedef void					*PVOID;
+typedef char					*LPSTR;
+typedef const char				*LPCSTR;
+typedef TCHAR					*LPTSTR;
+typedef const TCHAR				*LPCTSTR;
+typedef WCHAR					*LPWSTR;
+typedef const WCHAR				*LPCWSTR;
+typedef DWORD					*LPDWORD;
+typedef BYTE					*LPBYTE;
+typedef BOOL					*LPBOOL;
+typedef DWORD					LCID;
+typedef WORD					LANGID;
+typedef void					*HANDLE;
+typedef void					*HMODULE;
+typedef void					*HINSTANCE;
+typedef void					*HWND;
+typedef void					*FARPROC;
+
+typedef union _LARGE_INTEGER {
+	struct {
+		DWORD LowPart;
+		LONG HighPart;
+	} u;
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _FILETIME {
+	DWORD dwLowDateTime;
+	DWORD dwHighDateTime;
+} FILETIME;
+
+typedef struct _BY_HANDLE_FILE_INFORMATION {
+	DWORD dwFileAttributes;
+	FILETIME ftCreationTime;
+	FILETIME ftLastAccessTime;
+	FILETIME ftLastWriteTime;
+	DWORD dwVolumeSerialNumber;
+	DWORD nFileSizeHigh;
+	DWORD nFileSizeLow;
+	DWORD nNumberOfLinks;
+	DWORD nFileIndexHigh;
+	DWORD nFileIndexLow;
+} BY_HANDLE_FILE_INFORMATION;
+
+typedef struct _WIN32_FIND_DATA {
+	DWORD dwFileAttributes;
+	FILETIME ftCreationTime;
+	FILETIME ftLastAccessTime;
+	FILETIME ftLastWriteTime;
+	DWORD nFileSizeHigh;
+	DWORD nFileSizeLow;
+	TCHAR cFileName[MAX_PATH];
+} WIN32_FIND_DATA;
+
+typedef struct _SYSTEM_INFO {
+	DWORD dwPageSize;
+	DWORD dwNumberOfProcessors;
+} SYSTEM_INFO;
+
+typedef struct _VS_FIXEDFILEINFO {
+	DWORD dwFileVersionMS;
+	DWORD dwFileVersionLS;
+} VS_FIXEDFILEINFO;
+
+//クリティカルセクション (pthread_mutex_t を保持する領域)
+typedef struct _CRITICAL_SECTION {
+	union {
+		long long align;
+		char buf[64];
+	} u;
+} CRITICAL_SECTION;
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID);
+
+#define INVALID_HANDLE_VALUE	((HANDLE)(intptr_t)-1)
+#define INFINITE				0xFFFFFFFF
+#define MAXIMUM_WAIT_OBJECTS	64
+#define WAIT_OBJECT_0			0
+#define WAIT_TIMEOUT			258
+#define WAIT_FAILED				0xFFFFFFFF
+
+#define GENERIC_READ			0x80000000
+#define GENERIC_WRITE			0x40000000
+#define FILE_SHARE_READ			0x00000001
+#define FILE_SHARE_WRITE		0x00000002
+#define CREATE_ALWAYS			2
+#define OPEN_EXISTING			3
+#define FILE_ATTRIBUTE_DIRECTORY	0x00000010
+#define FILE_ATTRIBUTE_NORMAL	0x00000080
+#define PAGE_READONLY			0x02
+#define PAGE_READWRITE			0x04
+#define FILE_MAP_READ			0x0004
+#define MEM_COMMIT				0x00001000
+#define MEM_RESERVE				0x00002000
+#define MEM_DECOMMIT			0x00004000
+#define MEM_RELEASE				0x00008000
+#define HEAP_NO_SERIALIZE		0x00000001
+#define HEAP_ZERO_MEMORY		0x00000008
+
+#define ERROR_SUCCESS			0
+#define ERROR_FILE_NOT_FOUND	2
+#define ERROR_NOT_ENOUGH_MEMORY	8
+
+#define STD_INPUT_HANDLE		((DWORD)-10)
+#define STD_OUTPUT_HANDLE		((DWORD)-11)
+#define STD_ERROR_HANDLE		((DWORD)-12)
+#define ENABLE_LINE_INPUT		0x0002
+
+#define THREAD_PRIORITY_HIGHEST	2
+
+#define CP_ACP					0
+#define CP_UTF8					65001
+
+#define LANG_NEUTRAL			0x00
+#define LANG_ENGLISH			0x09
+#define LANG_JAPANESE			0x11
+#define MAKELANGID(p, s)		((((WORD)(s)) << 10) | (WORD)(p))
+#define PRIMARYLANGID(lgid)		((WORD)(lgid) & 0x3ff)
+#define LANGIDFROMLCID(lcid)	((WORD)(lcid))
+
+#define LOWORD(l)				((WORD)((DWORD_PTR)(l) & 0xffff))
+#define HIWORD(l)				((WORD)(((DWORD_PTR)(l) >> 16) & 0xffff))
+#define MAKELONG(a, b)			((LONG)(((WORD)(a)) | ((DWORD)((WORD)(b))) << 16))
+
+#define CopyMemory(d, s, n)		memcpy((d), (s), (n))
+#define MoveMemory(d, s, n)		memmove((d), (s), (n))
+#define FillMemory(d, n, c)		memset((d), (c), (n))
+#define ZeroMemory(d, n)		memset((d), 0, (n))
+#define MemoryBarrier()			__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define _alloca					alloca
+
+#define CreateEvent				CreateEventA
+#define CreateFile				CreateFileA
+#define FindFirstFile			FindFirstFileA
+#define FindNextFile			FindNextFileA
+#define GetCurrentDirectory		GetCurrentDirectoryA
+#define GetFullPathName			GetFullPathNameA
+#define GetModuleFileName		GetModuleFileNameA
+#define GetFileVersionInfo		GetFileVersionInfoA
+#define GetFileVersionInfoSize	GetFileVersionInfoSizeA
+#define VerQueryValue			VerQueryValueA
+#define LoadLibrary				LoadLibraryA
+#define ReadConsole				ReadConsoleA
+#define MessageBox				MessageBoxA
+#define CreateFileMapping		CreateFileMappingA
+#define wsprintf				wsprintfA
+#define lstrlen					lstrlenA
+#define lstrcpy					lstrcpyA
+#define lstrcpyn				lstrcpynA
+#define lstrcat					lstrcatA
+#define lstrcmp					lstrcmpA
+#define lstrcmpi				lstrcmpiA
+
+/* Function Prototypes */
+//エラー
+DWORD GetLastError(void);
+void SetLastError(DWORD err);
+
+//文字列
+int wsprintfA(LPSTR buf, LPCSTR format, ...);
+BOOL IsDBCSLeadByte(BYTE c);
+int MultiByteToWideChar(UINT cp, DWORD flags, LPCSTR str, int len, LPWSTR ret, int size);
+int WideCharToMultiByte(UINT cp, DWORD flags, LPCWSTR str, int len, LPSTR ret, int size, LPCSTR def, LPBOOL used);
+
+//ハンドル
+BOOL CloseHandle(HANDLE h);
+HANDLE GetStdHandle(DWORD id);
+BOOL GetConsoleMode(HANDLE h, LPDWORD mode);
+BOOL SetConsoleMode(HANDLE h, DWORD mode);
+BOOL ReadConsoleA(HANDLE h, LPVOID buf, DWORD len, LPDWORD ret, LPVOID reserved);
+int MessageBoxA(HWND hWnd, LPCSTR text, LPCSTR caption, UINT type);
+
+//ファイル
+HANDLE CreateFileA(LPCSTR path, DWORD access, DWORD share, LPVOID sa, DWORD disposition, DWORD flags, HANDLE tmpl);
+BOOL WriteFile(HANDLE h, LPCVOID buf, DWORD len, LPDWORD ret, LPVOID ov);
+DWORD GetFileSize(HANDLE h, LPDWORD high);
+BOOL GetFileInformationByHandle(HANDLE h, BY_HANDLE_FILE_INFORMATION *fi);
+HANDLE CreateFileMappingA(HANDLE h, LPVOID sa, DWORD protect, DWORD high, DWORD low, LPCSTR name);
+LPVOID MapViewOfFile(HANDLE h, DWORD access, DWORD high, DWORD low, SIZE_T size);
+BOOL UnmapViewOfFile(LPCVOID view);
+HANDLE FindFirstFileA(LPCSTR path, WIN32_FIND_DATA *fd);
+BOOL FindNextFileA(HANDLE h, WIN32_FIND_DATA *fd);
+BOOL FindClose(HANDLE h);
+DWORD GetCurrentDirectoryA(DWORD size, LPSTR buf);
+DWORD GetFullPathNameA(LPCSTR path, DWORD size, LPSTR buf, LPSTR *name);
+DWORD GetModuleFileNameA(HMODULE hModule, LPSTR buf, DWORD size);
+DWORD GetFileVersionInfoSizeA(LPCSTR path, LPDWORD handle);
+BOOL GetFileVersionInfoA(LPCSTR path, DWORD handle, DWORD size, LPVOID buf);
+BOOL VerQueryValueA(LPCVOID buf, LPCSTR sub, LPVOID *ret, UINT *len);
+
+//ライブラリ
+HMODULE LoadLibraryA(LPCSTR path);
+FARPROC GetProcAddress(HMODULE hModule, LPCSTR name);
+BOOL FreeLibrary(HMODULE hModule);
+
+//メモリ
+HANDLE GetProcessHeap(void);
+HANDLE HeapCreate(DWORD flags, SIZE_T init, SIZE_T max);
+BOOL HeapDestroy(HANDLE heap);
+LPVOID HeapAlloc(HANDLE heap, DWORD flags, SIZE_T size);
+LPVOID HeapReAlloc(HANDLE heap, DWORD flags, LPVOID mem, SIZE_T size);
+BOOL HeapFree(HANDLE heap, DWORD flags, LPVOID mem);
+LPVOID VirtualAlloc(LPVOID addr, SIZE_T size, DWORD type, DWORD protect);
+BOOL VirtualFree(LPVOID addr, SIZE_T size, DWORD type);
+
+//スレッド
+HANDLE CreateThread(LPVOID sa, SIZE_T stack, LPTHREAD_START_ROUTINE func, LPVOID param, DWORD flags, LPDWORD id);
+BOOL SetThreadPriority(HANDLE h, int priority);
+DWORD GetCurrentThreadId(void);
+HANDLE CreateEventA(LPVOID sa, BOOL manual, BOOL initial, LPCSTR name);
+BOOL SetEvent(HANDLE h);
+BOOL ResetEvent(HANDLE h);
+DWORD WaitForSingleObject(HANDLE h, DWORD msec);
+DWORD WaitForMultipleObjects(DWORD cnt, const HANDLE *h, BOOL all, DWORD msec);
+void InitializeCriticalSection(CRITICAL_SECTION *cs);
+void DeleteCriticalSection(CRITICAL_SECTION *cs);
+void EnterCriticalSection(CRITICAL_SECTION *cs);
+void LeaveCriticalSection(CRITICAL_SECTION *cs);
+void Sleep(DWORD msec);
+
+//システム
+void GetSystemInfo(SYSTEM_INFO *si);
+LCID GetThreadLocale(void);
+ULONGLONG GetTickCount64(void);
+DWORD GetTickCount(void);
+BOOL QueryPerformanceCounter(LARGE_INTEGER *c);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *f);
+
+/*
+ * lstr* - Win32 と同じく NULL を空文字列として扱う
+ */
+static inline int lstrlenA(LPCSTR str)
+{
+	return (str == NULL) ? 0 : (int)strlen(str);
+}
+
+static inline LPSTR lstrcpyA(LPSTR dst, LPCSTR src)
+{
+	//同じバッファ内で前に詰めるコピーがあるため memmove を使用する
+	if (src == NULL) {
+		*dst = '\0';
+		return dst;
+	}
+	return memmove(dst, src, strlen(src) + 1);
+}
+
+static inline LPSTR lstrcatA(LPSTR dst, LPCSTR src)
+{
+	return strcat(dst, (src == NULL) ? "" : src);
+}
+
+static inline LPSTR lstrcpynA(LPSTR dst, LPCSTR src, int len)
+{
+	int i;
+
+	if (len <= 0) {
+		return dst;
+	}
+	for (i = 0; i < len - 1 && src != NULL && src[i] != '\0'; i++) {
+		dst[i] = src[i];
+	}
+	dst[i] = '\0';
+	return dst;
+}
+
+static inline int lstrcmpA(LPCSTR str1, LPCSTR str2)
+{
+	return strcmp((str1 == NULL) ? "" : str1, (str2 == NULL) ? "" : str2);
+}
+
+static inline int lstrcmpiA(LPCSTR str1, LPCSTR str2)
+{
+	return strcasecmp((str1 == NULL) ? "" : str1, (str2 == NULL) ? "" : str2);
+}
+
+/*
+ * Interlocked* - 32ビットの整数を不可分に操作
+ */
+static inline LONG InterlockedIncrement(volatile LONG *p)
+{
+	return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedDecrement(volatile LONG *p)
+{
+	return __atomic_sub_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedExchange(volatile LONG *p, LONG v)
+{
+	return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedExchangeAdd(volatile LONG *p, LONG v)
+{
+	return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedCompareExchange(volatile LONG *p, LONG v, LONG cmp)
+{
+	__atomic_compare_exchange_n(p, &cmp, v, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return cmp;
+}
+
+static inline LONG InterlockedOr(volatile LONG *p, LONG v)
+{
+	return __atomic_fetch_or(p, v, __ATOMIC_SEQ_CST);
+}
+
+static inline LONG InterlockedAnd(volatile LONG *p, LONG v)
+{
+	return __atomic_fetch_and(p, v, __ATOMIC_SEQ_CST);
+}
+
+static inline PVOID InterlockedExchangePointer(PVOID volatile *p, PVOID v)
+{
+	return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	//PG0_POSIX_WINDOWS_H
+/* End of source */
@@ -0,0 +1,20 @@
+/*
+ * PG0
+ *
+ * posix/windowsx.h
+ *
+ *	コアで使用するマクロは無いため windows.h のみ読み込む
+ *
+ * Copyright (C) 1996-2018 by Ohno Tomoaki. All rights reserved.
+ *		https://www.nakka.com/
+ *		nakka@nakka.com
+ */
+
+#ifndef PG0_POSIX_WINDOWSX_H
+#define PG0_POSIX_WINDOWSX_H
+
+/* Include Files */
+#include <windows.h>
+
+#endif	//PG0_POSIX_WINDOWSX_H
+/* End of source */
@@ -0,0 +1,171 @@
+/*
+ * PG0 test
+ *
+ * test_breakpoint.c
+ *
+ *	ブレークポイントが実行コンテキストごとに保持され、インポートしたスクリプトにも反映されることを確認する
+ *
+ *	test_breakpoint [dir]
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define SCRIPT_NAME			TEXT("breakpoint.pg0")
+//ブレークポイントを設定する行 (0 から始まる行番号)
+#define BREAK_LINE			4
+#define MODULE_BREAK_LINE	2
+//BREAK_LINE を実行する回数
+#define BREAK_CNT			3
+
+#define CHECK(cond, msg) \
+	if (!(cond)) { _tprintf(TEXT("FAIL: %s\n"), msg); err++; } else { _tprintf(TEXT("ok: %s\n"), msg); }
+
+/* Global Variables */
+//ブレークポイントでコールバックが呼び出された回数
+static int hit_cnt;
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		_ftprintf(stderr, TEXT("%s\n"), param->v->u.sValue);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * BreakCallback - ブレークポイントで呼び出されたトークンを数える
+ */
+static int SFUNC BreakCallback(EXECINFO *ei, TOKEN *tk)
+{
+	if (tk != NULL && IsBreakPoint(ei->sci, tk) == TRUE) {
+		hit_cnt++;
+	}
+	return 0;
+}
+
+/*
+ * FindLineHead - 指定行に入る位置のトークンを検索
+ */
+static TOKEN *FindLineHead(TOKEN *tk, int line)
+{
+	TOKEN *ret;
+
+	for (; tk != NULL; tk = tk->next) {
+		if (tk->line_head == TRUE && tk->line == line) {
+			return tk;
+		}
+		if (tk->target != NULL && (ret = FindLineHead(tk->target, line)) != NULL) {
+			return ret;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * RunContext - ブレークポイントのみでコールバックを呼び出して実行
+ */
+static int RunContext(SCRIPTINFO *sci)
+{
+	VALUEINFO *rvi = NULL;
+
+	hit_cnt = 0;
+	sci->callback = (LIBFUNC)BreakCallback;
+	SetBreakOnly(sci, TRUE);
+	if (ExecScript(sci, NULL, &rvi) != 0) {
+		hit_cnt = -1;
+	}
+	FreeValueList(rvi);
+	return hit_cnt;
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	INSTANCEINFO *inst;
+	CODEINFO *code;
+	SCRIPTINFO *sci1, *sci2;
+	TOKEN *tk, *mtk;
+	TCHAR *dir = TEXT("");
+	int err = 0;
+
+	if (argc > 1) {
+		dir = argv[1];
+	}
+	InitializeScript();
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return 1;
+	}
+	SelectInstance(inst);
+	code = CompileScript(inst, dir, SCRIPT_NAME, FALSE, TRUE);
+	if (code == NULL) {
+		_tprintf(TEXT("FAIL: compile %s%s\n"), dir, SCRIPT_NAME);
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return 1;
+	}
+	sci1 = CreateScriptContext(inst, code);
+	sci2 = CreateScriptContext(inst, code);
+	if (sci1 == NULL || sci2 == NULL || sci1->next == NULL || sci2->next == NULL) {
+		_tprintf(TEXT("FAIL: context\n"));
+		return 1;
+	}
+	tk = FindLineHead(sci1->tk, BREAK_LINE);
+	mtk = FindLineHead(sci1->next->tk, MODULE_BREAK_LINE);
+	CHECK(tk != NULL && mtk != NULL, TEXT("line head tokens"));
+
+	// 解析結果を共有する他のコンテキストには影響しない
+	CHECK(SetBreakPoint(sci1, BREAK_LINE, TRUE) > 0, TEXT("set breakpoint"));
+	CHECK(IsBreakPoint(sci1, tk) == TRUE && IsBreakPoint(sci2, tk) == FALSE, TEXT("breakpoint per context"));
+	CHECK(RunContext(sci2) == 0, TEXT("no hit in other context"));
+	CHECK(RunContext(sci1) == BREAK_CNT, TEXT("hit in own context"));
+
+	// インポートしたスクリプト
+	CHECK(sci1->next->break_only == TRUE && sci2->next->break_only == TRUE, TEXT("break only propagated to module"));
+	CHECK(SetBreakPoint(sci1->next, MODULE_BREAK_LINE, TRUE) > 0, TEXT("set module breakpoint"));
+	CHECK(IsBreakPoint(sci1->next, mtk) == TRUE && IsBreakPoint(sci2->next, mtk) == FALSE, TEXT("module breakpoint per context"));
+	ClearBreakPoint(sci1);
+	CHECK(IsBreakPoint(sci1, tk) == FALSE && IsBreakPoint(sci1->next, mtk) == FALSE, TEXT("clear all modules"));
+
+	FreeScriptInfo(sci1);
+	FreeScriptInfo(sci2);
+	ReleaseCode(code);
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+	EndScript();
+	return (err > 0) ? 1 : 0;
+}
+/* End of source */
@@ -0,0 +1,267 @@
+/*
+ * PG0 test
+ *
+ * test_instance.c
+ *
+ *	複数のスレッドでインスタンスの作成、実行、破棄を同時に繰り返し、
+ *	インスタンスのヒープが互いに独立し、解放後に空になることを確認する
+ *
+ *	test_instance
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define THREAD_CNT			8
+#define ROUND_CNT			20
+//スレッドごとに作成する文字列の長さの単位
+#define STR_LEN				100
+
+//スレッドごとに長さの異なる文字列を作成して配列に格納する
+#define TEST_SRC			TEXT("s = \"\"; for (i = 0; i < len; i++) { s = s + \"x\"; } ") \
+							TEXT("a = {}; for (i = 0; i < 50; i++) { a[i] = s + i; } ") \
+							TEXT("check(a[49]); return length(s);")
+
+/* Struct */
+typedef struct _THREADINFO {
+	int index;
+	HANDLE hStart;
+	//実行中のインスタンス
+	INSTANCEINFO *inst;
+	//全ラウンドのインスタンスの使用サイズを加算するヒープ
+	MEMHEAP *total;
+	int err;
+} THREADINFO;
+
+/* Global Variables */
+static THREADINFO ti[THREAD_CNT];
+//実行中のインスタンスのヒープ (同時に存在するヒープが重ならないことを確認)
+static MEMHEAP *volatile running_mh[THREAD_CNT];
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		_ftprintf(stderr, TEXT("%s\n"), param->v->u.sValue);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * func_check - 実行中のスレッドが自身のインスタンスのヒープを使用していることを確認
+ */
+static int SFUNC func_check(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	INSTANCEINFO *inst = ei->sci->sci_top->inst;
+	THREADINFO *t = (THREADINFO *)inst->param;
+	SIZE_T size;
+	int i;
+
+	if (t == NULL) {
+		_tprintf(TEXT("FAIL: instance without thread info\n"));
+		return -1;
+	}
+	if (t->inst != inst || mem_heap_get() != inst->mh) {
+		_tprintf(TEXT("FAIL: thread %d: current heap is not the instance heap\n"), t->index);
+		t->err++;
+		return 0;
+	}
+	for (i = 0; i < THREAD_CNT; i++) {
+		if (i != t->index && running_mh[i] == inst->mh) {
+			_tprintf(TEXT("FAIL: thread %d: heap shared with thread %d\n"), t->index, i);
+			t->err++;
+		}
+	}
+	// 引数の文字列は自身のヒープで確保されている
+	GetInstanceMemory(inst, &size, NULL);
+	if (param == NULL || param->v->type != TYPE_STRING ||
+		size < (SIZE_T)((t->index + 1) * STR_LEN * 50) * sizeof(TCHAR)) {
+		_tprintf(TEXT("FAIL: thread %d: instance heap size %llu\n"), t->index, (unsigned long long)size);
+		t->err++;
+	}
+	return 0;
+}
+
+/*
+ * RunRound - インスタンスを作成してスクリプトを実行し破棄する
+ */
+static void RunRound(THREADINFO *t)
+{
+	INSTANCEINFO *inst;
+	SCRIPTINFO *sci;
+	EXECINFO ei;
+	VALUEINFO *pvi, *rvi = NULL;
+	SIZE_T base, size, peak;
+	int len = (t->index + 1) * STR_LEN;
+	int r;
+
+	inst = CreateInstance();
+	if (inst == NULL) {
+		_tprintf(TEXT("FAIL: thread %d: create instance\n"), t->index);
+		t->err++;
+		return;
+	}
+	mem_heap_set_parent(inst->mh, t->total);
+	RegisterFunction(inst, TEXT("check"), (LIBFUNC)func_check);
+	inst->param = t;
+	t->inst = inst;
+	SelectInstance(inst);
+	GetInstanceMemory(inst, &base, NULL);
+
+	sci = CreateScriptInfo(inst, FALSE, TRUE);
+	if (sci == NULL) {
+		_tprintf(TEXT("FAIL: thread %d: script info\n"), t->index);
+		t->err++;
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return;
+	}
+	ZeroMemory(&ei, sizeof(EXECINFO));
+	ei.sci = sci;
+	sci->tk = ParseSentence(&ei, TEST_SRC, 0);
+	pvi = AllocValue();
+	if (sci->tk == NULL || pvi == NULL) {
+		_tprintf(TEXT("FAIL: thread %d: parse\n"), t->index);
+		t->err++;
+		FreeValueList(pvi);
+		FreeScriptInfo(sci);
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return;
+	}
+	pvi->name = alloc_copy(TEXT("len"));
+	pvi->name_hash = str2hash(TEXT("len"));
+	pvi->v->type = TYPE_INTEGER;
+	pvi->v->u.iValue = len;
+
+	running_mh[t->index] = inst->mh;
+	r = ExecScript(sci, pvi, &rvi);
+	running_mh[t->index] = NULL;
+	if (r != 0 || rvi == NULL || rvi->v->type != TYPE_INTEGER || rvi->v->u.iValue != len) {
+		_tprintf(TEXT("FAIL: thread %d: ret %d\n"), t->index, r);
+		t->err++;
+	}
+	FreeValueList(rvi);
+	FreeScriptInfo(sci);
+
+	// 実行で確保したメモリはすべてインスタンスのヒープに戻る
+	GetInstanceMemory(inst, &size, &peak);
+	if (size != base || peak <= base) {
+		_tprintf(TEXT("FAIL: thread %d: size %llu, base %llu, peak %llu\n"), t->index,
+			(unsigned long long)size, (unsigned long long)base, (unsigned long long)peak);
+		t->err++;
+	}
+	SelectInstance(NULL);
+	t->inst = NULL;
+	DestroyInstance(inst);
+
+	// 破棄後は親のヒープにも何も残らない
+	mem_heap_usage(t->total, &size, NULL);
+	if (size != 0) {
+		_tprintf(TEXT("FAIL: thread %d: %llu bytes left after destroy\n"), t->index, (unsigned long long)size);
+		t->err++;
+	}
+}
+
+/*
+ * InstanceThread - ラウンドを繰り返すスレッド
+ */
+static DWORD WINAPI InstanceThread(LPVOID param)
+{
+	THREADINFO *t = (THREADINFO *)param;
+	int i;
+
+	WaitForSingleObject(t->hStart, INFINITE);
+	for (i = 0; i < ROUND_CNT; i++) {
+		RunRound(t);
+	}
+	return 0;
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	HANDLE hThread[THREAD_CNT];
+	HANDLE hStart;
+	SIZE_T peak;
+	int err = 0;
+	int cnt;
+	int i;
+
+	InitializeScript();
+	hStart = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (hStart == NULL) {
+		return 1;
+	}
+	for (cnt = 0; cnt < THREAD_CNT; cnt++) {
+		ti[cnt].index = cnt;
+		ti[cnt].hStart = hStart;
+		ti[cnt].total = mem_heap_create();
+		if (ti[cnt].total == NULL) {
+			return 1;
+		}
+		hThread[cnt] = CreateThread(NULL, 0, InstanceThread, &ti[cnt], 0, NULL);
+		if (hThread[cnt] == NULL) {
+			_tprintf(TEXT("FAIL: create thread\n"));
+			return 1;
+		}
+	}
+	// すべてのスレッドを同時に開始
+	SetEvent(hStart);
+	WaitForMultipleObjects(cnt, hThread, TRUE, INFINITE);
+
+	for (i = 0; i < cnt; i++) {
+		CloseHandle(hThread[i]);
+		// 他のスレッドの確保が加算されていないことを使用サイズの最大値で確認
+		mem_heap_usage(ti[i].total, NULL, &peak);
+		if (i > 0 && ti[i - 1].err == 0 && ti[i].err == 0) {
+			SIZE_T prev_peak;
+			mem_heap_usage(ti[i - 1].total, NULL, &prev_peak);
+			if (peak <= prev_peak) {
+				_tprintf(TEXT("FAIL: thread %d: peak %llu <= thread %d peak %llu\n"), i,
+					(unsigned long long)peak, i - 1, (unsigned long long)prev_peak);
+				ti[i].err++;
+			}
+		}
+		if (ti[i].err == 0) {
+			_tprintf(TEXT("ok: thread %d (%d rounds, peak %llu)\n"), i, ROUND_CNT, (unsigned long long)peak);
+		}
+		err += ti[i].err;
+		mem_heap_destroy(ti[i].total);
+	}
+	CloseHandle(hStart);
+	EndScript();
+	return (err > 0) ? 1 : 0;
+}
+/* End of source */
@@ -0,0 +1,142 @@
+/*
+ * PG0 test
+ *
+ * test_memory.c
+ *
+ *	インスタンスのメモリ上限に達したスクリプトが ERR_ALLOC で終了することを確認する
+ *
+ *	test_memory
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define MEMORY_LIMIT		4096
+
+/* Global Variables */
+//出力されたエラー
+static TCHAR err_buf[BUF_SIZE];
+
+//テストするスクリプト
+static TCHAR *test_src[] = {
+	//文字列の連結
+	TEXT("s = \"x\"; i = 0; while (i < 40) { s = s + s; i++; } print(length(s));"),
+	TEXT("s = \"x\"; while (1) { s = s + s; }"),
+	//配列の連結
+	TEXT("a = {1, 2, 3}; while (1) { a = a + a; }"),
+	//配列の要素の追加
+	TEXT("i = 0; while (1) { a[i] = \"value\" + i; i++; }"),
+};
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力 (最後のエラーを保持)
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		lstrcpyn(err_buf, param->v->u.sValue, BUF_SIZE);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * TestLimit - メモリの上限を設定して実行
+ */
+static BOOL TestLimit(TCHAR *src)
+{
+	INSTANCEINFO *inst;
+	SCRIPTINFO *sci;
+	EXECINFO ei;
+	VALUEINFO *rvi = NULL;
+	SIZE_T size, peak;
+	int ret;
+
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return FALSE;
+	}
+	SelectInstance(inst);
+	sci = CreateScriptInfo(inst, FALSE, TRUE);
+	if (sci == NULL) {
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return FALSE;
+	}
+	ZeroMemory(&ei, sizeof(EXECINFO));
+	ei.sci = sci;
+	sci->tk = ParseSentence(&ei, src, 0);
+	if (sci->tk == NULL) {
+		_tprintf(TEXT("FAIL: parse error: %s\n"), src);
+		FreeScriptInfo(sci);
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return FALSE;
+	}
+	//解析済みの分に上限を加える
+	GetInstanceMemory(inst, &size, &peak);
+	SetInstanceMemoryLimit(inst, size + MEMORY_LIMIT);
+
+	*err_buf = TEXT('\0');
+	ret = ExecScript(sci, NULL, &rvi);
+	FreeValueList(rvi);
+	FreeScriptInfo(sci);
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+
+	if (ret != RET_ERROR) {
+		_tprintf(TEXT("FAIL: ret = %d: %s\n"), ret, src);
+		return FALSE;
+	}
+	if (_tcsstr(err_buf, TEXT("Alloc failed")) == NULL) {
+		_tprintf(TEXT("FAIL: error \"%s\": %s\n"), err_buf, src);
+		return FALSE;
+	}
+	_tprintf(TEXT("ok: %s\n"), src);
+	return TRUE;
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	int err = 0;
+	int i;
+
+	InitializeScript();
+	for (i = 0; i < sizeof(test_src) / sizeof(TCHAR *); i++) {
+		if (TestLimit(test_src[i]) == FALSE) {
+			err++;
+		}
+	}
+	EndScript();
+	return (err > 0) ? 1 : 0;
+}
+/* End of source */
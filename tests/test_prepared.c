@@ -0,0 +1,183 @@
+/*
+ * PG0 test
+ *
+ * test_prepared.c
+ *
+ *	準備済みスクリプトのトップレベルが準備時に1回だけ実行され、関数の呼び出しで更新した
+ *	グローバル変数が実行ごとのヒープの巻き戻し後も保持されることを確認する
+ *
+ *	test_prepared [dir]
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define SCRIPT_NAME			TEXT("prepared.pg0")
+//関数を呼び出す回数
+#define CALL_CNT			200
+
+#define CHECK(cond, msg) \
+	if (!(cond)) { _tprintf(TEXT("FAIL: %s\n"), msg); err++; } else { _tprintf(TEXT("ok: %s\n"), msg); }
+
+/* Global Variables */
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	if (param != NULL && param->v->type == TYPE_STRING) {
+		_ftprintf(stderr, TEXT("%s\n"), param->v->u.sValue);
+	}
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * SetInt - 整数の引数を設定
+ */
+static void SetInt(VALUE *v, int i)
+{
+	ZeroMemory(v, sizeof(VALUE));
+	v->type = TYPE_INTEGER;
+	v->u.iValue = i;
+}
+
+/*
+ * SetString - 文字列の引数を設定
+ */
+static void SetString(VALUE *v, TCHAR *str)
+{
+	ZeroMemory(v, sizeof(VALUE));
+	v->type = TYPE_STRING;
+	v->u.sValue = str;
+}
+
+/*
+ * IsString - 戻り値の文字列を比較
+ */
+static BOOL IsString(VALUE *v, TCHAR *str)
+{
+	return (v != NULL && v->type == TYPE_STRING && v->u.sValue != NULL && lstrcmp(v->u.sValue, str) == 0) ? TRUE : FALSE;
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	INSTANCEINFO *inst;
+	CODEINFO *code;
+	PREPAREINFO *pp;
+	VALUE args[2];
+	VALUE *rv;
+	SIZE_T size1, size2;
+	TCHAR *dir = TEXT("");
+	BOOL ok;
+	int err = 0;
+	int i;
+
+	if (argc > 1) {
+		dir = argv[1];
+	}
+	InitializeScript();
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return 1;
+	}
+	SelectInstance(inst);
+	code = CompileScript(inst, dir, SCRIPT_NAME, FALSE, TRUE);
+	if (code == NULL) {
+		_tprintf(TEXT("FAIL: compile %s%s\n"), dir, SCRIPT_NAME);
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return 1;
+	}
+	pp = PrepareScript(inst, code);
+	ReleaseCode(code);
+	if (pp == NULL) {
+		_tprintf(TEXT("FAIL: prepare\n"));
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return 1;
+	}
+
+	// 関数で更新したグローバル変数 (整数、配列の要素、文字列) は次の実行以降も残る
+	for (i = 1, ok = TRUE; i <= CALL_CNT; i++) {
+		SetInt(&args[0], i);
+		if (InvokeScript(pp, TEXT("add"), args, 1, &rv) != 0 || rv == NULL ||
+			rv->type != TYPE_INTEGER || rv->u.iValue != i) {
+			ok = FALSE;
+		}
+	}
+	CHECK(ok == TRUE, TEXT("top level runs once, counter kept"));
+	SetInt(&args[0], 1);
+	CHECK(InvokeScript(pp, TEXT("get"), args, 1, &rv) == 0 && IsString(rv, TEXT("n1v200")), TEXT("first element kept"));
+	SetInt(&args[0], CALL_CNT);
+	CHECK(InvokeScript(pp, TEXT("get"), args, 1, &rv) == 0 && IsString(rv, TEXT("n200v200")), TEXT("last element kept"));
+
+	// インポートしたスクリプトの変数も保持する
+	SetString(&args[0], TEXT("x"));
+	SetString(&args[1], TEXT("y"));
+	CHECK(InvokeScript(pp, TEXT("cat"), args, 2, &rv) == 0 && IsString(rv, TEXT("xym1")), TEXT("string arguments"));
+	CHECK(InvokeScript(pp, TEXT("cat"), args, 2, &rv) == 0 && IsString(rv, TEXT("xym2")), TEXT("module variable kept"));
+
+	// トップレベルは実行ごとの変数で実行し、グローバル変数は変更しない
+	SetInt(&args[0], 21);
+	CHECK(InvokeScript(pp, NULL, args, 1, &rv) == 0 && rv != NULL && rv->type == TYPE_INTEGER && rv->u.iValue == 42,
+		TEXT("top level invoke"));
+	SetInt(&args[0], 0);
+	CHECK(InvokeScript(pp, TEXT("add"), args, 1, &rv) == 0 && rv != NULL && rv->u.iValue == CALL_CNT + 1,
+		TEXT("globals kept after top level invoke"));
+
+	// エラー後も実行できる
+	CHECK(InvokeScript(pp, TEXT("none"), args, 1, &rv) == -1 && rv == NULL, TEXT("unknown function"));
+	SetInt(&args[0], CALL_CNT);
+	CHECK(InvokeScript(pp, TEXT("get"), args, 1, &rv) == 0 && IsString(rv, TEXT("n200v0")), TEXT("invoke after error"));
+
+	// グローバル変数を変更しない実行はメモリを増やさない
+	for (i = 0; i < 10; i++) {
+		InvokeScript(pp, TEXT("get"), args, 1, &rv);
+	}
+	GetInstanceMemory(inst, &size1, NULL);
+	for (i = 0; i < 1000; i++) {
+		InvokeScript(pp, TEXT("get"), args, 1, &rv);
+	}
+	GetInstanceMemory(inst, &size2, NULL);
+	CHECK(size1 == size2, TEXT("memory stable across invokes"));
+
+	FreePrepared(pp);
+	GetInstanceMemory(inst, &size1, NULL);
+	CHECK(size1 < size2, TEXT("memory released"));
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+	EndScript();
+	return (err > 0) ? 1 : 0;
+}
+/* End of source */
@@ -0,0 +1,153 @@
+/*
+ * PG0 test
+ *
+ * test_stats.c
+ *
+ *	実行の統計で確保と解放の数がスクリプト情報の解放後に一致することを確認する
+ *
+ *	test_stats [dir]
+ */
+
+/* Include Files */
+#include <windows.h>
+#include <stdio.h>
+
+#include "../PG0/script.h"
+#include "../PG0/script_string.h"
+#include "../PG0/script_memory.h"
+#include "../PG0/script_utility.h"
+
+/* Define */
+#define MEMORY_LIMIT		(64 * 1024)
+
+/* Global Variables */
+static TCHAR *stat_obj_name[STAT_OBJ_SIZE] = {
+	TEXT("value"),
+	TEXT("string"),
+	TEXT("frame"),
+	TEXT("funcaddr"),
+};
+
+/* Local Function Prototypes */
+
+/*
+ * _lib_func_error - エラー出力 (出力しない)
+ */
+int SFUNC _lib_func_error(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_print - 出力 (出力しない)
+ */
+int SFUNC _lib_func_print(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	return 0;
+}
+
+/*
+ * _lib_func_input - 入力 (常に空文字)
+ */
+int SFUNC _lib_func_input(EXECINFO *ei, VALUEINFO *param, VALUEINFO *ret, TCHAR *ErrStr)
+{
+	ret->v->u.sValue = alloc_copy(TEXT(""));
+	ret->v->type = TYPE_STRING;
+	return 0;
+}
+
+/*
+ * CreateArgs - 引数の作成
+ */
+static VALUEINFO *CreateArgs(TCHAR *name)
+{
+	VALUEINFO *pvi;
+
+	pvi = AllocValue();
+	if (pvi == NULL) {
+		return NULL;
+	}
+	pvi->name = alloc_copy(TEXT("argv"));
+	pvi->name_hash = str2hash(TEXT("argv"));
+	pvi->v->type = TYPE_ARRAY;
+	pvi->v->u.array = StringToVariable(NULL, name);
+	return pvi;
+}
+
+/*
+ * TestStats - スクリプトを実行して確保と解放の数を比較
+ */
+static BOOL TestStats(TCHAR *dir, TCHAR *name, SIZE_T limit)
+{
+	INSTANCEINFO *inst;
+	SCRIPTINFO *sci;
+	STATINFO stat;
+	VALUEINFO *rvi = NULL;
+	BOOL ret = TRUE;
+	int r = -1;
+	int i;
+
+	inst = CreateInstance();
+	if (inst == NULL) {
+		return FALSE;
+	}
+	SetInstanceMemoryLimit(inst, limit);
+	SelectInstance(inst);
+	if (SetInstanceStat(inst, TRUE) == FALSE) {
+		SelectInstance(NULL);
+		DestroyInstance(inst);
+		return FALSE;
+	}
+	sci = CreateScriptInfo(inst, FALSE, TRUE);
+	if (sci != NULL) {
+		ReadScriptFile(sci, dir, name);
+		if (sci->tk != NULL) {
+			r = ExecScript(sci, CreateArgs(name), &rvi);
+		}
+		FreeValueList(rvi);
+		FreeScriptInfo(sci);
+	}
+	// インスタンスの破棄後に比較
+	stat = *GetInstanceStat(inst);
+	SelectInstance(NULL);
+	DestroyInstance(inst);
+
+	for (i = 0; i < STAT_OBJ_SIZE; i++) {
+		if (stat.alloc[i] != stat.free[i]) {
+			_tprintf(TEXT("FAIL: %s %s alloc %lld, free %lld\n"), name, stat_obj_name[i], stat.alloc[i], stat.free[i]);
+			ret = FALSE;
+		}
+	}
+	if (stat.alloc[STAT_OBJ_STRING] == 0) {
+		_tprintf(TEXT("FAIL: %s no string allocs\n"), name);
+		ret = FALSE;
+	}
+	if (ret == TRUE) {
+		_tprintf(TEXT("ok: %s (ret %d, string %lld)\n"), name, r, stat.alloc[STAT_OBJ_STRING]);
+	}
+	return ret;
+}
+
+/*
+ * _tmain - メイン
+ */
+int _tmain(int argc, TCHAR **argv)
+{
+	TCHAR *dir = TEXT("");
+	int err = 0;
+
+	if (argc > 1) {
+		dir = argv[1];
+	}
+	InitializeScript();
+	if (TestStats(dir, TEXT("stats.pg0"), 0) == FALSE) {
+		err++;
+	}
+	// メモリの上限で中断した場合
+	if (TestStats(dir, TEXT("alloc_loop.pg0"), MEMORY_LIMIT) == FALSE) {
+		err++;
+	}
+	EndScript();
+	return (err > 0) ? 1 : 0;
+}
+/* End of source */